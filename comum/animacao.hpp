@@ -0,0 +1,383 @@
+// Animação com passo fixo, interpolação para o desenho e trilhas de quadros-chave
+//
+// O movimento deixa de depender da taxa de quadros: a simulação avança sempre em passos
+// de duração fixa (PassoFixo conta quantos passos couberam no tempo real decorrido) e o
+// desenho mostra o estado interpolado entre os dois últimos passos, com o fator
+// alfa(). Assim a taxa de desenho pode cair sem mudar a velocidade do movimento.
+//
+// Poses guarda N transformações (translação, quatérnio e escala) em arrays separados,
+// no mesmo layout do grafo de cena (grafo_cena.hpp), para serem interpoladas e aplicadas
+// em lote.
+//
+// Trilhas guarda quadros-chave de translação, rotação ou escala de cada pose e avalia
+// todas as trilhas de uma vez para um instante; com muitas trilhas a avaliação é
+// dividida entre os trabalhadores de tarefas::padrao(). Cada trilha lembra o último
+// segmento usado, de modo que tempos crescentes não precisam de busca.
+//
+// SimulacaoEmThread executa os passos em uma thread própria, no ritmo do relógio, e
+// publica os dois últimos estados; a thread de desenho só interpola.
+//
+// Uso com a simulação na thread principal:
+//   animacao::PassoFixo relogio(1.0 / 120.0);
+//   for (int n = relogio.avancar(glfwGetTime()); n > 0; --n) {
+//       std::swap(anterior, atual);
+//       // tempoSimulado() já é o instante do último passo; este é o n-ésimo antes dele
+//       trilhas.avaliar(relogio.tempoSimulado() - (n - 1) * relogio.passo(), atual);
+//   }
+//   animacao::interpolar(anterior, atual, relogio.alfa(), desenho);
+//   animacao::aplicar(desenho, grafo, nos);
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "grafo_cena.hpp"
+#include "tarefas.hpp"
+
+namespace animacao {
+
+//--------------------------------------------------------------------------------
+// Estado de N transformações em arrays separados (SoA)
+struct Poses {
+    std::vector<float> tx, ty, tz;      // Translação
+    std::vector<float> qx, qy, qz, qw;  // Rotação (quatérnio unitário)
+    std::vector<float> ex, ey, ez;      // Escala
+
+    // Novas poses começam na identidade
+    void redimensionar(size_t n) {
+        for (std::vector<float>* v : {&tx, &ty, &tz, &qx, &qy, &qz})
+            v->resize(n, 0.0f);
+        qw.resize(n, 1.0f);
+        ex.resize(n, 1.0f); ey.resize(n, 1.0f); ez.resize(n, 1.0f);
+    }
+    size_t tamanho() const { return qw.size(); }
+};
+
+// saida = a + (b - a) * alfa; rotações por nlerp (interpolação linear normalizada) pelo
+// caminho mais curto. Entre dois passos de simulação próximos equivale ao slerp.
+inline void interpolar(const Poses& a, const Poses& b, float alfa, Poses& saida) {
+    size_t n = std::min(a.tamanho(), b.tamanho());
+    saida.redimensionar(n);
+    float beta = 1.0f - alfa;
+    for (size_t i = 0; i < n; ++i) {
+        saida.tx[i] = a.tx[i] * beta + b.tx[i] * alfa;
+        saida.ty[i] = a.ty[i] * beta + b.ty[i] * alfa;
+        saida.tz[i] = a.tz[i] * beta + b.tz[i] * alfa;
+        saida.ex[i] = a.ex[i] * beta + b.ex[i] * alfa;
+        saida.ey[i] = a.ey[i] * beta + b.ey[i] * alfa;
+        saida.ez[i] = a.ez[i] * beta + b.ez[i] * alfa;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        float d = a.qx[i] * b.qx[i] + a.qy[i] * b.qy[i] + a.qz[i] * b.qz[i] + a.qw[i] * b.qw[i];
+        float s = std::copysign(alfa, d); // q e -q são a mesma rotação: segue o caminho curto
+        float x = a.qx[i] * beta + b.qx[i] * s, y = a.qy[i] * beta + b.qy[i] * s;
+        float z = a.qz[i] * beta + b.qz[i] * s, w = a.qw[i] * beta + b.qw[i] * s;
+        float inverso = 1.0f / std::sqrt(std::max(x * x + y * y + z * z + w * w, 1e-20f));
+        saida.qx[i] = x * inverso; saida.qy[i] = y * inverso; saida.qz[i] = z * inverso; saida.qw[i] = w * inverso;
+    }
+}
+
+// Copia as poses para os nós do grafo: a pose i vai para o nó nos[i]
+inline void aplicar(const Poses& poses, grafo::GrafoCena& grafoCena, const std::vector<int>& nos) {
+    size_t n = std::min(poses.tamanho(), nos.size());
+    for (size_t i = 0; i < n; ++i) {
+        grafoCena.definirTranslacao(nos[i], poses.tx[i], poses.ty[i], poses.tz[i]);
+        grafoCena.definirQuaternio(nos[i], poses.qx[i], poses.qy[i], poses.qz[i], poses.qw[i]);
+        grafoCena.definirEscala(nos[i], poses.ex[i], poses.ey[i], poses.ez[i]);
+    }
+}
+
+//--------------------------------------------------------------------------------
+// Acumulador de passo fixo
+class PassoFixo {
+public:
+    // maximoPassos limita a recuperação depois de uma pausa longa (o excesso é descartado),
+    // para a simulação não entrar em espiral tentando alcançar o relógio
+    explicit PassoFixo(double passo = 1.0 / 120.0, int maximoPassos = 8)
+        : duracaoPasso(passo), maximoPassos(maximoPassos) {
+        if (passo <= 0.0)
+            throw std::invalid_argument("O passo da simulação precisa ser positivo");
+    }
+
+    // Recebe o tempo real atual (em segundos) e devolve quantos passos simular agora.
+    // O primeiro chamado só fixa a origem do relógio.
+    int avancar(double tempoReal) {
+        if (!iniciado) {
+            ultimoTempoReal = tempoReal;
+            iniciado = true;
+            return 0;
+        }
+        acumulado += std::max(0.0, tempoReal - ultimoTempoReal);
+        ultimoTempoReal = tempoReal;
+        int passos = static_cast<int>(acumulado / duracaoPasso);
+        if (passos > maximoPassos) {
+            descartados += passos - maximoPassos;
+            passos = maximoPassos;
+            acumulado = passos * duracaoPasso + std::fmod(acumulado, duracaoPasso);
+        }
+        acumulado -= passos * duracaoPasso;
+        contagemPassos += passos;
+        return passos;
+    }
+
+    // Fração do próximo passo já decorrida, em [0, 1): peso do estado atual na interpolação
+    float alfa() const { return static_cast<float>(acumulado / duracaoPasso); }
+    double passo() const { return duracaoPasso; }
+    // Instante do último passo calculado (ao terminar o laço de avancar())
+    double tempoSimulado() const { return contagemPassos * duracaoPasso; }
+    uint64_t passos() const { return contagemPassos; }
+    uint64_t passosDescartados() const { return descartados; }
+
+private:
+    double duracaoPasso;
+    int maximoPassos;
+    bool iniciado = false;
+    double ultimoTempoReal = 0.0;
+    double acumulado = 0.0;
+    uint64_t contagemPassos = 0;
+    uint64_t descartados = 0;
+};
+
+//--------------------------------------------------------------------------------
+// Trilhas de quadros-chave
+
+enum Canal : uint8_t {
+    TRANSLACAO,
+    ROTACAO,  // Quatérnios x, y, z, w
+    ESCALA
+};
+
+class Trilhas {
+public:
+    // tempos: crescentes, em segundos; valores: 3 floats por chave (4 para ROTACAO).
+    // repetir = true volta ao início depois da última chave; senão a última é mantida.
+    size_t adicionar(uint32_t pose, Canal canal, const std::vector<float>& tempos, const std::vector<float>& valores,
+                     bool repetir = false) {
+        size_t componentes = canal == ROTACAO ? 4 : 3;
+        if (tempos.empty() || valores.size() != tempos.size() * componentes)
+            throw std::invalid_argument("Trilha com número de valores diferente do número de chaves");
+        for (size_t k = 1; k < tempos.size(); ++k)
+            if (tempos[k] <= tempos[k - 1])
+                throw std::invalid_argument("Os tempos das chaves precisam ser crescentes");
+
+        Trilha trilha;
+        trilha.pose = pose;
+        trilha.canal = canal;
+        trilha.repetir = repetir;
+        trilha.primeiraChave = static_cast<uint32_t>(temposChaves.size());
+        trilha.numeroChaves = static_cast<uint32_t>(tempos.size());
+        trilhas.push_back(trilha);
+        numeroPoses = std::max<size_t>(numeroPoses, size_t(pose) + 1);
+        for (size_t k = 0; k < tempos.size(); ++k) {
+            temposChaves.push_back(tempos[k]);
+            // Sempre 4 floats por chave: acesso uniforme para qualquer canal
+            for (size_t c = 0; c < 4; ++c)
+                valoresChaves.push_back(c < componentes ? valores[k * componentes + c] : 0.0f);
+        }
+        return trilhas.size() - 1;
+    }
+
+    // Avalia todas as trilhas no instante "tempo" e escreve o resultado nas poses
+    // (que crescem se preciso). Trilhas diferentes não podem mexer no mesmo canal da mesma pose.
+    void avaliar(double tempo, Poses& poses) {
+        if (poses.tamanho() < numeroPoses)
+            poses.redimensionar(numeroPoses);
+        const size_t granulo = 2048; // Abaixo disso dividir não compensa
+        if (trilhas.size() <= granulo) {
+            avaliarIntervalo(tempo, poses, 0, trilhas.size());
+            return;
+        }
+        tarefas::padrao().paraleloPara(0, trilhas.size(), granulo, [&](size_t inicio, size_t fim) {
+            avaliarIntervalo(tempo, poses, inicio, fim);
+        });
+    }
+
+    size_t numeroTrilhas() const { return trilhas.size(); }
+
+    // Número de poses que avaliar() preenche (maior pose alvo + 1)
+    size_t numeroPosesAlvo() const { return numeroPoses; }
+
+    // Duração da trilha mais longa
+    float duracao() const {
+        float d = 0.0f;
+        for (const Trilha& t : trilhas)
+            d = std::max(d, temposChaves[t.primeiraChave + t.numeroChaves - 1]);
+        return d;
+    }
+
+private:
+    struct Trilha {
+        uint32_t pose;
+        uint32_t primeiraChave;
+        uint32_t numeroChaves;
+        uint32_t segmento = 0; // Último segmento usado, ponto de partida da próxima busca
+        Canal canal;
+        bool repetir;
+    };
+
+    void avaliarIntervalo(double tempo, Poses& poses, size_t inicio, size_t fim) {
+        for (size_t i = inicio; i < fim; ++i) {
+            Trilha& trilha = trilhas[i];
+            const float* tempos = &temposChaves[trilha.primeiraChave];
+            const float* valores = &valoresChaves[size_t(trilha.primeiraChave) * 4];
+            uint32_t n = trilha.numeroChaves;
+
+            // Tempo local da trilha (com repetição, módulo a duração)
+            double t = tempo;
+            if (trilha.repetir && n > 1 && t > tempos[n - 1])
+                t = tempos[0] + std::fmod(t - tempos[0], double(tempos[n - 1] - tempos[0]));
+
+            float resultado[4];
+            if (n == 1 || t <= tempos[0]) {
+                std::copy(valores, valores + 4, resultado);
+            } else if (t >= tempos[n - 1]) {
+                std::copy(valores + size_t(n - 1) * 4, valores + size_t(n) * 4, resultado);
+            } else {
+                // Procura o segmento [k, k+1] que contém t, a partir do último usado
+                uint32_t k = std::min(trilha.segmento, n - 2);
+                if (t < tempos[k])
+                    k = static_cast<uint32_t>(std::upper_bound(tempos, tempos + n, float(t)) - tempos) - 1;
+                while (t >= tempos[k + 1])
+                    ++k;
+                trilha.segmento = k;
+                float u = static_cast<float>((t - tempos[k]) / (tempos[k + 1] - tempos[k]));
+                const float* a = valores + size_t(k) * 4;
+                const float* b = a + 4;
+                if (trilha.canal == ROTACAO) {
+                    float d = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+                    float s = std::copysign(u, d);
+                    float norma = 0.0f;
+                    for (int c = 0; c < 4; ++c) {
+                        resultado[c] = a[c] * (1.0f - u) + b[c] * s;
+                        norma += resultado[c] * resultado[c];
+                    }
+                    float inverso = 1.0f / std::sqrt(std::max(norma, 1e-20f));
+                    for (int c = 0; c < 4; ++c)
+                        resultado[c] *= inverso;
+                } else {
+                    for (int c = 0; c < 3; ++c)
+                        resultado[c] = a[c] + (b[c] - a[c]) * u;
+                }
+            }
+
+            uint32_t p = trilha.pose;
+            switch (trilha.canal) {
+            case TRANSLACAO:
+                poses.tx[p] = resultado[0]; poses.ty[p] = resultado[1]; poses.tz[p] = resultado[2];
+                break;
+            case ROTACAO:
+                poses.qx[p] = resultado[0]; poses.qy[p] = resultado[1]; poses.qz[p] = resultado[2]; poses.qw[p] = resultado[3];
+                break;
+            case ESCALA:
+                poses.ex[p] = resultado[0]; poses.ey[p] = resultado[1]; poses.ez[p] = resultado[2];
+                break;
+            }
+        }
+    }
+
+    std::vector<Trilha> trilhas;
+    std::vector<float> temposChaves;
+    std::vector<float> valoresChaves; // 4 floats por chave
+    size_t numeroPoses = 0;
+};
+
+// Quatérnio (x, y, z, w) da rotação de "angulo" radianos em torno do eixo unitário (x, y, z)
+inline void quaternioEixoAngulo(float angulo, float x, float y, float z, float q[4]) {
+    float s = std::sin(0.5f * angulo);
+    q[0] = x * s; q[1] = y * s; q[2] = z * s; q[3] = std::cos(0.5f * angulo);
+}
+
+//--------------------------------------------------------------------------------
+// Simulação de passo fixo em uma thread própria
+class SimulacaoEmThread {
+public:
+    // Avança "estado" de "tempo" para "tempo + passo"
+    using FuncaoPasso = std::function<void(Poses& estado, double tempo, double passo)>;
+
+    SimulacaoEmThread() = default;
+    SimulacaoEmThread(const SimulacaoEmThread&) = delete;
+    SimulacaoEmThread& operator=(const SimulacaoEmThread&) = delete;
+    ~SimulacaoEmThread() { parar(); }
+
+    void iniciar(const Poses& inicial, double passo, FuncaoPasso funcao) {
+        parar();
+        duracaoPasso = passo;
+        funcaoPasso = std::move(funcao);
+        anterior = atual = inicial;
+        contagemPassos = 0;
+        inicio = Relogio::now();
+        instanteAtual = inicio;
+        executando = true;
+        trabalhador = std::thread([this] { laco(); });
+    }
+
+    void parar() {
+        {
+            std::lock_guard<std::mutex> trava(mutex);
+            executando = false;
+        }
+        acordar.notify_all();
+        if (trabalhador.joinable())
+            trabalhador.join();
+    }
+
+    // Estado a desenhar agora: interpola os dois últimos passos publicados. Mostra o
+    // movimento com um passo de atraso, o preço de nunca esperar pela simulação.
+    void amostrar(Poses& saida) {
+        std::lock_guard<std::mutex> trava(mutex);
+        double alfa = std::chrono::duration<double>(Relogio::now() - instanteAtual).count() / duracaoPasso;
+        interpolar(anterior, atual, static_cast<float>(std::min(std::max(alfa, 0.0), 1.0)), saida);
+    }
+
+    uint64_t passos() const { return contagemPassos.load(std::memory_order_relaxed); }
+
+private:
+    using Relogio = std::chrono::steady_clock;
+
+    void laco() {
+        Poses trabalho = atual, anteriorLocal = atual;
+        uint64_t k = 0;
+        for (;;) {
+            // O passo k + 1 corresponde ao instante inicio + (k + 1) * passo do relógio
+            Relogio::time_point alvo = inicio + std::chrono::duration_cast<Relogio::duration>(
+                                                   std::chrono::duration<double>((k + 1) * duracaoPasso));
+            {
+                std::unique_lock<std::mutex> trava(mutex);
+                if (acordar.wait_until(trava, alvo, [this] { return !executando; }))
+                    return;
+            }
+            anteriorLocal = trabalho;
+            funcaoPasso(trabalho, k * duracaoPasso, duracaoPasso);
+            ++k;
+            {
+                std::lock_guard<std::mutex> trava(mutex);
+                anterior = anteriorLocal;
+                atual = trabalho;
+                instanteAtual = alvo;
+            }
+            contagemPassos.store(k, std::memory_order_relaxed);
+        }
+    }
+
+    double duracaoPasso = 1.0 / 120.0;
+    FuncaoPasso funcaoPasso;
+    std::thread trabalhador;
+    std::mutex mutex;
+    std::condition_variable acordar;
+    bool executando = false;
+    Poses anterior, atual;      // Publicados pela thread de simulação
+    Relogio::time_point inicio, instanteAtual;
+    std::atomic<uint64_t> contagemPassos{0};
+};
+
+} // namespace animacao
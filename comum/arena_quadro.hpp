@@ -0,0 +1,261 @@
+// Alocação linear por quadro (bump allocator) para dados temporários do laço de renderização
+//
+// ArenaLinear entrega memória avançando um ponteiro dentro de blocos grandes e libera
+// tudo de uma vez com reiniciar(). Se um quadro precisar de mais que o bloco atual,
+// um bloco extra é alocado; no reinício seguinte os blocos são fundidos em um só, com a
+// soma das capacidades, e a partir daí o quadro não chama mais malloc.
+//
+// ArenaQuadro mantém duas gerações de arenas (quadro atual e anterior, para dados que
+// ainda estão sendo lidos enquanto o próximo quadro é montado) e uma sub-arena por
+// thread, para que threads de trabalho aloquem sem travas.
+//
+// Alocador<T> adapta uma ArenaLinear aos contêineres da STL:
+//   arena::Vetor<glm::mat4> matrizes(arena::Alocador<glm::mat4>(quadro.principal()));
+// deallocate() não faz nada: a memória volta no reinício da arena. Os contêineres não
+// podem sobreviver ao quadro em que foram criados.
+//
+// Contadores: cada arena conta alocações, bytes e blocos pedidos ao heap. Compilando com
+// -DARENA_QUADRO_CONTAR_NEW (desligado por padrão; o cabeçalho deve ser incluído por um
+// único arquivo do programa), operator new/delete, inclusive as versões alinhadas, são
+// substituídos por versões que contam as chamadas em arena::chamadasNew, o que permite
+// verificar que o laço não aloca no heap.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace arena {
+
+struct Contadores {
+    size_t alocacoes = 0;  // Pedidos atendidos pela arena
+    size_t bytes = 0;      // Bytes entregues, incluindo o alinhamento
+    size_t blocosHeap = 0; // Blocos novos obtidos com malloc (inclusive a fusão no reinício)
+};
+
+class ArenaLinear {
+public:
+    explicit ArenaLinear(size_t capacidadeInicial = 64 * 1024) : capacidadeBloco(std::max<size_t>(capacidadeInicial, 256)) {}
+    ~ArenaLinear() { liberarBlocos(); }
+    ArenaLinear(const ArenaLinear&) = delete;
+    ArenaLinear& operator=(const ArenaLinear&) = delete;
+    ArenaLinear(ArenaLinear&& outra) noexcept { *this = std::move(outra); }
+    ArenaLinear& operator=(ArenaLinear&& outra) noexcept {
+        std::swap(blocos, outra.blocos);
+        std::swap(atual, outra.atual);
+        std::swap(usado, outra.usado);
+        std::swap(capacidadeBloco, outra.capacidadeBloco);
+        std::swap(contadores, outra.contadores);
+        return *this;
+    }
+
+    void* alocar(size_t bytes, size_t alinhamento = alignof(std::max_align_t)) {
+        if (blocos.empty())
+            novoBloco(bytes + alinhamento);
+        for (;;) {
+            Bloco& b = blocos[atual];
+            uintptr_t inicio = reinterpret_cast<uintptr_t>(b.memoria) + usado;
+            uintptr_t alinhado = (inicio + alinhamento - 1) & ~uintptr_t(alinhamento - 1);
+            size_t fim = usado + (alinhado - inicio) + bytes;
+            if (fim <= b.capacidade) {
+                contadores.alocacoes++;
+                contadores.bytes += fim - usado;
+                usado = fim;
+                return reinterpret_cast<void*>(alinhado);
+            }
+            // Passa para o próximo bloco já existente ou pede um novo
+            if (atual + 1 < blocos.size() && blocos[atual + 1].capacidade >= bytes + alinhamento) {
+                atual++;
+                usado = 0;
+            } else {
+                novoBloco(bytes + alinhamento);
+            }
+        }
+    }
+
+    // Só para tipos que não precisam de destrutor: a arena nunca os destrói
+    template <typename T>
+    T* criar(size_t quantidade = 1) {
+        static_assert(std::is_trivially_destructible_v<T>, "A arena não chama destrutores");
+        T* p = static_cast<T*>(alocar(quantidade * sizeof(T), alignof(T)));
+        for (size_t i = 0; i < quantidade; ++i)
+            new (p + i) T();
+        return p;
+    }
+
+    // Descarta tudo o que foi alocado; funde os blocos se o quadro precisou de mais de um
+    void reiniciar() {
+        contadores = Contadores();
+        if (blocos.size() > 1) {
+            size_t total = 0;
+            for (const Bloco& b : blocos)
+                total += b.capacidade;
+            liberarBlocos();
+            capacidadeBloco = total;
+            novoBloco(total);
+        }
+        atual = 0;
+        usado = 0;
+    }
+
+    const Contadores& contadoresAtuais() const { return contadores; }
+    size_t capacidade() const {
+        size_t total = 0;
+        for (const Bloco& b : blocos)
+            total += b.capacidade;
+        return total;
+    }
+
+private:
+    struct Bloco {
+        unsigned char* memoria;
+        size_t capacidade;
+    };
+
+    void novoBloco(size_t minimo) {
+        size_t capacidade = std::max(blocos.empty() ? capacidadeBloco : 2 * blocos.back().capacidade, minimo); // Crescimento geométrico
+        void* memoria = std::malloc(capacidade);
+        if (!memoria)
+            throw std::bad_alloc();
+        blocos.push_back({static_cast<unsigned char*>(memoria), capacidade});
+        atual = blocos.size() - 1;
+        usado = 0;
+        contadores.blocosHeap++;
+    }
+
+    void liberarBlocos() {
+        for (Bloco& b : blocos)
+            std::free(b.memoria);
+        blocos.clear();
+    }
+
+    std::vector<Bloco> blocos;
+    size_t atual = 0;
+    size_t usado = 0;
+    size_t capacidadeBloco = 64 * 1024;
+    Contadores contadores;
+};
+
+// Índice pequeno e estável da thread que chama (0, 1, 2... na ordem da primeira chamada)
+inline unsigned indiceThread() {
+    static std::atomic<unsigned> proximo{0};
+    thread_local unsigned indice = proximo.fetch_add(1);
+    return indice;
+}
+
+class ArenaQuadro {
+public:
+    // numeroThreads: quantas threads podem alocar no mesmo quadro (0 = número de núcleos)
+    explicit ArenaQuadro(unsigned numeroThreads = 0, size_t capacidadePorThread = 256 * 1024) {
+        if (numeroThreads == 0)
+            numeroThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (auto& geracao : geracoes)
+            for (unsigned i = 0; i < numeroThreads; ++i)
+                geracao.emplace_back(capacidadePorThread);
+    }
+
+    // Troca de geração: a do quadro anterior continua intacta, a nova é reiniciada
+    void iniciarQuadro() {
+        lado ^= 1;
+        for (ArenaLinear& a : geracoes[lado])
+            a.reiniciar();
+        numeroQuadro++;
+    }
+
+    ArenaLinear& daThread(unsigned indice) { return geracoes[lado][indice % geracoes[lado].size()]; }
+    ArenaLinear& principal() { return daThread(0); }
+
+    // Sub-arena da thread que chama, pelo índice de indiceThread(). Vale enquanto não houver
+    // mais threads alocando do que numeroThreads; fora disso, use daThread() com índices próprios.
+    ArenaLinear& local() { return daThread(indiceThread()); }
+
+    const ArenaLinear& doQuadroAnterior(unsigned indice) const {
+        return geracoes[lado ^ 1][indice % geracoes[lado ^ 1].size()];
+    }
+
+    // Soma dos contadores das sub-arenas do quadro atual
+    Contadores contadoresQuadro() const {
+        Contadores total;
+        for (const ArenaLinear& a : geracoes[lado]) {
+            total.alocacoes += a.contadoresAtuais().alocacoes;
+            total.bytes += a.contadoresAtuais().bytes;
+            total.blocosHeap += a.contadoresAtuais().blocosHeap;
+        }
+        return total;
+    }
+
+    unsigned numeroThreads() const { return static_cast<unsigned>(geracoes[0].size()); }
+    uint64_t quadro() const { return numeroQuadro; }
+
+private:
+    std::vector<ArenaLinear> geracoes[2];
+    unsigned lado = 0;
+    uint64_t numeroQuadro = 0;
+};
+
+template <typename T>
+class Alocador {
+public:
+    using value_type = T;
+
+    explicit Alocador(ArenaLinear& arena) noexcept : arena(&arena) {}
+    template <typename U>
+    Alocador(const Alocador<U>& outro) noexcept : arena(outro.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->alocar(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) noexcept {}
+
+    template <typename U>
+    bool operator==(const Alocador<U>& outro) const noexcept { return arena == outro.arena; }
+    template <typename U>
+    bool operator!=(const Alocador<U>& outro) const noexcept { return arena != outro.arena; }
+
+private:
+    template <typename U>
+    friend class Alocador;
+    ArenaLinear* arena;
+};
+
+template <typename T>
+using Vetor = std::vector<T, Alocador<T>>;
+
+#ifdef ARENA_QUADRO_CONTAR_NEW
+inline std::atomic<size_t> chamadasNew{0};
+#endif
+
+} // namespace arena
+
+#ifdef ARENA_QUADRO_CONTAR_NEW
+// Substituições globais (definidas uma única vez no programa) que contam as alocações no heap
+void* operator new(size_t bytes) {
+    arena::chamadasNew.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(bytes ? bytes : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t bytes) { return operator new(bytes); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+// Tipos com alignas maior que o de malloc; aligned_alloc exige tamanho múltiplo do alinhamento
+void* operator new(size_t bytes, std::align_val_t alinhamento) {
+    arena::chamadasNew.fetch_add(1, std::memory_order_relaxed);
+    size_t a = static_cast<size_t>(alinhamento);
+    if (void* p = std::aligned_alloc(a, (std::max<size_t>(bytes, 1) + a - 1) / a * a))
+        return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t bytes, std::align_val_t alinhamento) { return operator new(bytes, alinhamento); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+#endif
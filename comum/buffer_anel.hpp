@@ -0,0 +1,175 @@
+// Buffer em anel para enviar dados que mudam a cada quadro (uniformes, vértices animados)
+//
+// Com GL_ARB_buffer_storage (OpenGL 4.4), o buffer é criado uma vez com
+// glBufferStorage e mapeado de forma persistente e coerente: a CPU escreve
+// diretamente na memória que a GPU lê, sem cópia do driver. O buffer é dividido em
+// N regiões (3 por padrão), uma por quadro em voo; ao terminar um quadro é inserida
+// uma cerca (glFenceSync) e, antes de reutilizar a região, a CPU espera por ela.
+//
+// Sem a extensão (por exemplo no macOS, limitado ao OpenGL 4.1), as escritas vão para
+// uma cópia na CPU e enviar() faz um único glBufferSubData da faixa usada no quadro.
+//
+// Uso por quadro:
+//   anel.iniciarQuadro();
+//   auto a = anel.alocar(bytes, alinhamento);  // escreve em a.ponteiro
+//   anel.enviar();                             // antes dos desenhos que usam os dados
+//   ... glBindBufferRange(alvo, ponto, anel.buffer(), a.deslocamento, bytes) e desenhos ...
+//   anel.finalizarQuadro();
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+class BufferAnel {
+public:
+    struct Alocacao {
+        void* ponteiro;
+        GLintptr deslocamento; // Deslocamento em bytes dentro de buffer()
+    };
+
+    BufferAnel() = default;
+    BufferAnel(const BufferAnel&) = delete;
+    BufferAnel& operator=(const BufferAnel&) = delete;
+    ~BufferAnel() { destruir(); }
+
+    // Cria o buffer com "tamanhoRegiao" bytes por quadro e "regioes" quadros em voo.
+    // Se o mapeamento persistente falhar, cai para a cópia na CPU. Retorna false com
+    // tamanhos inválidos; o anel fica então vazio e alocar() sempre devolve ponteiro nulo
+    bool criar(GLenum alvo, size_t tamanhoRegiao, int regioes = 3) {
+        destruir();
+        if (tamanhoRegiao == 0 || regioes <= 0)
+            return false;
+        this->alvo = alvo;
+        this->tamanhoRegiao = tamanhoRegiao;
+        this->regioes = regioes;
+        cercas.assign(regioes, nullptr);
+
+        glGenBuffers(1, &idBuffer);
+        glBindBuffer(alvo, idBuffer);
+        size_t tamanhoTotal = tamanhoRegiao * regioes;
+        persistenteAtivo = GLEW_ARB_buffer_storage;
+        if (persistenteAtivo) {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(alvo, tamanhoTotal, nullptr, flags);
+            mapa = static_cast<uint8_t*>(glMapBufferRange(alvo, 0, tamanhoTotal, flags));
+            if (!mapa) {
+                // O armazenamento de glBufferStorage é imutável: troca por um buffer novo
+                fprintf(stderr, "Falha ao mapear o buffer persistente; usando glBufferSubData\n");
+                persistenteAtivo = false;
+                glBindBuffer(alvo, 0);
+                glDeleteBuffers(1, &idBuffer);
+                glGenBuffers(1, &idBuffer);
+                glBindBuffer(alvo, idBuffer);
+            }
+        }
+        if (!persistenteAtivo) {
+            glBufferData(alvo, tamanhoTotal, nullptr, GL_DYNAMIC_DRAW);
+            copiaCPU.resize(tamanhoTotal);
+            mapa = copiaCPU.data();
+        }
+        glBindBuffer(alvo, 0);
+        return true;
+    }
+
+    void destruir() {
+        for (GLsync& cerca : cercas) {
+            if (cerca)
+                glDeleteSync(cerca);
+            cerca = nullptr;
+        }
+        if (idBuffer) {
+            if (persistenteAtivo) {
+                glBindBuffer(alvo, idBuffer);
+                glUnmapBuffer(alvo);
+                glBindBuffer(alvo, 0);
+            }
+            glDeleteBuffers(1, &idBuffer);
+        }
+        idBuffer = 0;
+        mapa = nullptr;
+        copiaCPU.clear();
+        persistenteAtivo = false;
+        tamanhoRegiao = 0;
+        usado = enviado = 0;
+    }
+
+    // Avança para a próxima região e espera a GPU terminar de lê-la, se ainda estiver em uso
+    void iniciarQuadro() {
+        if (!idBuffer)
+            return;
+        regiaoAtual = (regiaoAtual + 1) % regioes;
+        usado = 0;
+        enviado = 0;
+        GLsync& cerca = cercas[regiaoAtual];
+        if (!cerca)
+            return;
+        GLbitfield flags = 0;
+        while (true) {
+            GLenum estado = glClientWaitSync(cerca, flags, 1000000); // 1 ms
+            if (estado == GL_ALREADY_SIGNALED || estado == GL_CONDITION_SATISFIED)
+                break;
+            if (estado == GL_WAIT_FAILED) {
+                fprintf(stderr, "glClientWaitSync falhou\n");
+                break;
+            }
+            esperas++;
+            flags = GL_SYNC_FLUSH_COMMANDS_BIT; // Garante que a cerca chegue à GPU
+        }
+        glDeleteSync(cerca);
+        cerca = nullptr;
+    }
+
+    // Reserva "bytes" na região do quadro atual; retorna ponteiro nulo se a região estiver cheia
+    Alocacao alocar(size_t bytes, size_t alinhamento = 16) {
+        size_t inicio = (usado + alinhamento - 1) / alinhamento * alinhamento;
+        if (inicio + bytes > tamanhoRegiao)
+            return {nullptr, 0};
+        usado = inicio + bytes;
+        size_t deslocamento = regiaoAtual * tamanhoRegiao + inicio;
+        return {mapa + deslocamento, static_cast<GLintptr>(deslocamento)};
+    }
+
+    // Torna visíveis para a GPU os dados escritos desde o último envio.
+    // No modo persistente e coerente não há nada a fazer.
+    void enviar() {
+        if (persistenteAtivo || usado == enviado)
+            return;
+        size_t base = regiaoAtual * tamanhoRegiao;
+        glBindBuffer(alvo, idBuffer);
+        glBufferSubData(alvo, base + enviado, usado - enviado, mapa + base + enviado);
+        glBindBuffer(alvo, 0);
+        enviado = usado;
+    }
+
+    // Marca o fim do uso da região atual pelos comandos já emitidos
+    void finalizarQuadro() {
+        if (!idBuffer)
+            return;
+        enviar();
+        if (cercas[regiaoAtual])
+            glDeleteSync(cercas[regiaoAtual]);
+        cercas[regiaoAtual] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    GLuint buffer() const { return idBuffer; }
+    bool persistente() const { return persistenteAtivo; }
+    long long numeroEsperas() const { return esperas; } // Quantas vezes a CPU alcançou a GPU
+
+private:
+    GLenum alvo = GL_ARRAY_BUFFER;
+    GLuint idBuffer = 0;
+    size_t tamanhoRegiao = 0;
+    int regioes = 0;
+    int regiaoAtual = 0;
+    size_t usado = 0;
+    size_t enviado = 0;
+    bool persistenteAtivo = false;
+    uint8_t* mapa = nullptr;
+    std::vector<uint8_t> copiaCPU;
+    std::vector<GLsync> cercas;
+    long long esperas = 0;
+};
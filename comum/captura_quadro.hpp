@@ -0,0 +1,116 @@
+// Modo de captura: desenha fora da tela até o quadro N, salva em PPM/PGM e encerra
+//
+// Com "--capturar N arquivo.ppm" na linha de comando, o exemplo abre uma janela
+// invisível de tamanho fixo, sem multiamostragem (cuja resolução varia entre drivers),
+// desenha os quadros 0..N com um relógio virtual de 60 quadros por segundo e grava o
+// back buffer do quadro N. O formato vem da extensão (formatos_imagem.hpp: ".png" e
+// ".qoi" comprimidos, os demais em Netpbm); ".pgm" salva em tons de cinza.
+// Os programas que incluem este arquivo são ligados com -lz.
+// A saída pode ser comparada com as imagens de referência em goldens/ por
+// cores_imagens/comparar_imagens, inclusive em máquinas sem GPU (Mesa llvmpipe
+// com xvfb-run; veja goldens/verificar.sh).
+//
+//   captura::Captura captura;
+//   captura.configurar(argc, argv);      // Remove os argumentos da captura de argv
+//   ... glfwWindowHint(...) do programa ...
+//   captura.prepararJanela();            // Logo antes de glfwCreateWindow
+//   while (...) {
+//       desenhar(captura.ativa() ? captura.tempo() : glfwGetTime());
+//       if (captura.concluirQuadro(janela)) break;   // Antes de glfwSwapBuffers
+//       glfwSwapBuffers(janela);
+//   }
+#pragma once
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+
+#include "formatos_imagem.hpp"
+
+namespace captura {
+
+class Captura {
+public:
+    // Procura "--capturar N arquivo" e tira esses argumentos de argv (os demais continuam
+    // nas mesmas posições relativas); devolve se a captura foi pedida
+    bool configurar(int& argc, char** argv) {
+        for (int i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--capturar") != 0)
+                continue;
+            if (i + 2 >= argc) {
+                fprintf(stderr, "Uso: --capturar <quadro> <arquivo.ppm|.pgm|.png|.qoi>\n");
+                std::exit(2);
+            }
+            quadroAlvo = std::max(0, std::atoi(argv[i + 1]));
+            caminho = argv[i + 2];
+            for (int j = i + 3; j <= argc; ++j) // Inclui o nullptr final de argv
+                argv[j - 3] = argv[j];
+            argc -= 3;
+            capturando = true;
+            return true;
+        }
+        return false;
+    }
+
+    bool ativa() const { return capturando; }
+    int quadro() const { return quadroAtual; }
+    // Relógio virtual: o mesmo instante de animação em qualquer máquina
+    double tempo() const { return quadroAtual / 60.0; }
+
+    // Dicas da janela de captura; chamar depois das do programa e antes de glfwCreateWindow
+    void prepararJanela() const {
+        if (!capturando)
+            return;
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_SAMPLES, 0);
+        glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+    }
+
+    // Chamar depois de desenhar cada quadro, antes de glfwSwapBuffers. No quadro pedido lê
+    // o back buffer, salva a imagem e devolve true: o programa deve sair do laço.
+    bool concluirQuadro(GLFWwindow* janela) {
+        if (!capturando)
+            return false;
+        if (quadroAtual++ < quadroAlvo)
+            return false;
+        int largura, altura;
+        glfwGetFramebufferSize(janela, &largura, &altura);
+        imagem::Imagem quadroLido = lerFramebuffer(largura, altura);
+        bool cinza = caminho.size() >= 4 && caminho.compare(caminho.size() - 4, 4, ".pgm") == 0;
+        try {
+            formatos::escrever(caminho, cinza ? imagem::paraCinza(quadroLido) : quadroLido);
+            printf("Quadro %d capturado em %s (%dx%d)\n", quadroAlvo, caminho.c_str(), largura, altura);
+        } catch (const std::exception& e) {
+            fprintf(stderr, "%s\n", e.what());
+            falhou = true;
+        }
+        return true;
+    }
+
+    // Código de saída do programa: diferente de zero se a imagem não pôde ser salva
+    int codigoSaida() const { return falhou ? 1 : 0; }
+
+    // Lê o back buffer como RGB, com a linha 0 no topo
+    static imagem::Imagem lerFramebuffer(int largura, int altura) {
+        imagem::Imagem img(largura, altura, 3);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1); // Linhas de 3 * largura bytes, sem preenchimento
+        glReadBuffer(GL_BACK);
+        glReadPixels(0, 0, largura, altura, GL_RGB, GL_UNSIGNED_BYTE, img.pixels.data());
+        imagem::inverterVertical(img);
+        return img;
+    }
+
+private:
+    bool capturando = false;
+    bool falhou = false;
+    int quadroAlvo = 0;
+    int quadroAtual = 0;
+    std::string caminho;
+};
+
+} // namespace captura
@@ -0,0 +1,430 @@
+// Descrição de cena carregada de arquivo (malhas, objetos, câmeras e viewports)
+//
+// Dois formatos compartilham as mesmas estruturas:
+//  - texto (.cena), para edição manual;
+//  - binário (.cenab), gerado por compilar_cena.cpp, que é mapeado na memória com
+//    mmap e lido sem nenhuma conversão: os arrays de posições e cores podem ser
+//    enviados diretamente para glBufferData.
+//
+// Exemplo de arquivo de texto:
+//
+//   # comentário
+//   malha casa
+//     v 0 0 0   1 0 0        # posição x y z e cor r g b
+//     ...
+//   fim
+//   camera frente ortografica -40 40 -40 40 -1 1 olho 0 0 1 alvo 0 0 0 cima 0 1 0
+//   camera lado perspectiva 45 0.1 100 olho 60 0 60 alvo 0 0 0 cima 0 1 0
+//   objeto casa posicao 0 0 0 rotacao 0 0 45 escala 1 1 1
+//   viewport 0 0 0.5 0.5 frente   # x y largura altura em frações da janela
+//
+// Erros de leitura ou de formato são reportados com std::runtime_error.
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cena {
+
+const char MAGICA[4] = {'C', 'E', 'N', 'A'};
+const uint32_t VERSAO = 1;
+
+enum TipoCamera : uint32_t {
+    CAMERA_ORTOGRAFICA = 0,
+    CAMERA_PERSPECTIVA = 1
+};
+
+// Layout do arquivo binário: cabeçalho seguido das seções, cada uma alinhada em 16 bytes
+struct Cabecalho {
+    char magica[4];
+    uint32_t versao;
+    uint32_t numeroVertices;
+    uint32_t numeroMalhas;
+    uint32_t numeroObjetos;
+    uint32_t numeroCameras;
+    uint32_t numeroViewports;
+    uint32_t reservado;
+    uint64_t deslocamentoPosicoes;  // numeroVertices * 3 floats
+    uint64_t deslocamentoCores;     // numeroVertices * 3 floats
+    uint64_t deslocamentoMalhas;
+    uint64_t deslocamentoObjetos;
+    uint64_t deslocamentoCameras;
+    uint64_t deslocamentoViewports;
+    uint64_t tamanhoTotal;
+};
+
+// Intervalo de vértices (GL_TRIANGLES) de uma malha
+struct Malha {
+    uint32_t primeiroVertice;
+    uint32_t numeroVertices;
+};
+
+// Instância de uma malha com a matriz de modelo já calculada (coluna a coluna, como no OpenGL)
+struct Objeto {
+    float modelo[16];
+    uint32_t malha;
+    uint32_t reservado[3];
+};
+
+// Para CAMERA_ORTOGRAFICA: parametros = esquerda, direita, baixo, cima, perto, longe
+// Para CAMERA_PERSPECTIVA: parametros = campo de visão (graus), perto, longe
+// Sem olho/alvo/cima, a câmera fica na origem olhando para -z (visualização identidade)
+struct Camera {
+    uint32_t tipo;
+    float parametros[6];
+    float olho[3];
+    float alvo[3];
+    float cima[3];
+};
+
+// Retângulo em frações do framebuffer (0..1, origem no canto inferior esquerdo)
+struct Viewport {
+    float x, y, largura, altura;
+    uint32_t camera;
+    uint32_t reservado[3];
+};
+
+static_assert(sizeof(Cabecalho) == 88, "layout do cabeçalho mudou");
+static_assert(sizeof(Objeto) == 80, "layout do objeto mudou");
+static_assert(sizeof(Camera) == 64, "layout da câmera mudou");
+static_assert(sizeof(Viewport) == 32, "layout do viewport mudou");
+
+// Cena em memória durante a leitura do texto
+struct DadosCena {
+    std::vector<float> posicoes;
+    std::vector<float> cores;
+    std::vector<Malha> malhas;
+    std::vector<Objeto> objetos;
+    std::vector<Camera> cameras;
+    std::vector<Viewport> viewports;
+};
+
+//--------------------------------------------------------------------------------
+// Matriz T * Rz * Ry * Rx * S (ângulos em graus), em ordem de colunas
+inline void calcularMatrizModelo(const float posicao[3], const float rotacao[3], const float escala[3], float m[16]) {
+    const float grausParaRadianos = 3.14159265358979f / 180.0f;
+    float cx = std::cos(rotacao[0] * grausParaRadianos), sx = std::sin(rotacao[0] * grausParaRadianos);
+    float cy = std::cos(rotacao[1] * grausParaRadianos), sy = std::sin(rotacao[1] * grausParaRadianos);
+    float cz = std::cos(rotacao[2] * grausParaRadianos), sz = std::sin(rotacao[2] * grausParaRadianos);
+
+    // Colunas de Rz * Ry * Rx
+    float r[9] = {
+        cz * cy,                 sz * cy,                 -sy,
+        cz * sy * sx - sz * cx,  sz * sy * sx + cz * cx,  cy * sx,
+        cz * sy * cx + sz * sx,  sz * sy * cx - cz * sx,  cy * cx
+    };
+    for (int coluna = 0; coluna < 3; ++coluna) {
+        for (int linha = 0; linha < 3; ++linha)
+            m[coluna * 4 + linha] = r[coluna * 3 + linha] * escala[coluna];
+        m[coluna * 4 + 3] = 0.0f;
+    }
+    m[12] = posicao[0];
+    m[13] = posicao[1];
+    m[14] = posicao[2];
+    m[15] = 1.0f;
+}
+
+//--------------------------------------------------------------------------------
+inline void lerVetor3(std::istringstream& linha, float v[3], const std::string& contexto) {
+    if (!(linha >> v[0] >> v[1] >> v[2]))
+        throw std::runtime_error("Esperados 3 números em " + contexto);
+}
+
+//--------------------------------------------------------------------------------
+// Interpreta o formato de texto
+inline DadosCena lerTexto(std::istream& entrada) {
+    DadosCena dados;
+    std::map<std::string, uint32_t> indiceMalhas;
+    std::map<std::string, uint32_t> indiceCameras;
+    std::vector<std::pair<std::string, size_t>> viewportsPendentes; // câmera pode ser declarada depois
+    std::string texto;
+    int numeroLinha = 0;
+    bool dentroMalha = false;
+
+    auto erro = [&](const std::string& mensagem) {
+        return std::runtime_error("Linha " + std::to_string(numeroLinha) + ": " + mensagem);
+    };
+
+    while (std::getline(entrada, texto)) {
+        ++numeroLinha;
+        size_t comentario = texto.find('#');
+        if (comentario != std::string::npos)
+            texto.erase(comentario);
+        std::istringstream linha(texto);
+        std::string comando;
+        if (!(linha >> comando))
+            continue;
+
+        if (dentroMalha) {
+            if (comando == "v") {
+                float p[3], c[3];
+                lerVetor3(linha, p, "posição do vértice");
+                lerVetor3(linha, c, "cor do vértice");
+                dados.posicoes.insert(dados.posicoes.end(), p, p + 3);
+                dados.cores.insert(dados.cores.end(), c, c + 3);
+                dados.malhas.back().numeroVertices++;
+            } else if (comando == "fim") {
+                if (dados.malhas.back().numeroVertices % 3 != 0)
+                    throw erro("malha com número de vértices que não é múltiplo de 3");
+                dentroMalha = false;
+            } else {
+                throw erro("comando inesperado dentro de malha: " + comando);
+            }
+            continue;
+        }
+
+        if (comando == "malha") {
+            std::string nome;
+            if (!(linha >> nome))
+                throw erro("malha sem nome");
+            indiceMalhas[nome] = static_cast<uint32_t>(dados.malhas.size());
+            dados.malhas.push_back({static_cast<uint32_t>(dados.posicoes.size() / 3), 0});
+            dentroMalha = true;
+        } else if (comando == "objeto") {
+            std::string nome, chave;
+            if (!(linha >> nome) || !indiceMalhas.count(nome))
+                throw erro("objeto referencia malha inexistente: " + nome);
+            float posicao[3] = {0, 0, 0}, rotacao[3] = {0, 0, 0}, escala[3] = {1, 1, 1};
+            while (linha >> chave) {
+                if (chave == "posicao") lerVetor3(linha, posicao, "posicao");
+                else if (chave == "rotacao") lerVetor3(linha, rotacao, "rotacao");
+                else if (chave == "escala") lerVetor3(linha, escala, "escala");
+                else throw erro("atributo de objeto desconhecido: " + chave);
+            }
+            Objeto objeto = {};
+            calcularMatrizModelo(posicao, rotacao, escala, objeto.modelo);
+            objeto.malha = indiceMalhas[nome];
+            dados.objetos.push_back(objeto);
+        } else if (comando == "camera") {
+            std::string nome, tipo, chave;
+            linha >> nome >> tipo;
+            Camera camera = {};
+            float olho[3] = {0, 0, 0}, alvo[3] = {0, 0, -1}, cima[3] = {0, 1, 0};
+            if (tipo == "ortografica") {
+                camera.tipo = CAMERA_ORTOGRAFICA;
+                for (int i = 0; i < 6; ++i)
+                    if (!(linha >> camera.parametros[i]))
+                        throw erro("câmera ortográfica requer esquerda direita baixo cima perto longe");
+            } else if (tipo == "perspectiva") {
+                camera.tipo = CAMERA_PERSPECTIVA;
+                for (int i = 0; i < 3; ++i)
+                    if (!(linha >> camera.parametros[i]))
+                        throw erro("câmera perspectiva requer campo_de_visao perto longe");
+            } else {
+                throw erro("tipo de câmera desconhecido: " + tipo);
+            }
+            while (linha >> chave) {
+                if (chave == "olho") lerVetor3(linha, olho, "olho");
+                else if (chave == "alvo") lerVetor3(linha, alvo, "alvo");
+                else if (chave == "cima") lerVetor3(linha, cima, "cima");
+                else throw erro("atributo de câmera desconhecido: " + chave);
+            }
+            std::memcpy(camera.olho, olho, sizeof(olho));
+            std::memcpy(camera.alvo, alvo, sizeof(alvo));
+            std::memcpy(camera.cima, cima, sizeof(cima));
+            indiceCameras[nome] = static_cast<uint32_t>(dados.cameras.size());
+            dados.cameras.push_back(camera);
+        } else if (comando == "viewport") {
+            Viewport viewport = {};
+            std::string nomeCamera;
+            if (!(linha >> viewport.x >> viewport.y >> viewport.largura >> viewport.altura >> nomeCamera))
+                throw erro("viewport requer x y largura altura camera");
+            viewportsPendentes.push_back({nomeCamera, dados.viewports.size()});
+            dados.viewports.push_back(viewport);
+        } else {
+            throw erro("comando desconhecido: " + comando);
+        }
+    }
+    if (dentroMalha)
+        throw std::runtime_error("Malha sem 'fim' no final do arquivo");
+
+    for (const auto& pendente : viewportsPendentes) {
+        auto it = indiceCameras.find(pendente.first);
+        if (it == indiceCameras.end())
+            throw std::runtime_error("Viewport referencia câmera inexistente: " + pendente.first);
+        dados.viewports[pendente.second].camera = it->second;
+    }
+    return dados;
+}
+
+//--------------------------------------------------------------------------------
+inline uint64_t alinhar16(uint64_t valor) {
+    return (valor + 15) & ~uint64_t(15);
+}
+
+//--------------------------------------------------------------------------------
+// Serializa a cena no formato binário
+inline std::vector<uint8_t> serializar(const DadosCena& dados) {
+    Cabecalho cabecalho = {};
+    std::memcpy(cabecalho.magica, MAGICA, 4);
+    cabecalho.versao = VERSAO;
+    cabecalho.numeroVertices = static_cast<uint32_t>(dados.posicoes.size() / 3);
+    cabecalho.numeroMalhas = static_cast<uint32_t>(dados.malhas.size());
+    cabecalho.numeroObjetos = static_cast<uint32_t>(dados.objetos.size());
+    cabecalho.numeroCameras = static_cast<uint32_t>(dados.cameras.size());
+    cabecalho.numeroViewports = static_cast<uint32_t>(dados.viewports.size());
+
+    uint64_t posicao = alinhar16(sizeof(Cabecalho));
+    auto reservar = [&posicao](uint64_t& deslocamento, size_t bytes) {
+        deslocamento = posicao;
+        posicao = alinhar16(posicao + bytes);
+    };
+    reservar(cabecalho.deslocamentoPosicoes, dados.posicoes.size() * sizeof(float));
+    reservar(cabecalho.deslocamentoCores, dados.cores.size() * sizeof(float));
+    reservar(cabecalho.deslocamentoMalhas, dados.malhas.size() * sizeof(Malha));
+    reservar(cabecalho.deslocamentoObjetos, dados.objetos.size() * sizeof(Objeto));
+    reservar(cabecalho.deslocamentoCameras, dados.cameras.size() * sizeof(Camera));
+    reservar(cabecalho.deslocamentoViewports, dados.viewports.size() * sizeof(Viewport));
+    cabecalho.tamanhoTotal = posicao;
+
+    std::vector<uint8_t> binario(posicao, 0);
+    auto copiar = [&binario](uint64_t deslocamento, const void* origem, size_t bytes) {
+        if (bytes > 0)
+            std::memcpy(binario.data() + deslocamento, origem, bytes);
+    };
+    copiar(0, &cabecalho, sizeof(cabecalho));
+    copiar(cabecalho.deslocamentoPosicoes, dados.posicoes.data(), dados.posicoes.size() * sizeof(float));
+    copiar(cabecalho.deslocamentoCores, dados.cores.data(), dados.cores.size() * sizeof(float));
+    copiar(cabecalho.deslocamentoMalhas, dados.malhas.data(), dados.malhas.size() * sizeof(Malha));
+    copiar(cabecalho.deslocamentoObjetos, dados.objetos.data(), dados.objetos.size() * sizeof(Objeto));
+    copiar(cabecalho.deslocamentoCameras, dados.cameras.data(), dados.cameras.size() * sizeof(Camera));
+    copiar(cabecalho.deslocamentoViewports, dados.viewports.data(), dados.viewports.size() * sizeof(Viewport));
+    return binario;
+}
+
+//--------------------------------------------------------------------------------
+// Cena carregada: os ponteiros apontam diretamente para o arquivo mapeado
+// (ou para o buffer compilado a partir do texto) e valem enquanto o objeto existir
+class Cena {
+public:
+    Cena() = default;
+    Cena(const Cena&) = delete;
+    Cena& operator=(const Cena&) = delete;
+    Cena(Cena&& outra) noexcept { *this = std::move(outra); }
+    Cena& operator=(Cena&& outra) noexcept {
+        if (this != &outra) {
+            liberar();
+            mapeamento = outra.mapeamento;
+            tamanhoMapeamento = outra.tamanhoMapeamento;
+            buffer = std::move(outra.buffer);
+            dados = outra.dados;
+            outra.mapeamento = nullptr;
+            outra.tamanhoMapeamento = 0;
+            outra.dados = nullptr;
+        }
+        return *this;
+    }
+    ~Cena() { liberar(); }
+
+    // Carrega um arquivo .cenab (mapeado com mmap) ou .cena (compilado em memória)
+    static Cena carregar(const std::string& caminho) {
+        Cena cena;
+        int descritor = open(caminho.c_str(), O_RDONLY);
+        if (descritor < 0)
+            throw std::runtime_error("Não foi possível abrir a cena " + caminho);
+        struct stat informacoes;
+        if (fstat(descritor, &informacoes) != 0) {
+            close(descritor);
+            throw std::runtime_error("Não foi possível obter o tamanho de " + caminho);
+        }
+        size_t tamanho = static_cast<size_t>(informacoes.st_size);
+
+        char magica[4] = {};
+        bool binaria = tamanho >= sizeof(Cabecalho) && pread(descritor, magica, 4, 0) == 4 &&
+                       std::memcmp(magica, MAGICA, 4) == 0;
+        if (binaria) {
+            void* mapa = mmap(nullptr, tamanho, PROT_READ, MAP_PRIVATE, descritor, 0);
+            close(descritor);
+            if (mapa == MAP_FAILED)
+                throw std::runtime_error("Falha no mmap de " + caminho);
+            cena.mapeamento = mapa;
+            cena.tamanhoMapeamento = tamanho;
+            cena.dados = static_cast<const uint8_t*>(mapa);
+        } else {
+            close(descritor);
+            std::ifstream arquivo(caminho);
+            cena.buffer = serializar(lerTexto(arquivo));
+            cena.dados = cena.buffer.data();
+            tamanho = cena.buffer.size();
+        }
+        cena.validar(tamanho);
+        return cena;
+    }
+
+    const Cabecalho& cabecalho() const { return *reinterpret_cast<const Cabecalho*>(dados); }
+    uint32_t numeroVertices() const { return cabecalho().numeroVertices; }
+    uint32_t numeroMalhas() const { return cabecalho().numeroMalhas; }
+    uint32_t numeroObjetos() const { return cabecalho().numeroObjetos; }
+    uint32_t numeroCameras() const { return cabecalho().numeroCameras; }
+    uint32_t numeroViewports() const { return cabecalho().numeroViewports; }
+
+    const float* posicoes() const { return secao<float>(cabecalho().deslocamentoPosicoes); }
+    const float* cores() const { return secao<float>(cabecalho().deslocamentoCores); }
+    const Malha* malhas() const { return secao<Malha>(cabecalho().deslocamentoMalhas); }
+    const Objeto* objetos() const { return secao<Objeto>(cabecalho().deslocamentoObjetos); }
+    const Camera* cameras() const { return secao<Camera>(cabecalho().deslocamentoCameras); }
+    const Viewport* viewports() const { return secao<Viewport>(cabecalho().deslocamentoViewports); }
+
+    size_t bytesPosicoes() const { return size_t(numeroVertices()) * 3 * sizeof(float); }
+    size_t bytesCores() const { return size_t(numeroVertices()) * 3 * sizeof(float); }
+
+private:
+    template <typename T>
+    const T* secao(uint64_t deslocamento) const { return reinterpret_cast<const T*>(dados + deslocamento); }
+
+    // Confere se todas as seções e referências cabem no arquivo antes de expor os ponteiros
+    void validar(size_t tamanho) const {
+        const Cabecalho& c = cabecalho();
+        if (c.versao != VERSAO)
+            throw std::runtime_error("Versão de cena não suportada: " + std::to_string(c.versao));
+        if (c.tamanhoTotal > tamanho)
+            throw std::runtime_error("Arquivo de cena truncado");
+        auto conferir = [&](uint64_t deslocamento, uint64_t bytes) {
+            if (deslocamento % 16 != 0 || deslocamento + bytes > tamanho)
+                throw std::runtime_error("Seção da cena fora dos limites do arquivo");
+        };
+        conferir(c.deslocamentoPosicoes, uint64_t(c.numeroVertices) * 3 * sizeof(float));
+        conferir(c.deslocamentoCores, uint64_t(c.numeroVertices) * 3 * sizeof(float));
+        conferir(c.deslocamentoMalhas, uint64_t(c.numeroMalhas) * sizeof(Malha));
+        conferir(c.deslocamentoObjetos, uint64_t(c.numeroObjetos) * sizeof(Objeto));
+        conferir(c.deslocamentoCameras, uint64_t(c.numeroCameras) * sizeof(Camera));
+        conferir(c.deslocamentoViewports, uint64_t(c.numeroViewports) * sizeof(Viewport));
+        for (uint32_t i = 0; i < c.numeroMalhas; ++i)
+            if (uint64_t(malhas()[i].primeiroVertice) + malhas()[i].numeroVertices > c.numeroVertices)
+                throw std::runtime_error("Malha com vértices fora do intervalo");
+        for (uint32_t i = 0; i < c.numeroObjetos; ++i)
+            if (objetos()[i].malha >= c.numeroMalhas)
+                throw std::runtime_error("Objeto referencia malha inexistente");
+        for (uint32_t i = 0; i < c.numeroViewports; ++i)
+            if (viewports()[i].camera >= c.numeroCameras)
+                throw std::runtime_error("Viewport referencia câmera inexistente");
+    }
+
+    void liberar() {
+        if (mapeamento)
+            munmap(mapeamento, tamanhoMapeamento);
+        mapeamento = nullptr;
+        tamanhoMapeamento = 0;
+        buffer.clear();
+        dados = nullptr;
+    }
+
+    void* mapeamento = nullptr;
+    size_t tamanhoMapeamento = 0;
+    std::vector<uint8_t> buffer;
+    const uint8_t* dados = nullptr;
+};
+
+} // namespace cena
@@ -0,0 +1,217 @@
+// Gravação de comandos de desenho em várias threads e execução na thread do OpenGL
+//
+// Só a thread que tem o contexto atual pode chamar o OpenGL, mas o trabalho que
+// antecede as chamadas (percorrer a cena, montar matrizes, descartar objetos) não
+// precisa dele. Cada tarefa (por exemplo, um viewport) grava comandos em um
+// BufferComandos próprio, um bloco linear de memória que só a sua thread escreve,
+// sem travas. Depois a thread do OpenGL percorre os buffers na ordem das tarefas e
+// emite as chamadas, de modo que a imagem não depende de qual thread terminou antes.
+//
+// Uso, a cada quadro, na thread do OpenGL:
+//   gravador.gravar(numeroViewports, [&](size_t i, comandos::BufferComandos& b) {
+//       b.viewport(...); b.usarPrograma(programa); b.uniformeMatriz4(local, mvp); ...
+//   });
+//   gravador.executar();
+//
+// Os dados apontados por um comando (ponteiros de chamar()) precisam continuar válidos
+// até executar().
+#pragma once
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "tarefas.hpp"
+
+namespace comandos {
+
+enum Tipo : uint32_t {
+    VIEWPORT,
+    PROGRAMA,
+    UNIFORME_MATRIZ4,
+    ATRIBUTO,
+    DESABILITAR_ATRIBUTO,
+    DESENHAR_ARRAYS,
+    CHAMAR
+};
+
+struct Cabecalho {
+    uint32_t tipo;
+    uint32_t palavras; // Tamanho do comando (cabeçalho incluído) em palavras de 8 bytes
+};
+
+struct ComandoViewport { GLint x, y; GLsizei largura, altura; };
+struct ComandoPrograma { GLuint programa; };
+struct ComandoUniformeMatriz4 { GLint local; GLfloat valor[16]; };
+struct ComandoAtributo {
+    GLuint local, buffer;
+    GLint componentes;
+    GLenum tipo;
+    GLboolean normalizado;
+    GLsizei stride;
+    size_t deslocamento;
+};
+struct ComandoDesabilitarAtributo { GLuint local; };
+struct ComandoDesenharArrays { GLenum primitiva; GLint primeiro; GLsizei quantidade; };
+struct ComandoChamar {
+    void (*trampolim)(void (*)(), void*); // Restaura o tipo original da função antes de chamá-la
+    void (*funcao)();
+    void* dados;
+};
+
+// Memória linear de comandos. Cresce apenas na thread dona e é reaproveitada entre quadros.
+class BufferComandos {
+public:
+    void reiniciar() { usadas = 0; quantidade = 0; }
+
+    void viewport(GLint x, GLint y, GLsizei largura, GLsizei altura) { gravar(VIEWPORT, ComandoViewport{x, y, largura, altura}); }
+    void usarPrograma(GLuint programa) { gravar(PROGRAMA, ComandoPrograma{programa}); }
+
+    void uniformeMatriz4(GLint local, const GLfloat valor[16]) {
+        ComandoUniformeMatriz4 c;
+        c.local = local;
+        std::memcpy(c.valor, valor, sizeof(c.valor));
+        gravar(UNIFORME_MATRIZ4, c);
+    }
+
+    // Vincula o buffer, define o ponteiro do atributo e o habilita
+    void atributo(GLuint local, GLuint buffer, GLint componentes, GLenum tipo, GLboolean normalizado = GL_FALSE,
+                  GLsizei stride = 0, size_t deslocamento = 0) {
+        gravar(ATRIBUTO, ComandoAtributo{local, buffer, componentes, tipo, normalizado, stride, deslocamento});
+    }
+
+    void desabilitarAtributo(GLuint local) { gravar(DESABILITAR_ATRIBUTO, ComandoDesabilitarAtributo{local}); }
+
+    void desenharArrays(GLenum primitiva, GLint primeiro, GLsizei quantidade) {
+        gravar(DESENHAR_ARRAYS, ComandoDesenharArrays{primitiva, primeiro, quantidade});
+    }
+
+    // Chamada arbitrária na thread do OpenGL, para o que não tem comando próprio
+    template <typename T>
+    void chamar(void (*funcao)(T*), T* dados) {
+        gravar(CHAMAR, ComandoChamar{&trampolim<T>, reinterpret_cast<void (*)()>(funcao), static_cast<void*>(dados)});
+    }
+
+    // Emite os comandos gravados; só na thread com o contexto atual
+    void executar() const {
+        for (size_t i = 0; i < usadas;) {
+            const Cabecalho& cabecalho = *reinterpret_cast<const Cabecalho*>(&memoria[i]);
+            const void* dados = &memoria[i + 1];
+            switch (cabecalho.tipo) {
+            case VIEWPORT: {
+                auto& c = *static_cast<const ComandoViewport*>(dados);
+                glViewport(c.x, c.y, c.largura, c.altura);
+                break;
+            }
+            case PROGRAMA:
+                glUseProgram(static_cast<const ComandoPrograma*>(dados)->programa);
+                break;
+            case UNIFORME_MATRIZ4: {
+                auto& c = *static_cast<const ComandoUniformeMatriz4*>(dados);
+                glUniformMatrix4fv(c.local, 1, GL_FALSE, c.valor);
+                break;
+            }
+            case ATRIBUTO: {
+                auto& c = *static_cast<const ComandoAtributo*>(dados);
+                glBindBuffer(GL_ARRAY_BUFFER, c.buffer);
+                glVertexAttribPointer(c.local, c.componentes, c.tipo, c.normalizado, c.stride,
+                                      reinterpret_cast<const void*>(c.deslocamento));
+                glEnableVertexAttribArray(c.local);
+                break;
+            }
+            case DESABILITAR_ATRIBUTO:
+                glDisableVertexAttribArray(static_cast<const ComandoDesabilitarAtributo*>(dados)->local);
+                break;
+            case DESENHAR_ARRAYS: {
+                auto& c = *static_cast<const ComandoDesenharArrays*>(dados);
+                glDrawArrays(c.primitiva, c.primeiro, c.quantidade);
+                break;
+            }
+            case CHAMAR: {
+                auto& c = *static_cast<const ComandoChamar*>(dados);
+                c.trampolim(c.funcao, c.dados);
+                break;
+            }
+            }
+            i += cabecalho.palavras;
+        }
+    }
+
+    size_t numeroComandos() const { return quantidade; }
+    size_t bytes() const { return usadas * sizeof(uint64_t); }
+
+private:
+    template <typename T>
+    static void trampolim(void (*funcao)(), void* dados) {
+        reinterpret_cast<void (*)(T*)>(funcao)(static_cast<T*>(dados));
+    }
+
+    template <typename C>
+    void gravar(Tipo tipo, const C& comando) {
+        static_assert(std::is_trivially_copyable_v<C>, "Comandos são copiados byte a byte");
+        size_t palavras = 1 + (sizeof(C) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+        if (usadas + palavras > memoria.size())
+            memoria.resize(std::max<size_t>(2 * memoria.size(), usadas + palavras + 256));
+        Cabecalho cabecalho{tipo, static_cast<uint32_t>(palavras)};
+        std::memcpy(&memoria[usadas], &cabecalho, sizeof(cabecalho));
+        std::memcpy(&memoria[usadas + 1], &comando, sizeof(C));
+        usadas += palavras;
+        quantidade++;
+    }
+
+    std::vector<uint64_t> memoria; // Palavras de 8 bytes mantêm todos os comandos alinhados
+    size_t usadas = 0;
+    size_t quantidade = 0;
+};
+
+// Grava uma tarefa por BufferComandos no agendador compartilhado (tarefas::padrao()), sem
+// threads próprias. A thread que chama também trabalha e só retorna quando todas as
+// tarefas foram gravadas.
+class GravadorParalelo {
+public:
+    explicit GravadorParalelo(tarefas::Agendador& agendador = tarefas::padrao()) : agendador(agendador) {}
+
+    GravadorParalelo(const GravadorParalelo&) = delete;
+    GravadorParalelo& operator=(const GravadorParalelo&) = delete;
+
+    template <typename Tarefa>
+    void gravar(size_t numeroTarefas, const Tarefa& tarefa) {
+        if (buffers.size() < numeroTarefas)
+            buffers.resize(numeroTarefas);
+        for (size_t i = 0; i < numeroTarefas; ++i)
+            buffers[i].reiniciar();
+        gravadas = numeroTarefas;
+        // Grânulo 1: cada tarefa (viewport) pode ser roubada por um trabalhador livre
+        agendador.paraleloPara(0, numeroTarefas, 1, [&](size_t i0, size_t i1) {
+            for (size_t i = i0; i < i1; ++i)
+                tarefa(i, buffers[i]);
+        });
+    }
+
+    // Emite os buffers gravados, na ordem das tarefas
+    void executar() const {
+        for (size_t i = 0; i < gravadas; ++i)
+            buffers[i].executar();
+    }
+
+    size_t numeroComandos() const {
+        size_t total = 0;
+        for (size_t i = 0; i < gravadas; ++i)
+            total += buffers[i].numeroComandos();
+        return total;
+    }
+
+    // Trabalhadores do agendador mais a thread que chama gravar()
+    unsigned numeroThreads() const { return agendador.numeroTrabalhadores() + 1; }
+
+private:
+    tarefas::Agendador& agendador;
+    std::vector<BufferComandos> buffers;
+    size_t gravadas = 0;
+};
+
+} // namespace comandos
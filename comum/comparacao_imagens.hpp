@@ -0,0 +1,195 @@
+// Comparação de imagens para validar otimizações contra imagens de referência
+//
+// comparar() mede, em uma passada por linhas (dividida entre os trabalhadores de
+// tarefas::padrao() e vetorizada com simd::u8x16):
+//  - a maior diferença absoluta de um canal e quantos pixels passam da tolerância
+//    (um pixel conta se qualquer canal diferir mais que ela);
+//  - o erro quadrático médio e o PSNR (infinito para imagens idênticas);
+//  - o SSIM da luminância, em janelas de 8x8 deslocadas de 4 em 4 pixels.
+// mapaDiferencas() gera uma imagem de calor: a referência esmaecida em cinza e, por cima,
+// os pixels fora da tolerância em cores que vão do azul (pouca diferença) ao vermelho.
+//
+//   comparacao::Resultado r = comparacao::comparar(referencia, teste, 2);
+//   if (r.pixelsForaTolerancia > 0) imagem::escrever("diferencas.ppm", comparacao::mapaDiferencas(referencia, teste, 2));
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "imagem.hpp"
+#include "simd.hpp"
+#include "tarefas.hpp"
+
+namespace comparacao {
+
+struct Resultado {
+    int maiorDiferenca = 0;          // Maior |a - b| de um canal
+    size_t pixelsForaTolerancia = 0; // Pixels com algum canal diferindo mais que a tolerância
+    size_t pixels = 0;
+    double mse = 0.0;                // Erro quadrático médio por canal
+    double psnr = std::numeric_limits<double>::infinity(); // Em dB
+    double ssim = 1.0;               // Média das janelas, de -1 a 1 (1 = idênticas)
+
+    double fracaoForaTolerancia() const { return pixels ? double(pixelsForaTolerancia) / pixels : 0.0; }
+};
+
+namespace detalhe {
+
+inline void exigirMesmoFormato(const imagem::Imagem& a, const imagem::Imagem& b) {
+    if (a.largura != b.largura || a.altura != b.altura || a.canais != b.canais)
+        throw std::invalid_argument("As imagens comparadas precisam ter o mesmo tamanho e número de canais");
+}
+
+// Pixels de uma linha com algum canal fora da tolerância (só chamada para linhas com diferenças)
+inline size_t contarPixelsForaTolerancia(const uint8_t* a, const uint8_t* b, int largura, int canais, int tolerancia) {
+    size_t n = 0;
+    for (int x = 0; x < largura; ++x) {
+        bool fora = false;
+        for (int c = 0; c < canais; ++c)
+            fora |= std::abs(int(a[x * canais + c]) - int(b[x * canais + c])) > tolerancia;
+        n += fora;
+    }
+    return n;
+}
+
+// SSIM de uma faixa de janelas (linhas de janela [j0, j1)): soma dos valores e número de janelas
+inline void ssimFaixa(const imagem::Imagem& a, const imagem::Imagem& b, int j0, int j1, double& soma, size_t& janelas) {
+    const int lado = 8, passo = 4, largura = a.largura;
+    const double c1 = (0.01 * 255) * (0.01 * 255), c2 = (0.03 * 255) * (0.03 * 255), n = lado * lado;
+    // Somas de cada coluna nas 8 linhas da janela; depois as janelas somam 8 colunas vizinhas
+    std::vector<uint32_t> sx(largura), sy(largura), sxx(largura), syy(largura), sxy(largura);
+    for (int j = j0; j < j1; ++j) {
+        std::fill(sx.begin(), sx.end(), 0); std::fill(sy.begin(), sy.end(), 0);
+        std::fill(sxx.begin(), sxx.end(), 0); std::fill(syy.begin(), syy.end(), 0); std::fill(sxy.begin(), sxy.end(), 0);
+        for (int y = j * passo; y < j * passo + lado; ++y) {
+            const uint8_t* la = a.linha(y);
+            const uint8_t* lb = b.linha(y);
+            for (int x = 0; x < largura; ++x) { // Laço simples: o compilador vetoriza
+                uint32_t va = la[x], vb = lb[x];
+                sx[x] += va; sy[x] += vb;
+                sxx[x] += va * va; syy[x] += vb * vb; sxy[x] += va * vb;
+            }
+        }
+        for (int x0 = 0; x0 + lado <= largura; x0 += passo) {
+            double mx = 0, my = 0, mxx = 0, myy = 0, mxy = 0;
+            for (int x = x0; x < x0 + lado; ++x) {
+                mx += sx[x]; my += sy[x]; mxx += sxx[x]; myy += syy[x]; mxy += sxy[x];
+            }
+            mx /= n; my /= n;
+            double vx = mxx / n - mx * mx, vy = myy / n - my * my, cov = mxy / n - mx * my;
+            soma += ((2 * mx * my + c1) * (2 * cov + c2)) / ((mx * mx + my * my + c1) * (vx + vy + c2));
+            janelas++;
+        }
+    }
+}
+
+} // namespace detalhe
+
+// SSIM da luminância (imagens coloridas são convertidas com imagem::paraCinza)
+inline double ssim(const imagem::Imagem& a, const imagem::Imagem& b) {
+    detalhe::exigirMesmoFormato(a, b);
+    imagem::Imagem ca = imagem::paraCinza(a), cb = imagem::paraCinza(b);
+    int linhasJanela = ca.altura >= 8 ? (ca.altura - 8) / 4 + 1 : 0;
+    if (linhasJanela == 0 || ca.largura < 8)
+        return 1.0; // Menor que uma janela: sem estrutura para comparar
+    double soma = 0.0;
+    size_t janelas = 0;
+    std::mutex mutex;
+    tarefas::padrao().paraleloPara(0, linhasJanela, 8, [&](size_t j0, size_t j1) {
+        double s = 0.0;
+        size_t n = 0;
+        detalhe::ssimFaixa(ca, cb, static_cast<int>(j0), static_cast<int>(j1), s, n);
+        std::lock_guard<std::mutex> trava(mutex);
+        soma += s;
+        janelas += n;
+    });
+    return janelas ? soma / janelas : 1.0;
+}
+
+inline Resultado comparar(const imagem::Imagem& a, const imagem::Imagem& b, int tolerancia = 0) {
+    detalhe::exigirMesmoFormato(a, b);
+    tolerancia = std::min(std::max(tolerancia, 0), 255);
+    Resultado r;
+    r.pixels = size_t(a.largura) * a.altura;
+    uint64_t somaQuadrados = 0;
+    std::mutex mutex;
+    tarefas::padrao().paraleloPara(0, a.altura, 16, [&](size_t y0, size_t y1) {
+        uint8_t maior = 0;
+        size_t foraTolerancia = 0;
+        uint64_t quadrados = 0;
+        const size_t bytes = a.bytesPorLinha();
+        for (size_t y = y0; y < y1; ++y) {
+            const uint8_t* la = a.linha(static_cast<int>(y));
+            const uint8_t* lb = b.linha(static_cast<int>(y));
+            simd::u8x16 maximoLinha = simd::difundirByte(0);
+            int canaisFora = 0;
+            size_t i = 0;
+            for (; i + 16 <= bytes; i += 16) {
+                simd::u8x16 d = simd::diferencaAbsoluta(simd::carregarBytes(la + i), simd::carregarBytes(lb + i));
+                maximoLinha = simd::maximo(maximoLinha, d);
+                canaisFora += simd::contarMaioresQue(d, static_cast<uint8_t>(tolerancia));
+                quadrados += simd::somaQuadrados(d);
+            }
+            uint8_t maiorLinha = simd::maximoHorizontal(maximoLinha);
+            for (; i < bytes; ++i) {
+                int d = std::abs(int(la[i]) - int(lb[i]));
+                maiorLinha = std::max(maiorLinha, static_cast<uint8_t>(d));
+                canaisFora += d > tolerancia;
+                quadrados += uint64_t(d) * d;
+            }
+            maior = std::max(maior, maiorLinha);
+            if (canaisFora > 0) // Raro quando as imagens batem: só então agrupa os canais por pixel
+                foraTolerancia += detalhe::contarPixelsForaTolerancia(la, lb, a.largura, a.canais, tolerancia);
+        }
+        std::lock_guard<std::mutex> trava(mutex);
+        r.maiorDiferenca = std::max(r.maiorDiferenca, int(maior));
+        r.pixelsForaTolerancia += foraTolerancia;
+        somaQuadrados += quadrados;
+    });
+    r.mse = a.pixels.empty() ? 0.0 : double(somaQuadrados) / a.pixels.size();
+    if (r.mse > 0.0)
+        r.psnr = 10.0 * std::log10(255.0 * 255.0 / r.mse);
+    r.ssim = ssim(a, b);
+    return r;
+}
+
+// Mapa de calor RGB das diferenças acima da tolerância, normalizado pela maior diferença
+inline imagem::Imagem mapaDiferencas(const imagem::Imagem& a, const imagem::Imagem& b, int tolerancia = 0) {
+    detalhe::exigirMesmoFormato(a, b);
+    imagem::Imagem cinza = imagem::paraCinza(a);
+    imagem::Imagem mapa(a.largura, a.altura, 3);
+    int maior = 1;
+    for (size_t i = 0; i < a.pixels.size(); ++i)
+        maior = std::max(maior, std::abs(int(a.pixels[i]) - int(b.pixels[i])));
+    for (int y = 0; y < a.altura; ++y) {
+        for (int x = 0; x < a.largura; ++x) {
+            int d = 0;
+            for (int c = 0; c < a.canais; ++c)
+                d = std::max(d, std::abs(int(a.pixel(x, y)[c]) - int(b.pixel(x, y)[c])));
+            uint8_t* saida = mapa.pixel(x, y);
+            if (d <= tolerancia) {
+                // Fundo: a referência em cinza claro, só para dar contexto
+                uint8_t fundo = static_cast<uint8_t>(192 + cinza.pixel(x, y)[0] / 4);
+                saida[0] = saida[1] = saida[2] = fundo;
+                continue;
+            }
+            // Azul -> verde -> amarelo -> vermelho
+            float t = static_cast<float>(d) / maior;
+            float r = std::min(1.0f, std::max(0.0f, 2.0f * t - 0.5f));
+            float g = t < 0.75f ? std::min(1.0f, 2.0f * t) : 4.0f * (1.0f - t);
+            float bl = std::max(0.0f, 1.0f - 2.0f * t);
+            saida[0] = static_cast<uint8_t>(255.0f * r + 0.5f);
+            saida[1] = static_cast<uint8_t>(255.0f * g + 0.5f);
+            saida[2] = static_cast<uint8_t>(255.0f * bl + 0.5f);
+        }
+    }
+    return mapa;
+}
+
+} // namespace comparacao
@@ -0,0 +1,36 @@
+// Converte uma cena em texto (.cena) para o formato binário (.cenab) lido com mmap
+//
+// Uso: compilar_cena entrada.cena saida.cenab
+#include <fstream>
+#include <iostream>
+
+#include "cena.hpp"
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Uso: " << argv[0] << " entrada.cena saida.cenab" << std::endl;
+        return 1;
+    }
+
+    try {
+        std::ifstream entrada(argv[1]);
+        if (!entrada)
+            throw std::runtime_error(std::string("Não foi possível abrir ") + argv[1]);
+        cena::DadosCena dados = cena::lerTexto(entrada);
+        std::vector<uint8_t> binario = cena::serializar(dados);
+
+        std::ofstream saida(argv[2], std::ios::binary);
+        if (!saida)
+            throw std::runtime_error(std::string("Não foi possível criar ") + argv[2]);
+        saida.write(reinterpret_cast<const char*>(binario.data()), binario.size());
+
+        std::cout << argv[2] << ": " << dados.posicoes.size() / 3 << " vértices, "
+                  << dados.malhas.size() << " malhas, " << dados.objetos.size() << " objetos, "
+                  << dados.cameras.size() << " câmeras, " << dados.viewports.size() << " viewports ("
+                  << binario.size() << " bytes)" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Erro: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
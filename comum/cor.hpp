@@ -0,0 +1,259 @@
+// Espaço de cor: imagens em float linear e conversão de/para sRGB de 8 bits
+//
+// Os bytes de um PPM estão em sRGB, com gama: a média de 0 e 255 não é 128, é 188.
+// Misturar, suavizar bordas ou reduzir uma imagem direto nos bytes escurece as
+// transições. Aqui as contas são feitas em ImagemLinear (float, luz proporcional) e só
+// a saída volta para 8 bits:
+//   - sRGB -> linear: tabela de 256 floats, exata.
+//   - linear -> sRGB: trecho linear perto do preto e, acima dele, um polinômio de grau 5
+//     em sqrt(x) no lugar de pow(x, 1 / 2.4), 4 canais por vez com simd::f4. O erro
+//     fica abaixo de 0,09 do passo de 8 bits, então o byte só difere do exato quando o
+//     valor cai quase no meio de dois níveis.
+//   - Pontilhado na volta para 8 bits: ordenado (Bayer 8x8, paralelo e vetorizado) ou
+//     difusão de erro (Floyd-Steinberg em serpentina, com o erro medido em luz linear).
+//
+//   cor::ImagemLinear linear = cor::paraLinear(imagem::ler("render.ppm"));
+//   cor::compor(linear, x, y, vermelho, 0.25f);             // 25% de cobertura, em luz linear
+//   imagem::escrever("saida.ppm", cor::paraSRGB(cor::reduzir(linear, 2), cor::ORDENADO));
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "imagem.hpp"
+#include "simd.hpp"
+#include "tarefas.hpp"
+
+namespace cor {
+
+struct ImagemLinear {
+    int largura = 0, altura = 0, canais = 0;
+    std::vector<float> pixels; // Intercalados, linha a linha, 0 = preto e 1 = branco
+
+    ImagemLinear() = default;
+    ImagemLinear(int largura, int altura, int canais, float valor = 0.0f)
+        : largura(largura), altura(altura), canais(canais), pixels(size_t(largura) * altura * canais, valor) {}
+
+    size_t floatsPorLinha() const { return size_t(largura) * canais; }
+    float* linha(int y) { return pixels.data() + y * floatsPorLinha(); }
+    const float* linha(int y) const { return pixels.data() + y * floatsPorLinha(); }
+    float* pixel(int x, int y) { return linha(y) + size_t(x) * canais; }
+    const float* pixel(int x, int y) const { return linha(y) + size_t(x) * canais; }
+};
+
+enum Pontilhado {
+    SEM_PONTILHADO, // Arredonda cada valor
+    ORDENADO,       // Matriz de Bayer 8x8: rápido, padrão fixo
+    DIFUSAO_ERRO    // Floyd-Steinberg: sem padrão, mas sequencial
+};
+
+namespace detalhe {
+
+const float LIMITE_LINEAR = 0.0031308f; // Abaixo dele o sRGB é a reta 12,92 x
+
+// Ajuste de mínimo erro máximo de 255 * (1,055 x^(1/2,4) - 0,055) como polinômio em
+// t = sqrt(x), para x entre LIMITE_LINEAR e 1
+const float COEFICIENTES[6] = {-10.2264362f, 387.043451f, -357.476869f, 517.481359f, -413.405815f, 131.666394f};
+
+inline const std::array<float, 256>& tabelaLinear() {
+    static const std::array<float, 256> tabela = [] {
+        std::array<float, 256> t{};
+        for (int i = 0; i < 256; ++i) {
+            double s = i / 255.0;
+            t[i] = static_cast<float>(s <= 0.04045 ? s / 12.92 : std::pow((s + 0.055) / 1.055, 2.4));
+        }
+        return t;
+    }();
+    return tabela;
+}
+
+// Valor sRGB entre 0 e 255, ainda sem arredondar
+inline float codificar255(float x) {
+    x = std::min(std::max(x, 0.0f), 1.0f);
+    if (x <= LIMITE_LINEAR)
+        return x * (12.92f * 255.0f);
+    float t = std::sqrt(x);
+    const float* c = COEFICIENTES;
+    return std::min(255.0f, ((((c[5] * t + c[4]) * t + c[3]) * t + c[2]) * t + c[1]) * t + c[0]);
+}
+
+inline simd::f4 codificar255(simd::f4 x) {
+    using namespace simd;
+    x = minimo(maximo(x, difundir(0.0f)), difundir(1.0f));
+    f4 t = raizQuadrada(x);
+    const float* c = COEFICIENTES;
+    f4 curva = multiplicarSomar(difundir(c[5]), t, difundir(c[4]));
+    curva = multiplicarSomar(curva, t, difundir(c[3]));
+    curva = multiplicarSomar(curva, t, difundir(c[2]));
+    curva = multiplicarSomar(curva, t, difundir(c[1]));
+    curva = multiplicarSomar(curva, t, difundir(c[0]));
+    f4 reta = x * difundir(12.92f * 255.0f);
+    return minimo(selecionar(mascaraMaior(x, difundir(LIMITE_LINEAR)), curva, reta), difundir(255.0f));
+}
+
+// Limiares de Bayer 8x8 em (0, 1), centrados: somados ao valor antes de arredondar
+inline float limiarBayer(int x, int y) {
+    static const uint8_t BAYER[8][8] = {{0, 32, 8, 40, 2, 34, 10, 42},  {48, 16, 56, 24, 50, 18, 58, 26},
+                                        {12, 44, 4, 36, 14, 46, 6, 38}, {60, 28, 52, 20, 62, 30, 54, 22},
+                                        {3, 35, 11, 43, 1, 33, 9, 41},  {51, 19, 59, 27, 49, 17, 57, 25},
+                                        {15, 47, 7, 39, 13, 45, 5, 37}, {63, 31, 55, 23, 61, 29, 53, 21}};
+    return (BAYER[y & 7][x & 7] + 0.5f) / 64.0f - 0.5f;
+}
+
+inline void exigirCanais(int canais) {
+    if (canais != 1 && canais != 3)
+        throw std::invalid_argument("A conversão de cor trabalha com imagens de 1 ou 3 canais");
+}
+
+} // namespace detalhe
+
+inline float deSRGB(uint8_t valor) { return detalhe::tabelaLinear()[valor]; }
+
+inline uint8_t paraSRGB(float linear) { return static_cast<uint8_t>(detalhe::codificar255(linear) + 0.5f); }
+
+// Conversões diretas pela fórmula do sRGB, para conferir as rápidas
+namespace referencia {
+
+inline float deSRGB(uint8_t valor) {
+    double s = valor / 255.0;
+    return static_cast<float>(s <= 0.04045 ? s / 12.92 : std::pow((s + 0.055) / 1.055, 2.4));
+}
+
+inline uint8_t paraSRGB(float linear) {
+    double x = std::min(std::max(double(linear), 0.0), 1.0);
+    double s = x <= 0.0031308 ? 12.92 * x : 1.055 * std::pow(x, 1.0 / 2.4) - 0.055;
+    return static_cast<uint8_t>(std::lround(s * 255.0));
+}
+
+inline ImagemLinear paraLinear(const imagem::Imagem& img) {
+    ImagemLinear saida(img.largura, img.altura, img.canais);
+    for (size_t i = 0; i < img.pixels.size(); ++i)
+        saida.pixels[i] = deSRGB(img.pixels[i]);
+    return saida;
+}
+
+inline imagem::Imagem paraSRGB(const ImagemLinear& img) {
+    imagem::Imagem saida(img.largura, img.altura, img.canais);
+    for (size_t i = 0; i < img.pixels.size(); ++i)
+        saida.pixels[i] = paraSRGB(img.pixels[i]);
+    return saida;
+}
+
+} // namespace referencia
+
+inline ImagemLinear paraLinear(const imagem::Imagem& img) {
+    detalhe::exigirCanais(img.canais);
+    ImagemLinear saida(img.largura, img.altura, img.canais);
+    const size_t n = img.pixels.size();
+    tarefas::padrao().paraleloPara(0, n, 1 << 16, [&](size_t i0, size_t i1) {
+        const float* tabela = detalhe::tabelaLinear().data();
+        const uint8_t* origem = img.pixels.data();
+        float* destino = saida.pixels.data();
+        for (size_t i = i0; i < i1; ++i)
+            destino[i] = tabela[origem[i]];
+    });
+    return saida;
+}
+
+inline imagem::Imagem paraSRGB(const ImagemLinear& img, Pontilhado pontilhado = SEM_PONTILHADO) {
+    detalhe::exigirCanais(img.canais);
+    imagem::Imagem saida(img.largura, img.altura, img.canais);
+    const size_t n = img.floatsPorLinha();
+
+    if (pontilhado == DIFUSAO_ERRO) {
+        // Serpentina: linhas pares da esquerda para a direita, ímpares ao contrário. O erro
+        // é a diferença de luz entre o valor desejado e o do byte escolhido, e vai 7/16
+        // para o vizinho seguinte e 3/16, 5/16 e 1/16 para a linha de baixo.
+        const int canais = img.canais, largura = img.largura;
+        std::vector<float> erroAtual(size_t(largura + 2) * canais, 0.0f), erroSeguinte(erroAtual.size(), 0.0f);
+        for (int y = 0; y < img.altura; ++y) {
+            const bool direita = (y & 1) == 0;
+            const int passo = direita ? 1 : -1;
+            std::fill(erroSeguinte.begin(), erroSeguinte.end(), 0.0f);
+            for (int k = 0; k < largura; ++k) {
+                int x = direita ? k : largura - 1 - k;
+                const float* origem = img.pixel(x, y);
+                uint8_t* destino = saida.pixel(x, y);
+                for (int c = 0; c < canais; ++c) {
+                    size_t i = size_t(x + 1) * canais + c; // Índices deslocados de 1 pixel: sem testes na borda
+                    float desejado = origem[c] + erroAtual[i];
+                    uint8_t byte = paraSRGB(desejado);
+                    float erro = desejado - deSRGB(byte);
+                    destino[c] = byte;
+                    erroAtual[i + passo * canais] += erro * (7.0f / 16.0f);
+                    erroSeguinte[i - passo * canais] += erro * (3.0f / 16.0f);
+                    erroSeguinte[i] += erro * (5.0f / 16.0f);
+                    erroSeguinte[i + passo * canais] += erro * (1.0f / 16.0f);
+                }
+            }
+            std::swap(erroAtual, erroSeguinte);
+        }
+        return saida;
+    }
+
+    // Sem pontilhado ou ordenado: linhas independentes, 4 floats por vez. O padrão de
+    // Bayer se repete a cada 8 pixels, 8 * canais floats (múltiplo de 4), então cada linha
+    // guarda os limiares de um período alinhado com os grupos de 4.
+    const bool ordenado = pontilhado == ORDENADO;
+    tarefas::padrao().paraleloPara(0, size_t(img.altura), 16, [&](size_t y0, size_t y1) {
+        const int canais = img.canais; // Locais: veja filtros::paraCinza()
+        const size_t periodo = size_t(8) * canais;
+        float limiares[8 * 3];
+        for (size_t y = y0; y < y1; ++y) {
+            for (size_t j = 0; j < periodo; ++j)
+                limiares[j] = ordenado ? detalhe::limiarBayer(int(j / canais), int(y)) : 0.0f;
+            const float* origem = img.linha(int(y));
+            uint8_t* destino = saida.linha(int(y));
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                simd::f4 v = detalhe::codificar255(simd::carregar(origem + i)) + simd::carregar(limiares + i % periodo);
+                simd::armazenarBytesArredondados(destino + i, simd::minimo(simd::maximo(v, simd::difundir(0.0f)), simd::difundir(255.0f)));
+            }
+            for (; i < n; ++i)
+                destino[i] = static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, detalhe::codificar255(origem[i]) + limiares[i % periodo])) + 0.5f);
+        }
+    });
+    return saida;
+}
+
+// Mistura "cor" (linear, img.canais valores) sobre o pixel com a cobertura dada (0 a 1)
+inline void compor(ImagemLinear& img, int x, int y, const float* cor, float cobertura) {
+    float* p = img.pixel(x, y);
+    for (int c = 0; c < img.canais; ++c)
+        p[c] += (cor[c] - p[c]) * cobertura;
+}
+
+// Média de blocos fator x fator em luz linear (superamostragem -> resolução final);
+// a última linha e coluna de blocos podem ser menores
+inline ImagemLinear reduzir(const ImagemLinear& img, int fator) {
+    if (fator < 1)
+        throw std::invalid_argument("O fator de redução precisa ser positivo");
+    ImagemLinear saida((img.largura + fator - 1) / fator, (img.altura + fator - 1) / fator, img.canais);
+    tarefas::padrao().paraleloPara(0, size_t(saida.altura), 8, [&](size_t y0, size_t y1) {
+        const int canais = img.canais;
+        std::vector<float> soma(saida.floatsPorLinha());
+        for (size_t y = y0; y < y1; ++y) {
+            std::fill(soma.begin(), soma.end(), 0.0f);
+            const int ya = int(y) * fator, yb = std::min(img.altura, ya + fator);
+            for (int yy = ya; yy < yb; ++yy) {
+                const float* origem = img.linha(yy);
+                for (int x = 0; x < img.largura; ++x)
+                    for (int c = 0; c < canais; ++c)
+                        soma[size_t(x / fator) * canais + c] += origem[size_t(x) * canais + c];
+            }
+            float* destino = saida.linha(int(y));
+            for (int x = 0; x < saida.largura; ++x) {
+                int area = (std::min(img.largura, (x + 1) * fator) - x * fator) * (yb - ya);
+                for (int c = 0; c < canais; ++c)
+                    destino[size_t(x) * canais + c] = soma[size_t(x) * canais + c] / area;
+            }
+        }
+    });
+    return saida;
+}
+
+} // namespace cor
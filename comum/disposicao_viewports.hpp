@@ -0,0 +1,248 @@
+// Disposição automática de N viewports no framebuffer
+//
+// Calcula os retângulos (em pixels, origem no canto inferior esquerdo, como glViewport)
+// de N vistas a partir do tamanho do framebuffer, em quatro modos:
+//  - GRADE: células iguais; escolhe o número de colunas que deixa cada vista maior. Com
+//    uma proporção definida, cada vista é centralizada na célula com faixas (letterbox),
+//    como em viewport/configuracao-automatizada/configuracao.cpp;
+//  - MOSAICO: cobre o framebuffer inteiro, sem faixas; cada linha divide a largura entre
+//    as suas vistas e o número de linhas é o que deixa as vistas mais próximas da
+//    proporção desejada. Cada vista deve montar a projeção com a própria proporção;
+//  - IMAGEM_EM_IMAGEM: a vista 0 ocupa a janela e as demais são miniaturas enfileiradas
+//    a partir do canto inferior direito, por cima da principal;
+//  - FRACOES: retângulos em frações da janela (os viewports de um arquivo .cena).
+//
+// Os retângulos ficam guardados e só são recalculados quando o tamanho muda ou a
+// configuração é trocada; chame redimensionar() no callback de tamanho do framebuffer
+// (glfwSetFramebufferSizeCallback) e use retangulos() no laço de desenho:
+//
+//   disposicao::Disposicao vistas;
+//   vistas.configurar(disposicao::GRADE, 64, 16.0f / 9.0f);
+//   vistas.redimensionar(larguraFramebuffer, alturaFramebuffer);
+//   for (const disposicao::Retangulo& r : vistas.retangulos()) glViewport(r.x, r.y, r.largura, r.altura);
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace disposicao {
+
+enum Modo {
+    GRADE,
+    MOSAICO,
+    IMAGEM_EM_IMAGEM,
+    FRACOES
+};
+
+struct Retangulo {
+    int x, y, largura, altura;
+
+    float proporcao() const { return altura > 0 ? static_cast<float>(largura) / altura : 1.0f; }
+    bool contem(int px, int py) const { return px >= x && px < x + largura && py >= y && py < y + altura; }
+};
+
+// Retângulo em frações do framebuffer (0..1, origem no canto inferior esquerdo)
+struct Fracao {
+    float x, y, largura, altura;
+};
+
+class Disposicao {
+public:
+    // proporcao: largura / altura que cada vista deve manter (0 = ocupa a célula inteira).
+    // espacamento: pixels livres entre as vistas e nas bordas (GRADE e MOSAICO).
+    void configurar(Modo modo, size_t numeroVistas, float proporcao = 0.0f, int espacamento = 0) {
+        this->modo = modo;
+        this->quantidadeVistas = numeroVistas;
+        this->proporcaoVistas = std::max(0.0f, proporcao);
+        this->espacamento = std::max(0, espacamento);
+        sujo = true;
+    }
+
+    void configurarFracoes(const std::vector<Fracao>& fracoes, float proporcao = 0.0f) {
+        this->fracoes = fracoes;
+        configurar(FRACOES, fracoes.size(), proporcao);
+    }
+
+    // Altura das miniaturas de IMAGEM_EM_IMAGEM, em fração da altura do framebuffer
+    void definirEscalaMiniaturas(float escala) {
+        escalaMiniaturas = std::min(std::max(escala, 0.01f), 1.0f);
+        sujo = true;
+    }
+
+    // Recalcula os retângulos se o tamanho ou a configuração mudaram; devolve se recalculou
+    bool redimensionar(int largura, int altura) {
+        if (!sujo && largura == larguraFramebuffer && altura == alturaFramebuffer)
+            return false;
+        larguraFramebuffer = largura;
+        alturaFramebuffer = altura;
+        sujo = false;
+        calcular();
+        contagemRecalculos++;
+        return true;
+    }
+
+    const std::vector<Retangulo>& retangulos() const { return calculados; }
+    const Retangulo& operator[](size_t i) const { return calculados[i]; }
+    size_t numeroVistas() const { return quantidadeVistas; }
+    int largura() const { return larguraFramebuffer; }
+    int altura() const { return alturaFramebuffer; }
+    uint64_t recalculos() const { return contagemRecalculos; }
+
+    // Vista sob o pixel (x, y), ou -1; as miniaturas, desenhadas depois, têm prioridade
+    int vistaEm(int x, int y) const {
+        for (size_t i = calculados.size(); i-- > 0;)
+            if (calculados[i].contem(x, y))
+                return static_cast<int>(i);
+        return -1;
+    }
+
+private:
+    void calcular() {
+        calculados.assign(quantidadeVistas, Retangulo{0, 0, 0, 0});
+        if (quantidadeVistas == 0 || larguraFramebuffer <= 0 || alturaFramebuffer <= 0)
+            return;
+        switch (modo) {
+        case GRADE: calcularGrade(); break;
+        case MOSAICO: calcularMosaico(); break;
+        case IMAGEM_EM_IMAGEM: calcularImagemEmImagem(); break;
+        case FRACOES: calcularFracoes(); break;
+        }
+    }
+
+    // Maior retângulo com a proporção das vistas que cabe em (x, y, largura, altura), centralizado
+    Retangulo ajustar(int x, int y, int largura, int altura) const {
+        largura = std::max(largura, 0);
+        altura = std::max(altura, 0);
+        if (proporcaoVistas <= 0.0f || largura == 0 || altura == 0)
+            return {x, y, largura, altura};
+        int l = largura, a = altura;
+        if (static_cast<float>(largura) / altura > proporcaoVistas)
+            l = std::max(1, static_cast<int>(std::lround(altura * proporcaoVistas)));
+        else
+            a = std::max(1, static_cast<int>(std::lround(largura / proporcaoVistas)));
+        return {x + (largura - l) / 2, y + (altura - a) / 2, l, a};
+    }
+
+    // Divide [0, total) em n partes inteiras sem sobras; devolve o início da parte k
+    static int divisao(int total, int n, int k) { return static_cast<int>(int64_t(total) * k / n); }
+
+    void calcularGrade() {
+        const int n = static_cast<int>(quantidadeVistas), e = espacamento;
+        // Escolhe as colunas pela área de cada vista (com proporção livre, pelo menor lado da célula)
+        int melhorColunas = 1;
+        double melhorArea = -1.0;
+        for (int colunas = 1; colunas <= n; ++colunas) {
+            int linhas = (n + colunas - 1) / colunas;
+            double l = double(larguraFramebuffer - (colunas + 1) * e) / colunas;
+            double a = double(alturaFramebuffer - (linhas + 1) * e) / linhas;
+            if (l <= 0 || a <= 0)
+                continue;
+            double area = proporcaoVistas > 0 ? std::min(l, a * proporcaoVistas) * std::min(a, l / proporcaoVistas)
+                                             : std::min(l, a) * std::min(l, a);
+            if (area > melhorArea * 1.0001) { // Em empate fica com menos colunas
+                melhorArea = area;
+                melhorColunas = colunas;
+            }
+        }
+        const int colunas = melhorColunas, linhas = (n + colunas - 1) / colunas;
+        const int larguraUtil = larguraFramebuffer - (colunas + 1) * e, alturaUtil = alturaFramebuffer - (linhas + 1) * e;
+        for (int i = 0; i < n; ++i) {
+            int linha = i / colunas, coluna = i % colunas;
+            // Ordem de leitura: a linha 0 fica no topo. A última linha incompleta é centralizada.
+            int naLinha = std::min(colunas, n - linha * colunas);
+            int deslocamento = (colunas - naLinha) * (larguraUtil / colunas + e) / 2;
+            int x0 = divisao(larguraUtil, colunas, coluna), x1 = divisao(larguraUtil, colunas, coluna + 1);
+            int y0 = divisao(alturaUtil, linhas, linhas - 1 - linha), y1 = divisao(alturaUtil, linhas, linhas - linha);
+            calculados[i] = ajustar(e * (coluna + 1) + x0 + deslocamento, e * (linhas - linha) + y0, x1 - x0, y1 - y0);
+        }
+    }
+
+    void calcularMosaico() {
+        const int n = static_cast<int>(quantidadeVistas), e = espacamento;
+        const double alvo = proporcaoVistas > 0 ? proporcaoVistas : 1.0;
+        // Número de linhas que minimiza o desvio (em escala logarítmica) da proporção de cada vista
+        int melhorLinhas = 1;
+        double melhorDesvio = 1e30;
+        for (int linhas = 1; linhas <= n; ++linhas) {
+            double a = double(alturaFramebuffer - (linhas + 1) * e) / linhas;
+            if (a <= 0)
+                break;
+            double desvio = 0.0;
+            for (int linha = 0; linha < linhas; ++linha) {
+                int naLinha = n * (linha + 1) / linhas - n * linha / linhas;
+                double l = double(larguraFramebuffer - (naLinha + 1) * e) / naLinha;
+                desvio += naLinha * std::fabs(std::log(std::max(l, 1.0) / a / alvo));
+            }
+            if (desvio < melhorDesvio) {
+                melhorDesvio = desvio;
+                melhorLinhas = linhas;
+            }
+        }
+        const int linhas = melhorLinhas, alturaUtil = alturaFramebuffer - (linhas + 1) * e;
+        for (int linha = 0, i = 0; linha < linhas; ++linha) {
+            int naLinha = n * (linha + 1) / linhas - n * linha / linhas;
+            int larguraUtil = larguraFramebuffer - (naLinha + 1) * e;
+            int y0 = divisao(alturaUtil, linhas, linhas - 1 - linha), y1 = divisao(alturaUtil, linhas, linhas - linha);
+            for (int coluna = 0; coluna < naLinha; ++coluna, ++i) {
+                int x0 = divisao(larguraUtil, naLinha, coluna), x1 = divisao(larguraUtil, naLinha, coluna + 1);
+                calculados[i] = {e * (coluna + 1) + x0, e * (linhas - linha) + y0, x1 - x0, y1 - y0};
+            }
+        }
+    }
+
+    void calcularImagemEmImagem() {
+        calculados[0] = ajustar(0, 0, larguraFramebuffer, alturaFramebuffer);
+        size_t miniaturas = quantidadeVistas - 1;
+        if (miniaturas == 0)
+            return;
+        const int margem = std::max(espacamento, std::max(2, alturaFramebuffer / 100));
+        double proporcao = proporcaoVistas > 0 ? proporcaoVistas : double(larguraFramebuffer) / alturaFramebuffer;
+        // Encolhe as miniaturas até todas caberem na metade de baixo da janela e cada uma
+        // caber, com as margens, na largura (numa janela alta e estreita é a largura que limita)
+        double altura = escalaMiniaturas * alturaFramebuffer;
+        size_t porLinha = 1, linhas = miniaturas;
+        for (;;) {
+            double largura = altura * proporcao;
+            porLinha = std::max<size_t>(1, static_cast<size_t>((larguraFramebuffer - margem) / (largura + margem)));
+            linhas = (miniaturas + porLinha - 1) / porLinha;
+            bool cabe = linhas * (altura + margem) <= 0.5 * alturaFramebuffer && largura + 2 * margem <= larguraFramebuffer;
+            if (cabe || altura < 4.0)
+                break;
+            altura *= 0.9;
+        }
+        int a = std::max(1, static_cast<int>(altura)), l = std::max(1, static_cast<int>(altura * proporcao));
+        for (size_t k = 0; k < miniaturas; ++k) {
+            int linha = static_cast<int>(k / porLinha), coluna = static_cast<int>(k % porLinha);
+            int x = std::max(margem, larguraFramebuffer - (coluna + 1) * (l + margem));
+            calculados[k + 1] = {x, margem + linha * (a + margem), l, a};
+        }
+    }
+
+    void calcularFracoes() {
+        for (size_t i = 0; i < quantidadeVistas; ++i) {
+            const Fracao& f = fracoes[i];
+            int x0 = static_cast<int>(std::lround(f.x * larguraFramebuffer));
+            int y0 = static_cast<int>(std::lround(f.y * alturaFramebuffer));
+            int x1 = static_cast<int>(std::lround((f.x + f.largura) * larguraFramebuffer));
+            int y1 = static_cast<int>(std::lround((f.y + f.altura) * alturaFramebuffer));
+            calculados[i] = ajustar(x0, y0, x1 - x0, y1 - y0);
+        }
+    }
+
+    Modo modo = GRADE;
+    size_t quantidadeVistas = 0;
+    float proporcaoVistas = 0.0f;
+    int espacamento = 0;
+    float escalaMiniaturas = 0.25f;
+    std::vector<Fracao> fracoes;
+
+    bool sujo = true;
+    int larguraFramebuffer = 0, alturaFramebuffer = 0;
+    uint64_t contagemRecalculos = 0;
+    std::vector<Retangulo> calculados;
+};
+
+} // namespace disposicao
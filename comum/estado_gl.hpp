@@ -0,0 +1,312 @@
+// Camada fina de rastreamento de estado do OpenGL e fila de desenho ordenada
+//
+// EstadoGL guarda o que já está vinculado (programa, VAO, buffers, atributos
+// habilitados e seus ponteiros, valores de uniforms) e só repassa ao driver as
+// chamadas que mudam algo. As posições dos uniforms são buscadas uma única vez por
+// programa. Os contadores dizem, por quadro, quantas chamadas foram emitidas e
+// quantas foram evitadas.
+//
+// FilaDesenho recebe itens (programa, material, malha, profundidade), ordena-os por
+// uma chave de 64 bits
+//
+//   [63..48] programa  [47..32] material  [31..16] malha  [15..0] profundidade
+//
+// e os executa pelo EstadoGL, de modo que itens com o mesmo programa e material fiquem
+// juntos e as trocas de estado caiam ao mínimo. A profundidade (0 = perto, 1 = longe)
+// desempata de frente para trás, o que favorece o descarte pelo teste de profundidade.
+//
+// O cabeçalho não inclui o OpenGL: inclua antes o GLEW (ou o GLUT, no macOS).
+// Se outro código mexer no estado do OpenGL por fora, chame invalidar().
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class EstadoGL {
+public:
+    struct Contadores {
+        size_t emitidas = 0;        // Chamadas repassadas ao OpenGL (inclui desenhos)
+        size_t evitadas = 0;        // Vínculos e envios de uniform redundantes que não saíram
+        size_t buscasEvitadas = 0;  // glGetUniformLocation respondidas pelo cache
+        size_t desenhos = 0;
+    };
+
+    void usarPrograma(GLuint programa) {
+        if (programaAtual == programa && programaConhecido) {
+            contadores.evitadas++;
+            return;
+        }
+        glUseProgram(programa);
+        programaAtual = programa;
+        programaConhecido = true;
+        contadores.emitidas++;
+    }
+
+#ifdef GL_VERSION_3_0
+    void vincularVao(GLuint vao) {
+        if (vaoAtual == vao && vaoConhecido) {
+            contadores.evitadas++;
+            return;
+        }
+        glBindVertexArray(vao);
+        vaoAtual = vao;
+        vaoConhecido = true;
+        contadores.emitidas++;
+    }
+#endif
+
+    // GL_ELEMENT_ARRAY_BUFFER faz parte do estado do VAO e é rastreado junto com ele
+    void vincularBuffer(GLenum alvo, GLuint buffer) {
+        GLuint* atual = alvo == GL_ARRAY_BUFFER ? &bufferVertices
+                      : alvo == GL_ELEMENT_ARRAY_BUFFER ? &estadoVao().bufferIndices : nullptr;
+        if (atual && *atual == buffer) {
+            contadores.evitadas++;
+            return;
+        }
+        glBindBuffer(alvo, buffer);
+        if (atual)
+            *atual = buffer;
+        contadores.emitidas++;
+    }
+
+    void habilitarAtributo(GLuint local) { alterarAtributo(local, true); }
+    void desabilitarAtributo(GLuint local) { alterarAtributo(local, false); }
+
+    // Como glVertexAttribPointer; pula a chamada se o VAO atual já aponta para o mesmo lugar
+    void ponteiroAtributo(GLuint local, GLint componentes, GLenum tipo, GLboolean normalizado, GLsizei stride,
+                          const void* ponteiro) {
+        Ponteiro novo{bufferVertices, componentes, tipo, normalizado, stride, ponteiro};
+        Ponteiro& atual = estadoVao().ponteiros[local % MAXIMO_ATRIBUTOS];
+        if (local < MAXIMO_ATRIBUTOS && atual.igual(novo)) {
+            contadores.evitadas++;
+            return;
+        }
+        glVertexAttribPointer(local, componentes, tipo, normalizado, stride, ponteiro);
+        if (local < MAXIMO_ATRIBUTOS)
+            atual = novo;
+        contadores.emitidas++;
+    }
+
+    // Posição de um uniform do programa atual, buscada no driver só na primeira vez
+    GLint localUniforme(const char* nome) {
+        auto& locais = uniformes[programaAtual];
+        auto it = locais.find(nome);
+        if (it != locais.end()) {
+            contadores.buscasEvitadas++;
+            return it->second;
+        }
+        GLint local = glGetUniformLocation(programaAtual, nome);
+        locais.emplace(nome, local);
+        contadores.emitidas++;
+        return local;
+    }
+
+    void uniforme4fv(const char* nome, const GLfloat valor[4]) {
+        GLint local = localUniforme(nome);
+        if (local < 0 || !valorMudou(local, valor, 4))
+            return; // -1: o programa não tem esse uniform (ou o compilador o eliminou)
+        glUniform4fv(local, 1, valor);
+        contadores.emitidas++;
+    }
+
+    void uniformeMatriz4fv(const char* nome, const GLfloat valor[16]) {
+        GLint local = localUniforme(nome);
+        if (local < 0 || !valorMudou(local, valor, 16))
+            return;
+        glUniformMatrix4fv(local, 1, GL_FALSE, valor);
+        contadores.emitidas++;
+    }
+
+    void desenharArrays(GLenum primitiva, GLint primeiro, GLsizei quantidade) {
+        glDrawArrays(primitiva, primeiro, quantidade);
+        contadores.emitidas++;
+        contadores.desenhos++;
+    }
+
+    // Esquece tudo o que foi rastreado (o próximo vínculo de cada tipo sempre é emitido)
+    void invalidar() {
+        programaConhecido = vaoConhecido = false;
+        bufferVertices = INVALIDO;
+        vaos.clear();
+        valores.clear();
+    }
+
+    // Os programas apagados precisam sair do cache, porque o nome pode ser reaproveitado
+    void esquecerPrograma(GLuint programa) {
+        uniformes.erase(programa);
+        for (auto it = valores.begin(); it != valores.end();)
+            it = (it->first >> 32) == programa ? valores.erase(it) : std::next(it);
+        if (programaAtual == programa)
+            programaConhecido = false;
+    }
+
+    // Zera os contadores e devolve os do quadro que terminou
+    Contadores iniciarQuadro() {
+        Contadores anteriores = contadores;
+        contadores = Contadores();
+        return anteriores;
+    }
+
+    const Contadores& contadoresQuadro() const { return contadores; }
+
+    // Para o que iniciarQuadro() devolve: o quadro em andamento ainda está incompleto
+    static void imprimirContadores(const Contadores& c, FILE* saida = stdout) {
+        fprintf(saida, "Estado GL: %zu chamadas emitidas (%zu desenhos), %zu evitadas, %zu buscas de uniform em cache\n",
+                c.emitidas, c.desenhos, c.evitadas, c.buscasEvitadas);
+    }
+
+private:
+    static constexpr GLuint MAXIMO_ATRIBUTOS = 16; // Mínimo garantido de GL_MAX_VERTEX_ATTRIBS
+    static constexpr GLuint INVALIDO = ~GLuint(0);
+
+    struct Ponteiro {
+        GLuint buffer;
+        GLint componentes;
+        GLenum tipo;
+        GLboolean normalizado;
+        GLsizei stride;
+        const void* ponteiro;
+
+        bool igual(const Ponteiro& p) const {
+            return buffer == p.buffer && componentes == p.componentes && tipo == p.tipo &&
+                   normalizado == p.normalizado && stride == p.stride && ponteiro == p.ponteiro;
+        }
+    };
+    struct EstadoVao {
+        uint32_t habilitados = 0;
+        uint32_t conhecidos = 0; // Atributos cujo estado (habilitado ou não) já foi definido por aqui
+        GLuint bufferIndices = INVALIDO;
+        Ponteiro ponteiros[MAXIMO_ATRIBUTOS];
+        EstadoVao() {
+            for (Ponteiro& p : ponteiros)
+                p = {INVALIDO, 0, 0, GL_FALSE, 0, nullptr};
+        }
+    };
+
+    EstadoVao& estadoVao() { return vaos[vaoAtual]; }
+
+    void alterarAtributo(GLuint local, bool habilitar) {
+        EstadoVao& vao = estadoVao();
+        uint32_t bit = local < MAXIMO_ATRIBUTOS ? 1u << local : 0u;
+        if (bit && (vao.conhecidos & bit) && bool(vao.habilitados & bit) == habilitar) {
+            contadores.evitadas++;
+            return;
+        }
+        if (habilitar)
+            glEnableVertexAttribArray(local);
+        else
+            glDisableVertexAttribArray(local);
+        vao.conhecidos |= bit;
+        vao.habilitados = habilitar ? vao.habilitados | bit : vao.habilitados & ~bit;
+        contadores.emitidas++;
+    }
+
+    // Compara com o último valor enviado para (programa, local) e guarda o novo
+    bool valorMudou(GLint local, const GLfloat* valor, size_t n) {
+        uint64_t chave = (uint64_t(programaAtual) << 32) | uint32_t(local);
+        auto [it, novo] = valores.try_emplace(chave);
+        if (!novo && std::memcmp(it->second.data(), valor, n * sizeof(GLfloat)) == 0) {
+            contadores.evitadas++;
+            return false;
+        }
+        std::memcpy(it->second.data(), valor, n * sizeof(GLfloat));
+        return true;
+    }
+
+    bool programaConhecido = false, vaoConhecido = false;
+    GLuint programaAtual = 0, vaoAtual = 0, bufferVertices = INVALIDO;
+    std::unordered_map<GLuint, EstadoVao> vaos; // 0 é o estado fora de qualquer VAO
+    std::unordered_map<GLuint, std::unordered_map<std::string, GLint>> uniformes;
+    std::unordered_map<uint64_t, std::array<GLfloat, 16>> valores;
+    Contadores contadores;
+};
+
+class FilaDesenho {
+public:
+    // Um material é, por enquanto, um único uniform vec4 (por exemplo a cor)
+    struct Material {
+        std::string uniforme;
+        GLfloat valor[4];
+    };
+
+    // Geometria de um item: de onde vêm as posições e o intervalo desenhado. Com buffer 0
+    // o ponteiro é um endereço na memória do processo (arrays do cliente, GL 2.1).
+    struct Malha {
+        GLuint vao;
+        GLuint buffer;
+        GLuint atributo;
+        GLint componentes;
+        const void* ponteiro;
+        GLenum primitiva;
+        GLint primeiro;
+        GLsizei quantidade;
+    };
+
+    explicit FilaDesenho(EstadoGL& estado) : estado(estado) {}
+
+    uint16_t registrarPrograma(GLuint programa) { return registrar(programas, programa); }
+    uint16_t registrarMaterial(const Material& material) { return registrar(materiais, material); }
+    uint16_t registrarMalha(const Malha& malha) { return registrar(malhas, malha); }
+
+    // Profundidade normalizada em [0, 1]; fora do intervalo é saturada
+    void submeter(uint16_t programa, uint16_t material, uint16_t malha, float profundidade = 0.0f) {
+        float p = std::min(std::max(profundidade, 0.0f), 1.0f);
+        uint64_t chave = (uint64_t(programa) << 48) | (uint64_t(material) << 32) | (uint64_t(malha) << 16) |
+                         uint64_t(p * 65535.0f + 0.5f);
+        itens.push_back(chave);
+    }
+
+    // Ordena os itens submetidos, emite-os e esvazia a fila
+    void executar() {
+        std::sort(itens.begin(), itens.end());
+        uint32_t ultimoPrograma = ~0u, ultimoMaterial = ~0u, ultimaMalha = ~0u;
+        for (uint64_t chave : itens) {
+            uint16_t programa = uint16_t(chave >> 48), material = uint16_t(chave >> 32), indice = uint16_t(chave >> 16);
+            estado.usarPrograma(programas[programa]);
+            if (programa != ultimoPrograma) {
+                // Os uniforms são de cada programa: o mesmo material precisa ser enviado de novo
+                ultimoMaterial = ultimaMalha = ~0u;
+                ultimoPrograma = programa;
+            }
+            if (material != ultimoMaterial) {
+                const Material& m = materiais[material];
+                estado.uniforme4fv(m.uniforme.c_str(), m.valor);
+                ultimoMaterial = material;
+            }
+            const Malha& malha = malhas[indice];
+            if (indice != ultimaMalha) {
+#ifdef GL_VERSION_3_0
+                if (malha.vao)
+                    estado.vincularVao(malha.vao);
+#endif
+                estado.vincularBuffer(GL_ARRAY_BUFFER, malha.buffer);
+                estado.habilitarAtributo(malha.atributo);
+                estado.ponteiroAtributo(malha.atributo, malha.componentes, GL_FLOAT, GL_FALSE, 0, malha.ponteiro);
+                ultimaMalha = indice;
+            }
+            estado.desenharArrays(malha.primitiva, malha.primeiro, malha.quantidade);
+        }
+        itens.clear();
+    }
+
+    size_t numeroItens() const { return itens.size(); }
+
+private:
+    template <typename T>
+    static uint16_t registrar(std::vector<T>& tabela, const T& valor) {
+        tabela.push_back(valor);
+        return static_cast<uint16_t>(tabela.size() - 1);
+    }
+
+    EstadoGL& estado;
+    std::vector<GLuint> programas;
+    std::vector<Material> materiais;
+    std::vector<Malha> malhas;
+    std::vector<uint64_t> itens; // Só as chaves: os índices da chave bastam para achar o item
+};
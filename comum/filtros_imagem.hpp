@@ -0,0 +1,494 @@
+// Filtros de imagem sobre imagem::Imagem (8 bits por canal), no estilo do pré-processamento
+// de convexhull/carros.py: cinza, desfoque gaussiano, gradiente de Sobel, média em caixa
+// por imagem integral, histograma, equalização e limiarização.
+//
+// Cada filtro tem duas versões com o mesmo resultado (a menos de 1 nível de arredondamento
+// nos filtros em ponto flutuante):
+//  - filtros::referencia::*: laços escalares diretos, fáceis de conferir;
+//  - filtros::*: divididos em faixas de linhas ou blocos (que cabem na cache) entre os
+//    trabalhadores de tarefas::padrao(), com os laços internos em simd::f4 ou simd::u8x16,
+//    ou escritos para o compilador vetorizar.
+// cores_imagens/filtros_benchmark.cpp mede as duas versões e confere uma contra a outra.
+//
+// Bordas: o pixel da borda é repetido (como BORDER_REPLICATE do OpenCV).
+//
+//   imagem::Imagem cinza = filtros::paraCinza(imagem::ler("carros.ppm"));
+//   imagem::Imagem binaria = filtros::limiarizar(filtros::desfoqueGaussiano(cinza, 1.5f), 50);
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "imagem.hpp"
+#include "simd.hpp"
+#include "tarefas.hpp"
+
+namespace filtros {
+
+using imagem::Imagem;
+using Histograma = std::array<uint32_t, 256>;
+
+namespace detalhe {
+
+inline void exigirCinza(const Imagem& img) {
+    if (img.canais != 1)
+        throw std::invalid_argument("O filtro espera uma imagem em tons de cinza (1 canal)");
+}
+
+inline uint8_t saturar(float v) { return v <= 0.0f ? 0 : v >= 255.0f ? 255 : static_cast<uint8_t>(v + 0.5f); }
+
+inline int limitar(int v, int minimo, int maximo) { return std::min(std::max(v, minimo), maximo); }
+
+// Executa f(y0, y1) em faixas de até "linhas" linhas, em paralelo
+template <typename Funcao>
+void porFaixas(int altura, size_t linhas, Funcao&& f) {
+    tarefas::padrao().paraleloPara(0, static_cast<size_t>(altura), linhas,
+                                   [&](size_t y0, size_t y1) { f(static_cast<int>(y0), static_cast<int>(y1)); });
+}
+
+// Pesos do núcleo gaussiano normalizado, com raio ceil(3 * sigma)
+inline std::vector<float> nucleoGaussiano(float sigma) {
+    if (sigma <= 0.0f)
+        throw std::invalid_argument("O desvio padrão do desfoque precisa ser positivo");
+    int raio = std::max(1, static_cast<int>(std::ceil(3.0f * sigma)));
+    std::vector<float> pesos(2 * raio + 1);
+    double soma = 0.0;
+    for (int k = -raio; k <= raio; ++k)
+        soma += pesos[k + raio] = static_cast<float>(std::exp(-0.5 * k * k / (double(sigma) * sigma)));
+    for (float& p : pesos)
+        p = static_cast<float>(p / soma);
+    return pesos;
+}
+
+// Tabela da equalização (a mesma fórmula do cv::equalizeHist)
+inline std::array<uint8_t, 256> tabelaEqualizacao(const Histograma& h) {
+    std::array<uint8_t, 256> tabela{};
+    uint64_t total = 0, minimo = 0;
+    for (uint32_t n : h)
+        total += n;
+    for (uint32_t n : h)
+        if ((minimo = n) != 0)
+            break;
+    if (total == minimo) { // Imagem de uma cor só: fica como está
+        for (int i = 0; i < 256; ++i)
+            tabela[i] = static_cast<uint8_t>(i);
+        return tabela;
+    }
+    uint64_t acumulado = 0;
+    for (int i = 0; i < 256; ++i) {
+        acumulado += h[i];
+        double v = acumulado <= minimo ? 0.0 : double(acumulado - minimo) * 255.0 / double(total - minimo);
+        tabela[i] = static_cast<uint8_t>(std::min(255.0, std::floor(v + 0.5)));
+    }
+    return tabela;
+}
+
+} // namespace detalhe
+
+//--------------------------------------------------------------------------------
+// Versões escalares de referência
+namespace referencia {
+
+inline Imagem paraCinza(const Imagem& img) { return imagem::paraCinza(img); }
+
+inline Imagem desfoqueGaussiano(const Imagem& img, float sigma) {
+    std::vector<float> pesos = detalhe::nucleoGaussiano(sigma);
+    int raio = static_cast<int>(pesos.size() / 2), c = img.canais;
+    std::vector<float> horizontal(img.pixels.size());
+    for (int y = 0; y < img.altura; ++y)
+        for (int x = 0; x < img.largura; ++x)
+            for (int k = 0; k < c; ++k) {
+                float soma = 0.0f;
+                for (int d = -raio; d <= raio; ++d)
+                    soma += pesos[d + raio] * img.pixel(detalhe::limitar(x + d, 0, img.largura - 1), y)[k];
+                horizontal[(size_t(y) * img.largura + x) * c + k] = soma;
+            }
+    Imagem saida(img.largura, img.altura, c);
+    for (int y = 0; y < img.altura; ++y)
+        for (int x = 0; x < img.largura; ++x)
+            for (int k = 0; k < c; ++k) {
+                float soma = 0.0f;
+                for (int d = -raio; d <= raio; ++d)
+                    soma += pesos[d + raio] * horizontal[(size_t(detalhe::limitar(y + d, 0, img.altura - 1)) * img.largura + x) * c + k];
+                saida.pixel(x, y)[k] = detalhe::saturar(soma);
+            }
+    return saida;
+}
+
+// Magnitude do gradiente, sqrt(gx² + gy²) saturada em 255
+inline Imagem sobel(const Imagem& cinza) {
+    detalhe::exigirCinza(cinza);
+    Imagem saida(cinza.largura, cinza.altura, 1);
+    auto p = [&](int x, int y) {
+        return int(*cinza.pixel(detalhe::limitar(x, 0, cinza.largura - 1), detalhe::limitar(y, 0, cinza.altura - 1)));
+    };
+    for (int y = 0; y < cinza.altura; ++y)
+        for (int x = 0; x < cinza.largura; ++x) {
+            int gx = (p(x + 1, y - 1) + 2 * p(x + 1, y) + p(x + 1, y + 1)) - (p(x - 1, y - 1) + 2 * p(x - 1, y) + p(x - 1, y + 1));
+            int gy = (p(x - 1, y + 1) + 2 * p(x, y + 1) + p(x + 1, y + 1)) - (p(x - 1, y - 1) + 2 * p(x, y - 1) + p(x + 1, y - 1));
+            *saida.pixel(x, y) = detalhe::saturar(static_cast<float>(std::sqrt(double(gx * gx + gy * gy))));
+        }
+    return saida;
+}
+
+// Média da janela (2 * raio + 1)², cortada nas bordas da imagem, por soma direta
+inline Imagem filtroCaixa(const Imagem& cinza, int raio) {
+    detalhe::exigirCinza(cinza);
+    Imagem saida(cinza.largura, cinza.altura, 1);
+    for (int y = 0; y < cinza.altura; ++y)
+        for (int x = 0; x < cinza.largura; ++x) {
+            int x0 = std::max(0, x - raio), x1 = std::min(cinza.largura - 1, x + raio);
+            int y0 = std::max(0, y - raio), y1 = std::min(cinza.altura - 1, y + raio);
+            uint64_t soma = 0;
+            for (int j = y0; j <= y1; ++j)
+                for (int i = x0; i <= x1; ++i)
+                    soma += *cinza.pixel(i, j);
+            uint64_t area = uint64_t(x1 - x0 + 1) * (y1 - y0 + 1);
+            *saida.pixel(x, y) = static_cast<uint8_t>((soma + area / 2) / area);
+        }
+    return saida;
+}
+
+inline Histograma histograma(const Imagem& cinza) {
+    detalhe::exigirCinza(cinza);
+    Histograma h{};
+    for (uint8_t p : cinza.pixels)
+        h[p]++;
+    return h;
+}
+
+inline Imagem equalizar(const Imagem& cinza) {
+    std::array<uint8_t, 256> tabela = detalhe::tabelaEqualizacao(histograma(cinza));
+    Imagem saida = cinza;
+    for (uint8_t& p : saida.pixels)
+        p = tabela[p];
+    return saida;
+}
+
+// p > limiar vira "maximo", o resto 0 (cv2.threshold com THRESH_BINARY)
+inline Imagem limiarizar(const Imagem& cinza, uint8_t limiar, uint8_t maximo = 255) {
+    detalhe::exigirCinza(cinza);
+    Imagem saida = cinza;
+    for (uint8_t& p : saida.pixels)
+        p = p > limiar ? maximo : 0;
+    return saida;
+}
+
+} // namespace referencia
+
+//--------------------------------------------------------------------------------
+// Versões paralelas e vetorizadas
+
+inline Imagem paraCinza(const Imagem& img) {
+    if (img.canais == 1)
+        return img;
+    if (img.canais < 3)
+        throw std::invalid_argument("Conversão para cinza espera 3 ou mais canais");
+    Imagem cinza(img.largura, img.altura, 1);
+    detalhe::porFaixas(img.altura, 64, [&](int y0, int y1) {
+        // Em variáveis locais: lidas pela captura, seriam recarregadas a cada escrita em
+        // uint8_t* (que pode apontar para qualquer lugar) e o laço não seria vetorizado
+        const int c = img.canais, largura = img.largura;
+        for (int y = y0; y < y1; ++y) {
+            const uint8_t* entrada = img.linha(y);
+            uint8_t* saida = cinza.linha(y);
+            if (c == 3) { // Passo constante: o caso comum (PPM) sai sem multiplicação por c
+                for (int x = 0; x < largura; ++x, entrada += 3)
+                    saida[x] = static_cast<uint8_t>((77 * entrada[0] + 150 * entrada[1] + 29 * entrada[2] + 128) >> 8);
+            } else {
+                for (int x = 0; x < largura; ++x, entrada += c)
+                    saida[x] = static_cast<uint8_t>((77 * entrada[0] + 150 * entrada[1] + 29 * entrada[2] + 128) >> 8);
+            }
+        }
+    });
+    return cinza;
+}
+
+// Desfoque separável em blocos de 64 linhas por 128 colunas: a passada horizontal do bloco
+// (com as linhas de borda do núcleo) fica em um buffer que cabe na cache L2 e a vertical lê
+// dele; as duas somam 4 valores por vez com simd::f4
+inline Imagem desfoqueGaussiano(const Imagem& img, float sigma) {
+    const std::vector<float> pesos = detalhe::nucleoGaussiano(sigma);
+    const int raio = static_cast<int>(pesos.size() / 2), c = img.canais;
+    const int ALTURA_BLOCO = 64, LARGURA_BLOCO = 128;
+    const int blocosX = (img.largura + LARGURA_BLOCO - 1) / LARGURA_BLOCO;
+    const int blocosY = (img.altura + ALTURA_BLOCO - 1) / ALTURA_BLOCO;
+    Imagem saida(img.largura, img.altura, c);
+
+    tarefas::padrao().paraleloPara(0, size_t(blocosX) * blocosY, 1, [&](size_t b0, size_t b1) {
+        std::vector<float> linhaEstendida((LARGURA_BLOCO + 2 * raio) * c + 4);
+        std::vector<float> horizontal(size_t(ALTURA_BLOCO + 2 * raio) * LARGURA_BLOCO * c + 4);
+        std::vector<float> acumulado(size_t(LARGURA_BLOCO) * c + 4);
+        for (size_t b = b0; b < b1; ++b) {
+            const int x0 = static_cast<int>(b % blocosX) * LARGURA_BLOCO, y0 = static_cast<int>(b / blocosX) * ALTURA_BLOCO;
+            const int largura = std::min(LARGURA_BLOCO, img.largura - x0), altura = std::min(ALTURA_BLOCO, img.altura - y0);
+            const int n = largura * c; // Floats por linha do bloco
+
+            // Passada horizontal das linhas y0 - raio .. y0 + altura + raio - 1
+            for (int j = 0; j < altura + 2 * raio; ++j) {
+                const uint8_t* origem = img.linha(detalhe::limitar(y0 + j - raio, 0, img.altura - 1));
+                for (int i = 0; i < largura + 2 * raio; ++i) {
+                    const uint8_t* p = origem + size_t(detalhe::limitar(x0 + i - raio, 0, img.largura - 1)) * c;
+                    for (int k = 0; k < c; ++k)
+                        linhaEstendida[i * c + k] = p[k];
+                }
+                float* destino = &horizontal[size_t(j) * n];
+                int i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    simd::f4 soma = simd::difundir(0.0f);
+                    for (int d = 0; d <= 2 * raio; ++d)
+                        soma = simd::multiplicarSomar(simd::difundir(pesos[d]), simd::carregar(&linhaEstendida[i + d * c]), soma);
+                    simd::armazenar(destino + i, soma);
+                }
+                for (; i < n; ++i) {
+                    float soma = 0.0f;
+                    for (int d = 0; d <= 2 * raio; ++d)
+                        soma += pesos[d] * linhaEstendida[i + d * c];
+                    destino[i] = soma;
+                }
+            }
+
+            // Passada vertical, linha a linha do bloco
+            for (int y = 0; y < altura; ++y) {
+                int i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    simd::f4 soma = simd::difundir(0.0f);
+                    for (int d = 0; d <= 2 * raio; ++d)
+                        soma = simd::multiplicarSomar(simd::difundir(pesos[d]), simd::carregar(&horizontal[size_t(y + d) * n + i]), soma);
+                    simd::armazenar(&acumulado[i], soma);
+                }
+                for (; i < n; ++i) {
+                    float soma = 0.0f;
+                    for (int d = 0; d <= 2 * raio; ++d)
+                        soma += pesos[d] * horizontal[size_t(y + d) * n + i];
+                    acumulado[i] = soma;
+                }
+                uint8_t* destino = saida.linha(y0 + y) + size_t(x0) * c;
+                for (int k = 0; k < n; ++k)
+                    destino[k] = detalhe::saturar(acumulado[k]);
+            }
+        }
+    });
+    return saida;
+}
+
+// Sobel por faixas: as três linhas vizinhas, convertidas para float com a borda repetida,
+// ficam em um anel e cada linha de entrada é convertida uma vez só
+inline Imagem sobel(const Imagem& cinza) {
+    detalhe::exigirCinza(cinza);
+    Imagem saida(cinza.largura, cinza.altura, 1);
+    detalhe::porFaixas(cinza.altura, 32, [&](int y0, int y1) {
+        const int largura = cinza.largura; // Local: veja paraCinza()
+        const size_t tamanhoLinha = largura + 2 + 4;
+        std::vector<float> anel(3 * tamanhoLinha), magnitude(largura + 4);
+        auto converter = [&](int y, float* destino) {
+            const uint8_t* origem = cinza.linha(detalhe::limitar(y, 0, cinza.altura - 1));
+            destino[0] = origem[0];
+            for (int x = 0; x < largura; ++x)
+                destino[x + 1] = origem[x];
+            destino[largura + 1] = origem[largura - 1];
+        };
+        float* linhas[3] = {&anel[0], &anel[tamanhoLinha], &anel[2 * tamanhoLinha]};
+        converter(y0 - 1, linhas[0]);
+        converter(y0, linhas[1]);
+        const simd::f4 dois = simd::difundir(2.0f);
+        for (int y = y0; y < y1; ++y) {
+            converter(y + 1, linhas[2]);
+            const float *a = linhas[0], *m = linhas[1], *b = linhas[2];
+            int x = 0;
+            for (; x + 4 <= largura; x += 4) {
+                simd::f4 a0 = simd::carregar(a + x), a1 = simd::carregar(a + x + 1), a2 = simd::carregar(a + x + 2);
+                simd::f4 m0 = simd::carregar(m + x), m2 = simd::carregar(m + x + 2);
+                simd::f4 b0 = simd::carregar(b + x), b1 = simd::carregar(b + x + 1), b2 = simd::carregar(b + x + 2);
+                simd::f4 gx = (a2 - a0) + dois * (m2 - m0) + (b2 - b0);
+                simd::f4 gy = (b0 + dois * b1 + b2) - (a0 + dois * a1 + a2);
+                simd::armazenar(&magnitude[x], simd::raizQuadrada(gx * gx + gy * gy));
+            }
+            for (; x < largura; ++x) {
+                float gx = (a[x + 2] - a[x]) + 2.0f * (m[x + 2] - m[x]) + (b[x + 2] - b[x]);
+                float gy = (b[x] + 2.0f * b[x + 1] + b[x + 2]) - (a[x] + 2.0f * a[x + 1] + a[x + 2]);
+                magnitude[x] = std::sqrt(gx * gx + gy * gy);
+            }
+            uint8_t* destino = saida.linha(y);
+            for (int k = 0; k < largura; ++k)
+                destino[k] = detalhe::saturar(magnitude[k]);
+            std::rotate(linhas, linhas + 1, linhas + 3); // A linha de baixo vira a do meio
+        }
+    });
+    return saida;
+}
+
+// Imagem integral: somas[(y * (largura + 1)) + x] = soma dos pixels acima e à esquerda de (x, y)
+struct ImagemIntegral {
+    int largura = 0, altura = 0;
+    std::vector<uint32_t> somas; // (largura + 1) * (altura + 1), com a linha e a coluna 0 zeradas
+
+    // Soma do retângulo [x0, x1) x [y0, y1). As contas são módulo 2³², então o resultado é
+    // exato sempre que a soma do retângulo cabe em 32 bits (até 16 milhões de pixels),
+    // mesmo que os valores acumulados da imagem inteira tenham dado a volta.
+    uint32_t soma(int x0, int y0, int x1, int y1) const {
+        const size_t l = size_t(largura) + 1;
+        return somas[y1 * l + x1] - somas[y0 * l + x1] - somas[y1 * l + x0] + somas[y0 * l + x0];
+    }
+};
+
+// Em duas passadas paralelas: somas prefixadas de cada linha (independentes) e depois o
+// acúmulo vertical, que soma linhas inteiras e é dividido por faixas de colunas
+inline ImagemIntegral integral(const Imagem& cinza) {
+    detalhe::exigirCinza(cinza);
+    ImagemIntegral r;
+    r.largura = cinza.largura;
+    r.altura = cinza.altura;
+    const size_t l = size_t(cinza.largura) + 1;
+    r.somas.assign(l * (cinza.altura + 1), 0);
+    detalhe::porFaixas(cinza.altura, 64, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            const uint8_t* origem = cinza.linha(y);
+            uint32_t* destino = &r.somas[(y + 1) * l + 1];
+            uint32_t acumulado = 0;
+            for (int x = 0; x < cinza.largura; ++x)
+                destino[x] = acumulado += origem[x];
+        }
+    });
+    tarefas::padrao().paraleloPara(0, l, 2048, [&](size_t x0, size_t x1) {
+        for (int y = 1; y <= cinza.altura; ++y) {
+            uint32_t* linha = &r.somas[y * l];
+            const uint32_t* anterior = linha - l;
+            for (size_t x = x0; x < x1; ++x) // Vetorizado pelo compilador
+                linha[x] += anterior[x];
+        }
+    });
+    return r;
+}
+
+// Média em caixa com custo constante por pixel, qualquer que seja o raio. No meio da
+// linha a média arredondada (soma + area / 2) / area vem da multiplicação pelo inverso em
+// double, que pode cair logo abaixo do inteiro quando a divisão é exata (1 / 9 não é
+// representável): um passo de correção inteiro sobe o quociente nesses casos.
+inline Imagem filtroCaixa(const Imagem& cinza, int raio) {
+    ImagemIntegral somas = integral(cinza);
+    Imagem saida(cinza.largura, cinza.altura, 1);
+    detalhe::porFaixas(cinza.altura, 64, [&](int y0, int y1) {
+        const int largura = cinza.largura, altura = cinza.altura; // Locais: veja paraCinza()
+        const size_t l = size_t(largura) + 1;
+        for (int y = y0; y < y1; ++y) {
+            const int ya = std::max(0, y - raio), yb = std::min(altura, y + raio + 1), alturaJanela = yb - ya;
+            const uint32_t* topo = &somas.somas[ya * l];
+            const uint32_t* base = &somas.somas[yb * l];
+            uint8_t* destino = saida.linha(y);
+            auto media = [&](int x) {
+                const int xa = std::max(0, x - raio), xb = std::min(largura, x + raio + 1);
+                uint32_t area = uint32_t(xb - xa) * alturaJanela;
+                uint32_t soma = base[xb] - topo[xb] - base[xa] + topo[xa];
+                return static_cast<uint8_t>((soma + area / 2) / area);
+            };
+            // Bordas com a janela cortada; no meio a área é a mesma e o inverso é calculado uma vez
+            const int inicioMeio = std::min(raio, largura), fimMeio = std::max(inicioMeio, largura - raio - 1);
+            for (int x = 0; x < inicioMeio; ++x)
+                destino[x] = media(x);
+            const uint32_t area = uint32_t(2 * raio + 1) * alturaJanela;
+            const uint32_t metade = area / 2;
+            const double inverso = 1.0 / area;
+            for (int x = inicioMeio; x < fimMeio; ++x) {
+                uint32_t soma = base[x + raio + 1] - topo[x + raio + 1] - base[x - raio] + topo[x - raio] + metade;
+                uint32_t q = static_cast<uint32_t>(double(soma) * inverso);
+                q += (q + 1) * area <= soma;
+                destino[x] = static_cast<uint8_t>(q);
+            }
+            for (int x = fimMeio; x < largura; ++x)
+                destino[x] = media(x);
+        }
+    });
+    return saida;
+}
+
+// Histograma com 4 contadores parciais por faixa (pixels vizinhos iguais não esperam o
+// incremento anterior), somados no fim
+inline Histograma histograma(const Imagem& cinza) {
+    detalhe::exigirCinza(cinza);
+    Histograma total{};
+    std::mutex mutex;
+    const size_t n = cinza.pixels.size();
+    tarefas::padrao().paraleloPara(0, n, 1 << 18, [&](size_t i0, size_t i1) {
+        uint32_t parciais[4][256] = {};
+        const uint8_t* p = cinza.pixels.data();
+        size_t i = i0;
+        for (; i + 4 <= i1; i += 4) {
+            parciais[0][p[i]]++;
+            parciais[1][p[i + 1]]++;
+            parciais[2][p[i + 2]]++;
+            parciais[3][p[i + 3]]++;
+        }
+        for (; i < i1; ++i)
+            parciais[0][p[i]]++;
+        std::lock_guard<std::mutex> trava(mutex);
+        for (int v = 0; v < 256; ++v)
+            total[v] += parciais[0][v] + parciais[1][v] + parciais[2][v] + parciais[3][v];
+    });
+    return total;
+}
+
+// Aplica a tabela de 256 entradas a cada byte, em paralelo
+inline Imagem aplicarTabela(const Imagem& img, const std::array<uint8_t, 256>& tabela) {
+    Imagem saida(img.largura, img.altura, img.canais);
+    tarefas::padrao().paraleloPara(0, img.pixels.size(), 1 << 18, [&](size_t i0, size_t i1) {
+        const std::array<uint8_t, 256> local = tabela; // Cópia na pilha: o compilador sabe que destino não a altera
+        const uint8_t* origem = img.pixels.data();
+        uint8_t* destino = saida.pixels.data();
+        for (size_t i = i0; i < i1; ++i)
+            destino[i] = local[origem[i]];
+    });
+    return saida;
+}
+
+inline Imagem equalizar(const Imagem& cinza) { return aplicarTabela(cinza, detalhe::tabelaEqualizacao(histograma(cinza))); }
+
+// Limiar que maximiza a variância entre as classes (método de Otsu)
+inline uint8_t limiarOtsu(const Histograma& h) {
+    double total = 0.0, somaTotal = 0.0;
+    for (int v = 0; v < 256; ++v) {
+        total += h[v];
+        somaTotal += double(v) * h[v];
+    }
+    double pesoFundo = 0.0, somaFundo = 0.0, melhorVariancia = -1.0;
+    int melhor = 0;
+    for (int v = 0; v < 256; ++v) {
+        pesoFundo += h[v];
+        somaFundo += double(v) * h[v];
+        double pesoFrente = total - pesoFundo;
+        if (pesoFundo == 0.0 || pesoFrente == 0.0)
+            continue;
+        double diferenca = somaFundo / pesoFundo - (somaTotal - somaFundo) / pesoFrente;
+        double variancia = pesoFundo * pesoFrente * diferenca * diferenca;
+        if (variancia > melhorVariancia) {
+            melhorVariancia = variancia;
+            melhor = v;
+        }
+    }
+    return static_cast<uint8_t>(melhor);
+}
+
+// 16 pixels por vez: máscara de p > limiar combinada com o valor máximo
+inline Imagem limiarizar(const Imagem& cinza, uint8_t limiar, uint8_t maximo = 255) {
+    detalhe::exigirCinza(cinza);
+    Imagem saida(cinza.largura, cinza.altura, 1);
+    const simd::u8x16 valor = simd::difundirByte(maximo);
+    tarefas::padrao().paraleloPara(0, cinza.pixels.size(), 1 << 18, [&](size_t i0, size_t i1) {
+        const uint8_t* origem = cinza.pixels.data();
+        uint8_t* destino = saida.pixels.data();
+        size_t i = i0;
+        for (; i + 16 <= i1; i += 16)
+            simd::armazenarBytes(destino + i, simd::mascaraMaioresQue(simd::carregarBytes(origem + i), limiar) & valor);
+        for (; i < i1; ++i)
+            destino[i] = origem[i] > limiar ? maximo : 0;
+    });
+    return saida;
+}
+
+} // namespace filtros
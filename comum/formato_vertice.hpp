@@ -0,0 +1,315 @@
+// Formatos de vértice tipados: uma única descrição da struct gera os
+// glVertexAttribPointer, o stride, os deslocamentos e as declarações de entrada do
+// vertex shader, para que C++ e GLSL não possam divergir
+//
+// Uso:
+//   struct VerticeCasa { GLfloat posicao[3]; vertice::CorRGBA8 cor; };
+//   template <> struct vertice::Formato<VerticeCasa> {
+//       static constexpr vertice::Atributo atributos[] = {
+//           ATRIBUTO_VERTICE(VerticeCasa, posicao, 0),
+//           ATRIBUTO_VERTICE(VerticeCasa, cor, 1),
+//       };
+//   };
+//   codigo = vertice::inserirDeclaracoes<VerticeCasa>(codigo); // "layout(location = 0) in vec3 posicao;" ...
+//   vertice::configurarAtributos<VerticeCasa>();              // com o VBO já vinculado
+//
+// A validade do layout (locais repetidos, atributos sobrepostos ou desalinhados,
+// stride acima do limite do OpenGL) é verificada com static_assert.
+//
+// Além de float[1..4], há tipos compactos para reduzir a banda de vértices:
+// Meio[N] (half float, GL_HALF_FLOAT), uint16_t[N] e int16_t[N] (normalizados),
+// Normal1010102 (GL_INT_2_10_10_10_REV normalizado) e CorRGBA8 (GL_UNSIGNED_BYTE
+// normalizado). Uma posição em Meio[4],
+// uma normal e uma cor ocupam 16 bytes por vértice, contra 36 com floats.
+#pragma once
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace vertice {
+
+// Número em ponto flutuante de 16 bits (IEEE 754 binary16)
+struct Meio {
+    uint16_t bits;
+};
+
+// Vetor de 3 componentes com sinal em 10 bits cada e 2 bits para w
+struct Normal1010102 {
+    uint32_t bits;
+};
+
+// Cor com 8 bits por canal, normalizada para [0, 1] no shader
+struct CorRGBA8 {
+    uint8_t r, g, b, a;
+};
+
+// Conversão com arredondamento para o par mais próximo; trata subnormais, infinito e NaN
+inline Meio paraMeio(float valor) {
+    uint32_t f;
+    std::memcpy(&f, &valor, sizeof(f));
+    uint32_t sinal = (f >> 16) & 0x8000u;
+    uint32_t absoluto = f & 0x7FFFFFFFu;
+    if (absoluto >= 0x7F800000u) // Infinito ou NaN
+        return {static_cast<uint16_t>(sinal | 0x7C00u | (absoluto > 0x7F800000u ? 0x200u : 0u))};
+    if (absoluto >= 0x477FF000u) // Acima do maior half (65504) após o arredondamento
+        return {static_cast<uint16_t>(sinal | 0x7C00u)};
+    if (absoluto < 0x38800000u) { // Subnormal em half
+        if (absoluto < 0x33000000u)
+            return {static_cast<uint16_t>(sinal)};
+        uint32_t expoente = absoluto >> 23;
+        uint32_t mantissa = (absoluto & 0x7FFFFFu) | 0x800000u;
+        uint32_t deslocamento = 126 - expoente; // valor = mantissa * 2^(expoente - 150) = h * 2^-24
+        uint32_t resultado = mantissa >> deslocamento;
+        uint32_t resto = mantissa & ((1u << deslocamento) - 1);
+        uint32_t metade = 1u << (deslocamento - 1);
+        if (resto > metade || (resto == metade && (resultado & 1)))
+            resultado++;
+        return {static_cast<uint16_t>(sinal | resultado)};
+    }
+    uint32_t resultado = (absoluto - 0x38000000u) >> 13;
+    uint32_t resto = absoluto & 0x1FFFu;
+    if (resto > 0x1000u || (resto == 0x1000u && (resultado & 1)))
+        resultado++;
+    return {static_cast<uint16_t>(sinal | resultado)};
+}
+
+inline float deMeio(Meio meio) {
+    uint32_t sinal = static_cast<uint32_t>(meio.bits & 0x8000u) << 16;
+    uint32_t expoente = (meio.bits >> 10) & 0x1Fu;
+    uint32_t mantissa = meio.bits & 0x3FFu;
+    uint32_t f;
+    if (expoente == 0x1F) {
+        f = sinal | 0x7F800000u | (mantissa << 13);
+    } else if (expoente == 0) {
+        float valor = std::ldexp(static_cast<float>(mantissa), -24);
+        return sinal ? -valor : valor;
+    } else {
+        f = sinal | ((expoente + 112) << 23) | (mantissa << 13);
+    }
+    float valor;
+    std::memcpy(&valor, &f, sizeof(valor));
+    return valor;
+}
+
+// Componentes em [-1, 1]; w em {-1, 0, 1}
+inline Normal1010102 empacotarNormal(float x, float y, float z, float w = 0.0f) {
+    auto componente = [](float v, float escala, uint32_t mascara) {
+        int32_t inteiro = static_cast<int32_t>(std::lround(std::clamp(v, -1.0f, 1.0f) * escala));
+        return static_cast<uint32_t>(inteiro) & mascara;
+    };
+    return {componente(x, 511.0f, 0x3FFu) | (componente(y, 511.0f, 0x3FFu) << 10) |
+            (componente(z, 511.0f, 0x3FFu) << 20) | (componente(w, 1.0f, 0x3u) << 30)};
+}
+
+inline void desempacotarNormal(Normal1010102 n, float& x, float& y, float& z) {
+    auto componente = [](uint32_t bits) {
+        int32_t inteiro = static_cast<int32_t>(bits << 22) >> 22; // Estende o sinal dos 10 bits
+        return std::max(inteiro / 511.0f, -1.0f);
+    };
+    x = componente(n.bits);
+    y = componente(n.bits >> 10);
+    z = componente(n.bits >> 20);
+}
+
+inline CorRGBA8 empacotarCor(float r, float g, float b, float a = 1.0f) {
+    auto canal = [](float v) { return static_cast<uint8_t>(std::lround(std::clamp(v, 0.0f, 1.0f) * 255.0f)); };
+    return {canal(r), canal(g), canal(b), canal(a)};
+}
+
+// Como cada tipo de membro é enviado ao OpenGL e declarado no GLSL
+template <typename M>
+struct TraitsAtributo {
+    static_assert(sizeof(M) == 0, "Tipo de membro sem formato de vértice conhecido");
+};
+
+template <size_t N>
+struct NomeVetorGlsl {
+    static_assert(N >= 1 && N <= 4, "Atributos têm de 1 a 4 componentes");
+    static constexpr const char* nome = N == 1 ? "float" : N == 2 ? "vec2" : N == 3 ? "vec3" : "vec4";
+};
+
+template <>
+struct TraitsAtributo<GLfloat> {
+    static constexpr GLint componentes = 1;
+    static constexpr GLenum tipo = GL_FLOAT;
+    static constexpr GLboolean normalizado = GL_FALSE;
+    static constexpr const char* glsl = "float";
+};
+
+template <size_t N>
+struct TraitsAtributo<GLfloat[N]> {
+    static constexpr GLint componentes = N;
+    static constexpr GLenum tipo = GL_FLOAT;
+    static constexpr GLboolean normalizado = GL_FALSE;
+    static constexpr const char* glsl = NomeVetorGlsl<N>::nome;
+};
+
+template <size_t N>
+struct TraitsAtributo<Meio[N]> {
+    static constexpr GLint componentes = N;
+    static constexpr GLenum tipo = GL_HALF_FLOAT;
+    static constexpr GLboolean normalizado = GL_FALSE;
+    static constexpr const char* glsl = NomeVetorGlsl<N>::nome;
+};
+
+// Inteiros de 16 bits são sempre normalizados: [0, 65535] -> [0, 1] e [-32767, 32767] -> [-1, 1]
+template <size_t N>
+struct TraitsAtributo<uint16_t[N]> {
+    static constexpr GLint componentes = N;
+    static constexpr GLenum tipo = GL_UNSIGNED_SHORT;
+    static constexpr GLboolean normalizado = GL_TRUE;
+    static constexpr const char* glsl = NomeVetorGlsl<N>::nome;
+};
+
+template <size_t N>
+struct TraitsAtributo<int16_t[N]> {
+    static constexpr GLint componentes = N;
+    static constexpr GLenum tipo = GL_SHORT;
+    static constexpr GLboolean normalizado = GL_TRUE;
+    static constexpr const char* glsl = NomeVetorGlsl<N>::nome;
+};
+
+template <>
+struct TraitsAtributo<Normal1010102> {
+    static constexpr GLint componentes = 4;
+    static constexpr GLenum tipo = GL_INT_2_10_10_10_REV;
+    static constexpr GLboolean normalizado = GL_TRUE;
+    static constexpr const char* glsl = "vec4";
+};
+
+template <>
+struct TraitsAtributo<CorRGBA8> {
+    static constexpr GLint componentes = 4;
+    static constexpr GLenum tipo = GL_UNSIGNED_BYTE;
+    static constexpr GLboolean normalizado = GL_TRUE;
+    static constexpr const char* glsl = "vec4";
+};
+
+struct Atributo {
+    GLuint local;           // layout(location = ...)
+    GLint componentes;
+    GLenum tipo;
+    GLboolean normalizado;
+    size_t deslocamento;    // Em bytes, a partir do início da struct
+    size_t tamanho;         // sizeof do membro
+    const char* glsl;       // Tipo da entrada no vertex shader
+    const char* nome;       // Nome da entrada no vertex shader (o mesmo do membro)
+};
+
+template <typename M>
+constexpr Atributo criarAtributo(GLuint local, size_t deslocamento, const char* nome) {
+    using T = TraitsAtributo<M>;
+    return {local, T::componentes, T::tipo, T::normalizado, deslocamento, sizeof(M), T::glsl, nome};
+}
+
+#define ATRIBUTO_VERTICE(Tipo, membro, local) \
+    ::vertice::criarAtributo<std::remove_cv_t<decltype(Tipo::membro)>>(local, offsetof(Tipo, membro), #membro)
+
+// Especializado para cada struct de vértice com "static constexpr Atributo atributos[]"
+template <typename T>
+struct Formato;
+
+template <typename T>
+constexpr size_t numeroAtributos() {
+    return sizeof(Formato<T>::atributos) / sizeof(Atributo);
+}
+
+template <typename T>
+constexpr bool locaisUnicos() {
+    constexpr size_t n = numeroAtributos<T>();
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = i + 1; j < n; ++j)
+            if (Formato<T>::atributos[i].local == Formato<T>::atributos[j].local)
+                return false;
+    return true;
+}
+
+template <typename T>
+constexpr bool semSobreposicao() {
+    constexpr size_t n = numeroAtributos<T>();
+    for (size_t i = 0; i < n; ++i) {
+        const Atributo& a = Formato<T>::atributos[i];
+        if (a.deslocamento + a.tamanho > sizeof(T))
+            return false;
+        for (size_t j = i + 1; j < n; ++j) {
+            const Atributo& b = Formato<T>::atributos[j];
+            if (a.deslocamento < b.deslocamento + b.tamanho && b.deslocamento < a.deslocamento + a.tamanho)
+                return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+constexpr bool alinhados() {
+    for (size_t i = 0; i < numeroAtributos<T>(); ++i)
+        if (Formato<T>::atributos[i].deslocamento % 4 != 0)
+            return false;
+    return sizeof(T) % 4 == 0;
+}
+
+// Instanciado por todas as funções que usam o formato, de modo que um erro de layout não compila
+template <typename T>
+constexpr bool verificarFormato() {
+    static_assert(std::is_standard_layout_v<T> && std::is_trivially_copyable_v<T>,
+                  "Vértices precisam ser structs simples, copiáveis com memcpy");
+    static_assert(numeroAtributos<T>() > 0, "Formato sem atributos");
+    static_assert(locaisUnicos<T>(), "Dois atributos com o mesmo layout(location)");
+    static_assert(semSobreposicao<T>(), "Atributos sobrepostos ou fora da struct");
+    static_assert(alinhados<T>(), "Atributos e stride precisam ser múltiplos de 4 bytes");
+    static_assert(sizeof(T) <= 2048, "Stride acima de GL_MAX_VERTEX_ATTRIB_STRIDE garantido");
+    return true;
+}
+
+template <typename T>
+constexpr GLsizei stride() {
+    static_assert(verificarFormato<T>());
+    return static_cast<GLsizei>(sizeof(T));
+}
+
+// Declarações de entrada do vertex shader, uma por atributo
+template <typename T>
+std::string declaracoesGlsl() {
+    static_assert(verificarFormato<T>());
+    std::string declaracoes;
+    for (const Atributo& a : Formato<T>::atributos)
+        declaracoes += "layout(location = " + std::to_string(a.local) + ") in " + a.glsl + " " + a.nome + ";\n";
+    return declaracoes;
+}
+
+// Insere as declarações logo após a linha #version do código do vertex shader
+template <typename T>
+std::string inserirDeclaracoes(const std::string& codigo) {
+    size_t versao = codigo.find("#version");
+    size_t fimLinha = versao == std::string::npos ? std::string::npos : codigo.find('\n', versao);
+    if (fimLinha == std::string::npos)
+        return declaracoesGlsl<T>() + codigo;
+    return codigo.substr(0, fimLinha + 1) + declaracoesGlsl<T>() + codigo.substr(fimLinha + 1);
+}
+
+// Configura e habilita os atributos do VBO vinculado em GL_ARRAY_BUFFER.
+// "base" é o deslocamento em bytes do primeiro vértice dentro do buffer.
+template <typename T>
+void configurarAtributos(size_t base = 0) {
+    static_assert(verificarFormato<T>());
+    for (const Atributo& a : Formato<T>::atributos) {
+        glEnableVertexAttribArray(a.local);
+        glVertexAttribPointer(a.local, a.componentes, a.tipo, a.normalizado, stride<T>(),
+                              reinterpret_cast<const void*>(base + a.deslocamento));
+    }
+}
+
+template <typename T>
+void desabilitarAtributos() {
+    for (const Atributo& a : Formato<T>::atributos)
+        glDisableVertexAttribArray(a.local);
+}
+
+} // namespace vertice
@@ -0,0 +1,63 @@
+// Leitura e escrita de imagens escolhendo o formato pela extensão do arquivo
+//
+// ".png" usa png.hpp (zlib, codificação paralela), ".qoi" usa qoi.hpp e qualquer outra
+// extensão usa Netpbm (imagem.hpp). Na leitura o canal alfa é descartado, para a imagem
+// ter sempre 1 ou 3 canais como as de imagem::ler. Compilar com -lz.
+//
+//   formatos::escrever("quadro.png", quadro);   // ~5-10x menor que o PPM
+//   imagem::Imagem lida = formatos::ler("quadro.qoi");
+#pragma once
+
+#include <cctype>
+#include <string>
+
+#include "imagem.hpp"
+#include "png.hpp"
+#include "qoi.hpp"
+
+namespace formatos {
+
+namespace detalhe {
+
+inline bool terminaCom(const std::string& caminho, const char* extensao) {
+    std::string e(extensao);
+    if (caminho.size() < e.size())
+        return false;
+    for (size_t i = 0; i < e.size(); ++i)
+        if (std::tolower(static_cast<unsigned char>(caminho[caminho.size() - e.size() + i])) != e[i])
+            return false;
+    return true;
+}
+
+// Cinza e alfa -> cinza, RGBA -> RGB
+inline imagem::Imagem semAlfa(imagem::Imagem img) {
+    if (img.canais != 2 && img.canais != 4)
+        return img;
+    imagem::Imagem saida(img.largura, img.altura, img.canais - 1);
+    size_t n = size_t(img.largura) * img.altura;
+    for (size_t i = 0; i < n; ++i)
+        for (int c = 0; c < saida.canais; ++c)
+            saida.pixels[i * saida.canais + c] = img.pixels[i * img.canais + c];
+    return saida;
+}
+
+} // namespace detalhe
+
+inline imagem::Imagem ler(const std::string& caminho) {
+    if (detalhe::terminaCom(caminho, ".png"))
+        return detalhe::semAlfa(png::ler(caminho));
+    if (detalhe::terminaCom(caminho, ".qoi"))
+        return detalhe::semAlfa(qoi::ler(caminho));
+    return imagem::ler(caminho);
+}
+
+inline void escrever(const std::string& caminho, const imagem::Imagem& img) {
+    if (detalhe::terminaCom(caminho, ".png"))
+        png::escrever(caminho, img);
+    else if (detalhe::terminaCom(caminho, ".qoi"))
+        qoi::escrever(caminho, img);
+    else
+        imagem::escrever(caminho, img);
+}
+
+} // namespace formatos
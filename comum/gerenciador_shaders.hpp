@@ -0,0 +1,282 @@
+// Gerenciador de programas GLSL com cache de binários em disco
+//
+// Cada programa é identificado por um hash (FNV-1a de 64 bits) do código dos shaders,
+// das definições (#define) injetadas e das strings do driver (fabricante, renderizador,
+// versão). Na primeira execução o programa é compilado e o binário obtido com
+// glGetProgramBinary é salvo em <diretorio>/<hash>.bin; nas seguintes ele é recarregado
+// com glProgramBinary, sem compilar. Se o driver rejeitar o binário (por exemplo após
+// uma atualização), o programa é compilado novamente e o cache, substituído.
+//
+// Com GL_KHR_parallel_shader_compile (ou a versão ARB), solicitar() apenas dispara a
+// compilação e o link; o driver trabalha em várias threads e programa() só espera
+// quando o resultado é de fato necessário. Para compilar muitas variantes, solicite
+// todas primeiro e só depois chame programa() para cada uma.
+//
+// Os programas devolvidos pertencem ao chamador (glDeleteProgram continua com ele).
+#pragma once
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#  define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+class GerenciadorShaders {
+public:
+    explicit GerenciadorShaders(std::string diretorioCache = ".cache_shaders") : diretorio(std::move(diretorioCache)) {}
+
+    // Dispara a criação de um programa e devolve o identificador da solicitação
+    size_t solicitar(const std::string& codigoVertice, const std::string& codigoFragmento,
+                     const std::vector<std::string>& definicoes = {}) {
+        inicializar();
+        Solicitacao s;
+        std::string vertice = injetarDefinicoes(codigoVertice, definicoes);
+        std::string fragmento = injetarDefinicoes(codigoFragmento, definicoes);
+        s.hash = hashFNV(vertice + '\0' + fragmento + '\0' + identificacaoDriver);
+
+        s.programa = glCreateProgram();
+        if (binariosSuportados && carregarBinario(s)) {
+            s.doCache = true;
+            acertos++;
+        } else {
+            s.vertice = compilar(vertice, GL_VERTEX_SHADER);
+            s.fragmento = compilar(fragmento, GL_FRAGMENT_SHADER);
+            glAttachShader(s.programa, s.vertice);
+            glAttachShader(s.programa, s.fragmento);
+            if (binariosSuportados)
+                glProgramParameteri(s.programa, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+            glLinkProgram(s.programa); // Com compilação paralela, retorna sem esperar
+            compilados++;
+        }
+        solicitacoes.push_back(s);
+        return solicitacoes.size() - 1;
+    }
+
+    // Consulta sem bloquear se o programa já terminou de compilar e linkar
+    bool pronto(size_t id) const {
+        const Solicitacao& s = solicitacoes[id];
+        if (s.finalizado || s.doCache || !compilacaoParalela)
+            return true;
+        GLint completo = GL_FALSE;
+        glGetProgramiv(s.programa, GL_COMPLETION_STATUS_KHR, &completo);
+        return completo == GL_TRUE;
+    }
+
+    // Devolve o programa pronto para uso (bloqueia até o fim do link); 0 em caso de erro
+    GLuint programa(size_t id) {
+        Solicitacao& s = solicitacoes[id];
+        if (!s.finalizado)
+            finalizar(s);
+        return s.programa;
+    }
+
+    // Esquece as solicitações feitas até aqui (os identificadores deixam de valer); os
+    // programas continuam com quem os obteve. Para quem solicita sem parar, como a recarga
+    void descartarSolicitacoes() {
+        for (Solicitacao& s : solicitacoes)
+            if (!s.finalizado)
+                finalizar(s);
+        solicitacoes.clear();
+    }
+
+    void imprimirEstatisticas() const {
+        printf("Shaders: %d programas do cache, %d compilados%s\n", acertos, compilados,
+               compilacaoParalela ? " (compilação paralela)" : "");
+    }
+
+    // Lê um arquivo de shader inteiro; string vazia se não existir
+    static std::string lerArquivo(const std::string& caminho) {
+        std::ifstream arquivo(caminho);
+        std::stringstream conteudo;
+        conteudo << arquivo.rdbuf();
+        return conteudo.str();
+    }
+
+private:
+    struct Solicitacao {
+        uint64_t hash = 0;
+        GLuint programa = 0;
+        GLuint vertice = 0;
+        GLuint fragmento = 0;
+        bool doCache = false;
+        bool finalizado = false;
+    };
+
+    // Feito na primeira solicitação porque exige um contexto OpenGL ativo
+    void inicializar() {
+        if (inicializado)
+            return;
+        inicializado = true;
+        auto texto = [](GLenum nome) {
+            const GLubyte* s = glGetString(nome);
+            return s ? std::string(reinterpret_cast<const char*>(s)) : std::string();
+        };
+        identificacaoDriver = texto(GL_VENDOR) + '|' + texto(GL_RENDERER) + '|' + texto(GL_VERSION) + '|' +
+                              texto(GL_SHADING_LANGUAGE_VERSION);
+
+        GLint formatos = 0;
+        if (GLEW_ARB_get_program_binary)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatos);
+        binariosSuportados = formatos > 0;
+        if (binariosSuportados)
+            std::filesystem::create_directories(diretorio);
+
+        if (GLEW_KHR_parallel_shader_compile) {
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu); // Deixa o driver decidir quantas threads usar
+            compilacaoParalela = true;
+        } else if (GLEW_ARB_parallel_shader_compile) {
+            glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+            compilacaoParalela = true;
+        }
+    }
+
+    static uint64_t hashFNV(const std::string& dados) {
+        uint64_t hash = 14695981039346656037ull;
+        for (unsigned char c : dados) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // Insere "#define X" logo após a linha #version (que precisa continuar sendo a primeira diretiva)
+    static std::string injetarDefinicoes(const std::string& codigo, const std::vector<std::string>& definicoes) {
+        if (definicoes.empty())
+            return codigo;
+        std::string linhas;
+        for (const std::string& d : definicoes)
+            linhas += "#define " + d + "\n";
+        size_t versao = codigo.find("#version");
+        if (versao == std::string::npos)
+            return linhas + codigo;
+        size_t fimLinha = codigo.find('\n', versao);
+        if (fimLinha == std::string::npos)
+            return codigo + "\n" + linhas;
+        return codigo.substr(0, fimLinha + 1) + linhas + codigo.substr(fimLinha + 1);
+    }
+
+    static GLuint compilar(const std::string& codigo, GLenum tipo) {
+        GLuint shader = glCreateShader(tipo);
+        const char* ponteiro = codigo.c_str();
+        glShaderSource(shader, 1, &ponteiro, nullptr);
+        glCompileShader(shader); // O status só é consultado em finalizar(), para não serializar a compilação
+        return shader;
+    }
+
+    std::string caminhoCache(uint64_t hash) const {
+        char nome[32];
+        snprintf(nome, sizeof(nome), "%016llx.bin", static_cast<unsigned long long>(hash));
+        return (std::filesystem::path(diretorio) / nome).string();
+    }
+
+    bool carregarBinario(Solicitacao& s) {
+        const std::string caminho = caminhoCache(s.hash);
+        std::error_code erro;
+        const uintmax_t tamanhoArquivo = std::filesystem::file_size(caminho, erro);
+        std::ifstream arquivo(caminho, std::ios::binary);
+        if (erro || !arquivo)
+            return false;
+        GLenum formato = 0;
+        uint32_t tamanho = 0;
+        arquivo.read(reinterpret_cast<char*>(&formato), sizeof(formato));
+        arquivo.read(reinterpret_cast<char*>(&tamanho), sizeof(tamanho));
+        // O tamanho vem do próprio arquivo: um cache truncado ou corrompido não pode pedir
+        // mais memória do que os bytes que de fato estão lá. Nesse caso é só uma falta no cache
+        if (!arquivo || tamanho == 0 || tamanho != tamanhoArquivo - sizeof(formato) - sizeof(tamanho))
+            return false;
+        std::vector<char> binario(tamanho);
+        if (!arquivo || !arquivo.read(binario.data(), tamanho))
+            return false;
+
+        glProgramBinary(s.programa, formato, binario.data(), static_cast<GLsizei>(tamanho));
+        GLint sucesso = GL_FALSE;
+        glGetProgramiv(s.programa, GL_LINK_STATUS, &sucesso);
+        if (sucesso == GL_TRUE)
+            return true;
+
+        // Binário de outro driver ou versão: descarta o programa e compila do zero
+        glDeleteProgram(s.programa);
+        s.programa = glCreateProgram();
+        return false;
+    }
+
+    void salvarBinario(const Solicitacao& s) const {
+        GLint tamanho = 0;
+        glGetProgramiv(s.programa, GL_PROGRAM_BINARY_LENGTH, &tamanho);
+        if (tamanho <= 0)
+            return;
+        std::vector<char> binario(tamanho);
+        GLenum formato = 0;
+        glGetProgramBinary(s.programa, tamanho, nullptr, &formato, binario.data());
+
+        // Escreve em um arquivo temporário e renomeia, para nunca deixar um cache pela metade
+        std::string caminho = caminhoCache(s.hash);
+        std::string temporario = caminho + ".tmp";
+        {
+            std::ofstream arquivo(temporario, std::ios::binary);
+            uint32_t tamanhoArquivo = static_cast<uint32_t>(tamanho);
+            arquivo.write(reinterpret_cast<const char*>(&formato), sizeof(formato));
+            arquivo.write(reinterpret_cast<const char*>(&tamanhoArquivo), sizeof(tamanhoArquivo));
+            arquivo.write(binario.data(), tamanho);
+            if (!arquivo)
+                return;
+        }
+        std::error_code erro;
+        std::filesystem::rename(temporario, caminho, erro);
+    }
+
+    static void imprimirLogShader(GLuint shader, const char* tipo) {
+        GLint sucesso = GL_FALSE, tamanhoLog = 0;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &sucesso);
+        if (sucesso == GL_TRUE)
+            return;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &tamanhoLog);
+        std::vector<char> log(std::max(tamanhoLog, 1));
+        glGetShaderInfoLog(shader, tamanhoLog, nullptr, log.data());
+        fprintf(stderr, "Erro ao compilar o shader de %s:\n%s\n", tipo, log.data());
+    }
+
+    void finalizar(Solicitacao& s) {
+        s.finalizado = true;
+        if (s.doCache)
+            return;
+
+        GLint sucesso = GL_FALSE;
+        glGetProgramiv(s.programa, GL_LINK_STATUS, &sucesso); // Bloqueia até o link terminar
+        if (sucesso != GL_TRUE) {
+            imprimirLogShader(s.vertice, "vértice");
+            imprimirLogShader(s.fragmento, "fragmento");
+            GLint tamanhoLog = 0;
+            glGetProgramiv(s.programa, GL_INFO_LOG_LENGTH, &tamanhoLog);
+            std::vector<char> log(std::max(tamanhoLog, 1));
+            glGetProgramInfoLog(s.programa, tamanhoLog, nullptr, log.data());
+            fprintf(stderr, "Erro ao linkar o programa:\n%s\n", log.data());
+            glDeleteProgram(s.programa);
+            s.programa = 0;
+        } else if (binariosSuportados) {
+            salvarBinario(s);
+        }
+
+        glDeleteShader(s.vertice);
+        glDeleteShader(s.fragmento);
+        s.vertice = s.fragmento = 0;
+    }
+
+    std::string diretorio;
+    std::string identificacaoDriver;
+    std::vector<Solicitacao> solicitacoes;
+    bool inicializado = false;
+    bool binariosSuportados = false;
+    bool compilacaoParalela = false;
+    int acertos = 0;
+    int compilados = 0;
+};
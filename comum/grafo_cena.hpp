@@ -0,0 +1,232 @@
+// Grafo de cena em estrutura de arrays (SoA) com propagação de transformações em lote
+//
+// Cada nó guarda o índice do pai, a translação, rotação (quatérnio) e escala locais em
+// arrays separados, a matriz de mundo (16 floats, ordem de colunas) e um marcador de
+// "sujo". Os nós ficam em ordem topológica (pai[i] < i), de modo que uma única
+// passada linear propaga os marcadores para as subárvores e outra recalcula apenas
+// as matrizes dos nós alterados: as locais de 4 em 4 nós com simd::f4 e as de mundo
+// com a multiplicação 4x4 vetorizada.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "simd.hpp"
+
+namespace grafo {
+
+class GrafoCena {
+public:
+    // Adiciona um nó com transformação identidade; pai = -1 cria uma raiz.
+    // O pai precisa já existir, o que mantém a ordem topológica.
+    int adicionar(int pai) {
+        int indice = tamanho();
+        if (pai >= indice)
+            throw std::invalid_argument("O pai precisa ser adicionado antes do filho");
+        pais.push_back(pai);
+        tx.push_back(0.0f); ty.push_back(0.0f); tz.push_back(0.0f);
+        qx.push_back(0.0f); qy.push_back(0.0f); qz.push_back(0.0f); qw.push_back(1.0f);
+        ex.push_back(1.0f); ey.push_back(1.0f); ez.push_back(1.0f);
+        mundos.resize(mundos.size() + 16, 0.0f);
+        sujos.push_back(1);
+        return indice;
+    }
+
+    void definirTranslacao(int no, float x, float y, float z) {
+        tx[no] = x; ty[no] = y; tz[no] = z;
+        sujos[no] = 1;
+    }
+
+    // Rotação de "angulo" radianos em torno do eixo (x, y, z), que deve ser unitário
+    void definirRotacao(int no, float angulo, float x, float y, float z) {
+        float s = std::sin(0.5f * angulo);
+        qx[no] = x * s; qy[no] = y * s; qz[no] = z * s; qw[no] = std::cos(0.5f * angulo);
+        sujos[no] = 1;
+    }
+
+    // Rotação dada diretamente pelo quatérnio unitário (x, y, z, w), por exemplo já interpolado
+    void definirQuaternio(int no, float x, float y, float z, float w) {
+        qx[no] = x; qy[no] = y; qz[no] = z; qw[no] = w;
+        sujos[no] = 1;
+    }
+
+    void definirEscala(int no, float x, float y, float z) {
+        ex[no] = x; ey[no] = y; ez[no] = z;
+        sujos[no] = 1;
+    }
+
+    // Troca o pai de um nó. Se a ordem topológica for quebrada, é preciso chamar
+    // ordenarTopologicamente() antes do próximo atualizar().
+    void definirPai(int no, int novoPai) {
+        pais[no] = novoPai;
+        sujos[no] = 1;
+        if (novoPai > no)
+            ordenado = false;
+    }
+
+    // Reordena os nós por profundidade (estável) e devolve o novo índice de cada nó antigo
+    std::vector<int> ordenarTopologicamente() {
+        int n = tamanho();
+        std::vector<int> profundidade(n, -1);
+        std::vector<int> pilha;
+        int maiorProfundidade = 0;
+        for (int i = 0; i < n; ++i) {
+            int no = i;
+            while (no >= 0 && profundidade[no] < 0) {
+                pilha.push_back(no);
+                no = pais[no];
+                if (static_cast<int>(pilha.size()) > n)
+                    throw std::logic_error("Ciclo no grafo de cena");
+            }
+            int base = no >= 0 ? profundidade[no] : -1;
+            while (!pilha.empty()) {
+                profundidade[pilha.back()] = ++base;
+                pilha.pop_back();
+            }
+            maiorProfundidade = std::max(maiorProfundidade, profundidade[i]);
+        }
+
+        // Ordenação por contagem da profundidade
+        std::vector<int> inicio(maiorProfundidade + 2, 0);
+        for (int i = 0; i < n; ++i) inicio[profundidade[i] + 1]++;
+        for (int d = 1; d < static_cast<int>(inicio.size()); ++d) inicio[d] += inicio[d - 1];
+        std::vector<int> novoIndice(n), antigo(n);
+        for (int i = 0; i < n; ++i) {
+            novoIndice[i] = inicio[profundidade[i]]++;
+            antigo[novoIndice[i]] = i;
+        }
+
+        auto permutar = [&](auto& v, int componentes) {
+            auto copia = v;
+            for (int i = 0; i < n; ++i)
+                for (int c = 0; c < componentes; ++c)
+                    v[size_t(i) * componentes + c] = copia[size_t(antigo[i]) * componentes + c];
+        };
+        permutar(pais, 1);
+        for (int& p : pais) p = p >= 0 ? novoIndice[p] : -1;
+        permutar(tx, 1); permutar(ty, 1); permutar(tz, 1);
+        permutar(qx, 1); permutar(qy, 1); permutar(qz, 1); permutar(qw, 1);
+        permutar(ex, 1); permutar(ey, 1); permutar(ez, 1);
+        permutar(mundos, 16);
+        permutar(sujos, 1);
+        ordenado = true;
+        return novoIndice;
+    }
+
+    // Recalcula as matrizes de mundo dos nós sujos e de seus descendentes.
+    // Retorna quantos nós foram recalculados.
+    int atualizar() {
+        if (!ordenado)
+            throw std::logic_error("Grafo fora de ordem topológica: chame ordenarTopologicamente()");
+        int n = tamanho();
+
+        // 1ª passada: um filho fica sujo se o pai estiver sujo
+        int recalculados = 0;
+        for (int i = 0; i < n; ++i) {
+            int p = pais[i];
+            if (p >= 0)
+                sujos[i] |= sujos[p];
+            recalculados += sujos[i];
+        }
+        if (recalculados == 0)
+            return 0;
+
+        // 2ª passada: blocos de 4 nós; as matrizes locais são montadas juntas e
+        // depois combinadas com a matriz de mundo do pai, em ordem crescente
+        alignas(16) float local[4][16];
+        for (int bloco = 0; bloco < n; bloco += 4) {
+            int quantidade = std::min(4, n - bloco);
+            if (!(sujos[bloco] | (quantidade > 1 && sujos[bloco + 1]) |
+                  (quantidade > 2 && sujos[bloco + 2]) | (quantidade > 3 && sujos[bloco + 3])))
+                continue;
+
+            if (quantidade == 4)
+                calcularLocais4(bloco, local);
+            else
+                for (int k = 0; k < quantidade; ++k)
+                    calcularLocal(bloco + k, local[k]);
+
+            for (int k = 0; k < quantidade; ++k) {
+                int i = bloco + k;
+                if (!sujos[i])
+                    continue;
+                float* mundo = &mundos[size_t(i) * 16];
+                if (pais[i] >= 0)
+                    simd::multiplicarMatriz4(&mundos[size_t(pais[i]) * 16], local[k], mundo);
+                else
+                    std::copy(local[k], local[k] + 16, mundo);
+            }
+        }
+
+        // Os marcadores só podem ser limpos depois que todos os filhos foram processados
+        std::fill(sujos.begin(), sujos.end(), 0);
+        return recalculados;
+    }
+
+    int tamanho() const { return static_cast<int>(pais.size()); }
+    int pai(int no) const { return pais[no]; }
+    const float* mundo(int no) const { return &mundos[size_t(no) * 16]; }
+
+private:
+    // Matriz local T * R * S de um nó, em ordem de colunas
+    void calcularLocal(int i, float m[16]) const {
+        float x = qx[i], y = qy[i], z = qz[i], w = qw[i];
+        float r[9] = {
+            1 - 2 * (y * y + z * z), 2 * (x * y + z * w),     2 * (x * z - y * w),
+            2 * (x * y - z * w),     1 - 2 * (x * x + z * z), 2 * (y * z + x * w),
+            2 * (x * z + y * w),     2 * (y * z - x * w),     1 - 2 * (x * x + y * y)
+        };
+        float escala[3] = {ex[i], ey[i], ez[i]};
+        for (int c = 0; c < 3; ++c) {
+            for (int l = 0; l < 3; ++l)
+                m[c * 4 + l] = r[c * 3 + l] * escala[c];
+            m[c * 4 + 3] = 0.0f;
+        }
+        m[12] = tx[i]; m[13] = ty[i]; m[14] = tz[i]; m[15] = 1.0f;
+    }
+
+    // Mesma conta de calcularLocal para 4 nós consecutivos, um por pista do vetor
+    void calcularLocais4(int i, float m[4][16]) const {
+        using simd::f4;
+        f4 x = simd::carregar(&qx[i]), y = simd::carregar(&qy[i]);
+        f4 z = simd::carregar(&qz[i]), w = simd::carregar(&qw[i]);
+        f4 um = simd::difundir(1.0f), dois = simd::difundir(2.0f);
+        f4 xx = x * x, yy = y * y, zz = z * z;
+        f4 xy = x * y, xz = x * z, yz = y * z, xw = x * w, yw = y * w, zw = z * w;
+        f4 sx = simd::carregar(&ex[i]), sy = simd::carregar(&ey[i]), sz = simd::carregar(&ez[i]);
+
+        f4 colunas[12] = {
+            (um - dois * (yy + zz)) * sx, dois * (xy + zw) * sx,        dois * (xz - yw) * sx,
+            dois * (xy - zw) * sy,        (um - dois * (xx + zz)) * sy, dois * (yz + xw) * sy,
+            dois * (xz + yw) * sz,        dois * (yz - xw) * sz,        (um - dois * (xx + yy)) * sz,
+            simd::carregar(&tx[i]),       simd::carregar(&ty[i]),       simd::carregar(&tz[i])
+        };
+
+        // Transpõe de "um elemento por vetor" para "uma matriz por nó"
+        alignas(16) float pistas[12][4];
+        for (int e = 0; e < 12; ++e)
+            simd::armazenar(pistas[e], colunas[e]);
+        for (int k = 0; k < 4; ++k) {
+            float* mk = m[k];
+            for (int c = 0; c < 4; ++c) {
+                mk[c * 4 + 0] = pistas[c * 3 + 0][k];
+                mk[c * 4 + 1] = pistas[c * 3 + 1][k];
+                mk[c * 4 + 2] = pistas[c * 3 + 2][k];
+                mk[c * 4 + 3] = c == 3 ? 1.0f : 0.0f;
+            }
+        }
+    }
+
+    std::vector<int32_t> pais;
+    std::vector<float> tx, ty, tz;      // Translação local
+    std::vector<float> qx, qy, qz, qw;  // Rotação local (quatérnio unitário)
+    std::vector<float> ex, ey, ez;      // Escala local
+    std::vector<float> mundos;          // 16 floats por nó
+    std::vector<uint8_t> sujos;
+    bool ordenado = true;
+};
+
+} // namespace grafo
@@ -0,0 +1,135 @@
+// Imagem de 8 bits por canal e leitura/escrita nos formatos Netpbm (PGM e PPM)
+//
+// Pixels intercalados, linha a linha, com a linha 0 no topo (a ordem dos arquivos
+// Netpbm; o framebuffer do OpenGL começa por baixo). Lê P2/P3 (ASCII) e P5/P6
+// (binário) e sempre escreve em binário: P5 para 1 canal, P6 para 3.
+//
+//   imagem::Imagem quadro = imagem::ler("referencia.ppm");
+//   imagem::escrever("cinza.pgm", imagem::paraCinza(quadro));
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace imagem {
+
+struct Imagem {
+    int largura = 0, altura = 0, canais = 0;
+    std::vector<uint8_t> pixels;
+
+    Imagem() = default;
+    Imagem(int largura, int altura, int canais, uint8_t valor = 0)
+        : largura(largura), altura(altura), canais(canais), pixels(size_t(largura) * altura * canais, valor) {}
+
+    size_t bytesPorLinha() const { return size_t(largura) * canais; }
+    uint8_t* linha(int y) { return pixels.data() + y * bytesPorLinha(); }
+    const uint8_t* linha(int y) const { return pixels.data() + y * bytesPorLinha(); }
+    uint8_t* pixel(int x, int y) { return linha(y) + size_t(x) * canais; }
+    const uint8_t* pixel(int x, int y) const { return linha(y) + size_t(x) * canais; }
+    bool vazia() const { return pixels.empty(); }
+};
+
+namespace detalhe {
+
+// Próximo número do cabeçalho, pulando espaços e comentários (# até o fim da linha)
+inline int lerNumero(std::istream& entrada) {
+    int c;
+    while ((c = entrada.peek()) != EOF) {
+        if (c == '#') {
+            std::string comentario;
+            std::getline(entrada, comentario);
+        } else if (std::isspace(c)) {
+            entrada.get();
+        } else {
+            break;
+        }
+    }
+    int valor = -1;
+    if (!(entrada >> valor) || valor < 0)
+        throw std::runtime_error("Cabeçalho Netpbm inválido");
+    return valor;
+}
+
+} // namespace detalhe
+
+inline Imagem ler(const std::string& caminho) {
+    std::ifstream entrada(caminho, std::ios::binary);
+    if (!entrada)
+        throw std::runtime_error("Não foi possível abrir " + caminho);
+    char magico[2] = {};
+    entrada.read(magico, 2);
+    if (magico[0] != 'P' || (magico[1] != '2' && magico[1] != '3' && magico[1] != '5' && magico[1] != '6'))
+        throw std::runtime_error(caminho + " não é PGM nem PPM (P2, P3, P5 ou P6)");
+    bool binario = magico[1] == '5' || magico[1] == '6';
+    int canais = magico[1] == '3' || magico[1] == '6' ? 3 : 1;
+    int largura = detalhe::lerNumero(entrada);
+    int altura = detalhe::lerNumero(entrada);
+    int maximo = detalhe::lerNumero(entrada);
+    if (largura == 0 || altura == 0 || maximo == 0 || maximo > 255)
+        throw std::runtime_error(caminho + ": só imagens de 8 bits não vazias são suportadas");
+
+    Imagem img(largura, altura, canais);
+    if (binario) {
+        entrada.get(); // Um único espaço separa o cabeçalho dos dados
+        entrada.read(reinterpret_cast<char*>(img.pixels.data()), static_cast<std::streamsize>(img.pixels.size()));
+        if (entrada.gcount() != static_cast<std::streamsize>(img.pixels.size()))
+            throw std::runtime_error(caminho + ": dados truncados");
+    } else {
+        for (uint8_t& p : img.pixels) {
+            int valor;
+            if (!(entrada >> valor) || valor < 0 || valor > maximo)
+                throw std::runtime_error(caminho + ": dados truncados ou inválidos");
+            p = static_cast<uint8_t>(valor);
+        }
+    }
+    // Normaliza para 0..255 quando o arquivo usa outro valor máximo
+    if (maximo != 255)
+        for (uint8_t& p : img.pixels)
+            p = static_cast<uint8_t>((p * 255 + maximo / 2) / maximo);
+    return img;
+}
+
+inline void escrever(const std::string& caminho, const Imagem& img) {
+    if (img.canais != 1 && img.canais != 3)
+        throw std::invalid_argument("Netpbm só guarda imagens com 1 (PGM) ou 3 (PPM) canais");
+    std::ofstream saida(caminho, std::ios::binary);
+    if (!saida)
+        throw std::runtime_error("Não foi possível abrir " + caminho + " para escrita");
+    saida << (img.canais == 1 ? "P5" : "P6") << "\n" << img.largura << " " << img.altura << "\n255\n";
+    saida.write(reinterpret_cast<const char*>(img.pixels.data()), static_cast<std::streamsize>(img.pixels.size()));
+    if (!saida)
+        throw std::runtime_error("Falha ao escrever " + caminho);
+}
+
+// Luminância (pesos do BT.601 em ponto fixo de 8 bits); cópia se já for cinza
+inline Imagem paraCinza(const Imagem& img) {
+    if (img.canais == 1)
+        return img;
+    Imagem cinza(img.largura, img.altura, 1);
+    size_t n = size_t(img.largura) * img.altura;
+    for (size_t i = 0; i < n; ++i) {
+        const uint8_t* p = &img.pixels[i * img.canais];
+        cinza.pixels[i] = static_cast<uint8_t>((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+    }
+    return cinza;
+}
+
+// Inverte a ordem das linhas (framebuffer do OpenGL <-> Netpbm)
+inline void inverterVertical(Imagem& img) {
+    std::vector<uint8_t> temporaria(img.bytesPorLinha());
+    for (int y = 0; y < img.altura / 2; ++y) {
+        uint8_t* a = img.linha(y);
+        uint8_t* b = img.linha(img.altura - 1 - y);
+        std::copy(a, a + temporaria.size(), temporaria.data());
+        std::copy(b, b + temporaria.size(), a);
+        std::copy(temporaria.begin(), temporaria.end(), b);
+    }
+}
+
+} // namespace imagem
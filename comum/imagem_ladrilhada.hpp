@@ -0,0 +1,473 @@
+// Imagem maior que a memória, lida e gravada em ladrilhos de um arquivo PGM/PPM binário
+//
+// O arquivo (P5 ou P6) fica no disco e é acessado por ladrilhos de lado fixo. Cada
+// ladrilho é lido com uma borda (halo) de pixels dos vizinhos, para filtros de vizinhança
+// não precisarem de mais nada; fora da imagem a borda repete o último pixel. Filtrando
+// Ladrilho::recorteDentroDaImagem() com borda maior ou igual ao raio do filtro, o
+// resultado ladrilho a ladrilho é igual ao da imagem inteira (veja
+// cores_imagens/filtro_ladrilhado.cpp).
+//
+// Os ladrilhos ficam em uma cache LRU limitada por um orçamento de memória. obter()
+// devolve um shared_ptr: enquanto ele existir o ladrilho não sai da cache (o orçamento
+// pode ser ultrapassado se houver mais ladrilhos em uso do que cabem nele). Ladrilhos
+// alterados são gravados no arquivo ao saírem da cache e em sincronizar().
+// Uma thread de precarga lê com antecedência os ladrilhos pedidos em precarregar();
+// paraCadaLadrilho() percorre a imagem em ordem de leitura, em paralelo com
+// tarefas::padrao(), precarregando os ladrilhos seguintes ao que cada trabalhador pegou.
+//
+// A borda é só para leitura: ao gravar, só o interior vai para o arquivo, e as bordas
+// já em cache dos vizinhos não são atualizadas. Filtros devem ler de uma imagem e
+// escrever em outra:
+//
+//   ladrilhos::ImagemLadrilhada entrada("grande.ppm", 256, 3, 512 << 20);
+//   ladrilhos::ImagemLadrilhada saida = ladrilhos::ImagemLadrilhada::criar("filtrada.ppm", entrada.largura(), entrada.altura(), 3);
+//   ladrilhos::paraCadaLadrilho(entrada, saida, [](const ladrilhos::Ladrilho& de, ladrilhos::Ladrilho& para) { ... });
+//   saida.sincronizar();
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "imagem.hpp"
+#include "tarefas.hpp"
+
+namespace ladrilhos {
+
+//--------------------------------------------------------------------------------
+// Arquivo PGM/PPM binário com acesso aleatório a trechos de linha
+class ArquivoNetpbm {
+public:
+    // Abre um arquivo existente (P5 ou P6, 8 bits)
+    explicit ArquivoNetpbm(const std::string& caminho) : caminho(caminho) {
+        arquivo.open(caminho, std::ios::binary | std::ios::in | std::ios::out);
+        if (!arquivo)
+            throw std::runtime_error("Não foi possível abrir " + caminho);
+        char magico[2] = {};
+        arquivo.read(magico, 2);
+        if (magico[0] != 'P' || (magico[1] != '5' && magico[1] != '6'))
+            throw std::runtime_error(caminho + ": só PGM/PPM binários (P5/P6) têm acesso aleatório");
+        canaisArquivo = magico[1] == '6' ? 3 : 1;
+        larguraArquivo = imagem::detalhe::lerNumero(arquivo);
+        alturaArquivo = imagem::detalhe::lerNumero(arquivo);
+        if (imagem::detalhe::lerNumero(arquivo) != 255)
+            throw std::runtime_error(caminho + ": só imagens com valor máximo 255 são suportadas");
+        arquivo.get();
+        inicioDados = static_cast<uint64_t>(arquivo.tellg());
+    }
+
+    // Cria o arquivo com o tamanho final (esparso na maioria dos sistemas de arquivos)
+    static void criar(const std::string& caminho, int largura, int altura, int canais) {
+        if (largura <= 0 || altura <= 0 || (canais != 1 && canais != 3))
+            throw std::invalid_argument("Imagem ladrilhada precisa de tamanho positivo e 1 ou 3 canais");
+        std::ofstream saida(caminho, std::ios::binary | std::ios::trunc);
+        if (!saida)
+            throw std::runtime_error("Não foi possível criar " + caminho);
+        saida << (canais == 1 ? "P5" : "P6") << "\n" << largura << " " << altura << "\n255\n";
+        uint64_t tamanho = uint64_t(largura) * altura * canais;
+        saida.seekp(static_cast<std::streamoff>(tamanho - 1), std::ios::cur);
+        saida.put(0);
+        if (!saida)
+            throw std::runtime_error("Falha ao reservar " + std::to_string(tamanho) + " bytes em " + caminho);
+    }
+
+    int largura() const { return larguraArquivo; }
+    int altura() const { return alturaArquivo; }
+    int canais() const { return canaisArquivo; }
+
+    // n pixels da linha y a partir da coluna x
+    void ler(int x, int y, int n, uint8_t* destino) {
+        std::lock_guard<std::mutex> trava(mutex);
+        arquivo.seekg(static_cast<std::streamoff>(deslocamento(x, y)));
+        arquivo.read(reinterpret_cast<char*>(destino), static_cast<std::streamsize>(n) * canaisArquivo);
+        if (!arquivo)
+            throw std::runtime_error(caminho + ": falha na leitura");
+    }
+
+    void gravar(int x, int y, int n, const uint8_t* origem) {
+        std::lock_guard<std::mutex> trava(mutex);
+        arquivo.seekp(static_cast<std::streamoff>(deslocamento(x, y)));
+        arquivo.write(reinterpret_cast<const char*>(origem), static_cast<std::streamsize>(n) * canaisArquivo);
+        if (!arquivo)
+            throw std::runtime_error(caminho + ": falha na gravação");
+    }
+
+    void descarregar() {
+        std::lock_guard<std::mutex> trava(mutex);
+        arquivo.flush();
+    }
+
+private:
+    uint64_t deslocamento(int x, int y) const { return inicioDados + (uint64_t(y) * larguraArquivo + x) * canaisArquivo; }
+
+    std::string caminho;
+    std::fstream arquivo;
+    std::mutex mutex; // Posição de leitura/gravação compartilhada
+    int larguraArquivo = 0, alturaArquivo = 0, canaisArquivo = 0;
+    uint64_t inicioDados = 0;
+};
+
+//--------------------------------------------------------------------------------
+// Ladrilho: interior [x0, x0 + largura) x [y0, y0 + altura) da imagem, mais a borda
+struct Ladrilho {
+    int tx = 0, ty = 0;           // Índice do ladrilho
+    int x0 = 0, y0 = 0;           // Canto superior esquerdo do interior na imagem
+    int largura = 0, altura = 0;  // Interior (menor na última coluna e linha de ladrilhos)
+    int halo = 0, canais = 0;
+    // Quantos pixels da borda de cada lado estão dentro da imagem (o resto repete a beirada)
+    int haloEsquerda = 0, haloTopo = 0, haloDireita = 0, haloBaixo = 0;
+    std::vector<uint8_t> pixels;  // (largura + 2 * halo) x (altura + 2 * halo), linha a linha
+
+    size_t bytesPorLinha() const { return size_t(largura + 2 * halo) * canais; }
+    // Coordenadas relativas ao interior: de -halo até largura + halo - 1
+    uint8_t* pixel(int x, int y) { return pixels.data() + size_t(y + halo) * bytesPorLinha() + size_t(x + halo) * canais; }
+    const uint8_t* pixel(int x, int y) const { return pixels.data() + size_t(y + halo) * bytesPorLinha() + size_t(x + halo) * canais; }
+
+    // Cópia do ladrilho com a borda, para usar os filtros de imagem inteira
+    imagem::Imagem comoImagem() const {
+        imagem::Imagem img(largura + 2 * halo, altura + 2 * halo, canais);
+        std::copy(pixels.begin(), pixels.end(), img.pixels.begin());
+        return img;
+    }
+
+    // Cópia só da parte que existe na imagem, com o interior em (haloEsquerda, haloTopo):
+    // para filtros que tratam a beirada da imagem de outro jeito (a caixa corta a janela)
+    imagem::Imagem recorteDentroDaImagem() const {
+        imagem::Imagem img(largura + haloEsquerda + haloDireita, altura + haloTopo + haloBaixo, canais);
+        for (int j = 0; j < img.altura; ++j)
+            std::copy_n(pixel(-haloEsquerda, j - haloTopo), img.bytesPorLinha(), img.linha(j));
+        return img;
+    }
+
+    // Copia para o interior o retângulo de "origem" que começa em (x, y) (por exemplo,
+    // o resultado de um filtro sobre comoImagem() de outro ladrilho, com x = y = halo dele)
+    void copiarInterior(const imagem::Imagem& origem, int x, int y) {
+        for (int j = 0; j < altura; ++j)
+            std::copy_n(origem.pixel(x, y + j), size_t(largura) * canais, pixel(0, j));
+        marcarAlterado();
+    }
+
+    // Faz o ladrilho ser gravado no arquivo ao sair da cache. A liberação publica os pixels
+    // escritos antes para a thread que vê a marca em gravarSeAlterado() e os grava
+    void marcarAlterado() { alterado.store(true, std::memory_order_release); }
+
+    std::atomic<bool> alterado{false};
+};
+
+enum Acesso {
+    LEITURA,        // Lê do arquivo
+    SOBRESCREVER    // Não lê: o interior será todo escrito (ladrilhos de saída)
+};
+
+struct Estatisticas {
+    uint64_t acertos = 0;           // Pedidos atendidos pela cache
+    uint64_t faltas = 0;            // Pedidos que precisaram ler (ou criar) o ladrilho
+    uint64_t leituras = 0;          // Ladrilhos lidos do arquivo
+    uint64_t gravacoes = 0;         // Ladrilhos alterados gravados no arquivo
+    uint64_t descartes = 0;         // Ladrilhos tirados da cache pelo orçamento
+    uint64_t precargas = 0;         // Ladrilhos lidos pela thread de precarga
+    size_t bytesEmCache = 0;
+    size_t maximoBytesEmCache = 0;
+};
+
+//--------------------------------------------------------------------------------
+class ImagemLadrilhada {
+public:
+    // lado: pixels do interior de cada ladrilho; halo: pixels de borda lidos dos vizinhos;
+    // orcamento: bytes de ladrilhos mantidos em cache
+    ImagemLadrilhada(const std::string& caminho, int lado = 256, int halo = 0, size_t orcamento = size_t(256) << 20)
+        : arquivo(new ArquivoNetpbm(caminho)), lado(lado), halo(halo), orcamento(orcamento) {
+        if (lado <= 0 || halo < 0)
+            throw std::invalid_argument("O lado do ladrilho precisa ser positivo e a borda não negativa");
+        colunas = (arquivo->largura() + lado - 1) / lado;
+        linhas = (arquivo->altura() + lado - 1) / lado;
+        precarga = std::thread([this] { lacoPrecarga(); });
+    }
+
+    // Cria o arquivo e abre a imagem (para saídas, tipicamente sem borda)
+    static ImagemLadrilhada criar(const std::string& caminho, int largura, int altura, int canais, int lado = 256,
+                                  int halo = 0, size_t orcamento = size_t(256) << 20) {
+        ArquivoNetpbm::criar(caminho, largura, altura, canais);
+        return ImagemLadrilhada(caminho, lado, halo, orcamento);
+    }
+
+    ImagemLadrilhada(const ImagemLadrilhada&) = delete;
+    ImagemLadrilhada& operator=(const ImagemLadrilhada&) = delete;
+
+    // Grava os ladrilhos alterados; a thread de precarga termina antes
+    ~ImagemLadrilhada() {
+        {
+            std::lock_guard<std::mutex> trava(mutexPrecarga);
+            encerrar = true;
+        }
+        acordarPrecarga.notify_all();
+        if (precarga.joinable())
+            precarga.join();
+        try {
+            sincronizar();
+        } catch (const std::exception& e) {
+            fprintf(stderr, "%s\n", e.what()); // Destrutor não lança: o erro é só informado
+        }
+    }
+
+    int largura() const { return arquivo->largura(); }
+    int altura() const { return arquivo->altura(); }
+    int canais() const { return arquivo->canais(); }
+    int ladoLadrilho() const { return lado; }
+    int bordaLadrilho() const { return halo; }
+    int colunasLadrilhos() const { return colunas; }
+    int linhasLadrilhos() const { return linhas; }
+    int numeroLadrilhos() const { return colunas * linhas; }
+
+    // Ladrilho (tx, ty), lido do arquivo se não estiver em cache. Segura em qualquer thread.
+    std::shared_ptr<Ladrilho> obter(int tx, int ty, Acesso acesso = LEITURA) {
+        if (tx < 0 || ty < 0 || tx >= colunas || ty >= linhas)
+            throw std::out_of_range("Ladrilho fora da imagem");
+        std::shared_ptr<Entrada> entrada;
+        {
+            std::lock_guard<std::mutex> trava(mutexCache);
+            auto it = cache.find(chave(tx, ty));
+            if (it != cache.end()) {
+                entrada = it->second;
+                usos.splice(usos.begin(), usos, entrada->posicao); // Mais recente na frente
+                estatisticas.acertos++;
+            } else {
+                entrada = std::make_shared<Entrada>();
+                usos.push_front(chave(tx, ty));
+                entrada->posicao = usos.begin();
+                cache.emplace(chave(tx, ty), entrada);
+                estatisticas.faltas++;
+                estatisticas.bytesEmCache += bytesLadrilho(tx, ty);
+                estatisticas.maximoBytesEmCache = std::max(estatisticas.maximoBytesEmCache, estatisticas.bytesEmCache);
+            }
+        }
+        {
+            // Quem chegar primeiro carrega; os demais esperam aqui
+            std::lock_guard<std::mutex> trava(entrada->mutex);
+            if (!entrada->pronto) {
+                preparar(entrada->ladrilho, tx, ty, acesso);
+                entrada->pronto = true;
+            }
+        }
+        respeitarOrcamento();
+        return std::shared_ptr<Ladrilho>(entrada, &entrada->ladrilho);
+    }
+
+    // Pede a leitura antecipada do ladrilho pela thread de precarga
+    void precarregar(int tx, int ty) {
+        if (tx < 0 || ty < 0 || tx >= colunas || ty >= linhas)
+            return;
+        {
+            std::lock_guard<std::mutex> trava(mutexPrecarga);
+            pendentes.push_back(chave(tx, ty));
+            if (pendentes.size() > MAXIMO_PENDENTES) // Pedidos antigos perdem a vez: já devem ter sido usados
+                pendentes.pop_front();
+        }
+        acordarPrecarga.notify_one();
+    }
+
+    // Grava no arquivo todos os ladrilhos alterados ainda em cache
+    void sincronizar() {
+        std::vector<std::shared_ptr<Entrada>> entradas;
+        {
+            std::lock_guard<std::mutex> trava(mutexCache);
+            for (auto& par : cache)
+                entradas.push_back(par.second);
+        }
+        for (const std::shared_ptr<Entrada>& e : entradas) {
+            std::lock_guard<std::mutex> trava(e->mutex);
+            gravarSeAlterado(e->ladrilho);
+        }
+        arquivo->descarregar();
+    }
+
+    Estatisticas estatisticasAtuais() {
+        std::lock_guard<std::mutex> trava(mutexCache);
+        return estatisticas;
+    }
+
+    void imprimirEstatisticas(const char* nome, FILE* saida = stdout) {
+        Estatisticas e = estatisticasAtuais();
+        fprintf(saida, "%s: %llu acertos, %llu faltas, %llu lidos (%llu pela precarga), %llu gravados, %llu descartados, "
+                       "pico de %.1f MB em cache (orçamento %.1f MB)\n",
+                nome, (unsigned long long)e.acertos, (unsigned long long)e.faltas, (unsigned long long)e.leituras,
+                (unsigned long long)e.precargas, (unsigned long long)e.gravacoes, (unsigned long long)e.descartes,
+                e.maximoBytesEmCache / 1048576.0, orcamento / 1048576.0);
+    }
+
+private:
+    static constexpr size_t MAXIMO_PENDENTES = 64;
+
+    struct Entrada {
+        std::mutex mutex;              // Protege o carregamento e a gravação do ladrilho
+        bool pronto = false;
+        Ladrilho ladrilho;
+        std::list<uint64_t>::iterator posicao; // Na lista de usos (protegida por mutexCache)
+    };
+
+    static uint64_t chave(int tx, int ty) { return (uint64_t(uint32_t(ty)) << 32) | uint32_t(tx); }
+
+    size_t bytesLadrilho(int tx, int ty) const {
+        int l = std::min(lado, largura() - tx * lado), a = std::min(lado, altura() - ty * lado);
+        return size_t(l + 2 * halo) * (a + 2 * halo) * canais();
+    }
+
+    // Lê o interior e a borda (repetindo os pixels da beirada fora da imagem)
+    void preparar(Ladrilho& l, int tx, int ty, Acesso acesso) {
+        l.tx = tx;
+        l.ty = ty;
+        l.x0 = tx * lado;
+        l.y0 = ty * lado;
+        l.largura = std::min(lado, largura() - l.x0);
+        l.altura = std::min(lado, altura() - l.y0);
+        l.halo = halo;
+        l.canais = canais();
+        const int xa = std::max(0, l.x0 - halo), xb = std::min(largura(), l.x0 + l.largura + halo); // Colunas no arquivo
+        l.haloEsquerda = l.x0 - xa;
+        l.haloDireita = xb - l.x0 - l.largura;
+        l.haloTopo = std::min(halo, l.y0);
+        l.haloBaixo = std::min(halo, altura() - l.y0 - l.altura);
+        l.pixels.assign(l.bytesPorLinha() * (l.altura + 2 * halo), 0);
+        if (acesso == SOBRESCREVER)
+            return;
+        const int c = canais();
+        for (int j = -halo; j < l.altura + halo; ++j) {
+            int y = std::min(std::max(l.y0 + j, 0), altura() - 1);
+            uint8_t* linha = l.pixel(xa - l.x0, j);
+            arquivo->ler(xa, y, xb - xa, linha);
+            for (int i = -halo; i < xa - l.x0; ++i) // Borda esquerda fora da imagem
+                std::copy_n(linha, c, l.pixel(i, j));
+            for (int i = xb - l.x0; i < l.largura + halo; ++i) // Borda direita fora da imagem
+                std::copy_n(l.pixel(xb - l.x0 - 1, j), c, l.pixel(i, j));
+        }
+        std::lock_guard<std::mutex> trava(mutexCache);
+        estatisticas.leituras++;
+    }
+
+    // Chamada com o mutex da entrada travado
+    void gravarSeAlterado(Ladrilho& l) {
+        if (!l.alterado.exchange(false, std::memory_order_acq_rel))
+            return;
+        for (int j = 0; j < l.altura; ++j)
+            arquivo->gravar(l.x0, l.y0 + j, l.largura, l.pixel(0, j));
+        std::lock_guard<std::mutex> trava(mutexCache);
+        estatisticas.gravacoes++;
+    }
+
+    // Tira da cache os ladrilhos menos usados e livres (sem shared_ptr fora da cache)
+    // até caber no orçamento
+    void respeitarOrcamento() {
+        for (;;) {
+            std::shared_ptr<Entrada> vitima;
+            uint64_t chaveVitima = 0;
+            {
+                std::lock_guard<std::mutex> trava(mutexCache);
+                if (estatisticas.bytesEmCache <= orcamento)
+                    return;
+                for (auto it = usos.rbegin(); it != usos.rend(); ++it) {
+                    auto entrada = cache.find(*it);
+                    if (entrada->second.use_count() == 1) { // Só a cache o referencia
+                        vitima = entrada->second;
+                        chaveVitima = *it;
+                        break;
+                    }
+                }
+                if (!vitima)
+                    return; // Tudo em uso: o orçamento fica ultrapassado até os ladrilhos serem soltos
+            }
+            {
+                // Grava fora da trava da cache; quem pedir o ladrilho agora espera no mutex dele
+                std::lock_guard<std::mutex> trava(vitima->mutex);
+                gravarSeAlterado(vitima->ladrilho);
+            }
+            std::lock_guard<std::mutex> trava(mutexCache);
+            auto it = cache.find(chaveVitima);
+            // Só remove se ninguém o pegou durante a gravação (além desta função e da cache)
+            if (it != cache.end() && it->second == vitima && vitima.use_count() == 2 && !vitima->ladrilho.alterado.load(std::memory_order_acquire)) {
+                usos.erase(vitima->posicao);
+                cache.erase(it);
+                estatisticas.bytesEmCache -= bytesLadrilho(vitima->ladrilho.tx, vitima->ladrilho.ty);
+                estatisticas.descartes++;
+            }
+        }
+    }
+
+    void lacoPrecarga() {
+        for (;;) {
+            uint64_t c;
+            {
+                std::unique_lock<std::mutex> trava(mutexPrecarga);
+                acordarPrecarga.wait(trava, [this] { return encerrar || !pendentes.empty(); });
+                if (encerrar)
+                    return;
+                c = pendentes.front();
+                pendentes.pop_front();
+            }
+            {
+                std::lock_guard<std::mutex> trava(mutexCache);
+                if (cache.count(c))
+                    continue; // Já está em cache (ou sendo lido por quem o pediu)
+                estatisticas.precargas++;
+            }
+            try {
+                obter(static_cast<int>(c & 0xFFFFFFFFu), static_cast<int>(c >> 32));
+            } catch (const std::exception& e) {
+                fprintf(stderr, "Precarga: %s\n", e.what()); // O pedido de verdade vai lançar de novo
+            }
+        }
+    }
+
+    std::unique_ptr<ArquivoNetpbm> arquivo;
+    int lado, halo;
+    size_t orcamento;
+    int colunas = 0, linhas = 0;
+
+    std::mutex mutexCache;
+    std::unordered_map<uint64_t, std::shared_ptr<Entrada>> cache;
+    std::list<uint64_t> usos; // Chaves em ordem de uso, a mais recente na frente
+    Estatisticas estatisticas;
+
+    std::thread precarga;
+    std::mutex mutexPrecarga;
+    std::condition_variable acordarPrecarga;
+    std::deque<uint64_t> pendentes;
+    bool encerrar = false;
+};
+
+// Chama funcao(ladrilho de entrada, ladrilho de saída) para cada ladrilho, em paralelo.
+// As duas imagens precisam ter o mesmo tamanho e o mesmo lado de ladrilho. Os ladrilhos
+// são distribuídos um a um, aproximadamente em ordem de leitura; cada um pede a precarga
+// dos "antecedencia" seguintes da imagem (não só da faixa recebida, que com trabalhadores
+// é de um ladrilho), que logo serão pegos por algum trabalhador.
+template <typename Funcao>
+void paraCadaLadrilho(ImagemLadrilhada& entrada, ImagemLadrilhada& saida, Funcao&& funcao, int antecedencia = 2) {
+    if (entrada.largura() != saida.largura() || entrada.altura() != saida.altura() || entrada.ladoLadrilho() != saida.ladoLadrilho())
+        throw std::invalid_argument("As imagens ladrilhadas precisam ter o mesmo tamanho e o mesmo lado de ladrilho");
+    const int colunas = entrada.colunasLadrilhos();
+    const size_t n = size_t(entrada.numeroLadrilhos());
+    tarefas::padrao().paraleloPara(0, n, 1, [&](size_t i0, size_t i1) {
+        for (size_t i = i0; i < i1; ++i) {
+            for (int k = 1; k <= antecedencia && i + k < n; ++k)
+                entrada.precarregar(static_cast<int>((i + k) % colunas), static_cast<int>((i + k) / colunas));
+            int tx = static_cast<int>(i % colunas), ty = static_cast<int>(i / colunas);
+            std::shared_ptr<Ladrilho> de = entrada.obter(tx, ty);
+            std::shared_ptr<Ladrilho> para = saida.obter(tx, ty, SOBRESCREVER);
+            funcao(static_cast<const Ladrilho&>(*de), *para);
+            para->marcarAlterado();
+        }
+    });
+}
+
+} // namespace ladrilhos
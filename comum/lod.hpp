@@ -0,0 +1,375 @@
+// Níveis de detalhe (LOD) por simplificação com métricas de erro quádricas
+//
+// simplificar() colapsa arestas em ordem de custo (Garland e Heckbert, 1997): cada
+// vértice acumula a quádrica dos planos das faces vizinhas e o custo de colapsar uma
+// aresta é a soma dos quadrados das distâncias da nova posição a esses planos. Arestas
+// de borda recebem planos perpendiculares com peso alto, para a silhueta aberta não
+// encolher, e colapsos que invertem faces ou criam regiões não-variedade são recusados.
+//
+// gerarCadeia() monta a sequência de níveis, cada um com cerca de metade dos
+// triângulos do anterior, e guarda para cada nível um limite do erro geométrico (em
+// unidades do modelo). selecionar() escolhe o nível mais simples cujo erro projetado
+// na tela fica abaixo de um limiar em pixels.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "malha_obj.hpp"
+
+namespace lod {
+
+// Matriz 4x4 simétrica guardada pelos 10 coeficientes distintos
+struct Quadrica {
+    double a[10] = {};
+
+    static Quadrica plano(double x, double y, double z, double d, double peso = 1.0) {
+        Quadrica q;
+        double p[4] = {x, y, z, d};
+        int k = 0;
+        for (int i = 0; i < 4; ++i)
+            for (int j = i; j < 4; ++j)
+                q.a[k++] = peso * p[i] * p[j];
+        return q;
+    }
+
+    Quadrica& operator+=(const Quadrica& o) {
+        for (int i = 0; i < 10; ++i)
+            a[i] += o.a[i];
+        return *this;
+    }
+
+    // v^T Q v com v = (x, y, z, 1)
+    double avaliar(const double v[3]) const {
+        double x = v[0], y = v[1], z = v[2];
+        return a[0] * x * x + 2 * a[1] * x * y + 2 * a[2] * x * z + 2 * a[3] * x +
+               a[4] * y * y + 2 * a[5] * y * z + 2 * a[6] * y +
+               a[7] * z * z + 2 * a[8] * z + a[9];
+    }
+
+    // Ponto de custo mínimo (gradiente nulo); falso se o sistema for mal condicionado
+    bool minimo(double v[3]) const {
+        double m[3][3] = {{a[0], a[1], a[2]}, {a[1], a[4], a[5]}, {a[2], a[5], a[7]}};
+        double b[3] = {-a[3], -a[6], -a[8]};
+        double det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+                     m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+                     m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+        double escala = std::fabs(m[0][0]) + std::fabs(m[1][1]) + std::fabs(m[2][2]);
+        if (std::fabs(det) <= 1e-9 * escala * escala * escala)
+            return false;
+        for (int c = 0; c < 3; ++c) { // Regra de Cramer
+            double mc[3][3];
+            for (int i = 0; i < 3; ++i)
+                for (int j = 0; j < 3; ++j)
+                    mc[i][j] = j == c ? b[i] : m[i][j];
+            v[c] = (mc[0][0] * (mc[1][1] * mc[2][2] - mc[1][2] * mc[2][1]) -
+                    mc[0][1] * (mc[1][0] * mc[2][2] - mc[1][2] * mc[2][0]) +
+                    mc[0][2] * (mc[1][0] * mc[2][1] - mc[1][1] * mc[2][0])) / det;
+        }
+        return true;
+    }
+};
+
+namespace detalhe {
+
+inline void normalFace(const double* p0, const double* p1, const double* p2, double n[3]) {
+    double e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+    double e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+struct Candidato {
+    double custo;
+    uint32_t a, b;
+    uint32_t versaoA, versaoB; // Descartado se algum dos vértices mudou desde a inserção
+    double posicao[3];
+    bool operator>(const Candidato& o) const { return custo > o.custo; }
+};
+
+} // namespace detalhe
+
+// Reduz a malha até "trianguloAlvo" triângulos (ou até não haver colapso válido).
+// As posições iguais são soldadas antes; as normais da saída são recalculadas.
+// Se "erro" não for nulo, recebe a raiz do maior custo aceito, um limite aproximado
+// da distância entre a superfície simplificada e a original.
+inline malha::Malha simplificar(const malha::Malha& entrada, size_t trianguloAlvo, double* erro = nullptr) {
+    using detalhe::Candidato;
+
+    // Solda vértices com a mesma posição (costuras de normais ou de textura)
+    std::vector<double> pos;
+    std::vector<uint32_t> soldado(entrada.numeroVertices());
+    {
+        struct HashPosicao {
+            size_t operator()(const std::array<float, 3>& p) const {
+                uint32_t b[3];
+                std::memcpy(b, p.data(), sizeof(b));
+                return (size_t(b[0]) * 73856093u) ^ (size_t(b[1]) * 19349663u) ^ (size_t(b[2]) * 83492791u);
+            }
+        };
+        std::unordered_map<std::array<float, 3>, uint32_t, HashPosicao> unicos;
+        for (size_t v = 0; v < entrada.numeroVertices(); ++v) {
+            std::array<float, 3> p = {entrada.posicoes[3 * v], entrada.posicoes[3 * v + 1], entrada.posicoes[3 * v + 2]};
+            auto [it, novo] = unicos.emplace(p, static_cast<uint32_t>(pos.size() / 3));
+            if (novo)
+                pos.insert(pos.end(), {p[0], p[1], p[2]});
+            soldado[v] = it->second;
+        }
+    }
+    size_t numeroVertices = pos.size() / 3;
+
+    std::vector<std::array<uint32_t, 3>> tris;
+    for (size_t t = 0; t < entrada.indices.size(); t += 3) {
+        std::array<uint32_t, 3> tri = {soldado[entrada.indices[t]], soldado[entrada.indices[t + 1]], soldado[entrada.indices[t + 2]]};
+        if (tri[0] != tri[1] && tri[1] != tri[2] && tri[0] != tri[2])
+            tris.push_back(tri);
+    }
+    std::vector<uint8_t> removido(tris.size(), 0);
+    std::vector<std::vector<uint32_t>> vizinhas(numeroVertices); // Triângulos de cada vértice
+    for (uint32_t t = 0; t < tris.size(); ++t)
+        for (uint32_t v : tris[t])
+            vizinhas[v].push_back(t);
+
+    // Quádricas das faces (sem ponderar pela área, para o custo ser uma distância ao quadrado).
+    // "medidas" tem os planos de borda com peso 1 e serve só para estimar o erro; "quadricas",
+    // com as bordas penalizadas, decide a ordem dos colapsos.
+    std::vector<Quadrica> quadricas(numeroVertices);
+    std::unordered_map<uint64_t, int> usoAresta;
+    auto chaveAresta = [](uint32_t a, uint32_t b) { return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a; };
+    for (const auto& tri : tris) {
+        double n[3];
+        detalhe::normalFace(&pos[3 * tri[0]], &pos[3 * tri[1]], &pos[3 * tri[2]], n);
+        double comprimento = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (comprimento == 0.0)
+            continue;
+        for (double& c : n) c /= comprimento;
+        double d = -(n[0] * pos[3 * tri[0]] + n[1] * pos[3 * tri[0] + 1] + n[2] * pos[3 * tri[0] + 2]);
+        Quadrica q = Quadrica::plano(n[0], n[1], n[2], d);
+        for (uint32_t v : tri)
+            quadricas[v] += q;
+        for (int k = 0; k < 3; ++k)
+            usoAresta[chaveAresta(tri[k], tri[(k + 1) % 3])]++;
+    }
+
+    std::vector<Quadrica> medidas = quadricas;
+
+    // Bordas: plano que contém a aresta e é perpendicular à face
+    const double PESO_BORDA = 100.0;
+    for (const auto& tri : tris) {
+        double n[3];
+        detalhe::normalFace(&pos[3 * tri[0]], &pos[3 * tri[1]], &pos[3 * tri[2]], n);
+        for (int k = 0; k < 3; ++k) {
+            uint32_t a = tri[k], b = tri[(k + 1) % 3];
+            if (usoAresta[chaveAresta(a, b)] != 1)
+                continue;
+            double e[3] = {pos[3 * b] - pos[3 * a], pos[3 * b + 1] - pos[3 * a + 1], pos[3 * b + 2] - pos[3 * a + 2]};
+            double p[3] = {e[1] * n[2] - e[2] * n[1], e[2] * n[0] - e[0] * n[2], e[0] * n[1] - e[1] * n[0]};
+            double comprimento = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+            if (comprimento == 0.0)
+                continue;
+            for (double& c : p) c /= comprimento;
+            double d = -(p[0] * pos[3 * a] + p[1] * pos[3 * a + 1] + p[2] * pos[3 * a + 2]);
+            Quadrica q = Quadrica::plano(p[0], p[1], p[2], d, PESO_BORDA);
+            quadricas[a] += q;
+            quadricas[b] += q;
+            Quadrica medida = Quadrica::plano(p[0], p[1], p[2], d);
+            medidas[a] += medida;
+            medidas[b] += medida;
+        }
+    }
+
+    std::vector<uint32_t> versao(numeroVertices, 0);
+    std::vector<uint8_t> morto(numeroVertices, 0);
+    std::priority_queue<Candidato, std::vector<Candidato>, std::greater<Candidato>> fila;
+
+    auto avaliarAresta = [&](uint32_t a, uint32_t b) {
+        Quadrica q = quadricas[a];
+        q += quadricas[b];
+        Candidato c;
+        c.a = a; c.b = b; c.versaoA = versao[a]; c.versaoB = versao[b];
+        if (!q.minimo(c.posicao)) { // Sem solução única: o melhor entre os extremos e o ponto médio
+            const double* pa = &pos[3 * a];
+            const double* pb = &pos[3 * b];
+            double opcoes[3][3] = {{pa[0], pa[1], pa[2]}, {pb[0], pb[1], pb[2]},
+                                   {0.5 * (pa[0] + pb[0]), 0.5 * (pa[1] + pb[1]), 0.5 * (pa[2] + pb[2])}};
+            int melhor = 0;
+            for (int i = 1; i < 3; ++i)
+                if (q.avaliar(opcoes[i]) < q.avaliar(opcoes[melhor]))
+                    melhor = i;
+            std::copy(opcoes[melhor], opcoes[melhor] + 3, c.posicao);
+        }
+        c.custo = std::max(0.0, q.avaliar(c.posicao));
+        fila.push(c);
+    };
+
+    for (const auto& [chave, uso] : usoAresta) {
+        (void)uso;
+        avaliarAresta(static_cast<uint32_t>(chave >> 32), static_cast<uint32_t>(chave));
+    }
+
+    // Conjunto de vértices ligados a v por alguma aresta
+    std::vector<uint32_t> marca(numeroVertices, 0);
+    uint32_t marcaAtual = 0;
+    auto vizinhosDe = [&](uint32_t v, std::vector<uint32_t>& saida) {
+        saida.clear();
+        for (uint32_t t : vizinhas[v]) {
+            if (removido[t]) continue;
+            for (uint32_t w : tris[t])
+                if (w != v) saida.push_back(w);
+        }
+        std::sort(saida.begin(), saida.end());
+        saida.erase(std::unique(saida.begin(), saida.end()), saida.end());
+    };
+
+    size_t trianguloAtual = tris.size();
+    double maiorCusto = 0.0;
+    std::vector<uint32_t> vizinhosA, vizinhosB;
+    while (trianguloAtual > trianguloAlvo && !fila.empty()) {
+        Candidato c = fila.top();
+        fila.pop();
+        if (morto[c.a] || morto[c.b] || versao[c.a] != c.versaoA || versao[c.b] != c.versaoB)
+            continue;
+
+        // Condição de ligação: a e b só podem compartilhar os vértices opostos das faces da aresta
+        vizinhosDe(c.a, vizinhosA);
+        vizinhosDe(c.b, vizinhosB);
+        marcaAtual++;
+        for (uint32_t w : vizinhosA) marca[w] = marcaAtual;
+        int comuns = 0, facesAresta = 0;
+        for (uint32_t w : vizinhosB) comuns += marca[w] == marcaAtual;
+        for (uint32_t t : vizinhas[c.a])
+            if (!removido[t] && (tris[t][0] == c.b || tris[t][1] == c.b || tris[t][2] == c.b))
+                facesAresta++;
+        if (facesAresta == 0 || comuns != facesAresta)
+            continue;
+
+        // Recusa o colapso se alguma face remanescente virar do avesso
+        bool inverte = false;
+        for (uint32_t v : {c.a, c.b}) {
+            for (uint32_t t : vizinhas[v]) {
+                if (removido[t]) continue;
+                const auto& tri = tris[t];
+                if ((tri[0] == c.a || tri[1] == c.a || tri[2] == c.a) && (tri[0] == c.b || tri[1] == c.b || tri[2] == c.b))
+                    continue; // Some com o colapso
+                double antes[3], depois[3];
+                const double* p[3];
+                const double* q[3];
+                for (int k = 0; k < 3; ++k) {
+                    p[k] = &pos[3 * tri[k]];
+                    q[k] = tri[k] == v ? c.posicao : p[k];
+                }
+                detalhe::normalFace(p[0], p[1], p[2], antes);
+                detalhe::normalFace(q[0], q[1], q[2], depois);
+                double produto = antes[0] * depois[0] + antes[1] * depois[1] + antes[2] * depois[2];
+                double normas = std::sqrt((antes[0] * antes[0] + antes[1] * antes[1] + antes[2] * antes[2]) *
+                                          (depois[0] * depois[0] + depois[1] * depois[1] + depois[2] * depois[2]));
+                if (produto < 0.2 * normas) { // Mais de ~78 graus de giro
+                    inverte = true;
+                    break;
+                }
+            }
+            if (inverte) break;
+        }
+        if (inverte)
+            continue;
+
+        // Colapsa b em a
+        std::copy(c.posicao, c.posicao + 3, &pos[3 * c.a]);
+        quadricas[c.a] += quadricas[c.b];
+        medidas[c.a] += medidas[c.b];
+        maiorCusto = std::max(maiorCusto, medidas[c.a].avaliar(c.posicao));
+        morto[c.b] = 1;
+        versao[c.a]++;
+        for (uint32_t t : vizinhas[c.b]) {
+            if (removido[t]) continue;
+            auto& tri = tris[t];
+            bool temA = tri[0] == c.a || tri[1] == c.a || tri[2] == c.a;
+            if (temA) {
+                removido[t] = 1;
+                trianguloAtual--;
+            } else {
+                for (uint32_t& w : tri)
+                    if (w == c.b) w = c.a;
+                vizinhas[c.a].push_back(t);
+            }
+        }
+        vizinhas[c.b].clear();
+        auto& lista = vizinhas[c.a];
+        lista.erase(std::remove_if(lista.begin(), lista.end(), [&](uint32_t t) { return removido[t] != 0; }), lista.end());
+
+        vizinhosDe(c.a, vizinhosA);
+        for (uint32_t w : vizinhosA)
+            avaliarAresta(c.a, w);
+    }
+
+    // Compacta: só os vértices ainda usados, na ordem em que aparecem
+    malha::Malha saida;
+    std::vector<uint32_t> novoIndice(numeroVertices, UINT32_MAX);
+    for (size_t t = 0; t < tris.size(); ++t) {
+        if (removido[t]) continue;
+        for (uint32_t v : tris[t]) {
+            if (novoIndice[v] == UINT32_MAX) {
+                novoIndice[v] = static_cast<uint32_t>(saida.numeroVertices());
+                for (int c = 0; c < 3; ++c)
+                    saida.posicoes.push_back(static_cast<float>(pos[3 * v + c]));
+            }
+            saida.indices.push_back(novoIndice[v]);
+        }
+    }
+    malha::calcularNormais(saida);
+    if (erro)
+        *erro = std::sqrt(maiorCusto);
+    return saida;
+}
+
+struct Cadeia {
+    std::vector<malha::Malha> niveis; // niveis[0] é a malha original
+    std::vector<double> erros;        // Limite do desvio geométrico de cada nível, em unidades do modelo
+};
+
+// Cada nível tem "razao" vezes os triângulos do anterior, até "minimoTriangulos"
+inline Cadeia gerarCadeia(const malha::Malha& original, double razao = 0.5, size_t minimoTriangulos = 64) {
+    Cadeia cadeia;
+    cadeia.niveis.push_back(original);
+    cadeia.erros.push_back(0.0);
+    while (cadeia.niveis.back().numeroTriangulos() * razao >= minimoTriangulos) {
+        const malha::Malha& anterior = cadeia.niveis.back();
+        double erroNivel = 0.0;
+        malha::Malha proximo = simplificar(anterior, static_cast<size_t>(anterior.numeroTriangulos() * razao), &erroNivel);
+        if (proximo.numeroTriangulos() >= anterior.numeroTriangulos())
+            break; // Nenhum colapso válido restante
+        // Os erros se acumulam de um nível para o outro; a soma é um limite conservador
+        cadeia.erros.push_back(cadeia.erros.back() + erroNivel);
+        cadeia.niveis.push_back(std::move(proximo));
+    }
+    return cadeia;
+}
+
+// Pixels por unidade do modelo a uma distância "distancia" da câmera em perspectiva
+inline double pixelsPorUnidadePerspectiva(double distancia, double fovYRadianos, double alturaPixels) {
+    return alturaPixels / (2.0 * std::max(distancia, 1e-6) * std::tan(0.5 * fovYRadianos));
+}
+
+// Na projeção ortográfica a escala não depende da distância
+inline double pixelsPorUnidadeOrtografica(double alturaVolume, double alturaPixels) {
+    return alturaPixels / alturaVolume;
+}
+
+// Nível mais simples cujo erro projetado não passa de "limiarPixels"
+inline size_t selecionar(const Cadeia& cadeia, double pixelsPorUnidade, double limiarPixels = 1.0) {
+    size_t escolhido = 0;
+    for (size_t i = 0; i < cadeia.niveis.size(); ++i)
+        if (cadeia.erros[i] * pixelsPorUnidade <= limiarPixels)
+            escolhido = i;
+    return escolhido;
+}
+
+} // namespace lod
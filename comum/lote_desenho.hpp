@@ -0,0 +1,422 @@
+// Lote de desenho: todas as malhas em megabuffers compartilhados e um número
+// constante de chamadas de desenho, independente do número de objetos
+//
+// As malhas são concatenadas em um único VBO (vértices do formato V, veja
+// formato_vertice.hpp) e um único IBO de índices de 32 bits; cada malha guarda o seu
+// primeiro índice e o seu vértice base. A matriz de modelo de cada objeto vai em um
+// buffer de instâncias, lido como atributo mat4 com glVertexAttribDivisor(1).
+//
+// Três caminhos, escolhidos pelo que o driver oferece:
+//  - COMPUTE (GL 4.3): um comando DrawElementsIndirect por objeto, com baseInstance
+//    apontando para a sua matriz. Um compute shader testa a esfera envolvente de cada
+//    objeto contra o frustum e zera instanceCount dos invisíveis; em seguida uma única
+//    glMultiDrawElementsIndirect desenha tudo. Nada é lido de volta pela CPU.
+//  - INDIRETO (GL 4.3 ou ARB_multi_draw_indirect, sem compute shader): a CPU descarta
+//    os objetos fora do frustum, agrupa as matrizes visíveis por malha e monta um
+//    comando por malha; também uma única glMultiDrawElementsIndirect.
+//  - INSTANCIADO (GL 3.3, por exemplo no macOS): mesmo agrupamento, com uma
+//    glDrawElementsInstancedBaseVertex por malha.
+//
+// Uso:
+//   LoteDesenho<VerticeCasa> lote(4);                // matriz de modelo nos locais 4..7
+//   uint32_t casa = lote.adicionarMalha(vertices, indices);
+//   lote.adicionarObjeto(casa, modelo);
+//   lote.enviar();                                   // cria os buffers (contexto atual)
+//   lote.desenhar(glm::value_ptr(projecao * visualizacao));
+//   lote.limpar();                                   // antes de destruir o contexto
+//
+// desenhar() é descartar() seguido de desenharVisiveis(); o primeiro não chama o
+// OpenGL e pode rodar em outra thread (veja comandos_render.hpp).
+//
+// No vertex shader: "layout(location = 4) in mat4 modelo;" e
+// gl_Position = projecaoVisualizacao * modelo * vec4(posicao, 1.0).
+#pragma once
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "formato_vertice.hpp"
+
+// Layout fixado pelo OpenGL para glMultiDrawElementsIndirect
+struct ComandoIndireto {
+    GLuint numeroIndices;
+    GLuint numeroInstancias;
+    GLuint primeiroIndice;
+    GLint verticeBase;
+    GLuint instanciaBase;
+};
+static_assert(sizeof(ComandoIndireto) == 20, "ComandoIndireto precisa ter 5 inteiros de 32 bits");
+
+template <typename V>
+class LoteDesenho {
+public:
+    enum Modo { INSTANCIADO, INDIRETO, COMPUTE };
+
+    // localModelo: primeiro dos 4 locais de atributo ocupados pela matriz de modelo
+    explicit LoteDesenho(GLuint localModelo = 4) : localModelo(localModelo) {}
+    LoteDesenho(const LoteDesenho&) = delete;
+    LoteDesenho& operator=(const LoteDesenho&) = delete;
+
+    // Acrescenta uma malha aos megabuffers. "posicao" é o deslocamento, em floats, da
+    // posição (x, y, z) dentro de V, usado para calcular a esfera envolvente.
+    uint32_t adicionarMalha(const std::vector<V>& verticesMalha, const std::vector<uint32_t>& indicesMalha,
+                            size_t posicao = 0) {
+        MalhaLote m;
+        m.primeiroIndice = static_cast<GLuint>(indices.size());
+        m.numeroIndices = static_cast<GLuint>(indicesMalha.size());
+        m.verticeBase = static_cast<GLint>(vertices.size());
+        esferaEnvolvente(verticesMalha, posicao, m.centro, m.raio);
+        vertices.insert(vertices.end(), verticesMalha.begin(), verticesMalha.end());
+        indices.insert(indices.end(), indicesMalha.begin(), indicesMalha.end());
+        malhas.push_back(m);
+        return static_cast<uint32_t>(malhas.size() - 1);
+    }
+
+    uint32_t adicionarObjeto(uint32_t malha, const float modelo[16]) {
+        objetos.push_back({malha});
+        matrizes.insert(matrizes.end(), modelo, modelo + 16);
+        esferas.resize(esferas.size() + 4);
+        atualizarEsfera(static_cast<uint32_t>(objetos.size() - 1));
+        objetosAlterados = true;
+        return static_cast<uint32_t>(objetos.size() - 1);
+    }
+
+    void atualizarObjeto(uint32_t objeto, const float modelo[16]) {
+        std::memcpy(&matrizes[16 * size_t(objeto)], modelo, 16 * sizeof(float));
+        atualizarEsfera(objeto);
+        objetosAlterados = true;
+    }
+
+    // Cria os buffers na GPU com as malhas e objetos adicionados até aqui (objetos novos
+    // exigem chamar enviar() de novo; atualizarObjeto() não)
+    void enviar() {
+        liberar();
+        escolherModo();
+
+        glGenVertexArrays(1, &vao);
+        glBindVertexArray(vao);
+
+        glGenBuffers(1, &vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(V), vertices.data(), GL_STATIC_DRAW);
+        vertice::configurarAtributos<V>();
+
+        glGenBuffers(1, &ibo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo); // Fica registrado no VAO
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
+
+        glGenBuffers(1, &bufferInstancias);
+        configurarInstancias(0);
+
+        if (modo != INSTANCIADO)
+            glGenBuffers(1, &bufferComandos);
+        if (modo == COMPUTE) {
+            glGenBuffers(1, &bufferEsferas);
+            enviarComandosPorObjeto();
+        }
+        glBindVertexArray(0);
+        objetosAlterados = true;
+    }
+
+    // Resultado do descarte de um ponto de vista: matrizes visíveis agrupadas por malha e
+    // um comando por malha. Não toca no OpenGL, então pode ser preenchido em outra thread
+    // (um Visiveis por thread) e desenhado depois na thread do contexto.
+    struct Visiveis {
+        float planos[24];
+        std::vector<GLuint> contagem;
+        std::vector<char> visivel;
+        std::vector<float> matrizes;
+        std::vector<ComandoIndireto> comandos;
+        size_t quantidade = 0;
+    };
+
+    // Testa as esferas dos objetos contra o frustum da matriz projeção * visualização
+    // (coluna a coluna). No modo COMPUTE apenas guarda os planos: o teste é feito na GPU.
+    void descartar(const float projecaoVisualizacao[16], Visiveis& saida) const {
+        extrairPlanos(projecaoVisualizacao, saida.planos);
+        if (modo != COMPUTE)
+            agruparVisiveis(saida);
+    }
+
+    // Desenha o resultado de descartar(). O programa, com o uniform de projeção e
+    // visualização já definido, deve estar em uso.
+    void desenharVisiveis(const Visiveis& v) {
+        glBindVertexArray(vao);
+        chamadas = 0;
+
+        if (modo == COMPUTE) {
+            if (objetosAlterados) {
+                glBindBuffer(GL_ARRAY_BUFFER, bufferInstancias);
+                glBufferData(GL_ARRAY_BUFFER, matrizes.size() * sizeof(float), matrizes.data(), GL_DYNAMIC_DRAW);
+                glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferEsferas);
+                glBufferData(GL_SHADER_STORAGE_BUFFER, esferas.size() * sizeof(float), esferas.data(), GL_DYNAMIC_DRAW);
+                objetosAlterados = false;
+            }
+            GLint programaAtual = 0;
+            glGetIntegerv(GL_CURRENT_PROGRAM, &programaAtual);
+            glUseProgram(programaDescarte);
+            glUniform4fv(localPlanos, 6, v.planos);
+            glUniform1ui(localNumeroObjetos, static_cast<GLuint>(objetos.size()));
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, bufferEsferas);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, bufferComandos);
+            glDispatchCompute(static_cast<GLuint>((objetos.size() + 63) / 64), 1, 1);
+            glMemoryBarrier(GL_COMMAND_BARRIER_BIT); // Os comandos escritos pelo shader são lidos como indiretos
+            glUseProgram(static_cast<GLuint>(programaAtual));
+
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, bufferComandos);
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(objetos.size()), 0);
+            chamadas = 1;
+            visiveis = objetos.size(); // Desconhecido na CPU: o descarte aconteceu na GPU
+        } else {
+            visiveis = v.quantidade;
+            glBindBuffer(GL_ARRAY_BUFFER, bufferInstancias);
+            glBufferData(GL_ARRAY_BUFFER, v.matrizes.size() * sizeof(float), v.matrizes.data(), GL_STREAM_DRAW);
+
+            if (modo == INDIRETO) {
+                glBindBuffer(GL_DRAW_INDIRECT_BUFFER, bufferComandos);
+                glBufferData(GL_DRAW_INDIRECT_BUFFER, v.comandos.size() * sizeof(ComandoIndireto), v.comandos.data(), GL_STREAM_DRAW);
+                glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(v.comandos.size()), 0);
+                chamadas = 1;
+            } else {
+                // Sem baseInstance: o ponteiro das matrizes é deslocado para o grupo de cada malha
+                for (const ComandoIndireto& c : v.comandos) {
+                    if (c.numeroInstancias == 0)
+                        continue;
+                    configurarInstancias(size_t(c.instanciaBase) * 16 * sizeof(float));
+                    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, c.numeroIndices, GL_UNSIGNED_INT,
+                                                      reinterpret_cast<const void*>(size_t(c.primeiroIndice) * sizeof(uint32_t)),
+                                                      c.numeroInstancias, c.verticeBase);
+                    chamadas++;
+                }
+            }
+        }
+        glBindVertexArray(0);
+    }
+
+    // Descarta e desenha na mesma thread
+    void desenhar(const float projecaoVisualizacao[16]) {
+        descartar(projecaoVisualizacao, proprios);
+        desenharVisiveis(proprios);
+    }
+
+    Modo modoEscolhido() const { return modo; }
+    size_t numeroObjetos() const { return objetos.size(); }
+    size_t numeroMalhas() const { return malhas.size(); }
+    size_t chamadasUltimoDesenho() const { return chamadas; }
+    size_t visiveisUltimoDesenho() const { return visiveis; }
+
+    // Libera os objetos OpenGL; chamar com o contexto ainda atual (não há destrutor que o faça)
+    void limpar() {
+        liberar();
+        if (programaDescarte)
+            glDeleteProgram(programaDescarte);
+        programaDescarte = 0;
+    }
+
+    void imprimirEstatisticas() const {
+        const char* nomes[] = {"instanciado (GL 3.3)", "indireto (multi-draw, descarte na CPU)",
+                               "compute (multi-draw, descarte na GPU)"};
+        printf("Lote de desenho: %zu malhas, %zu objetos, %zu vértices, %zu índices, modo %s\n", malhas.size(),
+               objetos.size(), vertices.size(), indices.size(), nomes[modo]);
+    }
+
+private:
+    struct MalhaLote {
+        GLuint primeiroIndice, numeroIndices;
+        GLint verticeBase;
+        float centro[3], raio;
+    };
+    struct ObjetoLote {
+        uint32_t malha;
+    };
+
+    static void esferaEnvolvente(const std::vector<V>& vs, size_t posicao, float centro[3], float& raio) {
+        // Centro da caixa envolvente e maior distância até ele (não é a esfera mínima, mas basta para o descarte)
+        float minimo[3] = {INFINITY, INFINITY, INFINITY}, maximo[3] = {-INFINITY, -INFINITY, -INFINITY};
+        for (const V& v : vs) {
+            const float* p = reinterpret_cast<const float*>(&v) + posicao;
+            for (int c = 0; c < 3; ++c) {
+                minimo[c] = std::min(minimo[c], p[c]);
+                maximo[c] = std::max(maximo[c], p[c]);
+            }
+        }
+        float r2 = 0.0f;
+        for (int c = 0; c < 3; ++c)
+            centro[c] = vs.empty() ? 0.0f : 0.5f * (minimo[c] + maximo[c]);
+        for (const V& v : vs) {
+            const float* p = reinterpret_cast<const float*>(&v) + posicao;
+            float dx = p[0] - centro[0], dy = p[1] - centro[1], dz = p[2] - centro[2];
+            r2 = std::max(r2, dx * dx + dy * dy + dz * dz);
+        }
+        raio = std::sqrt(r2);
+    }
+
+    // Esfera do objeto no mundo: centro transformado e raio multiplicado pela maior escala
+    void atualizarEsfera(uint32_t objeto) {
+        const MalhaLote& m = malhas[objetos[objeto].malha];
+        const float* a = &matrizes[16 * size_t(objeto)];
+        float* e = &esferas[4 * size_t(objeto)];
+        for (int l = 0; l < 3; ++l)
+            e[l] = a[l] * m.centro[0] + a[4 + l] * m.centro[1] + a[8 + l] * m.centro[2] + a[12 + l];
+        float escala = 0.0f;
+        for (int c = 0; c < 3; ++c)
+            escala = std::max(escala, a[4 * c] * a[4 * c] + a[4 * c + 1] * a[4 * c + 1] + a[4 * c + 2] * a[4 * c + 2]);
+        e[3] = m.raio * std::sqrt(escala);
+    }
+
+    // Planos do frustum (Gribb e Hartmann): linha 4 da matriz mais ou menos as linhas 1 a 3
+    static void extrairPlanos(const float m[16], float planos[24]) {
+        for (int i = 0; i < 6; ++i) {
+            int linha = i / 2;
+            float sinal = i % 2 == 0 ? 1.0f : -1.0f;
+            float* p = &planos[4 * i];
+            for (int c = 0; c < 4; ++c)
+                p[c] = m[4 * c + 3] + sinal * m[4 * c + linha];
+            float comprimento = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+            if (comprimento > 0.0f)
+                for (int c = 0; c < 4; ++c)
+                    p[c] /= comprimento;
+        }
+    }
+
+    static bool dentro(const float planos[24], const float e[4]) {
+        for (int i = 0; i < 6; ++i) {
+            const float* p = &planos[4 * i];
+            if (p[0] * e[0] + p[1] * e[1] + p[2] * e[2] + p[3] < -e[3])
+                return false;
+        }
+        return true;
+    }
+
+    // Descarte na CPU: matrizes visíveis contíguas por malha e um comando por malha
+    void agruparVisiveis(Visiveis& v) const {
+        v.contagem.assign(malhas.size(), 0);
+        v.visivel.resize(objetos.size());
+        v.quantidade = 0;
+        for (size_t i = 0; i < objetos.size(); ++i) {
+            v.visivel[i] = dentro(v.planos, &esferas[4 * i]);
+            if (v.visivel[i]) {
+                v.contagem[objetos[i].malha]++;
+                v.quantidade++;
+            }
+        }
+        v.comandos.resize(malhas.size());
+        GLuint base = 0;
+        for (size_t m = 0; m < malhas.size(); ++m) {
+            v.comandos[m] = {malhas[m].numeroIndices, v.contagem[m], malhas[m].primeiroIndice, malhas[m].verticeBase, base};
+            base += v.contagem[m];
+            v.contagem[m] = v.comandos[m].instanciaBase; // Passa a ser a próxima posição livre do grupo
+        }
+        v.matrizes.resize(16 * v.quantidade);
+        for (size_t i = 0; i < objetos.size(); ++i)
+            if (v.visivel[i])
+                std::memcpy(&v.matrizes[16 * size_t(v.contagem[objetos[i].malha]++)], &matrizes[16 * i],
+                            16 * sizeof(float));
+    }
+
+    void configurarInstancias(size_t deslocamento) {
+        glBindBuffer(GL_ARRAY_BUFFER, bufferInstancias);
+        for (GLuint coluna = 0; coluna < 4; ++coluna) {
+            glEnableVertexAttribArray(localModelo + coluna);
+            glVertexAttribPointer(localModelo + coluna, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(float),
+                                  reinterpret_cast<const void*>(deslocamento + coluna * 4 * sizeof(float)));
+            glVertexAttribDivisor(localModelo + coluna, 1);
+        }
+    }
+
+    void enviarComandosPorObjeto() {
+        std::vector<ComandoIndireto> comandos(objetos.size());
+        for (size_t i = 0; i < objetos.size(); ++i) {
+            const MalhaLote& m = malhas[objetos[i].malha];
+            comandos[i] = {m.numeroIndices, 1, m.primeiroIndice, m.verticeBase, static_cast<GLuint>(i)};
+        }
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, bufferComandos);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, comandos.size() * sizeof(ComandoIndireto), comandos.data(), GL_DYNAMIC_DRAW);
+    }
+
+    void escolherModo() {
+        bool indireto = GLEW_VERSION_4_3 || (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance);
+        bool compute = GLEW_VERSION_4_3 || (GLEW_ARB_compute_shader && GLEW_ARB_shader_storage_buffer_object);
+        modo = indireto ? INDIRETO : INSTANCIADO;
+        if (indireto && compute && criarProgramaDescarte())
+            modo = COMPUTE;
+    }
+
+    bool criarProgramaDescarte() {
+        if (programaDescarte)
+            return true;
+        // Cada comando ocupa 5 uints; só numeroInstancias (o segundo) é reescrito
+        static const char* codigo = R"(
+#version 430
+layout(local_size_x = 64) in;
+layout(std430, binding = 0) readonly buffer Esferas { vec4 esferas[]; };
+layout(std430, binding = 1) buffer Comandos { uint comandos[]; };
+uniform vec4 planos[6];
+uniform uint numeroObjetos;
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= numeroObjetos)
+        return;
+    vec4 e = esferas[i];
+    bool visivel = true;
+    for (int p = 0; p < 6; ++p)
+        visivel = visivel && dot(planos[p].xyz, e.xyz) + planos[p].w >= -e.w;
+    comandos[5u * i + 1u] = visivel ? 1u : 0u;
+}
+)";
+        GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+        glShaderSource(shader, 1, &codigo, nullptr);
+        glCompileShader(shader);
+        GLuint programa = glCreateProgram();
+        glAttachShader(programa, shader);
+        glLinkProgram(programa);
+        glDeleteShader(shader);
+        GLint ok = GL_FALSE;
+        glGetProgramiv(programa, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            char log[1024] = {0};
+            glGetProgramInfoLog(programa, sizeof(log), nullptr, log);
+            fprintf(stderr, "Descarte por compute shader indisponível, usando a CPU:\n%s\n", log);
+            glDeleteProgram(programa);
+            return false;
+        }
+        programaDescarte = programa;
+        localPlanos = glGetUniformLocation(programa, "planos");
+        localNumeroObjetos = glGetUniformLocation(programa, "numeroObjetos");
+        return true;
+    }
+
+    void liberar() {
+        GLuint buffers[] = {vbo, ibo, bufferInstancias, bufferComandos, bufferEsferas};
+        for (GLuint b : buffers)
+            if (b)
+                glDeleteBuffers(1, &b);
+        if (vao)
+            glDeleteVertexArrays(1, &vao);
+        vbo = ibo = bufferInstancias = bufferComandos = bufferEsferas = vao = 0;
+    }
+
+    GLuint localModelo;
+    Modo modo = INSTANCIADO;
+
+    std::vector<V> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<MalhaLote> malhas;
+    std::vector<ObjetoLote> objetos;
+    std::vector<float> matrizes; // 16 floats por objeto
+    std::vector<float> esferas;  // centro e raio no mundo, 4 floats por objeto
+    bool objetosAlterados = true;
+
+    Visiveis proprios; // Usado por desenhar(), reaproveitado entre quadros
+
+    GLuint vao = 0, vbo = 0, ibo = 0, bufferInstancias = 0, bufferComandos = 0, bufferEsferas = 0;
+    GLuint programaDescarte = 0;
+    GLint localPlanos = -1, localNumeroObjetos = -1;
+    size_t chamadas = 0, visiveis = 0;
+};
@@ -0,0 +1,155 @@
+// Malha de triângulos indexada e leitura de arquivos Wavefront OBJ
+//
+// Lê apenas o necessário para os exemplos: posições (v), normais (vn) e faces (f),
+// com polígonos triangulados em leque e índices negativos (relativos). Cada par
+// posição/normal distinto vira um vértice; sem normais no arquivo, elas são
+// calculadas pela média das faces ponderada pela área.
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace malha {
+
+struct Malha {
+    std::vector<float> posicoes;   // x, y, z por vértice
+    std::vector<float> normais;    // x, y, z por vértice (unitárias)
+    std::vector<uint32_t> indices; // 3 por triângulo
+
+    size_t numeroVertices() const { return posicoes.size() / 3; }
+    size_t numeroTriangulos() const { return indices.size() / 3; }
+};
+
+inline void normalizar(float* v) {
+    float comprimento = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (comprimento > 0.0f) {
+        v[0] /= comprimento; v[1] /= comprimento; v[2] /= comprimento;
+    }
+}
+
+// Normais por vértice como média das normais das faces, ponderada pela área
+inline void calcularNormais(Malha& m) {
+    m.normais.assign(m.posicoes.size(), 0.0f);
+    for (size_t t = 0; t < m.indices.size(); t += 3) {
+        const float* a = &m.posicoes[3 * size_t(m.indices[t])];
+        const float* b = &m.posicoes[3 * size_t(m.indices[t + 1])];
+        const float* c = &m.posicoes[3 * size_t(m.indices[t + 2])];
+        float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+        float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+        for (int k = 0; k < 3; ++k)
+            for (int c2 = 0; c2 < 3; ++c2)
+                m.normais[3 * size_t(m.indices[t + k]) + c2] += n[c2];
+    }
+    for (size_t v = 0; v < m.numeroVertices(); ++v)
+        normalizar(&m.normais[3 * v]);
+}
+
+inline Malha carregarObj(const std::string& caminho) {
+    std::ifstream arquivo(caminho);
+    if (!arquivo)
+        throw std::runtime_error("Não foi possível abrir " + caminho);
+
+    std::vector<float> posicoesArquivo, normaisArquivo;
+    std::unordered_map<uint64_t, uint32_t> vertices; // (posição, normal) -> índice na malha
+    Malha m;
+    bool temNormais = false;
+
+    // Converte um índice do OBJ (1-based ou negativo) para 0-based
+    auto resolver = [](long indice, size_t quantidade) -> long {
+        return indice < 0 ? static_cast<long>(quantidade) + indice : indice - 1;
+    };
+
+    std::string linha;
+    std::vector<uint32_t> poligono;
+    while (std::getline(arquivo, linha)) {
+        std::istringstream entrada(linha);
+        std::string comando;
+        entrada >> comando;
+        if (comando == "v" || comando == "vn") {
+            float x = 0, y = 0, z = 0;
+            entrada >> x >> y >> z;
+            std::vector<float>& destino = comando == "v" ? posicoesArquivo : normaisArquivo;
+            destino.insert(destino.end(), {x, y, z});
+        } else if (comando == "f") {
+            poligono.clear();
+            std::string vertice;
+            while (entrada >> vertice) {
+                // Formatos: p, p/t, p//n, p/t/n
+                long p = std::stol(vertice), n = 0;
+                size_t barra = vertice.find('/');
+                if (barra != std::string::npos) {
+                    size_t segunda = vertice.find('/', barra + 1);
+                    if (segunda != std::string::npos && segunda + 1 < vertice.size())
+                        n = std::stol(vertice.substr(segunda + 1));
+                }
+                long ip = resolver(p, posicoesArquivo.size() / 3);
+                long in = n ? resolver(n, normaisArquivo.size() / 3) : -1;
+                if (ip < 0 || 3 * size_t(ip) >= posicoesArquivo.size() || (in >= 0 && 3 * size_t(in) >= normaisArquivo.size()))
+                    throw std::runtime_error("Índice fora do intervalo em " + caminho + ": " + linha);
+                temNormais |= in >= 0;
+
+                uint64_t chave = (uint64_t(ip) << 32) | uint32_t(in + 1);
+                auto [it, novo] = vertices.emplace(chave, static_cast<uint32_t>(m.numeroVertices()));
+                if (novo) {
+                    m.posicoes.insert(m.posicoes.end(), &posicoesArquivo[3 * ip], &posicoesArquivo[3 * ip] + 3);
+                    if (in >= 0)
+                        m.normais.insert(m.normais.end(), &normaisArquivo[3 * in], &normaisArquivo[3 * in] + 3);
+                    else
+                        m.normais.insert(m.normais.end(), {0.0f, 0.0f, 0.0f});
+                }
+                poligono.push_back(it->second);
+            }
+            for (size_t k = 2; k < poligono.size(); ++k) // Leque a partir do primeiro vértice
+                m.indices.insert(m.indices.end(), {poligono[0], poligono[k - 1], poligono[k]});
+        }
+    }
+
+    if (!temNormais)
+        calcularNormais(m);
+    else
+        for (size_t v = 0; v < m.numeroVertices(); ++v)
+            normalizar(&m.normais[3 * v]);
+    return m;
+}
+
+// Divide cada triângulo em 4 pelos pontos médios das arestas (arestas compartilhadas
+// geram um único vértice novo). Usado para obter malhas grandes a partir de modelos pequenos.
+inline Malha subdividir(const Malha& origem) {
+    Malha m;
+    m.posicoes = origem.posicoes;
+    m.normais = origem.normais;
+    m.indices.reserve(origem.indices.size() * 4);
+    std::unordered_map<uint64_t, uint32_t> pontosMedios;
+    pontosMedios.reserve(origem.indices.size() * 3 / 2);
+
+    auto pontoMedio = [&](uint32_t a, uint32_t b) {
+        uint64_t chave = a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+        auto [it, novo] = pontosMedios.emplace(chave, static_cast<uint32_t>(m.numeroVertices()));
+        if (novo) {
+            float n[3];
+            for (int c = 0; c < 3; ++c) {
+                m.posicoes.push_back(0.5f * (m.posicoes[3 * size_t(a) + c] + m.posicoes[3 * size_t(b) + c]));
+                n[c] = m.normais[3 * size_t(a) + c] + m.normais[3 * size_t(b) + c];
+            }
+            normalizar(n);
+            m.normais.insert(m.normais.end(), n, n + 3);
+        }
+        return it->second;
+    };
+
+    for (size_t t = 0; t < origem.indices.size(); t += 3) {
+        uint32_t a = origem.indices[t], b = origem.indices[t + 1], c = origem.indices[t + 2];
+        uint32_t ab = pontoMedio(a, b), bc = pontoMedio(b, c), ca = pontoMedio(c, a);
+        m.indices.insert(m.indices.end(), {a, ab, ca, ab, b, bc, ca, bc, c, ab, bc, ca});
+    }
+    return m;
+}
+
+} // namespace malha
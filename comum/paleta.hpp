@@ -0,0 +1,310 @@
+// Quantização de cores: paleta por corte mediano refinada por k-médias, em luz linear
+//
+// A imagem RGB vira primeiro um histograma de 32768 caixas (5 bits por canal), com a
+// contagem e a soma das cores lineares de cada caixa; depois disso o custo não depende
+// mais do tamanho da imagem.
+//   1. Corte mediano: começa com uma caixa com todas as cores e divide sempre a de maior
+//      erro quadrático, no eixo de maior variância, na mediana ponderada pelos pixels.
+//   2. k-médias (Lloyd) sobre as caixas do histograma, partindo do corte mediano, com a
+//      atribuição em paralelo.
+//   3. Mapeamento: tabela caixa -> cor mais próxima, um acesso por pixel; ou com difusão
+//      de erro (Floyd-Steinberg em luz linear), que evita faixas em degradês.
+// Médias e distâncias são calculadas em luz linear (cor.hpp): a média de preto e branco
+// é o cinza que reflete metade da luz, não o byte 128.
+//
+//   paleta::Paleta cores = paleta::kMedias(img, paleta::corteMediano(img, 256));
+//   paleta::ImagemIndexada indexada = paleta::quantizar(img, cores, true);
+//   imagem::escrever("quantizada.ppm", paleta::expandir(indexada));
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "cor.hpp"
+#include "imagem.hpp"
+#include "tarefas.hpp"
+
+namespace paleta {
+
+using Cor = std::array<uint8_t, 3>;
+using Paleta = std::vector<Cor>;
+
+struct ImagemIndexada {
+    int largura = 0, altura = 0;
+    std::vector<uint8_t> indices; // Um por pixel, na paleta abaixo (até 256 cores)
+    Paleta cores;
+};
+
+namespace detalhe {
+
+const int BITS = 5;
+const int CAIXAS = 1 << (3 * BITS);
+
+inline int caixa(const uint8_t* rgb) { return (rgb[0] >> 3) << 10 | (rgb[1] >> 3) << 5 | (rgb[2] >> 3); }
+
+// Caixas não vazias do histograma: pixels e cor linear média
+struct Histograma {
+    std::vector<int> indices;                  // Caixa de cada entrada
+    std::vector<uint32_t> pixels;
+    std::vector<std::array<float, 3>> medias;
+};
+
+inline void exigirRGB(const imagem::Imagem& img) {
+    if (img.canais != 3)
+        throw std::invalid_argument("A quantização de cores precisa de uma imagem RGB");
+}
+
+inline Histograma histograma(const imagem::Imagem& img) {
+    exigirRGB(img);
+    std::vector<uint32_t> contagem(CAIXAS, 0);
+    std::vector<std::array<double, 3>> somas(CAIXAS, {0.0, 0.0, 0.0});
+    std::mutex mutex;
+    const size_t n = size_t(img.largura) * img.altura;
+    tarefas::padrao().paraleloPara(0, n, 1 << 18, [&](size_t i0, size_t i1) {
+        std::vector<uint32_t> c(CAIXAS, 0);
+        std::vector<std::array<double, 3>> s(CAIXAS, {0.0, 0.0, 0.0});
+        const float* tabela = cor::detalhe::tabelaLinear().data();
+        for (size_t i = i0; i < i1; ++i) {
+            const uint8_t* p = &img.pixels[i * 3];
+            int k = caixa(p);
+            c[k]++;
+            s[k][0] += tabela[p[0]];
+            s[k][1] += tabela[p[1]];
+            s[k][2] += tabela[p[2]];
+        }
+        std::lock_guard<std::mutex> trava(mutex);
+        for (int k = 0; k < CAIXAS; ++k)
+            if (c[k]) {
+                contagem[k] += c[k];
+                for (int j = 0; j < 3; ++j)
+                    somas[k][j] += s[k][j];
+            }
+    });
+    Histograma h;
+    for (int k = 0; k < CAIXAS; ++k)
+        if (contagem[k]) {
+            h.indices.push_back(k);
+            h.pixels.push_back(contagem[k]);
+            h.medias.push_back({float(somas[k][0] / contagem[k]), float(somas[k][1] / contagem[k]), float(somas[k][2] / contagem[k])});
+        }
+    return h;
+}
+
+inline float distancia2(const std::array<float, 3>& a, const std::array<float, 3>& b) {
+    float d0 = a[0] - b[0], d1 = a[1] - b[1], d2 = a[2] - b[2];
+    return d0 * d0 + d1 * d1 + d2 * d2;
+}
+
+inline std::array<float, 3> linear(const Cor& c) { return {cor::deSRGB(c[0]), cor::deSRGB(c[1]), cor::deSRGB(c[2])}; }
+inline Cor srgb(const std::array<float, 3>& c) { return {cor::paraSRGB(c[0]), cor::paraSRGB(c[1]), cor::paraSRGB(c[2])}; }
+
+// Índice da cor mais próxima (busca exaustiva: paletas de até 256 cores)
+inline int maisProxima(const std::vector<std::array<float, 3>>& cores, const std::array<float, 3>& c) {
+    int melhor = 0;
+    float menor = std::numeric_limits<float>::max();
+    for (size_t j = 0; j < cores.size(); ++j) {
+        float d = distancia2(cores[j], c);
+        if (d < menor) {
+            menor = d;
+            melhor = int(j);
+        }
+    }
+    return melhor;
+}
+
+inline void exigirPaleta(const Paleta& cores) {
+    if (cores.empty() || cores.size() > 256)
+        throw std::invalid_argument("A paleta precisa ter de 1 a 256 cores");
+}
+
+} // namespace detalhe
+
+// Paleta de até "numeroCores" cores (menos se a imagem tiver menos caixas ocupadas)
+inline Paleta corteMediano(const imagem::Imagem& img, int numeroCores) {
+    if (numeroCores < 1 || numeroCores > 256)
+        throw std::invalid_argument("A paleta precisa ter de 1 a 256 cores");
+    detalhe::Histograma h = detalhe::histograma(img);
+
+    struct Grupo {
+        std::vector<int> entradas; // Posições em h
+        std::array<float, 3> media;
+        double erro;               // Soma de pixels * distância² à média
+        int eixo;                  // De maior variância
+    };
+    auto resumir = [&h](std::vector<int> entradas) {
+        Grupo g{std::move(entradas), {0, 0, 0}, 0.0, 0};
+        double total = 0, soma[3] = {0, 0, 0}, quadrados[3] = {0, 0, 0};
+        for (int e : g.entradas)
+            for (int c = 0; c < 3; ++c) {
+                double p = h.pixels[e], v = h.medias[e][c];
+                soma[c] += p * v;
+                quadrados[c] += p * v * v;
+                if (c == 0)
+                    total += p;
+            }
+        double maiorVariancia = -1;
+        for (int c = 0; c < 3; ++c) {
+            g.media[c] = float(soma[c] / total);
+            double variancia = quadrados[c] - soma[c] * soma[c] / total;
+            g.erro += variancia;
+            if (variancia > maiorVariancia) {
+                maiorVariancia = variancia;
+                g.eixo = c;
+            }
+        }
+        return g;
+    };
+
+    std::vector<int> todas(h.indices.size());
+    for (size_t i = 0; i < todas.size(); ++i)
+        todas[i] = int(i);
+    std::vector<Grupo> grupos;
+    grupos.push_back(resumir(std::move(todas)));
+    while (int(grupos.size()) < numeroCores) {
+        auto maior = std::max_element(grupos.begin(), grupos.end(), [](const Grupo& a, const Grupo& b) {
+            return (a.entradas.size() > 1 ? a.erro : -1.0) < (b.entradas.size() > 1 ? b.erro : -1.0);
+        });
+        if (maior->entradas.size() < 2)
+            break; // Cada grupo já é uma caixa só
+        std::vector<int> entradas = std::move(maior->entradas);
+        const int eixo = maior->eixo;
+        std::sort(entradas.begin(), entradas.end(), [&](int a, int b) { return h.medias[a][eixo] < h.medias[b][eixo]; });
+        // Mediana ponderada, deixando pelo menos uma entrada de cada lado
+        uint64_t total = 0, acumulado = 0;
+        for (int e : entradas)
+            total += h.pixels[e];
+        size_t corte = 1;
+        for (; corte < entradas.size() - 1; ++corte) {
+            acumulado += h.pixels[entradas[corte - 1]];
+            if (2 * acumulado >= total)
+                break;
+        }
+        std::vector<int> direita(entradas.begin() + corte, entradas.end());
+        entradas.resize(corte);
+        *maior = resumir(std::move(entradas));
+        grupos.push_back(resumir(std::move(direita)));
+    }
+
+    Paleta cores;
+    for (const Grupo& g : grupos)
+        cores.push_back(detalhe::srgb(g.media));
+    return cores;
+}
+
+// Refina a paleta com "iteracoes" passos de Lloyd sobre o histograma da imagem
+inline Paleta kMedias(const imagem::Imagem& img, const Paleta& inicial, int iteracoes = 8) {
+    detalhe::exigirPaleta(inicial);
+    detalhe::Histograma h = detalhe::histograma(img);
+    std::vector<std::array<float, 3>> centros;
+    for (const Cor& c : inicial)
+        centros.push_back(detalhe::linear(c));
+    const size_t k = centros.size();
+
+    for (int it = 0; it < iteracoes; ++it) {
+        std::vector<std::array<double, 3>> somas(k, {0.0, 0.0, 0.0});
+        std::vector<double> pesos(k, 0.0);
+        std::mutex mutex;
+        tarefas::padrao().paraleloPara(0, h.indices.size(), 512, [&](size_t e0, size_t e1) {
+            std::vector<std::array<double, 3>> s(k, {0.0, 0.0, 0.0});
+            std::vector<double> p(k, 0.0);
+            for (size_t e = e0; e < e1; ++e) {
+                int j = detalhe::maisProxima(centros, h.medias[e]);
+                for (int c = 0; c < 3; ++c)
+                    s[j][c] += double(h.pixels[e]) * h.medias[e][c];
+                p[j] += h.pixels[e];
+            }
+            std::lock_guard<std::mutex> trava(mutex);
+            for (size_t j = 0; j < k; ++j) {
+                pesos[j] += p[j];
+                for (int c = 0; c < 3; ++c)
+                    somas[j][c] += s[j][c];
+            }
+        });
+        for (size_t j = 0; j < k; ++j)
+            if (pesos[j] > 0) // Centro sem pixels fica onde está
+                for (int c = 0; c < 3; ++c)
+                    centros[j][c] = float(somas[j][c] / pesos[j]);
+    }
+
+    Paleta cores;
+    for (const std::array<float, 3>& c : centros)
+        cores.push_back(detalhe::srgb(c));
+    return cores;
+}
+
+// Troca cada pixel pelo índice da cor mais próxima da paleta; com difusaoErro, espalha
+// a diferença de luz para os vizinhos (serpentina, como cor::paraSRGB)
+inline ImagemIndexada quantizar(const imagem::Imagem& img, const Paleta& cores, bool difusaoErro = false) {
+    detalhe::exigirRGB(img);
+    detalhe::exigirPaleta(cores);
+    std::vector<std::array<float, 3>> lineares;
+    for (const Cor& c : cores)
+        lineares.push_back(detalhe::linear(c));
+
+    // Cor mais próxima do centro de cada caixa do histograma
+    std::vector<uint8_t> tabela(detalhe::CAIXAS);
+    tarefas::padrao().paraleloPara(0, size_t(detalhe::CAIXAS), 1024, [&](size_t k0, size_t k1) {
+        for (size_t k = k0; k < k1; ++k) {
+            uint8_t centro[3] = {uint8_t((k >> 10 & 31) << 3 | 4), uint8_t((k >> 5 & 31) << 3 | 4), uint8_t((k & 31) << 3 | 4)};
+            tabela[k] = uint8_t(detalhe::maisProxima(lineares, detalhe::linear({centro[0], centro[1], centro[2]})));
+        }
+    });
+
+    ImagemIndexada saida{img.largura, img.altura, std::vector<uint8_t>(size_t(img.largura) * img.altura), cores};
+    if (!difusaoErro) {
+        tarefas::padrao().paraleloPara(0, saida.indices.size(), 1 << 16, [&](size_t i0, size_t i1) {
+            const uint8_t* t = tabela.data();
+            const uint8_t* p = img.pixels.data();
+            uint8_t* destino = saida.indices.data();
+            for (size_t i = i0; i < i1; ++i)
+                destino[i] = t[detalhe::caixa(p + 3 * i)];
+        });
+        return saida;
+    }
+
+    const int largura = img.largura;
+    std::vector<std::array<float, 3>> erroAtual(size_t(largura) + 2, {0, 0, 0}), erroSeguinte(erroAtual.size(), {0, 0, 0});
+    for (int y = 0; y < img.altura; ++y) {
+        const bool direita = (y & 1) == 0;
+        const int passo = direita ? 1 : -1;
+        std::fill(erroSeguinte.begin(), erroSeguinte.end(), std::array<float, 3>{0, 0, 0});
+        for (int k = 0; k < largura; ++k) {
+            int x = direita ? k : largura - 1 - k;
+            size_t i = size_t(x) + 1;
+            const uint8_t* p = img.pixel(x, y);
+            std::array<float, 3> desejado;
+            uint8_t aproximado[3];
+            for (int c = 0; c < 3; ++c) {
+                desejado[c] = cor::deSRGB(p[c]) + erroAtual[i][c];
+                aproximado[c] = cor::paraSRGB(desejado[c]);
+            }
+            uint8_t j = tabela[detalhe::caixa(aproximado)];
+            saida.indices[size_t(y) * largura + x] = j;
+            for (int c = 0; c < 3; ++c) {
+                float erro = desejado[c] - lineares[j][c];
+                erroAtual[i + passo][c] += erro * (7.0f / 16.0f);
+                erroSeguinte[i - passo][c] += erro * (3.0f / 16.0f);
+                erroSeguinte[i][c] += erro * (5.0f / 16.0f);
+                erroSeguinte[i + passo][c] += erro * (1.0f / 16.0f);
+            }
+        }
+        std::swap(erroAtual, erroSeguinte);
+    }
+    return saida;
+}
+
+inline imagem::Imagem expandir(const ImagemIndexada& indexada) {
+    imagem::Imagem img(indexada.largura, indexada.altura, 3);
+    for (size_t i = 0; i < indexada.indices.size(); ++i) {
+        const Cor& c = indexada.cores[indexada.indices[i]];
+        std::copy(c.begin(), c.end(), &img.pixels[i * 3]);
+    }
+    return img;
+}
+
+} // namespace paleta
@@ -0,0 +1,422 @@
+// Codificação e decodificação de PNG (8 bits, cinza/RGB/RGBA, sem entrelaçamento) com zlib
+//
+// A codificação é paralela nas duas etapas (tarefas::padrao()):
+//   1. Filtragem: cada linha escolhe um dos 5 filtros do PNG pela heurística da menor
+//      soma dos resíduos em módulo (a do libpng), calculando o custo dos 5 em uma só
+//      passada vetorizada (simd::i16x8) sem gravar nada, e só então grava a linha com o
+//      filtro escolhido.
+//   2. Deflate: os dados filtrados são divididos em blocos de linhas comprimidos ao mesmo
+//      tempo, cada um em um fluxo deflate "cru" terminado com Z_SYNC_FLUSH (fronteira de
+//      byte, sem marcar o fim), como o pigz. Cada bloco usa os 32 KB anteriores como
+//      dicionário, então a compressão quase não piora. Os Adler-32 dos blocos são
+//      combinados com adler32_combine e cada bloco vira um chunk IDAT com CRC próprio.
+// O arquivo é um PNG comum, lido por qualquer decodificador.
+//
+// Compilar com -lz (e -pthread).
+//
+//   png::escrever("quadro.png", quadro);                    // Nível 6, Z_RLE, filtro adaptativo
+//   png::Opcoes menor; menor.nivel = 9; menor.estrategia = Z_DEFAULT_STRATEGY;
+//   std::vector<uint8_t> bytes = png::codificar(quadro, menor);
+//   imagem::Imagem lida = png::ler("quadro.png");          // 1, 2, 3 ou 4 canais, como no arquivo
+#pragma once
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "imagem.hpp"
+#include "simd.hpp"
+#include "tarefas.hpp"
+
+namespace png {
+
+enum Filtro : uint8_t { NENHUM = 0, SUB = 1, CIMA = 2, MEDIA = 3, PAETH = 4, ADAPTATIVO = 5 };
+
+struct Opcoes {
+    int nivel = 6;                     // Nível do zlib, 0 a 9
+    Filtro filtro = ADAPTATIVO;        // Ou um filtro fixo para todas as linhas
+    size_t bytesPorBloco = 512 << 10;  // Dados filtrados por bloco do deflate paralelo (arredondado para linhas inteiras)
+    // Z_RLE só procura repetições à distância 1, que é o que sobra depois dos filtros:
+    // em quadros renderizados fica 3-5% maior que Z_DEFAULT_STRATEGY e codifica ~8x mais rápido
+    int estrategia = Z_RLE;
+};
+
+namespace detalhe {
+
+const uint8_t ASSINATURA[8] = {137, 'P', 'N', 'G', '\r', '\n', 26, '\n'};
+const size_t DICIONARIO = 32768; // Janela do deflate
+
+inline void escreverU32(uint8_t* p, uint32_t v) {
+    p[0] = uint8_t(v >> 24);
+    p[1] = uint8_t(v >> 16);
+    p[2] = uint8_t(v >> 8);
+    p[3] = uint8_t(v);
+}
+
+inline uint32_t lerU32(const uint8_t* p) { return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | p[3]; }
+
+// Acrescenta um chunk completo (tamanho, tipo, dados, CRC)
+inline void escreverChunk(std::vector<uint8_t>& saida, const char* tipo, const uint8_t* dados, size_t n) {
+    size_t inicio = saida.size();
+    saida.resize(inicio + 12 + n);
+    uint8_t* p = saida.data() + inicio;
+    escreverU32(p, uint32_t(n));
+    std::memcpy(p + 4, tipo, 4);
+    if (n > 0)
+        std::memcpy(p + 8, dados, n);
+    escreverU32(p + 8 + n, uint32_t(crc32(0, p + 4, uInt(n + 4))));
+}
+
+// Preditor de Paeth sem desvios: a, b, c são o byte à esquerda, acima e acima à esquerda
+inline uint8_t paeth(int a, int b, int c) {
+    int pa = std::abs(b - c), pb = std::abs(a - c), pc = std::abs(a + b - 2 * c);
+    int bc = pb <= pc ? b : c;
+    return uint8_t(pa <= pb && pa <= pc ? a : bc);
+}
+
+// Custo de um resíduo: módulo do byte visto como inteiro com sinal
+inline uint32_t custo(uint8_t r) { return uint32_t(std::abs(int(int8_t(r)))); }
+
+// Os 4 preditores para 8 bytes seguidos (PNG, seção 9.2), em 16 bits para as somas não
+// estourarem; a, b, c como em paeth()
+inline simd::i16x8 predizerMedia(simd::i16x8 a, simd::i16x8 b) { return simd::deslocarDireita(a + b, 1); }
+
+inline simd::i16x8 predizerPaeth(simd::i16x8 a, simd::i16x8 b, simd::i16x8 c) {
+    using namespace simd;
+    i16x8 pa = modulo(b - c), pb = modulo(a - c), pc = modulo(a + b - c - c);
+    i16x8 bc = selecionar(mascaraMaior(pb, pc), c, b);
+    return selecionar(mascaraMaior(pa, pb) | mascaraMaior(pa, pc), bc, a);
+}
+
+// Custo de 8 resíduos x - predição: o byte do resíduo visto com sinal, em módulo (0 a 128)
+inline simd::i16x8 custo8(simd::i16x8 x, simd::i16x8 predicao) {
+    using namespace simd;
+    i16x8 r = (x - predicao) & difundir16(0xFF);
+    return minimo(r, difundir16(256) - r);
+}
+
+// Escolhe o filtro da linha pela menor soma de resíduos. Os preditores só dependem da
+// linha original, não dos resíduos, então os 5 custos saem de uma só passada de 8 bytes
+// por vez, sem gravar nada.
+inline Filtro escolherFiltro(const uint8_t* linha, const uint8_t* anterior, size_t n, int bpp) {
+    using namespace simd;
+    uint32_t soma[5] = {};
+    const size_t passo = std::min(size_t(bpp), n); // Locais: veja filtros::paraCinza()
+    for (size_t i = 0; i < passo; ++i) { // Primeiro pixel: a = c = 0
+        uint8_t x = linha[i], b = anterior[i];
+        soma[NENHUM] += custo(x);
+        soma[SUB] += custo(x);
+        soma[CIMA] += custo(uint8_t(x - b));
+        soma[MEDIA] += custo(uint8_t(x - (b >> 1)));
+        soma[PAETH] += custo(uint8_t(x - b)); // Paeth(0, b, 0) = b
+    }
+    // Cada parcela de 16 bits recebe no máximo 128 por iteração: esvazia a cada 255
+    i16x8 parcial[5];
+    size_t i = passo;
+    while (i + 8 <= n) {
+        for (i16x8& p : parcial)
+            p = difundir16(0);
+        size_t fimLote = std::min(n - 8, i + 255 * 8 - 8) + 1; // i < fimLote: 8 bytes dentro da linha
+        for (; i < fimLote; i += 8) {
+            i16x8 x = expandirBytes(linha + i), a = expandirBytes(linha + i - passo);
+            i16x8 b = expandirBytes(anterior + i), c = expandirBytes(anterior + i - passo);
+            parcial[NENHUM] = parcial[NENHUM] + custo8(x, difundir16(0));
+            parcial[SUB] = parcial[SUB] + custo8(x, a);
+            parcial[CIMA] = parcial[CIMA] + custo8(x, b);
+            parcial[MEDIA] = parcial[MEDIA] + custo8(x, predizerMedia(a, b));
+            parcial[PAETH] = parcial[PAETH] + custo8(x, predizerPaeth(a, b, c));
+        }
+        for (int f = 0; f < 5; ++f)
+            soma[f] += uint32_t(somaHorizontal(parcial[f]));
+    }
+    for (; i < n; ++i) { // Sobra do fim da linha
+        uint8_t x = linha[i], a = linha[i - passo], b = anterior[i], c = anterior[i - passo];
+        soma[NENHUM] += custo(x);
+        soma[SUB] += custo(uint8_t(x - a));
+        soma[CIMA] += custo(uint8_t(x - b));
+        soma[MEDIA] += custo(uint8_t(x - ((a + b) >> 1)));
+        soma[PAETH] += custo(uint8_t(x - paeth(a, b, c)));
+    }
+    // Empates ficam com o filtro mais simples (a ordem do libpng)
+    Filtro melhor = NENHUM;
+    for (int f = SUB; f <= PAETH; ++f)
+        if (soma[f] < soma[melhor])
+            melhor = Filtro(f);
+    return melhor;
+}
+
+// Grava linha - predição; predizer(a, b, c) recebe 8 bytes de cada vizinho e
+// predizerEscalar(a, b, c) um só, para o primeiro pixel (a = c = 0) e a sobra do fim
+template <typename Predizer, typename PredizerEscalar>
+void filtrarCom(const uint8_t* linha, const uint8_t* anterior, size_t n, size_t passo, uint8_t* destino, Predizer predizer,
+                PredizerEscalar predizerEscalar) {
+    for (size_t i = 0; i < passo; ++i)
+        destino[i] = uint8_t(linha[i] - predizerEscalar(0, anterior[i], 0));
+    size_t i = passo;
+    for (; i + 8 <= n; i += 8) {
+        simd::i16x8 x = simd::expandirBytes(linha + i), a = simd::expandirBytes(linha + i - passo);
+        simd::i16x8 b = simd::expandirBytes(anterior + i), c = simd::expandirBytes(anterior + i - passo);
+        simd::compactarBytes(destino + i, x - predizer(a, b, c));
+    }
+    for (; i < n; ++i)
+        destino[i] = uint8_t(linha[i] - predizerEscalar(linha[i - passo], anterior[i], anterior[i - passo]));
+}
+
+inline void filtrar(Filtro f, const uint8_t* linha, const uint8_t* anterior, size_t n, int bpp, uint8_t* destino) {
+    using simd::i16x8;
+    const size_t passo = std::min(size_t(bpp), n);
+    switch (f) {
+    case NENHUM:
+        std::memcpy(destino, linha, n);
+        break;
+    case SUB:
+        filtrarCom(linha, anterior, n, passo, destino, [](i16x8 a, i16x8, i16x8) { return a; }, [](int a, int, int) { return a; });
+        break;
+    case CIMA:
+        filtrarCom(linha, anterior, n, passo, destino, [](i16x8, i16x8 b, i16x8) { return b; }, [](int, int b, int) { return b; });
+        break;
+    case MEDIA:
+        filtrarCom(linha, anterior, n, passo, destino, [](i16x8 a, i16x8 b, i16x8) { return predizerMedia(a, b); },
+                   [](int a, int b, int) { return (a + b) >> 1; });
+        break;
+    default:
+        filtrarCom(linha, anterior, n, passo, destino, predizerPaeth, paeth);
+        break;
+    }
+}
+
+// Inverso de filtrar(), no lugar; "anterior" já está desfiltrada
+inline void desfiltrar(uint8_t f, uint8_t* linha, const uint8_t* anterior, size_t n, int bpp) {
+    const size_t passo = size_t(bpp);
+    const size_t inicio = std::min(passo, n);
+    switch (f) {
+    case NENHUM:
+        break;
+    case SUB:
+        for (size_t i = passo; i < n; ++i)
+            linha[i] = uint8_t(linha[i] + linha[i - passo]);
+        break;
+    case CIMA:
+        for (size_t i = 0; i < n; ++i)
+            linha[i] = uint8_t(linha[i] + anterior[i]);
+        break;
+    case MEDIA:
+        for (size_t i = 0; i < inicio; ++i)
+            linha[i] = uint8_t(linha[i] + (anterior[i] >> 1));
+        for (size_t i = passo; i < n; ++i)
+            linha[i] = uint8_t(linha[i] + ((linha[i - passo] + anterior[i]) >> 1));
+        break;
+    case PAETH:
+        for (size_t i = 0; i < inicio; ++i)
+            linha[i] = uint8_t(linha[i] + anterior[i]);
+        for (size_t i = passo; i < n; ++i)
+            linha[i] = uint8_t(linha[i] + paeth(linha[i - passo], anterior[i], anterior[i - passo]));
+        break;
+    default:
+        throw std::runtime_error("PNG com filtro de linha inválido");
+    }
+}
+
+// Comprime um bloco em deflate cru; "ultimo" fecha o fluxo, os demais terminam em Z_SYNC_FLUSH
+inline std::vector<uint8_t> comprimirBloco(const uint8_t* dados, size_t n, const uint8_t* dicionario, size_t tamanhoDicionario,
+                                           const Opcoes& opcoes, bool ultimo) {
+    z_stream z{};
+    if (deflateInit2(&z, opcoes.nivel, Z_DEFLATED, -15, 8, opcoes.estrategia) != Z_OK)
+        throw std::runtime_error("deflateInit2 falhou");
+    if (tamanhoDicionario > 0)
+        deflateSetDictionary(&z, dicionario, uInt(tamanhoDicionario));
+    std::vector<uint8_t> saida(deflateBound(&z, uLong(n)) + 16); // + marcador do Z_SYNC_FLUSH
+    z.next_in = const_cast<Bytef*>(dados);
+    z.avail_in = uInt(n);
+    int resultado;
+    do {
+        if (z.total_out == saida.size())
+            saida.resize(saida.size() * 2);
+        z.next_out = saida.data() + z.total_out;
+        z.avail_out = uInt(saida.size() - z.total_out);
+        resultado = deflate(&z, ultimo ? Z_FINISH : Z_SYNC_FLUSH);
+    } while (resultado != Z_STREAM_ERROR && (ultimo ? resultado != Z_STREAM_END : z.avail_out == 0));
+    saida.resize(z.total_out);
+    deflateEnd(&z);
+    if (resultado == Z_STREAM_ERROR)
+        throw std::runtime_error("deflate falhou");
+    return saida;
+}
+
+} // namespace detalhe
+
+// Heurística direta do libpng, para conferir escolherFiltro(): filtra a linha com os 5
+// filtros em buffers separados e soma cada um
+namespace referencia {
+
+inline Filtro escolherFiltro(const uint8_t* linha, const uint8_t* anterior, size_t n, int bpp) {
+    std::vector<uint8_t> candidato(n);
+    Filtro melhor = NENHUM;
+    uint64_t menor = ~uint64_t(0);
+    for (int f = NENHUM; f <= PAETH; ++f) {
+        detalhe::filtrar(Filtro(f), linha, anterior, n, bpp, candidato.data());
+        uint64_t soma = 0;
+        for (uint8_t r : candidato)
+            soma += detalhe::custo(r);
+        if (soma < menor) {
+            menor = soma;
+            melhor = Filtro(f);
+        }
+    }
+    return melhor;
+}
+
+} // namespace referencia
+
+// Arquivo PNG completo em memória. Aceita 1 (cinza), 2 (cinza e alfa), 3 (RGB) ou 4 (RGBA) canais.
+inline std::vector<uint8_t> codificar(const imagem::Imagem& img, const Opcoes& opcoes = Opcoes()) {
+    using namespace detalhe;
+    static const uint8_t tipoCor[5] = {0, 0, 4, 2, 6};
+    if (img.canais < 1 || img.canais > 4 || img.largura <= 0 || img.altura <= 0)
+        throw std::invalid_argument("PNG codifica imagens não vazias com 1 a 4 canais");
+    if (opcoes.nivel < 0 || opcoes.nivel > 9 || opcoes.filtro > ADAPTATIVO)
+        throw std::invalid_argument("Opções de PNG inválidas");
+
+    // 1. Filtragem, uma linha por vez em cada trabalhador: byte do filtro + resíduos
+    const size_t n = img.bytesPorLinha(), linhaFiltrada = n + 1;
+    std::vector<uint8_t> filtrados(linhaFiltrada * img.altura);
+    const std::vector<uint8_t> zeros(n, 0);
+    tarefas::padrao().paraleloPara(0, size_t(img.altura), 64, [&](size_t y0, size_t y1) {
+        const int bpp = img.canais;
+        const Filtro fixo = opcoes.filtro;
+        for (size_t y = y0; y < y1; ++y) {
+            const uint8_t* linha = img.linha(int(y));
+            const uint8_t* anterior = y > 0 ? img.linha(int(y) - 1) : zeros.data();
+            Filtro f = fixo == ADAPTATIVO ? escolherFiltro(linha, anterior, n, bpp) : fixo;
+            uint8_t* destino = &filtrados[y * linhaFiltrada];
+            destino[0] = f;
+            filtrar(f, linha, anterior, n, bpp, destino + 1);
+        }
+    });
+
+    // 2. Deflate paralelo por blocos de linhas inteiras
+    const size_t linhasPorBloco = std::max<size_t>(1, opcoes.bytesPorBloco / linhaFiltrada);
+    const size_t numeroBlocos = (size_t(img.altura) + linhasPorBloco - 1) / linhasPorBloco;
+    std::vector<std::vector<uint8_t>> blocos(numeroBlocos);
+    std::vector<uLong> adlers(numeroBlocos);
+    tarefas::padrao().paraleloPara(0, numeroBlocos, 1, [&](size_t b0, size_t b1) {
+        for (size_t b = b0; b < b1; ++b) {
+            size_t inicio = b * linhasPorBloco * linhaFiltrada;
+            size_t fim = std::min(filtrados.size(), inicio + linhasPorBloco * linhaFiltrada);
+            size_t dicionario = std::min(inicio, DICIONARIO);
+            blocos[b] = comprimirBloco(&filtrados[inicio], fim - inicio, &filtrados[inicio - dicionario], dicionario, opcoes,
+                                       b + 1 == numeroBlocos);
+            adlers[b] = adler32(adler32(0, nullptr, 0), &filtrados[inicio], uInt(fim - inicio));
+        }
+    });
+    uLong adler = adlers[0];
+    for (size_t b = 1; b < numeroBlocos; ++b) {
+        size_t tamanho = std::min(filtrados.size() - b * linhasPorBloco * linhaFiltrada, linhasPorBloco * linhaFiltrada);
+        adler = adler32_combine(adler, adlers[b], z_off_t(tamanho));
+    }
+
+    // Cabeçalho zlib (janela de 32 KB, nível indicado em FLEVEL) no primeiro IDAT e Adler-32 no último
+    const uint8_t nivelZlib = opcoes.nivel < 2 ? 0 : opcoes.nivel < 6 ? 1 : opcoes.nivel == 6 ? 2 : 3;
+    uint8_t cabecalhoZlib[2] = {0x78, uint8_t(nivelZlib << 6)};
+    cabecalhoZlib[1] = uint8_t(cabecalhoZlib[1] + 31 - (cabecalhoZlib[0] * 256 + cabecalhoZlib[1]) % 31);
+    blocos.front().insert(blocos.front().begin(), cabecalhoZlib, cabecalhoZlib + 2);
+    uint8_t final[4];
+    escreverU32(final, uint32_t(adler));
+    blocos.back().insert(blocos.back().end(), final, final + 4);
+
+    size_t total = 8 + 25 + 12;
+    for (const std::vector<uint8_t>& bloco : blocos)
+        total += bloco.size() + 12;
+    std::vector<uint8_t> saida;
+    saida.reserve(total);
+    saida.insert(saida.end(), ASSINATURA, ASSINATURA + 8);
+    uint8_t cabecalho[13];
+    escreverU32(cabecalho, uint32_t(img.largura));
+    escreverU32(cabecalho + 4, uint32_t(img.altura));
+    cabecalho[8] = 8;                     // Bits por canal
+    cabecalho[9] = tipoCor[img.canais];
+    cabecalho[10] = cabecalho[11] = cabecalho[12] = 0; // Deflate, filtros padrão, sem entrelaçamento
+    escreverChunk(saida, "IHDR", cabecalho, 13);
+    for (const std::vector<uint8_t>& bloco : blocos)
+        escreverChunk(saida, "IDAT", bloco.data(), bloco.size());
+    escreverChunk(saida, "IEND", nullptr, 0);
+    return saida;
+}
+
+// PNG de 8 bits sem entrelaçamento e sem paleta; a imagem sai com os canais do arquivo
+inline imagem::Imagem decodificar(const uint8_t* dados, size_t tamanho) {
+    using namespace detalhe;
+    if (tamanho < 8 || std::memcmp(dados, ASSINATURA, 8) != 0)
+        throw std::runtime_error("Dados não são uma imagem PNG");
+    int largura = 0, altura = 0, canais = 0;
+    std::vector<uint8_t> comprimidos;
+    for (size_t p = 8; p + 12 <= tamanho;) {
+        uint32_t n = lerU32(dados + p);
+        if (n > tamanho - p - 12)
+            throw std::runtime_error("PNG truncado");
+        const uint8_t* tipo = dados + p + 4;
+        const uint8_t* conteudo = dados + p + 8;
+        if (lerU32(conteudo + n) != uint32_t(crc32(0, tipo, n + 4)))
+            throw std::runtime_error("PNG com CRC errado");
+        if (std::memcmp(tipo, "IHDR", 4) == 0) {
+            if (n != 13 || conteudo[8] != 8 || conteudo[12] != 0)
+                throw std::runtime_error("Só PNGs de 8 bits por canal sem entrelaçamento são suportados");
+            static const int canaisPorTipo[7] = {1, 0, 3, 0, 2, 0, 4};
+            largura = int(lerU32(conteudo));
+            altura = int(lerU32(conteudo + 4));
+            canais = conteudo[9] < 7 ? canaisPorTipo[conteudo[9]] : 0;
+            if (canais == 0)
+                throw std::runtime_error("PNG com paleta ou tipo de cor desconhecido");
+        } else if (std::memcmp(tipo, "IDAT", 4) == 0) {
+            comprimidos.insert(comprimidos.end(), conteudo, conteudo + n);
+        } else if (std::memcmp(tipo, "IEND", 4) == 0) {
+            break;
+        }
+        p += 12 + n;
+    }
+    if (largura <= 0 || altura <= 0)
+        throw std::runtime_error("PNG sem cabeçalho");
+
+    imagem::Imagem img(largura, altura, canais);
+    const size_t linha = img.bytesPorLinha();
+    std::vector<uint8_t> filtrados((linha + 1) * altura);
+    uLongf descomprimidos = uLongf(filtrados.size());
+    if (uncompress(filtrados.data(), &descomprimidos, comprimidos.data(), uLong(comprimidos.size())) != Z_OK ||
+        descomprimidos != filtrados.size())
+        throw std::runtime_error("Dados comprimidos do PNG inválidos");
+    const std::vector<uint8_t> zeros(linha, 0);
+    for (int y = 0; y < altura; ++y) {
+        uint8_t* destino = img.linha(y);
+        std::memcpy(destino, &filtrados[y * (linha + 1) + 1], linha);
+        desfiltrar(filtrados[y * (linha + 1)], destino, y > 0 ? img.linha(y - 1) : zeros.data(), linha, canais);
+    }
+    return img;
+}
+
+inline void escrever(const std::string& caminho, const imagem::Imagem& img, const Opcoes& opcoes = Opcoes()) {
+    std::vector<uint8_t> dados = codificar(img, opcoes);
+    std::ofstream saida(caminho, std::ios::binary);
+    if (!saida)
+        throw std::runtime_error("Não foi possível abrir " + caminho + " para escrita");
+    saida.write(reinterpret_cast<const char*>(dados.data()), static_cast<std::streamsize>(dados.size()));
+    if (!saida)
+        throw std::runtime_error("Falha ao escrever " + caminho);
+}
+
+inline imagem::Imagem ler(const std::string& caminho) {
+    std::ifstream entrada(caminho, std::ios::binary);
+    if (!entrada)
+        throw std::runtime_error("Não foi possível abrir " + caminho);
+    std::vector<uint8_t> dados((std::istreambuf_iterator<char>(entrada)), std::istreambuf_iterator<char>());
+    return decodificar(dados.data(), dados.size());
+}
+
+} // namespace png
@@ -0,0 +1,198 @@
+// Codificação e decodificação de imagens QOI ("Quite OK Image", qoiformat.org)
+//
+// Compressão sem perdas em uma passada, sem entropia: cada pixel vira uma repetição
+// do anterior, um índice em uma tabela de 64 cores vistas, uma diferença pequena para o
+// anterior ou a cor literal. Comprime menos que PNG, mas codifica muitas vezes mais
+// rápido, sem dependências; bom para quadros intermediários. QOI só guarda RGB e RGBA:
+// imagens em cinza são gravadas como RGB (ler() devolve 3 canais).
+//
+//   qoi::escrever("quadro.qoi", quadro);
+//   imagem::Imagem lida = qoi::ler("quadro.qoi");
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "imagem.hpp"
+
+namespace qoi {
+
+namespace detalhe {
+
+enum : uint8_t {
+    OP_INDICE = 0x00,     // 00xxxxxx
+    OP_DIFERENCA = 0x40,  // 01xxxxxx
+    OP_LUMA = 0x80,       // 10xxxxxx
+    OP_REPETICAO = 0xc0,  // 11xxxxxx
+    OP_RGB = 0xfe,
+    OP_RGBA = 0xff,
+    MASCARA = 0xc0
+};
+
+const uint8_t FINAL[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+
+inline int hash(uint8_t r, uint8_t g, uint8_t b, uint8_t a) { return (r * 3 + g * 5 + b * 7 + a * 11) & 63; }
+
+inline void escreverU32(std::vector<uint8_t>& saida, uint32_t v) {
+    uint8_t b[4] = {uint8_t(v >> 24), uint8_t(v >> 16), uint8_t(v >> 8), uint8_t(v)};
+    saida.insert(saida.end(), b, b + 4);
+}
+
+inline uint32_t lerU32(const uint8_t* p) { return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | p[3]; }
+
+} // namespace detalhe
+
+// Arquivo QOI completo (cabeçalho, dados e marcador final) em memória
+inline std::vector<uint8_t> codificar(const imagem::Imagem& img) {
+    using namespace detalhe;
+    if (img.canais != 1 && img.canais != 3 && img.canais != 4)
+        throw std::invalid_argument("QOI codifica imagens com 1 (como RGB), 3 ou 4 canais");
+    const int canais = img.canais == 4 ? 4 : 3;
+    const size_t n = size_t(img.largura) * img.altura;
+    std::vector<uint8_t> saida;
+    saida.reserve(14 + n * (canais + 1) + 8); // Pior caso: todo pixel literal
+    saida.insert(saida.end(), {'q', 'o', 'i', 'f'});
+    escreverU32(saida, uint32_t(img.largura));
+    escreverU32(saida, uint32_t(img.altura));
+    saida.push_back(uint8_t(canais));
+    saida.push_back(0); // sRGB com alfa linear
+
+    // Escreve direto no buffer reservado (push_back por byte custaria tanto quanto a codificação)
+    size_t inicio = saida.size();
+    saida.resize(saida.capacity());
+    uint8_t* destino = saida.data() + inicio;
+    uint8_t vistos[64][4] = {};
+    uint8_t anterior[4] = {0, 0, 0, 255};
+    int repeticao = 0;
+    const uint8_t* p = img.pixels.data();
+    const int passo = img.canais;
+    for (size_t i = 0; i < n; ++i, p += passo) {
+        uint8_t r = p[0], g = passo == 1 ? p[0] : p[1], b = passo == 1 ? p[0] : p[2], a = passo == 4 ? p[3] : 255;
+        if (r == anterior[0] && g == anterior[1] && b == anterior[2] && a == anterior[3]) {
+            if (++repeticao == 62 || i + 1 == n) {
+                *destino++ = uint8_t(OP_REPETICAO | (repeticao - 1));
+                repeticao = 0;
+            }
+            continue;
+        }
+        if (repeticao > 0) {
+            *destino++ = uint8_t(OP_REPETICAO | (repeticao - 1));
+            repeticao = 0;
+        }
+        int h = hash(r, g, b, a);
+        if (vistos[h][0] == r && vistos[h][1] == g && vistos[h][2] == b && vistos[h][3] == a) {
+            *destino++ = uint8_t(OP_INDICE | h);
+        } else {
+            vistos[h][0] = r;
+            vistos[h][1] = g;
+            vistos[h][2] = b;
+            vistos[h][3] = a;
+            if (a == anterior[3]) {
+                // Diferenças com aritmética de 8 bits (255 -> 0 é +1)
+                int dr = int8_t(r - anterior[0]), dg = int8_t(g - anterior[1]), db = int8_t(b - anterior[2]);
+                int drg = dr - dg, dbg = db - dg;
+                if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                    *destino++ = uint8_t(OP_DIFERENCA | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+                } else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7) {
+                    *destino++ = uint8_t(OP_LUMA | (dg + 32));
+                    *destino++ = uint8_t((drg + 8) << 4 | (dbg + 8));
+                } else {
+                    *destino++ = OP_RGB;
+                    *destino++ = r;
+                    *destino++ = g;
+                    *destino++ = b;
+                }
+            } else {
+                *destino++ = OP_RGBA;
+                *destino++ = r;
+                *destino++ = g;
+                *destino++ = b;
+                *destino++ = a;
+            }
+        }
+        anterior[0] = r;
+        anterior[1] = g;
+        anterior[2] = b;
+        anterior[3] = a;
+    }
+    std::memcpy(destino, FINAL, 8);
+    saida.resize(size_t(destino + 8 - saida.data()));
+    saida.shrink_to_fit();
+    return saida;
+}
+
+inline imagem::Imagem decodificar(const uint8_t* dados, size_t tamanho) {
+    using namespace detalhe;
+    if (tamanho < 14 + 8 || std::memcmp(dados, "qoif", 4) != 0)
+        throw std::runtime_error("Dados não são uma imagem QOI");
+    int largura = int(lerU32(dados + 4)), altura = int(lerU32(dados + 8)), canais = dados[12];
+    if (largura <= 0 || altura <= 0 || (canais != 3 && canais != 4) || uint64_t(largura) * altura > (uint64_t(1) << 32))
+        throw std::runtime_error("Cabeçalho QOI inválido");
+    imagem::Imagem img(largura, altura, canais);
+    uint8_t vistos[64][4] = {};
+    uint8_t px[4] = {0, 0, 0, 255};
+    const uint8_t* p = dados + 14;
+    const uint8_t* fim = dados + tamanho - 8;
+    int repeticao = 0;
+    uint8_t* destino = img.pixels.data();
+    const size_t n = size_t(largura) * altura;
+    for (size_t i = 0; i < n; ++i, destino += canais) {
+        if (repeticao > 0) {
+            --repeticao;
+        } else {
+            if (p >= fim)
+                throw std::runtime_error("Imagem QOI truncada");
+            uint8_t op = *p++;
+            if (op == OP_RGB || op == OP_RGBA) {
+                int bytes = op == OP_RGB ? 3 : 4;
+                if (fim - p < bytes)
+                    throw std::runtime_error("Imagem QOI truncada");
+                for (int c = 0; c < bytes; ++c)
+                    px[c] = *p++;
+            } else if ((op & MASCARA) == OP_INDICE) {
+                std::memcpy(px, vistos[op], 4);
+            } else if ((op & MASCARA) == OP_DIFERENCA) {
+                px[0] = uint8_t(px[0] + ((op >> 4) & 3) - 2);
+                px[1] = uint8_t(px[1] + ((op >> 2) & 3) - 2);
+                px[2] = uint8_t(px[2] + (op & 3) - 2);
+            } else if ((op & MASCARA) == OP_LUMA) {
+                if (p >= fim)
+                    throw std::runtime_error("Imagem QOI truncada");
+                int dg = (op & 0x3f) - 32, segundo = *p++;
+                px[0] = uint8_t(px[0] + dg - 8 + (segundo >> 4));
+                px[1] = uint8_t(px[1] + dg);
+                px[2] = uint8_t(px[2] + dg - 8 + (segundo & 0x0f));
+            } else {
+                repeticao = op & 0x3f; // Este pixel e mais "repeticao"
+            }
+            std::memcpy(vistos[hash(px[0], px[1], px[2], px[3])], px, 4);
+        }
+        std::memcpy(destino, px, size_t(canais));
+    }
+    return img;
+}
+
+inline void escrever(const std::string& caminho, const imagem::Imagem& img) {
+    std::vector<uint8_t> dados = codificar(img);
+    std::ofstream saida(caminho, std::ios::binary);
+    if (!saida)
+        throw std::runtime_error("Não foi possível abrir " + caminho + " para escrita");
+    saida.write(reinterpret_cast<const char*>(dados.data()), static_cast<std::streamsize>(dados.size()));
+    if (!saida)
+        throw std::runtime_error("Falha ao escrever " + caminho);
+}
+
+inline imagem::Imagem ler(const std::string& caminho) {
+    std::ifstream entrada(caminho, std::ios::binary);
+    if (!entrada)
+        throw std::runtime_error("Não foi possível abrir " + caminho);
+    std::vector<uint8_t> dados((std::istreambuf_iterator<char>(entrada)), std::istreambuf_iterator<char>());
+    return decodificar(dados.data(), dados.size());
+}
+
+} // namespace qoi
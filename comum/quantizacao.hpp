@@ -0,0 +1,248 @@
+// Quantização de malhas para reduzir memória de vídeo e banda de vértices
+//
+// Cada vértice passa de 36 bytes (posição, normal e cor em floats) para 16:
+//   - posição: 3 x uint16 normalizados em relação à caixa envolvente da malha
+//     (o 4º componente só completa o alinhamento). A decodificação é uma escala e
+//     uma translação por eixo, que podem ser incorporadas à matriz de modelo
+//     (matrizDecodificacao), sem custo no shader;
+//   - normal: codificação octaédrica em 2 x int16 normalizados, decodificada no
+//     vertex shader com DECODIFICAR_NORMAL_GLSL (decodificarOctaedrica faz o mesmo na CPU);
+//   - cor: RGBA de 8 bits por canal.
+// Índices sempre em 16 bits: malhas com mais de 65536 vértices são divididas em
+// blocos de triângulos consecutivos, cada um com seus vértices contíguos, desenhados
+// com glDrawElementsBaseVertex (vértices nas bordas dos blocos são repetidos).
+//
+// A matriz de decodificação vale só para posições: a matriz das normais continua
+// sendo a da matriz de modelo original.
+// projecoes/multiprojecoes desenha o bule com estes vértices (a decodificação fica
+// toda no vertex shader).
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "formato_vertice.hpp"
+#include "malha_obj.hpp"
+
+namespace quantizacao {
+
+struct VerticeQuantizado {
+    uint16_t posicao[4];
+    int16_t normal[2];
+    vertice::CorRGBA8 cor;
+};
+static_assert(sizeof(VerticeQuantizado) == 16, "VerticeQuantizado deve ocupar 16 bytes");
+
+struct Bloco {
+    uint32_t primeiroIndice; // Posição do primeiro índice em "indices"
+    uint32_t numeroIndices;
+    uint32_t verticeBase;    // Somado a cada índice do bloco (glDrawElementsBaseVertex)
+};
+
+struct MalhaQuantizada {
+    std::vector<VerticeQuantizado> vertices;
+    std::vector<uint16_t> indices;
+    std::vector<Bloco> blocos;
+    float minimo[3];
+    float extensao[3]; // Tamanho da caixa envolvente em cada eixo
+
+    size_t bytes() const {
+        return vertices.size() * sizeof(VerticeQuantizado) + indices.size() * sizeof(uint16_t);
+    }
+
+    // Matriz (ordem de colunas) que leva a posição normalizada [0, 1]^3 ao espaço do modelo
+    void matrizDecodificacao(float m[16]) const {
+        std::fill(m, m + 16, 0.0f);
+        m[0] = extensao[0]; m[5] = extensao[1]; m[10] = extensao[2];
+        m[12] = minimo[0]; m[13] = minimo[1]; m[14] = minimo[2]; m[15] = 1.0f;
+    }
+};
+
+// Função GLSL para o vertex shader; recebe a entrada "normal" (vec2) já normalizada para [-1, 1]
+inline const char* DECODIFICAR_NORMAL_GLSL = R"(
+vec3 decodificarNormal(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+)";
+
+inline void decodificarOctaedrica(float ex, float ey, float n[3]) {
+    n[0] = ex; n[1] = ey; n[2] = 1.0f - std::fabs(ex) - std::fabs(ey);
+    float t = std::max(-n[2], 0.0f);
+    n[0] += n[0] >= 0.0f ? -t : t;
+    n[1] += n[1] >= 0.0f ? -t : t;
+    malha::normalizar(n);
+}
+
+// Projeta a normal no octaedro |x| + |y| + |z| = 1 e desdobra o hemisfério inferior.
+// Dos 4 arredondamentos possíveis, fica o de menor erro angular.
+inline void codificarOctaedrica(const float n[3], int16_t saida[2]) {
+    float soma = std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]);
+    float x = n[0] / soma, y = n[1] / soma;
+    if (n[2] < 0.0f) {
+        float ox = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        float oy = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = ox; y = oy;
+    }
+    double melhorCosseno = -2.0;
+    for (int i = 0; i < 4; ++i) {
+        float qx = (i & 1 ? std::ceil(x * 32767.0f) : std::floor(x * 32767.0f));
+        float qy = (i & 2 ? std::ceil(y * 32767.0f) : std::floor(y * 32767.0f));
+        qx = std::clamp(qx, -32767.0f, 32767.0f);
+        qy = std::clamp(qy, -32767.0f, 32767.0f);
+        float d[3];
+        decodificarOctaedrica(qx / 32767.0f, qy / 32767.0f, d);
+        double cosseno = double(d[0]) * n[0] + double(d[1]) * n[1] + double(d[2]) * n[2];
+        if (cosseno > melhorCosseno) {
+            melhorCosseno = cosseno;
+            saida[0] = static_cast<int16_t>(qx);
+            saida[1] = static_cast<int16_t>(qy);
+        }
+    }
+}
+
+// "cores" tem 3 floats por vértice em [0, 1]; sem cores, os vértices ficam brancos
+inline MalhaQuantizada quantizar(const malha::Malha& m, const std::vector<float>* cores = nullptr) {
+    MalhaQuantizada q;
+    size_t n = m.numeroVertices();
+    float maximo[3];
+    for (int c = 0; c < 3; ++c) {
+        q.minimo[c] = n ? m.posicoes[c] : 0.0f;
+        maximo[c] = q.minimo[c];
+    }
+    for (size_t v = 0; v < n; ++v)
+        for (int c = 0; c < 3; ++c) {
+            q.minimo[c] = std::min(q.minimo[c], m.posicoes[3 * v + c]);
+            maximo[c] = std::max(maximo[c], m.posicoes[3 * v + c]);
+        }
+    float escala[3];
+    for (int c = 0; c < 3; ++c) {
+        q.extensao[c] = maximo[c] - q.minimo[c];
+        escala[c] = q.extensao[c] > 0.0f ? 65535.0f / q.extensao[c] : 0.0f; // Eixo degenerado: tudo em 0
+    }
+
+    auto codificar = [&](uint32_t v) {
+        VerticeQuantizado saida;
+        for (int c = 0; c < 3; ++c)
+            saida.posicao[c] = static_cast<uint16_t>(std::lround((m.posicoes[3 * size_t(v) + c] - q.minimo[c]) * escala[c]));
+        saida.posicao[3] = 0;
+        codificarOctaedrica(&m.normais[3 * size_t(v)], saida.normal);
+        saida.cor = cores ? vertice::empacotarCor((*cores)[3 * v], (*cores)[3 * v + 1], (*cores)[3 * v + 2])
+                          : vertice::CorRGBA8{255, 255, 255, 255};
+        return saida;
+    };
+
+    q.indices.resize(m.indices.size());
+    if (n <= 65536) {
+        q.vertices.resize(n);
+        for (size_t v = 0; v < n; ++v)
+            q.vertices[v] = codificar(static_cast<uint32_t>(v));
+        std::copy(m.indices.begin(), m.indices.end(), q.indices.begin());
+        q.blocos.push_back({0, static_cast<uint32_t>(m.indices.size()), 0});
+        return q;
+    }
+
+    // Blocos gulosos: um triângulo que traria o bloco acima de 65536 vértices abre outro
+    q.vertices.reserve(n + n / 16);
+    std::vector<uint32_t> blocoDoVertice(n, UINT32_MAX), localDoVertice(n);
+    Bloco bloco = {0, 0, 0};
+    for (size_t t = 0; t < m.indices.size(); t += 3) {
+        uint32_t novos = 0;
+        for (int k = 0; k < 3; ++k)
+            novos += blocoDoVertice[m.indices[t + k]] != q.blocos.size();
+        if (q.vertices.size() - bloco.verticeBase + novos > 65536) {
+            q.blocos.push_back(bloco);
+            bloco = {static_cast<uint32_t>(t), 0, static_cast<uint32_t>(q.vertices.size())};
+        }
+        for (int k = 0; k < 3; ++k) {
+            uint32_t v = m.indices[t + k];
+            if (blocoDoVertice[v] != q.blocos.size()) {
+                blocoDoVertice[v] = static_cast<uint32_t>(q.blocos.size());
+                localDoVertice[v] = static_cast<uint32_t>(q.vertices.size() - bloco.verticeBase);
+                q.vertices.push_back(codificar(v));
+            }
+            q.indices[t + k] = static_cast<uint16_t>(localDoVertice[v]);
+        }
+        bloco.numeroIndices += 3;
+    }
+    q.blocos.push_back(bloco);
+    return q;
+}
+
+struct Erro {
+    double maiorPosicao = 0.0;     // Em unidades do modelo
+    double rmsPosicao = 0.0;
+    double relativoDiagonal = 0.0; // maiorPosicao / diagonal da caixa envolvente
+    double maiorAnguloNormal = 0.0; // Em graus
+    double medioAnguloNormal = 0.0;
+    int maiorCor = 0;              // Em passos de 1/255
+    size_t bytesOriginal = 0;      // Floats para posição, normal e cor, índices de 32 bits
+    size_t bytesQuantizado = 0;
+};
+
+// Compara cada vértice referenciado pelos índices quantizados com o original correspondente
+inline Erro medirErro(const malha::Malha& m, const MalhaQuantizada& q, const std::vector<float>* cores = nullptr) {
+    Erro erro;
+    double somaQuadrados = 0.0, somaAngulos = 0.0;
+    size_t amostras = 0;
+    for (const Bloco& bloco : q.blocos) {
+        for (uint32_t i = bloco.primeiroIndice; i < bloco.primeiroIndice + bloco.numeroIndices; ++i) {
+            size_t v = m.indices[i];
+            const VerticeQuantizado& vq = q.vertices[bloco.verticeBase + q.indices[i]];
+            double distancia2 = 0.0;
+            for (int c = 0; c < 3; ++c) {
+                double decodificado = q.minimo[c] + vq.posicao[c] / 65535.0 * q.extensao[c];
+                double d = decodificado - m.posicoes[3 * v + c];
+                distancia2 += d * d;
+            }
+            somaQuadrados += distancia2;
+            erro.maiorPosicao = std::max(erro.maiorPosicao, std::sqrt(distancia2));
+
+            float normal[3];
+            decodificarOctaedrica(vq.normal[0] / 32767.0f, vq.normal[1] / 32767.0f, normal);
+            const float* o = &m.normais[3 * v];
+            // atan2(|a x b|, a . b) é preciso para ângulos pequenos, ao contrário de acos(a . b)
+            double cx = double(normal[1]) * o[2] - double(normal[2]) * o[1];
+            double cy = double(normal[2]) * o[0] - double(normal[0]) * o[2];
+            double cz = double(normal[0]) * o[1] - double(normal[1]) * o[0];
+            double ponto = double(normal[0]) * o[0] + double(normal[1]) * o[1] + double(normal[2]) * o[2];
+            double angulo = std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), ponto) * 180.0 / 3.14159265358979323846;
+            somaAngulos += angulo;
+            erro.maiorAnguloNormal = std::max(erro.maiorAnguloNormal, angulo);
+
+            if (cores) {
+                const uint8_t canais[3] = {vq.cor.r, vq.cor.g, vq.cor.b};
+                for (int c = 0; c < 3; ++c) {
+                    int diferenca = static_cast<int>(std::lround(std::fabs(canais[c] - (*cores)[3 * v + c] * 255.0f)));
+                    erro.maiorCor = std::max(erro.maiorCor, diferenca);
+                }
+            }
+            amostras++;
+        }
+    }
+    if (amostras) {
+        erro.rmsPosicao = std::sqrt(somaQuadrados / amostras);
+        erro.medioAnguloNormal = somaAngulos / amostras;
+    }
+    double diagonal = std::sqrt(double(q.extensao[0]) * q.extensao[0] + double(q.extensao[1]) * q.extensao[1] +
+                                double(q.extensao[2]) * q.extensao[2]);
+    erro.relativoDiagonal = diagonal > 0.0 ? erro.maiorPosicao / diagonal : 0.0;
+    erro.bytesOriginal = m.numeroVertices() * 9 * sizeof(float) + m.indices.size() * sizeof(uint32_t);
+    erro.bytesQuantizado = q.bytes();
+    return erro;
+}
+
+} // namespace quantizacao
+
+template <>
+struct vertice::Formato<quantizacao::VerticeQuantizado> {
+    static constexpr vertice::Atributo atributos[] = {
+        ATRIBUTO_VERTICE(quantizacao::VerticeQuantizado, posicao, 0),
+        ATRIBUTO_VERTICE(quantizacao::VerticeQuantizado, normal, 1),
+        ATRIBUTO_VERTICE(quantizacao::VerticeQuantizado, cor, 2),
+    };
+};
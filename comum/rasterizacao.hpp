@@ -0,0 +1,507 @@
+// Rasterização com suavização analítica: linhas de Wu e polígonos por área com sinal
+//
+// Coordenadas contínuas: o pixel (x, y) ocupa o quadrado [x, x + 1) x [y, y + 1), com y
+// para baixo (a ordem de imagem::Imagem).
+//  - raster::Cobertura acumula arestas como os rasterizadores de fontes (font-rs,
+//    stb_truetype): cada aresta soma, nas células que cruza, a área com sinal que deixa
+//    à sua direita. A soma de prefixo de uma linha dá a cobertura exata de cada pixel
+//    (enrolamento * área), sem amostras nem ordenação de arestas.
+//  - raster::compor() resolve e compõe em uma passada por linha, só no intervalo de
+//    colunas tocado: copia a cor nos trechos cobertos por inteiro, mistura 8 bytes por
+//    vez com simd::i16x8 nos parciais e deixa o acumulador zerado para a próxima forma.
+//  - raster::linhaWu() desenha linhas de 1 pixel de Xiaolin Wu direto na imagem: é o
+//    caminho mais rápido para traços finos.
+// raster::referencia tem as versões serrilhadas (Bresenham e preenchimento por amostra no
+// centro do pixel) e a área exata de um polígono dentro de um pixel, para conferir.
+// cores_imagens/rasterizacao_benchmark.cpp mede e confere as duas.
+//
+// A mistura é nos bytes sRGB, como a dos rasterizadores 2D comuns: rápida, com bordas um
+// pouco mais escuras que a mistura em luz linear de cor::compor().
+//
+//   raster::Cobertura cobertura(img.largura, img.altura);
+//   raster::disco(cobertura, {128.0f, 128.0f}, 50.0f);
+//   raster::compor(img, cobertura, laranja);
+//   raster::linhaWu(img, {128.0f, 128.0f}, {228.0f, 128.0f}, amarelo);
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "imagem.hpp"
+#include "simd.hpp"
+
+namespace raster {
+
+struct Ponto {
+    float x, y;
+};
+
+// Como o enrolamento vira cobertura: NAO_ZERO preenche onde o contorno dá alguma volta,
+// PAR_IMPAR só onde dá um número ímpar de voltas (furos em polígonos sobrepostos)
+enum Regra { NAO_ZERO, PAR_IMPAR };
+
+// Acumulador de área com sinal do tamanho da imagem
+class Cobertura {
+public:
+    Cobertura(int largura, int altura)
+        : colunas(largura), linhas(altura), passo(largura + 2), acumulado(size_t(largura + 2) * std::max(altura, 0), 0.0f),
+          xMinimo(std::max(altura, 0), largura + 2), xMaximo(std::max(altura, 0), -1), alfa(std::max(largura, 0) + 1) {
+        if (largura <= 0 || altura <= 0)
+            throw std::invalid_argument("A cobertura precisa de largura e altura positivas");
+    }
+
+    int largura() const { return colunas; }
+    int altura() const { return linhas; }
+    bool vazia() const { return yMinimo > yMaximo; }
+
+    // Uma aresta orientada do contorno; a ordem das arestas não importa
+    void aresta(Ponto a, Ponto b) {
+        if (a.y == b.y || !std::isfinite(a.x + a.y + b.x + b.y))
+            return; // Horizontal: não muda a área de nenhuma linha
+        if (std::max(a.y, b.y) <= 0.0f || std::min(a.y, b.y) >= float(linhas))
+            return;
+        // Divide nas travessias de x = 0 e x = largura. Os pedaços de fora ficam presos na
+        // beirada: à esquerda a aresta inteira conta para a linha, à direita não conta
+        float cortes[2];
+        int n = 0;
+        for (float borda : {0.0f, float(colunas)})
+            if ((a.x < borda) != (b.x < borda))
+                cortes[n++] = (borda - a.x) / (b.x - a.x);
+        if (n == 2 && cortes[0] > cortes[1])
+            std::swap(cortes[0], cortes[1]);
+        Ponto anterior = a;
+        for (int i = 0; i < n; ++i) {
+            Ponto p{a.x + cortes[i] * (b.x - a.x), a.y + cortes[i] * (b.y - a.y)};
+            segmento(anterior, p);
+            anterior = p;
+        }
+        segmento(anterior, b);
+    }
+
+    // Contorno fechado (o último ponto liga ao primeiro)
+    void poligono(const Ponto* pontos, size_t n) {
+        for (size_t i = 0; i < n; ++i)
+            aresta(pontos[i], pontos[(i + 1) % n]);
+    }
+    void poligono(const std::vector<Ponto>& pontos) { poligono(pontos.data(), pontos.size()); }
+
+    // Chama f(y, x0, x1, alfa) para cada linha tocada, com a cobertura de 0 a 1 dos pixels
+    // x0 <= x < x1 em alfa[x], e zera o acumulador
+    template <typename Funcao>
+    void resolver(Regra regra, Funcao&& f) {
+        for (int y = yMinimo; y <= yMaximo; ++y) {
+            if (xMinimo[y] > xMaximo[y])
+                continue;
+            float* a = &acumulado[size_t(y) * passo];
+            const int x0 = xMinimo[y], fim = xMaximo[y];
+            int x1 = std::min(fim + 1, colunas);
+            float* saida = alfa.data();
+            const float soma = regra == NAO_ZERO ? somarPrefixos(a, saida, x0, x1, coberturaNaoZero) : somarPrefixos(a, saida, x0, x1, coberturaParImpar);
+            // Sobra enrolamento quando o contorno continua à direita da cobertura (arestas
+            // descartadas, como as que passam à direita de um ladrilho): a cobertura fica
+            // constante até a beirada
+            const float resto = regra == NAO_ZERO ? coberturaNaoZero(soma) : coberturaParImpar(soma);
+            if (resto >= 0.5f / 256.0f && x1 < colunas) {
+                std::fill(saida + x1, saida + colunas, resto);
+                x1 = colunas;
+            }
+            std::fill(a + x0, a + fim + 1, 0.0f);
+            xMinimo[y] = passo;
+            xMaximo[y] = -1;
+            if (x0 < x1)
+                f(y, x0, x1, static_cast<const float*>(saida));
+        }
+        yMinimo = linhas;
+        yMaximo = -1;
+    }
+
+private:
+    static float coberturaNaoZero(float soma) { return std::min(std::fabs(soma), 1.0f); }
+    static float coberturaParImpar(float soma) {
+        float t = std::fabs(soma);
+        t -= 2.0f * std::floor(t * 0.5f); // Enrolamento módulo 2
+        return t > 1.0f ? 2.0f - t : t;
+    }
+
+    // saida[x] = cobrir(a[x0] + ... + a[x]), devolve a soma da linha. Somas parciais de 4 em 4 células: a cadeia de
+    // dependências tem uma adição a cada 4 pixels, não uma por pixel
+    template <typename Cobrir>
+    static float somarPrefixos(const float* a, float* saida, int x0, int x1, Cobrir&& cobrir) {
+        float soma = 0.0f;
+        int x = x0;
+        for (; x + 4 <= x1; x += 4) {
+            const float s1 = a[x] + a[x + 1], s2 = s1 + a[x + 2], s3 = s2 + a[x + 3];
+            saida[x] = cobrir(soma + a[x]);
+            saida[x + 1] = cobrir(soma + s1);
+            saida[x + 2] = cobrir(soma + s2);
+            saida[x + 3] = cobrir(soma + s3);
+            soma += s3;
+        }
+        for (; x < x1; ++x) {
+            soma += a[x];
+            saida[x] = cobrir(soma);
+        }
+        return soma;
+    }
+
+    // Pedaço de aresta; x é preso a [0, largura]
+    void segmento(Ponto p0, Ponto p1) {
+        const float limite = float(colunas);
+        p0.x = std::min(std::max(p0.x, 0.0f), limite);
+        p1.x = std::min(std::max(p1.x, 0.0f), limite);
+        if (p0.y == p1.y)
+            return;
+        float sentido = 1.0f;
+        if (p0.y > p1.y) {
+            std::swap(p0, p1);
+            sentido = -1.0f;
+        }
+        const float dxdy = (p1.x - p0.x) / (p1.y - p0.y);
+        float x = p0.x;
+        if (p0.y < 0.0f)
+            x -= p0.y * dxdy;
+        const int yInicio = std::max(0, int(p0.y)), yFim = std::min(linhas, int(std::ceil(p1.y)));
+        if (yInicio >= yFim)
+            return;
+        yMinimo = std::min(yMinimo, yInicio);
+        yMaximo = std::max(yMaximo, yFim - 1);
+        for (int y = yInicio; y < yFim; ++y) {
+            float* a = &acumulado[size_t(y) * passo];
+            const float dy = std::min(float(y + 1), p1.y) - std::max(float(y), p0.y);
+            const float xProximo = std::min(std::max(x + dxdy * dy, 0.0f), limite);
+            const float d = dy * sentido;
+            const float xa = std::min(x, xProximo), xb = std::max(x, xProximo);
+            const float pisoA = std::floor(xa);
+            const int ia = int(pisoA), ib = int(std::ceil(xb));
+            if (ib <= ia + 1) {
+                // A aresta fica dentro de uma coluna: divide pela posição média
+                const float meio = 0.5f * (x + xProximo) - pisoA;
+                a[ia] += d - d * meio;
+                a[ia + 1] += d * meio;
+            } else {
+                // Atravessa várias colunas: triângulo na primeira, trapézios no meio, triângulo na última
+                const float s = 1.0f / (xb - xa);
+                const float fa = xa - pisoA;
+                const float a0 = 0.5f * s * (1.0f - fa) * (1.0f - fa);
+                const float fb = xb - float(ib) + 1.0f;
+                const float am = 0.5f * s * fb * fb;
+                a[ia] += d * a0;
+                if (ib == ia + 2) {
+                    a[ia + 1] += d * (1.0f - a0 - am);
+                } else {
+                    const float a1 = s * (1.5f - fa);
+                    a[ia + 1] += d * (a1 - a0);
+                    for (int i = ia + 2; i < ib - 1; ++i)
+                        a[i] += d * s;
+                    const float a2 = a1 + float(ib - ia - 3) * s;
+                    a[ib - 1] += d * (1.0f - a2 - am);
+                }
+                a[ib] += d * am;
+            }
+            xMinimo[y] = std::min(xMinimo[y], ia);
+            xMaximo[y] = std::max(xMaximo[y], std::max(ib, ia + 1));
+            x = xProximo;
+        }
+    }
+
+    int colunas, linhas, passo;         // passo = largura + 2: as arestas na beirada direita escrevem na coluna "largura"
+    std::vector<float> acumulado;       // passo * altura
+    std::vector<int> xMinimo, xMaximo;  // Colunas tocadas em cada linha
+    int yMinimo = 1 << 30, yMaximo = -1;
+    std::vector<float> alfa;            // Linha resolvida
+};
+
+namespace detalhe {
+
+inline void exigirMesmoTamanho(const imagem::Imagem& img, const Cobertura& cobertura) {
+    if (img.largura != cobertura.largura() || img.altura != cobertura.altura())
+        throw std::invalid_argument("A cobertura e a imagem precisam ter o mesmo tamanho");
+}
+
+// Mistura um byte com peso de 0 a 256
+inline uint8_t misturar(uint8_t destino, uint8_t cor, int peso) {
+    return static_cast<uint8_t>((destino * (256 - peso) + cor * peso + 128) >> 8);
+}
+
+// Cor repetida nos formatos que comporLinha() usa, preparada uma vez por forma
+struct Pincel {
+    int canais;
+    // Um bloco de 8 bytes começando no byte 8k usa mistura + 8k mod 24, que está sempre na
+    // fase certa para 1 a 4 canais; o preenchimento copia blocos de 48 bytes (16 pixels RGB)
+    int16_t mistura[32];
+    uint8_t preenchimento[48];
+
+    Pincel(const uint8_t* cor, int canais) : canais(canais) {
+        for (int i = 0, c = 0; i < 48; ++i, c = c + 1 == canais ? 0 : c + 1) {
+            preenchimento[i] = cor[c];
+            if (i < 32)
+                mistura[i] = cor[c];
+        }
+    }
+};
+
+// Mistura os n bytes de d (começando em um pixel) com pesos de 0 a 256 por byte
+inline void misturarTrecho(uint8_t* d, const int16_t* pesos, int n, const Pincel& pincel) {
+    const simd::i16x8 v256 = simd::difundir16(256), v128 = simd::difundir16(128);
+    int i = 0, fase = 0;
+    for (; i + 8 <= n; i += 8, fase = fase == 16 ? 0 : fase + 8) {
+        const simd::i16x8 destino = simd::expandirBytes(d + i), peso = simd::carregar16(pesos + i);
+        const simd::i16x8 c = simd::carregar16(pincel.mistura + fase);
+        // Até 255 * 256 + 128: cabe em 16 bits sem sinal
+        simd::compactarBytes(d + i, simd::deslocarDireita(destino * (v256 - peso) + c * peso + v128, 8));
+    }
+    for (const int16_t* c = pincel.mistura + fase; i < n; ++i, ++c)
+        d[i] = misturar(d[i], static_cast<uint8_t>(*c), pesos[i]);
+}
+
+inline void preencherTrecho(uint8_t* d, int n, const Pincel& pincel) {
+    int i = 0;
+    for (; i + 48 <= n; i += 48)
+        std::memcpy(d + i, pincel.preenchimento, 48);
+    std::memcpy(d + i, pincel.preenchimento, n - i);
+}
+
+// Compõe o pincel nos pixels x0 <= x < x1 de uma linha com a cobertura alfa[x]. A linha é
+// dividida em trechos vazios (peso 0, pulados), cheios (peso 256, copiados) e parciais
+// (misturados): no interior de uma forma, compor custa o mesmo que pintar sem suavização
+inline void comporLinha(uint8_t* linha, const float* alfa, int x0, int x1, const Pincel& pincel) {
+    // Os limites dos trechos são os de peso = int(alfa * 256 + 0.5)
+    const float vazio = 0.5f / 256.0f, cheio = 255.5f / 256.0f;
+    const int canais = pincel.canais;
+    thread_local std::vector<int16_t> pesos;
+    if (pesos.size() < size_t(x1 - x0) * canais)
+        pesos.resize(size_t(x1 - x0) * canais);
+    int16_t* p = pesos.data();
+    int x = x0;
+    while (x < x1) {
+        while (x < x1 && alfa[x] < vazio)
+            ++x;
+        int inicio = x, k = 0;
+        for (; x < x1 && alfa[x] >= vazio && alfa[x] < cheio; ++x) {
+            const int16_t peso = static_cast<int16_t>(alfa[x] * 256.0f + 0.5f);
+            for (int c = 0; c < canais; ++c)
+                p[k++] = peso;
+        }
+        if (k > 0)
+            misturarTrecho(linha + size_t(inicio) * canais, p, k, pincel);
+        inicio = x;
+        while (x < x1 && alfa[x] >= cheio)
+            ++x;
+        if (x > inicio)
+            preencherTrecho(linha + size_t(inicio) * canais, (x - inicio) * canais, pincel);
+    }
+}
+
+} // namespace detalhe
+
+// Compõe o que foi acumulado com a cor (canais bytes) e zera a cobertura
+inline void compor(imagem::Imagem& img, Cobertura& cobertura, const uint8_t* cor, Regra regra = NAO_ZERO) {
+    detalhe::exigirMesmoTamanho(img, cobertura);
+    const detalhe::Pincel pincel(cor, img.canais);
+    cobertura.resolver(regra, [&](int y, int x0, int x1, const float* alfa) { detalhe::comporLinha(img.linha(y), alfa, x0, x1, pincel); });
+}
+
+// Compõe uma cobertura cujo pixel (0, 0) é o pixel (x0, y0) da imagem (um ladrilho); o que
+// passar da beirada da imagem é descartado
+inline void compor(imagem::Imagem& img, int x0, int y0, Cobertura& cobertura, const uint8_t* cor, Regra regra = NAO_ZERO) {
+    if (x0 < 0 || y0 < 0)
+        throw std::invalid_argument("O ladrilho precisa começar dentro da imagem");
+    const detalhe::Pincel pincel(cor, img.canais);
+    const int larguraUtil = img.largura - x0, alturaUtil = img.altura - y0;
+    cobertura.resolver(regra, [&](int y, int xa, int xb, const float* alfa) {
+        if (y < alturaUtil && xa < larguraUtil)
+            detalhe::comporLinha(img.pixel(x0, y0 + y), alfa, xa, std::min(xb, larguraUtil), pincel);
+    });
+}
+
+// Formas comuns como contornos
+
+// Segmento com espessura e pontas retas (retângulo)
+inline void linha(Cobertura& cobertura, Ponto a, Ponto b, float espessura) {
+    float dx = b.x - a.x, dy = b.y - a.y, comprimento = std::hypot(dx, dy);
+    if (comprimento == 0.0f)
+        return;
+    float nx = -dy / comprimento * espessura * 0.5f, ny = dx / comprimento * espessura * 0.5f;
+    Ponto quadrilatero[4] = {{a.x + nx, a.y + ny}, {b.x + nx, b.y + ny}, {b.x - nx, b.y - ny}, {a.x - nx, a.y - ny}};
+    cobertura.poligono(quadrilatero, 4);
+}
+
+// Número de lados para um arco de raio r se afastar no máximo "tolerancia" pixels do círculo
+inline int ladosCirculo(float raio, float tolerancia = 0.1f) {
+    if (raio <= tolerancia)
+        return 8;
+    float passo = 2.0f * std::acos(1.0f - tolerancia / raio);
+    return std::max(8, std::min(4096, int(std::ceil(2.0f * float(M_PI) / passo))));
+}
+
+inline void disco(Cobertura& cobertura, Ponto centro, float raio, float tolerancia = 0.1f) {
+    const int n = ladosCirculo(raio, tolerancia);
+    const float passo = 2.0f * float(M_PI) / n;
+    raio *= std::sqrt(passo / std::sin(passo)); // Polígono com a mesma área do círculo
+    Ponto anterior{centro.x + raio, centro.y};
+    for (int i = 1; i <= n; ++i) {
+        Ponto p = i == n ? Ponto{centro.x + raio, centro.y} : Ponto{centro.x + raio * std::cos(i * passo), centro.y + raio * std::sin(i * passo)};
+        cobertura.aresta(anterior, p);
+        anterior = p;
+    }
+}
+
+// Linha de 1 pixel de largura de Xiaolin Wu: cada coluna (ou linha, se íngreme) pinta os
+// dois pixels mais próximos com pesos proporcionais à distância
+inline void linhaWu(imagem::Imagem& img, Ponto a, Ponto b, const uint8_t* cor) {
+    // Wu trabalha com centros de pixel nos inteiros
+    float x0 = a.x - 0.5f, y0 = a.y - 0.5f, x1 = b.x - 0.5f, y1 = b.y - 0.5f;
+    if (!std::isfinite(x0 + y0 + x1 + y1))
+        return;
+    const bool ingreme = std::fabs(y1 - y0) > std::fabs(x1 - x0);
+    if (ingreme) {
+        std::swap(x0, y0);
+        std::swap(x1, y1);
+    }
+    if (x0 > x1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+    const int canais = img.canais;
+    const int limitePrincipal = ingreme ? img.altura : img.largura, limiteSecundario = ingreme ? img.largura : img.altura;
+    auto pintar = [&](int principal, int secundario, float peso) {
+        if (principal < 0 || principal >= limitePrincipal || secundario < 0 || secundario >= limiteSecundario)
+            return;
+        uint8_t* p = ingreme ? img.pixel(secundario, principal) : img.pixel(principal, secundario);
+        const int p256 = int(peso * 256.0f + 0.5f);
+        for (int c = 0; c < canais; ++c)
+            p[c] = detalhe::misturar(p[c], cor[c], p256);
+    };
+    const float dx = x1 - x0, gradiente = dx == 0.0f ? 1.0f : (y1 - y0) / dx;
+
+    // Pontas: o pixel de cada extremidade é pintado pela fração dele que a linha cobre
+    auto ponta = [&](float x, float y, bool inicio) {
+        const float xArredondado = std::round(x), yPonta = y + gradiente * (xArredondado - x);
+        const float cobreX = inicio ? 1.0f - (x + 0.5f - std::floor(x + 0.5f)) : x + 0.5f - std::floor(x + 0.5f);
+        const float piso = std::floor(yPonta), frac = yPonta - piso;
+        pintar(int(xArredondado), int(piso), (1.0f - frac) * cobreX);
+        pintar(int(xArredondado), int(piso) + 1, frac * cobreX);
+        return int(xArredondado);
+    };
+    const int xInicio = ponta(x0, y0, true), xFim = ponta(x1, y1, false);
+    if (xFim == xInicio)
+        return;
+
+    // Meio, só no trecho dentro da imagem
+    const int primeiro = std::max(xInicio + 1, 0), ultimo = std::min(xFim - 1, limitePrincipal - 1);
+    float y = y0 + gradiente * (float(primeiro) - x0);
+    for (int x = primeiro; x <= ultimo; ++x, y += gradiente) {
+        const float piso = std::floor(y), frac = y - piso;
+        pintar(x, int(piso), 1.0f - frac);
+        pintar(x, int(piso) + 1, frac);
+    }
+}
+
+namespace referencia {
+
+// A linha serrilhada original de cores_imagens/pgm.cpp, em coordenadas inteiras de pixel
+inline void linhaBresenham(imagem::Imagem& img, int x0, int y0, int x1, int y1, const uint8_t* cor) {
+    const bool ingreme = std::abs(y1 - y0) > std::abs(x1 - x0);
+    if (ingreme) {
+        std::swap(x0, y0);
+        std::swap(x1, y1);
+    }
+    if (x0 > x1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+    const int dx = x1 - x0, dy = std::abs(y1 - y0), passoY = y0 < y1 ? 1 : -1;
+    int erro = dx / 2, y = y0;
+    for (int x = x0; x <= x1; ++x) {
+        int px = ingreme ? y : x, py = ingreme ? x : y;
+        if (0 <= px && px < img.largura && 0 <= py && py < img.altura)
+            std::copy(cor, cor + img.canais, img.pixel(px, py));
+        erro -= dy;
+        if (erro < 0) {
+            y += passoY;
+            erro += dx;
+        }
+    }
+}
+
+// Preenchimento serrilhado: pinta os pixels cujo centro está dentro do polígono
+inline void preencherSerrilhado(imagem::Imagem& img, const std::vector<Ponto>& pontos, const uint8_t* cor, Regra regra = NAO_ZERO) {
+    std::vector<std::pair<float, int>> cruzamentos; // x e sentido
+    const size_t n = pontos.size();
+    float topo = float(img.altura), base = 0.0f;
+    for (Ponto p : pontos) {
+        topo = std::min(topo, p.y);
+        base = std::max(base, p.y);
+    }
+    const int yInicio = std::max(0, int(std::floor(topo))), yFim = std::min(img.altura, int(std::ceil(base)));
+    for (int y = yInicio; y < yFim; ++y) {
+        const float yc = y + 0.5f;
+        cruzamentos.clear();
+        for (size_t i = 0; i < n; ++i) {
+            Ponto a = pontos[i], b = pontos[(i + 1) % n];
+            if ((a.y <= yc) != (b.y <= yc))
+                cruzamentos.push_back({a.x + (yc - a.y) / (b.y - a.y) * (b.x - a.x), a.y < b.y ? 1 : -1});
+        }
+        std::sort(cruzamentos.begin(), cruzamentos.end());
+        int enrolamento = 0;
+        for (size_t i = 0; i + 1 < cruzamentos.size(); ++i) {
+            enrolamento += cruzamentos[i].second;
+            if (regra == NAO_ZERO ? enrolamento == 0 : enrolamento % 2 == 0)
+                continue;
+            const int x0 = std::max(0, int(std::ceil(cruzamentos[i].first - 0.5f)));
+            const int x1 = std::min(img.largura, int(std::ceil(cruzamentos[i + 1].first - 0.5f)));
+            for (int x = x0; x < x1; ++x)
+                std::copy(cor, cor + img.canais, img.pixel(x, y));
+        }
+    }
+}
+
+// Área exata do polígono (simples) dentro do pixel (x, y), recortando-o pelo quadrado
+inline float areaNoPixel(const std::vector<Ponto>& pontos, int x, int y) {
+    std::vector<Ponto> atual = pontos, proximo;
+    // Recorta por cada lado do quadrado (Sutherland-Hodgman): dentro(p) >= 0
+    auto recortar = [&](auto&& dentro) {
+        proximo.clear();
+        for (size_t i = 0; i < atual.size(); ++i) {
+            Ponto a = atual[i], b = atual[(i + 1) % atual.size()];
+            float da = dentro(a), db = dentro(b);
+            if (da >= 0)
+                proximo.push_back(a);
+            if ((da >= 0) != (db >= 0)) {
+                float t = da / (da - db);
+                proximo.push_back({a.x + t * (b.x - a.x), a.y + t * (b.y - a.y)});
+            }
+        }
+        atual.swap(proximo);
+    };
+    recortar([&](Ponto p) { return p.x - x; });
+    recortar([&](Ponto p) { return x + 1 - p.x; });
+    recortar([&](Ponto p) { return p.y - y; });
+    recortar([&](Ponto p) { return y + 1 - p.y; });
+    double area = 0;
+    for (size_t i = 0; i < atual.size(); ++i) {
+        Ponto a = atual[i], b = atual[(i + 1) % atual.size()];
+        area += double(a.x) * b.y - double(b.x) * a.y;
+    }
+    return float(std::fabs(area) * 0.5);
+}
+
+// Composição escalar em float, para conferir detalhe::comporLinha()
+inline void compor(imagem::Imagem& img, Cobertura& cobertura, const uint8_t* cor, Regra regra = NAO_ZERO) {
+    detalhe::exigirMesmoTamanho(img, cobertura);
+    cobertura.resolver(regra, [&](int y, int x0, int x1, const float* alfa) {
+        for (int x = x0; x < x1; ++x) {
+            uint8_t* p = img.pixel(x, y);
+            for (int c = 0; c < img.canais; ++c)
+                p[c] = static_cast<uint8_t>(p[c] + (cor[c] - p[c]) * alfa[x] + 0.5f);
+        }
+    });
+}
+
+} // namespace referencia
+
+} // namespace raster
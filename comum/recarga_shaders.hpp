@@ -0,0 +1,196 @@
+// Recarga automática de shaders editados enquanto o programa roda
+//
+// Uma thread de trabalho observa os arquivos de shader (inotify no Linux; nos demais
+// sistemas, como o macOS, consulta a data de modificação a cada 250 ms). Quando um
+// deles muda, ela recompila o programa em um contexto OpenGL próprio, criado em uma
+// janela invisível que compartilha objetos com a janela principal, e deixa o novo
+// programa pendente. A thread de renderização só troca de programa no início de um
+// quadro, com trocar(), que nunca espera pela compilação.
+//
+// Um shader com erro não substitui o programa atual: o log é impresso e o programa
+// anterior continua em uso até a próxima gravação do arquivo.
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include "gerenciador_shaders.hpp"
+
+#ifdef __linux__
+#  include <poll.h>
+#  include <sys/inotify.h>
+#  include <unistd.h>
+#endif
+
+class RecarregadorShaders {
+public:
+    RecarregadorShaders() = default;
+    RecarregadorShaders(const RecarregadorShaders&) = delete;
+    RecarregadorShaders& operator=(const RecarregadorShaders&) = delete;
+    ~RecarregadorShaders() { parar(); }
+
+    // Deve ser chamado na thread principal (exigência do GLFW para criar janelas)
+    bool iniciar(GLFWwindow* janelaPrincipal, const std::string& caminhoVertice, const std::string& caminhoFragmento) {
+        parar();
+        this->caminhoVertice = caminhoVertice;
+        this->caminhoFragmento = caminhoFragmento;
+
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        contextoTrabalho = glfwCreateWindow(1, 1, "", nullptr, janelaPrincipal);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+        if (!contextoTrabalho) {
+            fprintf(stderr, "Recarga de shaders desativada: não foi possível criar o contexto compartilhado\n");
+            return false;
+        }
+
+        executando = true;
+        trabalhador = std::thread([this] { observar(); });
+        return true;
+    }
+
+    void parar() {
+        executando = false;
+        if (trabalhador.joinable())
+            trabalhador.join();
+        if (contextoTrabalho)
+            glfwDestroyWindow(contextoTrabalho);
+        contextoTrabalho = nullptr;
+        GLuint restante = pendente.exchange(0);
+        if (restante)
+            glDeleteProgram(restante);
+    }
+
+    // Chamado no início do quadro: se houver um programa novo, apaga o antigo e devolve true.
+    // Quem chama precisa obter de novo as posições dos uniformes.
+    bool trocar(GLuint& programa) {
+        GLuint novo = pendente.exchange(0);
+        if (!novo)
+            return false;
+        glDeleteProgram(programa);
+        programa = novo;
+        return true;
+    }
+
+    // Função chamada na thread de trabalho quando um programa novo fica pendente, por exemplo
+    // para acordar um laço de renderização sob demanda. Registre antes de iniciar().
+    void aoRecompilar(std::function<void()> notificar) { this->notificar = std::move(notificar); }
+
+private:
+    void observar() {
+        glfwMakeContextCurrent(contextoTrabalho);
+#ifdef __linux__
+        if (!observarInotify())
+#endif
+            observarDataModificacao();
+        // Solta o contexto antes de a thread terminar: parar() destrói a janela dele
+        glfwMakeContextCurrent(nullptr);
+    }
+
+#ifdef __linux__
+    // Observa o diretório (e não os arquivos), porque muitos editores gravam em um
+    // arquivo temporário e o renomeiam por cima do original
+    bool observarInotify() {
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0)
+            return false;
+        std::filesystem::path dirVertice = std::filesystem::path(caminhoVertice).parent_path();
+        std::filesystem::path dirFragmento = std::filesystem::path(caminhoFragmento).parent_path();
+        const uint32_t eventos = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+        bool ok = inotify_add_watch(fd, dirVertice.c_str(), eventos) >= 0;
+        if (dirFragmento != dirVertice)
+            ok = ok && inotify_add_watch(fd, dirFragmento.c_str(), eventos) >= 0;
+        if (!ok) {
+            close(fd);
+            return false;
+        }
+
+        std::string nomeVertice = std::filesystem::path(caminhoVertice).filename().string();
+        std::string nomeFragmento = std::filesystem::path(caminhoFragmento).filename().string();
+        alignas(inotify_event) char buffer[4096];
+        while (executando) {
+            pollfd p = {fd, POLLIN, 0};
+            if (poll(&p, 1, 200) <= 0) // Acorda periodicamente para ver se deve parar
+                continue;
+
+            bool alterado = false;
+            ssize_t lidos;
+            while ((lidos = read(fd, buffer, sizeof(buffer))) > 0) {
+                for (char* ptr = buffer; ptr < buffer + lidos;) {
+                    const inotify_event* evento = reinterpret_cast<const inotify_event*>(ptr);
+                    if (evento->len && (nomeVertice == evento->name || nomeFragmento == evento->name))
+                        alterado = true;
+                    ptr += sizeof(inotify_event) + evento->len;
+                }
+            }
+            if (alterado) {
+                // Uma gravação costuma gerar vários eventos seguidos; espera o editor terminar
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                while (read(fd, buffer, sizeof(buffer)) > 0) {}
+                recompilar();
+            }
+        }
+        close(fd);
+        return true;
+    }
+#endif
+
+    void observarDataModificacao() {
+        auto dataModificacao = [](const std::string& caminho) {
+            std::error_code erro;
+            return std::filesystem::last_write_time(caminho, erro);
+        };
+        auto ultimaVertice = dataModificacao(caminhoVertice);
+        auto ultimaFragmento = dataModificacao(caminhoFragmento);
+        while (executando) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+            auto vertice = dataModificacao(caminhoVertice);
+            auto fragmento = dataModificacao(caminhoFragmento);
+            if (vertice != ultimaVertice || fragmento != ultimaFragmento) {
+                ultimaVertice = vertice;
+                ultimaFragmento = fragmento;
+                recompilar();
+            }
+        }
+    }
+
+    void recompilar() {
+        std::string codigoVertice = GerenciadorShaders::lerArquivo(caminhoVertice);
+        std::string codigoFragmento = GerenciadorShaders::lerArquivo(caminhoFragmento);
+        if (codigoVertice.empty() || codigoFragmento.empty())
+            return; // Arquivo sendo regravado; o próximo evento traz o conteúdo completo
+
+        auto inicio = std::chrono::steady_clock::now();
+        GLuint programa = gerenciador.programa(gerenciador.solicitar(codigoVertice, codigoFragmento));
+        gerenciador.descartarSolicitacoes(); // Uma solicitação por recarga: sem isso a lista só cresce
+        if (!programa) {
+            fprintf(stderr, "Shaders com erro; mantendo o programa anterior\n");
+            return;
+        }
+        // Garante que o programa esteja completo antes de ser usado pelo outro contexto
+        glFinish();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+        printf("Shaders recarregados em %.1f ms\n", ms);
+
+        GLuint anterior = pendente.exchange(programa);
+        if (anterior)
+            glDeleteProgram(anterior); // Nunca chegou a ser usado pela thread de renderização
+        if (notificar)
+            notificar();
+    }
+
+    std::string caminhoVertice, caminhoFragmento;
+    GLFWwindow* contextoTrabalho = nullptr;
+    GerenciadorShaders gerenciador; // Próprio da thread de trabalho; reaproveita o mesmo cache em disco
+    std::thread trabalhador;
+    std::atomic<bool> executando{false};
+    std::atomic<GLuint> pendente{0};
+    std::function<void()> notificar;
+};
@@ -0,0 +1,195 @@
+// Laço de renderização sob demanda para janelas GLFW
+//
+// Em vez de desenhar sem parar (glfwPollEvents + glfwSwapBuffers a cada volta), o laço
+// dorme em glfwWaitEvents/glfwWaitEventsTimeout e só desenha um quadro quando algo o
+// marcou como sujo:
+//  - eventos da janela (tamanho do framebuffer, exposição, teclado, mouse, rolagem),
+//    pelos callbacks instalados em conectar();
+//  - marcarSujo(), que pode ser chamada de qualquer thread (acorda o laço com
+//    glfwPostEmptyEvent), por exemplo quando um recurso termina de carregar;
+//  - animações, que pedem o próximo quadro explicitamente com solicitarQuadro() ou
+//    agendam um quadro futuro com solicitarQuadroEm().
+// Sem nada disso, a thread principal fica bloqueada e o uso de CPU/GPU cai a quase zero.
+//
+// Uso:
+//   RenderizacaoSobDemanda sobDemanda;
+//   glfwSetCursorPosCallback(janela, ...);     // callbacks do programa primeiro
+//   sobDemanda.conectar(janela);               // encadeia os callbacks anteriores
+//   while (sobDemanda.proximoQuadro()) {
+//       desenhar();
+//       glfwSwapBuffers(janela);
+//       if (animando) sobDemanda.solicitarQuadro();
+//   }
+//
+// Callbacks instalados depois de conectar() substituem os daqui; nesse caso o próprio
+// callback deve chamar marcarSujo().
+#pragma once
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <mutex>
+
+class RenderizacaoSobDemanda {
+public:
+    // esperaMaxima: maior tempo, em segundos, que o laço fica bloqueado sem nenhum evento
+    // antes de conferir de novo os pedidos (0 = sem limite)
+    explicit RenderizacaoSobDemanda(double esperaMaxima = 0.0) : esperaMaxima(esperaMaxima) {}
+    // Não chama o GLFW (pode já ter sido encerrado quando uma instância global é destruída)
+    ~RenderizacaoSobDemanda() {
+        std::lock_guard<std::mutex> trava(mutexRegistro());
+        if (janela)
+            registro().erase(janela);
+    }
+    RenderizacaoSobDemanda(const RenderizacaoSobDemanda&) = delete;
+    RenderizacaoSobDemanda& operator=(const RenderizacaoSobDemanda&) = delete;
+
+    // Instala os callbacks de janela que marcam o quadro como sujo, guardando os anteriores
+    void conectar(GLFWwindow* janela) {
+        desconectar();
+        this->janela = janela;
+        {
+            std::lock_guard<std::mutex> trava(mutexRegistro());
+            registro()[janela] = this;
+        }
+        anteriores.tamanho = glfwSetFramebufferSizeCallback(janela, aoMudarTamanho);
+        anteriores.exposicao = glfwSetWindowRefreshCallback(janela, aoExpor);
+        anteriores.tecla = glfwSetKeyCallback(janela, aoTeclar);
+        anteriores.botao = glfwSetMouseButtonCallback(janela, aoClicar);
+        anteriores.cursor = glfwSetCursorPosCallback(janela, aoMoverCursor);
+        anteriores.rolagem = glfwSetScrollCallback(janela, aoRolar);
+        marcarSujo(); // O primeiro quadro sempre é desenhado
+    }
+
+    // Restaura os callbacks que existiam antes de conectar()
+    void desconectar() {
+        if (!janela)
+            return;
+        glfwSetFramebufferSizeCallback(janela, anteriores.tamanho);
+        glfwSetWindowRefreshCallback(janela, anteriores.exposicao);
+        glfwSetKeyCallback(janela, anteriores.tecla);
+        glfwSetMouseButtonCallback(janela, anteriores.botao);
+        glfwSetCursorPosCallback(janela, anteriores.cursor);
+        glfwSetScrollCallback(janela, anteriores.rolagem);
+        std::lock_guard<std::mutex> trava(mutexRegistro());
+        registro().erase(janela);
+        janela = nullptr;
+    }
+
+    // Pede um quadro; segura em qualquer thread
+    void marcarSujo() {
+        if (!sujo.exchange(true))
+            glfwPostEmptyEvent(); // Acorda o laço se ele estiver dormindo (inofensivo se não estiver)
+    }
+
+    // Animação: desenha o próximo quadro sem esperar por eventos (só na thread principal)
+    void solicitarQuadro() { quadroAgendado = 0.0; }
+
+    // Agenda um quadro para daqui a "segundos" (o mais cedo dos pedidos prevalece)
+    void solicitarQuadroEm(double segundos) {
+        quadroAgendado = std::min(quadroAgendado, glfwGetTime() + std::max(0.0, segundos));
+    }
+
+    // Bloqueia até haver um quadro a desenhar; devolve false quando a janela deve fechar
+    bool proximoQuadro() {
+        glfwPollEvents(); // Trata o que chegou enquanto o quadro anterior era desenhado
+        for (;;) {
+            if (glfwWindowShouldClose(janela))
+                return false;
+            double agora = glfwGetTime();
+            bool agendadoVenceu = quadroAgendado <= agora;
+            if (sujo.exchange(false) || agendadoVenceu) {
+                if (agendadoVenceu)
+                    quadroAgendado = SEM_AGENDAMENTO;
+                contadores.quadros++;
+                return true;
+            }
+            double espera = quadroAgendado - agora;
+            if (esperaMaxima > 0.0)
+                espera = std::min(espera, esperaMaxima);
+            contadores.esperas++;
+            if (espera == SEM_AGENDAMENTO)
+                glfwWaitEvents();
+            else
+                glfwWaitEventsTimeout(espera);
+        }
+    }
+
+    struct Contadores {
+        size_t quadros = 0; // Quadros liberados por proximoQuadro()
+        size_t esperas = 0; // Vezes em que o laço dormiu esperando eventos
+    };
+
+    const Contadores& contadoresAtuais() const { return contadores; }
+
+    void imprimirEstatisticas(FILE* saida = stdout) const {
+        fprintf(saida, "Renderização sob demanda: %zu quadros, %zu esperas por eventos\n", contadores.quadros, contadores.esperas);
+    }
+
+private:
+    static constexpr double SEM_AGENDAMENTO = std::numeric_limits<double>::infinity();
+
+    struct Callbacks {
+        GLFWframebuffersizefun tamanho = nullptr;
+        GLFWwindowrefreshfun exposicao = nullptr;
+        GLFWkeyfun tecla = nullptr;
+        GLFWmousebuttonfun botao = nullptr;
+        GLFWcursorposfun cursor = nullptr;
+        GLFWscrollfun rolagem = nullptr;
+    };
+
+    // Os callbacks do GLFW são funções livres: a instância de cada janela vem deste registro
+    // (o ponteiro de usuário da janela fica livre para o programa)
+    static std::map<GLFWwindow*, RenderizacaoSobDemanda*>& registro() {
+        static std::map<GLFWwindow*, RenderizacaoSobDemanda*> instancias;
+        return instancias;
+    }
+    static std::mutex& mutexRegistro() {
+        static std::mutex mutex;
+        return mutex;
+    }
+    static RenderizacaoSobDemanda* instancia(GLFWwindow* janela) {
+        std::lock_guard<std::mutex> trava(mutexRegistro());
+        auto it = registro().find(janela);
+        if (it == registro().end())
+            return nullptr;
+        it->second->marcarSujo();
+        return it->second;
+    }
+
+    static void aoMudarTamanho(GLFWwindow* janela, int largura, int altura) {
+        if (RenderizacaoSobDemanda* r = instancia(janela); r && r->anteriores.tamanho)
+            r->anteriores.tamanho(janela, largura, altura);
+    }
+    static void aoExpor(GLFWwindow* janela) {
+        if (RenderizacaoSobDemanda* r = instancia(janela); r && r->anteriores.exposicao)
+            r->anteriores.exposicao(janela);
+    }
+    static void aoTeclar(GLFWwindow* janela, int tecla, int codigo, int acao, int modificadores) {
+        if (RenderizacaoSobDemanda* r = instancia(janela); r && r->anteriores.tecla)
+            r->anteriores.tecla(janela, tecla, codigo, acao, modificadores);
+    }
+    static void aoClicar(GLFWwindow* janela, int botao, int acao, int modificadores) {
+        if (RenderizacaoSobDemanda* r = instancia(janela); r && r->anteriores.botao)
+            r->anteriores.botao(janela, botao, acao, modificadores);
+    }
+    static void aoMoverCursor(GLFWwindow* janela, double x, double y) {
+        if (RenderizacaoSobDemanda* r = instancia(janela); r && r->anteriores.cursor)
+            r->anteriores.cursor(janela, x, y);
+    }
+    static void aoRolar(GLFWwindow* janela, double x, double y) {
+        if (RenderizacaoSobDemanda* r = instancia(janela); r && r->anteriores.rolagem)
+            r->anteriores.rolagem(janela, x, y);
+    }
+
+    GLFWwindow* janela = nullptr;
+    Callbacks anteriores;
+    double esperaMaxima;
+    std::atomic<bool> sujo{false};
+    double quadroAgendado = SEM_AGENDAMENTO;
+    Contadores contadores;
+};
@@ -0,0 +1,348 @@
+// Vetor de 4 floats com implementação SSE (x86), NEON (ARM) ou escalar
+//
+// Os algoritmos escrevem o laço uma única vez sobre simd::f4 e o compilador escolhe
+// as instruções da plataforma. Também oferece a multiplicação de matrizes 4x4 em
+// ordem de colunas (a mesma convenção do OpenGL e da GLM), um vetor de 16 bytes
+// (simd::u8x16) para comparar imagens de 8 bits sem convertê-las para float e um de
+// 8 inteiros de 16 bits (simd::i16x8) para contas com bytes que passam de 255.
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64)
+#  include <xmmintrin.h>
+#  define SIMD_SSE 1
+#  if defined(__SSE2__) || defined(_M_X64)
+#    include <emmintrin.h>
+#    define SIMD_SSE2 1
+#  endif
+#elif defined(__ARM_NEON)
+#  include <arm_neon.h>
+#  define SIMD_NEON 1
+#endif
+
+namespace simd {
+
+#if defined(SIMD_SSE)
+
+struct f4 { __m128 v; };
+inline f4 carregar(const float* p) { return {_mm_loadu_ps(p)}; }
+inline void armazenar(float* p, f4 a) { _mm_storeu_ps(p, a.v); }
+inline f4 difundir(float s) { return {_mm_set1_ps(s)}; }
+inline f4 operator+(f4 a, f4 b) { return {_mm_add_ps(a.v, b.v)}; }
+inline f4 operator-(f4 a, f4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+inline f4 operator*(f4 a, f4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+inline f4 operator/(f4 a, f4 b) { return {_mm_div_ps(a.v, b.v)}; }
+inline f4 minimo(f4 a, f4 b) { return {_mm_min_ps(a.v, b.v)}; }
+inline f4 maximo(f4 a, f4 b) { return {_mm_max_ps(a.v, b.v)}; }
+inline f4 multiplicarSomar(f4 a, f4 b, f4 c) { return {_mm_add_ps(_mm_mul_ps(a.v, b.v), c.v)}; }
+inline f4 raizQuadrada(f4 a) { return {_mm_sqrt_ps(a.v)}; }
+// Todos os bits ligados onde a > b, zero nos demais
+inline f4 mascaraMaior(f4 a, f4 b) { return {_mm_cmpgt_ps(a.v, b.v)}; }
+// seVerdade onde a máscara está ligada, seFalso nos demais
+inline f4 selecionar(f4 mascara, f4 seVerdade, f4 seFalso) {
+    return {_mm_or_ps(_mm_and_ps(mascara.v, seVerdade.v), _mm_andnot_ps(mascara.v, seFalso.v))};
+}
+
+#elif defined(SIMD_NEON)
+
+struct f4 { float32x4_t v; };
+inline f4 carregar(const float* p) { return {vld1q_f32(p)}; }
+inline void armazenar(float* p, f4 a) { vst1q_f32(p, a.v); }
+inline f4 difundir(float s) { return {vdupq_n_f32(s)}; }
+inline f4 operator+(f4 a, f4 b) { return {vaddq_f32(a.v, b.v)}; }
+inline f4 operator-(f4 a, f4 b) { return {vsubq_f32(a.v, b.v)}; }
+inline f4 operator*(f4 a, f4 b) { return {vmulq_f32(a.v, b.v)}; }
+#  if defined(__aarch64__)
+inline f4 operator/(f4 a, f4 b) { return {vdivq_f32(a.v, b.v)}; }
+#  else
+inline f4 operator/(f4 a, f4 b) {
+    float32x4_t r = vrecpeq_f32(b.v);
+    r = vmulq_f32(vrecpsq_f32(b.v, r), r);
+    r = vmulq_f32(vrecpsq_f32(b.v, r), r);
+    return {vmulq_f32(a.v, r)};
+}
+#  endif
+inline f4 minimo(f4 a, f4 b) { return {vminq_f32(a.v, b.v)}; }
+inline f4 maximo(f4 a, f4 b) { return {vmaxq_f32(a.v, b.v)}; }
+inline f4 multiplicarSomar(f4 a, f4 b, f4 c) { return {vmlaq_f32(c.v, a.v, b.v)}; }
+#  if defined(__aarch64__)
+inline f4 raizQuadrada(f4 a) { return {vsqrtq_f32(a.v)}; }
+#  else
+inline f4 raizQuadrada(f4 a) {
+    float v[4];
+    vst1q_f32(v, a.v);
+    for (int i = 0; i < 4; ++i) v[i] = __builtin_sqrtf(v[i]);
+    return {vld1q_f32(v)};
+}
+#  endif
+inline f4 mascaraMaior(f4 a, f4 b) { return {vreinterpretq_f32_u32(vcgtq_f32(a.v, b.v))}; }
+inline f4 selecionar(f4 mascara, f4 seVerdade, f4 seFalso) { return {vbslq_f32(vreinterpretq_u32_f32(mascara.v), seVerdade.v, seFalso.v)}; }
+
+#else
+
+struct f4 { float v[4]; };
+inline f4 carregar(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void armazenar(float* p, f4 a) { for (int i = 0; i < 4; ++i) p[i] = a.v[i]; }
+inline f4 difundir(float s) { return {{s, s, s, s}}; }
+#  define SIMD_OPERADOR(op) \
+    inline f4 operator op(f4 a, f4 b) { return {{a.v[0] op b.v[0], a.v[1] op b.v[1], a.v[2] op b.v[2], a.v[3] op b.v[3]}}; }
+SIMD_OPERADOR(+)
+SIMD_OPERADOR(-)
+SIMD_OPERADOR(*)
+SIMD_OPERADOR(/)
+#  undef SIMD_OPERADOR
+inline f4 minimo(f4 a, f4 b) { f4 r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return r; }
+inline f4 maximo(f4 a, f4 b) { f4 r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return r; }
+inline f4 multiplicarSomar(f4 a, f4 b, f4 c) { return a * b + c; }
+inline f4 raizQuadrada(f4 a) { f4 r; for (int i = 0; i < 4; ++i) r.v[i] = __builtin_sqrtf(a.v[i]); return r; }
+// A máscara escalar é 1 ou 0; só serve para selecionar()
+inline f4 mascaraMaior(f4 a, f4 b) { f4 r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] > b.v[i] ? 1.0f : 0.0f; return r; }
+inline f4 selecionar(f4 mascara, f4 seVerdade, f4 seFalso) {
+    f4 r;
+    for (int i = 0; i < 4; ++i) r.v[i] = mascara.v[i] != 0.0f ? seVerdade.v[i] : seFalso.v[i];
+    return r;
+}
+
+#endif
+
+// r = a * b, matrizes 4x4 em ordem de colunas; r pode coincidir com a ou b
+inline void multiplicarMatriz4(const float* a, const float* b, float* r) {
+    f4 a0 = carregar(a), a1 = carregar(a + 4), a2 = carregar(a + 8), a3 = carregar(a + 12);
+    f4 coluna[4];
+    for (int j = 0; j < 4; ++j) {
+        const float* bj = b + 4 * j;
+        f4 c = a0 * difundir(bj[0]);
+        c = multiplicarSomar(a1, difundir(bj[1]), c);
+        c = multiplicarSomar(a2, difundir(bj[2]), c);
+        coluna[j] = multiplicarSomar(a3, difundir(bj[3]), c);
+    }
+    for (int j = 0; j < 4; ++j)
+        armazenar(r + 4 * j, coluna[j]);
+}
+
+//--------------------------------------------------------------------------------
+// 16 bytes sem sinal
+
+#if defined(SIMD_SSE2)
+
+struct u8x16 { __m128i v; };
+inline u8x16 carregarBytes(const uint8_t* p) { return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))}; }
+inline void armazenarBytes(uint8_t* p, u8x16 a) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), a.v); }
+inline u8x16 difundirByte(uint8_t s) { return {_mm_set1_epi8(static_cast<char>(s))}; }
+inline u8x16 minimo(u8x16 a, u8x16 b) { return {_mm_min_epu8(a.v, b.v)}; }
+inline u8x16 maximo(u8x16 a, u8x16 b) { return {_mm_max_epu8(a.v, b.v)}; }
+// |a - b| por byte
+inline u8x16 diferencaAbsoluta(u8x16 a, u8x16 b) { return {_mm_or_si128(_mm_subs_epu8(a.v, b.v), _mm_subs_epu8(b.v, a.v))}; }
+inline u8x16 operator&(u8x16 a, u8x16 b) { return {_mm_and_si128(a.v, b.v)}; }
+// 0xFF onde a > limiar, 0 nos demais
+inline u8x16 mascaraMaioresQue(u8x16 a, uint8_t limiar) {
+    __m128i excesso = _mm_subs_epu8(a.v, _mm_set1_epi8(static_cast<char>(limiar)));
+    return {_mm_andnot_si128(_mm_cmpeq_epi8(excesso, _mm_setzero_si128()), _mm_set1_epi8(-1))};
+}
+// Maior dos 16 bytes
+inline uint8_t maximoHorizontal(u8x16 a) {
+    __m128i m = _mm_max_epu8(a.v, _mm_srli_si128(a.v, 8));
+    m = _mm_max_epu8(m, _mm_srli_si128(m, 4));
+    m = _mm_max_epu8(m, _mm_srli_si128(m, 2));
+    m = _mm_max_epu8(m, _mm_srli_si128(m, 1));
+    return static_cast<uint8_t>(_mm_cvtsi128_si32(m));
+}
+// Quantos bytes são maiores que "limiar"
+inline int contarMaioresQue(u8x16 a, uint8_t limiar) {
+    __m128i excesso = _mm_subs_epu8(a.v, _mm_set1_epi8(static_cast<char>(limiar)));
+    __m128i uns = _mm_andnot_si128(_mm_cmpeq_epi8(excesso, _mm_setzero_si128()), _mm_set1_epi8(1));
+    __m128i soma = _mm_sad_epu8(uns, _mm_setzero_si128()); // Duas somas de 8 bytes
+    return _mm_cvtsi128_si32(soma) + _mm_cvtsi128_si32(_mm_srli_si128(soma, 8));
+}
+// Soma dos quadrados dos 16 bytes (até 16 * 255², cabe em 32 bits)
+inline uint32_t somaQuadrados(u8x16 a) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i baixo = _mm_unpacklo_epi8(a.v, zero), alto = _mm_unpackhi_epi8(a.v, zero);
+    __m128i s = _mm_add_epi32(_mm_madd_epi16(baixo, baixo), _mm_madd_epi16(alto, alto));
+    s = _mm_add_epi32(s, _mm_srli_si128(s, 8));
+    s = _mm_add_epi32(s, _mm_srli_si128(s, 4));
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(s));
+}
+
+#elif defined(SIMD_NEON)
+
+struct u8x16 { uint8x16_t v; };
+inline u8x16 carregarBytes(const uint8_t* p) { return {vld1q_u8(p)}; }
+inline void armazenarBytes(uint8_t* p, u8x16 a) { vst1q_u8(p, a.v); }
+inline u8x16 difundirByte(uint8_t s) { return {vdupq_n_u8(s)}; }
+inline u8x16 minimo(u8x16 a, u8x16 b) { return {vminq_u8(a.v, b.v)}; }
+inline u8x16 maximo(u8x16 a, u8x16 b) { return {vmaxq_u8(a.v, b.v)}; }
+inline u8x16 diferencaAbsoluta(u8x16 a, u8x16 b) { return {vabdq_u8(a.v, b.v)}; }
+inline u8x16 operator&(u8x16 a, u8x16 b) { return {vandq_u8(a.v, b.v)}; }
+inline u8x16 mascaraMaioresQue(u8x16 a, uint8_t limiar) { return {vcgtq_u8(a.v, vdupq_n_u8(limiar))}; }
+inline uint8_t maximoHorizontal(u8x16 a) {
+    uint8x8_t m = vpmax_u8(vget_low_u8(a.v), vget_high_u8(a.v));
+    m = vpmax_u8(m, m);
+    m = vpmax_u8(m, m);
+    m = vpmax_u8(m, m);
+    return vget_lane_u8(m, 0);
+}
+inline int contarMaioresQue(u8x16 a, uint8_t limiar) {
+    uint8x16_t maiores = vshrq_n_u8(vcgtq_u8(a.v, vdupq_n_u8(limiar)), 7); // 1 onde a > limiar
+    uint64x2_t soma = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(maiores)));
+    return static_cast<int>(vgetq_lane_u64(soma, 0) + vgetq_lane_u64(soma, 1));
+}
+inline uint32_t somaQuadrados(u8x16 a) {
+    uint16x8_t baixo = vmull_u8(vget_low_u8(a.v), vget_low_u8(a.v));
+    uint16x8_t alto = vmull_u8(vget_high_u8(a.v), vget_high_u8(a.v));
+    uint64x2_t soma = vpaddlq_u32(vaddq_u32(vpaddlq_u16(baixo), vpaddlq_u16(alto)));
+    return static_cast<uint32_t>(vgetq_lane_u64(soma, 0) + vgetq_lane_u64(soma, 1));
+}
+
+#else
+
+struct u8x16 { uint8_t v[16]; };
+inline u8x16 carregarBytes(const uint8_t* p) { u8x16 r; for (int i = 0; i < 16; ++i) r.v[i] = p[i]; return r; }
+inline void armazenarBytes(uint8_t* p, u8x16 a) { for (int i = 0; i < 16; ++i) p[i] = a.v[i]; }
+inline u8x16 difundirByte(uint8_t s) { u8x16 r; for (int i = 0; i < 16; ++i) r.v[i] = s; return r; }
+inline u8x16 minimo(u8x16 a, u8x16 b) { u8x16 r; for (int i = 0; i < 16; ++i) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return r; }
+inline u8x16 maximo(u8x16 a, u8x16 b) { u8x16 r; for (int i = 0; i < 16; ++i) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return r; }
+inline u8x16 diferencaAbsoluta(u8x16 a, u8x16 b) {
+    u8x16 r;
+    for (int i = 0; i < 16; ++i) r.v[i] = static_cast<uint8_t>(a.v[i] > b.v[i] ? a.v[i] - b.v[i] : b.v[i] - a.v[i]);
+    return r;
+}
+inline u8x16 operator&(u8x16 a, u8x16 b) { u8x16 r; for (int i = 0; i < 16; ++i) r.v[i] = a.v[i] & b.v[i]; return r; }
+inline u8x16 mascaraMaioresQue(u8x16 a, uint8_t limiar) {
+    u8x16 r;
+    for (int i = 0; i < 16; ++i) r.v[i] = a.v[i] > limiar ? 0xFF : 0;
+    return r;
+}
+inline uint8_t maximoHorizontal(u8x16 a) { uint8_t m = 0; for (int i = 0; i < 16; ++i) m = a.v[i] > m ? a.v[i] : m; return m; }
+inline int contarMaioresQue(u8x16 a, uint8_t limiar) { int n = 0; for (int i = 0; i < 16; ++i) n += a.v[i] > limiar; return n; }
+inline uint32_t somaQuadrados(u8x16 a) { uint32_t s = 0; for (int i = 0; i < 16; ++i) s += uint32_t(a.v[i]) * a.v[i]; return s; }
+
+#endif
+
+//--------------------------------------------------------------------------------
+// 8 inteiros de 16 bits com sinal
+
+#if defined(SIMD_SSE2)
+
+struct i16x8 { __m128i v; };
+// 8 bytes sem sinal -> 8 inteiros de 0 a 255
+inline i16x8 expandirBytes(const uint8_t* p) {
+    return {_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), _mm_setzero_si128())};
+}
+// Grava o byte baixo de cada inteiro (aritmética módulo 256)
+inline void compactarBytes(uint8_t* p, i16x8 a) {
+    __m128i baixos = _mm_and_si128(a.v, _mm_set1_epi16(0xFF));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(baixos, _mm_setzero_si128()));
+}
+inline i16x8 carregar16(const int16_t* p) { return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))}; }
+inline i16x8 difundir16(int16_t s) { return {_mm_set1_epi16(s)}; }
+inline i16x8 operator+(i16x8 a, i16x8 b) { return {_mm_add_epi16(a.v, b.v)}; }
+inline i16x8 operator-(i16x8 a, i16x8 b) { return {_mm_sub_epi16(a.v, b.v)}; }
+inline i16x8 operator&(i16x8 a, i16x8 b) { return {_mm_and_si128(a.v, b.v)}; }
+inline i16x8 operator|(i16x8 a, i16x8 b) { return {_mm_or_si128(a.v, b.v)}; }
+// 16 bits baixos do produto (módulo 2^16: serve também para números sem sinal)
+inline i16x8 operator*(i16x8 a, i16x8 b) { return {_mm_mullo_epi16(a.v, b.v)}; }
+inline i16x8 minimo(i16x8 a, i16x8 b) { return {_mm_min_epi16(a.v, b.v)}; }
+inline i16x8 modulo(i16x8 a) { return {_mm_max_epi16(a.v, _mm_sub_epi16(_mm_setzero_si128(), a.v))}; }
+// Deslocamento lógico (entra zero à esquerda)
+inline i16x8 deslocarDireita(i16x8 a, int bits) { return {_mm_srl_epi16(a.v, _mm_cvtsi32_si128(bits))}; }
+// Todos os bits ligados onde a > b, zero nos demais
+inline i16x8 mascaraMaior(i16x8 a, i16x8 b) { return {_mm_cmpgt_epi16(a.v, b.v)}; }
+// seVerdade onde a máscara está ligada, seFalso nos demais
+inline i16x8 selecionar(i16x8 mascara, i16x8 seVerdade, i16x8 seFalso) {
+    return {_mm_or_si128(_mm_and_si128(mascara.v, seVerdade.v), _mm_andnot_si128(mascara.v, seFalso.v))};
+}
+// Arredonda 4 floats entre 0 e 255 para o inteiro mais próximo e grava 4 bytes
+inline void armazenarBytesArredondados(uint8_t* p, f4 a) {
+    __m128i inteiros = _mm_cvtps_epi32(a.v);
+    __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(inteiros, inteiros), _mm_setzero_si128());
+    int32_t quatro = _mm_cvtsi128_si32(bytes);
+    std::memcpy(p, &quatro, 4);
+}
+inline int32_t somaHorizontal(i16x8 a) {
+    __m128i s = _mm_madd_epi16(a.v, _mm_set1_epi16(1)); // 4 somas de pares em 32 bits
+    s = _mm_add_epi32(s, _mm_srli_si128(s, 8));
+    s = _mm_add_epi32(s, _mm_srli_si128(s, 4));
+    return _mm_cvtsi128_si32(s);
+}
+
+#elif defined(SIMD_NEON)
+
+struct i16x8 { int16x8_t v; };
+inline i16x8 expandirBytes(const uint8_t* p) { return {vreinterpretq_s16_u16(vmovl_u8(vld1_u8(p)))}; }
+inline void compactarBytes(uint8_t* p, i16x8 a) { vst1_u8(p, vmovn_u16(vreinterpretq_u16_s16(a.v))); }
+inline i16x8 carregar16(const int16_t* p) { return {vld1q_s16(p)}; }
+inline i16x8 difundir16(int16_t s) { return {vdupq_n_s16(s)}; }
+inline i16x8 operator+(i16x8 a, i16x8 b) { return {vaddq_s16(a.v, b.v)}; }
+inline i16x8 operator-(i16x8 a, i16x8 b) { return {vsubq_s16(a.v, b.v)}; }
+inline i16x8 operator&(i16x8 a, i16x8 b) { return {vandq_s16(a.v, b.v)}; }
+inline i16x8 operator|(i16x8 a, i16x8 b) { return {vorrq_s16(a.v, b.v)}; }
+inline i16x8 operator*(i16x8 a, i16x8 b) { return {vmulq_s16(a.v, b.v)}; }
+inline i16x8 minimo(i16x8 a, i16x8 b) { return {vminq_s16(a.v, b.v)}; }
+inline i16x8 modulo(i16x8 a) { return {vabsq_s16(a.v)}; }
+inline i16x8 deslocarDireita(i16x8 a, int bits) {
+    return {vreinterpretq_s16_u16(vshlq_u16(vreinterpretq_u16_s16(a.v), vdupq_n_s16(static_cast<int16_t>(-bits))))};
+}
+inline i16x8 mascaraMaior(i16x8 a, i16x8 b) { return {vreinterpretq_s16_u16(vcgtq_s16(a.v, b.v))}; }
+inline i16x8 selecionar(i16x8 mascara, i16x8 seVerdade, i16x8 seFalso) {
+    return {vbslq_s16(vreinterpretq_u16_s16(mascara.v), seVerdade.v, seFalso.v)};
+}
+inline void armazenarBytesArredondados(uint8_t* p, f4 a) {
+#  if defined(__aarch64__)
+    uint32x4_t inteiros = vcvtnq_u32_f32(a.v);
+#  else
+    uint32x4_t inteiros = vcvtq_u32_f32(vaddq_f32(a.v, vdupq_n_f32(0.5f)));
+#  endif
+    uint8x8_t bytes = vqmovn_u16(vcombine_u16(vqmovn_u32(inteiros), vdup_n_u16(0)));
+    uint32_t quatro = vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+    std::memcpy(p, &quatro, 4); // p pode estar desalinhado
+}
+inline int32_t somaHorizontal(i16x8 a) {
+    int64x2_t s = vpaddlq_s32(vpaddlq_s16(a.v));
+    return static_cast<int32_t>(vgetq_lane_s64(s, 0) + vgetq_lane_s64(s, 1));
+}
+
+#else
+
+struct i16x8 { int16_t v[8]; };
+inline i16x8 expandirBytes(const uint8_t* p) { i16x8 r; for (int i = 0; i < 8; ++i) r.v[i] = p[i]; return r; }
+inline void compactarBytes(uint8_t* p, i16x8 a) { for (int i = 0; i < 8; ++i) p[i] = static_cast<uint8_t>(a.v[i]); }
+inline i16x8 carregar16(const int16_t* p) { i16x8 r; for (int i = 0; i < 8; ++i) r.v[i] = p[i]; return r; }
+inline i16x8 difundir16(int16_t s) { i16x8 r; for (int i = 0; i < 8; ++i) r.v[i] = s; return r; }
+#  define SIMD_OPERADOR(op) \
+    inline i16x8 operator op(i16x8 a, i16x8 b) { i16x8 r; for (int i = 0; i < 8; ++i) r.v[i] = static_cast<int16_t>(a.v[i] op b.v[i]); return r; }
+SIMD_OPERADOR(+)
+SIMD_OPERADOR(-)
+SIMD_OPERADOR(&)
+SIMD_OPERADOR(|)
+#  undef SIMD_OPERADOR
+inline i16x8 operator*(i16x8 a, i16x8 b) {
+    i16x8 r;
+    for (int i = 0; i < 8; ++i) r.v[i] = static_cast<int16_t>(uint32_t(uint16_t(a.v[i])) * uint16_t(b.v[i]));
+    return r;
+}
+inline i16x8 minimo(i16x8 a, i16x8 b) { i16x8 r; for (int i = 0; i < 8; ++i) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return r; }
+inline i16x8 modulo(i16x8 a) { i16x8 r; for (int i = 0; i < 8; ++i) r.v[i] = static_cast<int16_t>(a.v[i] < 0 ? -a.v[i] : a.v[i]); return r; }
+inline i16x8 deslocarDireita(i16x8 a, int bits) {
+    i16x8 r;
+    for (int i = 0; i < 8; ++i) r.v[i] = static_cast<int16_t>(static_cast<uint16_t>(a.v[i]) >> bits);
+    return r;
+}
+inline i16x8 mascaraMaior(i16x8 a, i16x8 b) { i16x8 r; for (int i = 0; i < 8; ++i) r.v[i] = a.v[i] > b.v[i] ? -1 : 0; return r; }
+inline i16x8 selecionar(i16x8 mascara, i16x8 seVerdade, i16x8 seFalso) {
+    i16x8 r;
+    for (int i = 0; i < 8; ++i) r.v[i] = mascara.v[i] ? seVerdade.v[i] : seFalso.v[i];
+    return r;
+}
+inline void armazenarBytesArredondados(uint8_t* p, f4 a) {
+    float v[4];
+    armazenar(v, a); // f4 pode ser SSE sem SSE2
+    for (int i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>(v[i] + 0.5f);
+}
+inline int32_t somaHorizontal(i16x8 a) { int32_t s = 0; for (int i = 0; i < 8; ++i) s += a.v[i]; return s; }
+
+#endif
+
+} // namespace simd
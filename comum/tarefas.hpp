@@ -0,0 +1,558 @@
+// Agendador de tarefas com roubo de trabalho (work stealing)
+//
+// Cada trabalhador tem uma fila dupla de Chase–Lev: empilha e desempilha as próprias
+// tarefas pelo fundo, sem travas, enquanto os outros roubam pelo topo quando ficam
+// sem trabalho. Há uma fila a mais para a thread de fora que espera (normalmente a
+// principal), reservada enquanto ela espera; tarefas criadas por outras threads de fora
+// entram por uma fila de injeção protegida por mutex.
+//
+// Três formas de uso:
+//
+//   Divisão de laço (fork/join), com o tamanho mínimo de cada pedaço:
+//     tarefas::padrao().paraleloPara(0, n, 4096, [&](size_t i0, size_t i1) { ... });
+//
+//   Grupo de tarefas soltas, esperadas juntas:
+//     tarefas::Grupo grupo(agendador);
+//     grupo.executar([&] { ... });
+//     grupo.esperar();
+//
+//   Grafo de dependências e continuações:
+//     auto carregar = agendador.criar([&] { ... });
+//     auto normais = agendador.criar([&] { ... });
+//     agendador.depois(carregar, normais);     // normais só roda quando carregar terminar
+//     agendador.enviar(normais);
+//     agendador.enviar(carregar);
+//     agendador.esperar(normais);
+//
+// Quem espera (esperar(), paraleloPara()) não dorme: executa tarefas pendentes até o
+// que esperava terminar. Por isso é seguro chamar paraleloPara() de dentro de uma tarefa.
+//
+// Instrumentação: estatisticas() devolve, por trabalhador, tarefas executadas, roubos,
+// tentativas de roubo e a fração do tempo ocupada; observar() registra uma função
+// chamada a cada tarefa concluída (para perfis externos).
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace tarefas {
+
+class Agendador;
+
+class Tarefa {
+public:
+    bool concluida() const { return terminou.load(std::memory_order_acquire); }
+
+private:
+    friend class Agendador;
+
+    std::function<void()> funcao;
+    std::atomic<int> dependencias{1}; // O 1 inicial impede a execução antes de enviar()
+    std::atomic<bool> terminou{false};
+    std::mutex mutexSucessores;
+    std::vector<std::shared_ptr<Tarefa>> sucessores;
+    std::shared_ptr<Tarefa> manterViva; // Referência a si mesma enquanto está no agendador
+    bool interna = false;               // Criada por paraleloPara/Grupo: apagada ao terminar
+};
+
+// Fila dupla de Chase–Lev (versão de Lê et al. com o modelo de memória do C++11).
+// Só a thread dona chama empilhar() e desempilhar(); qualquer thread pode chamar roubar().
+class DequeChaseLev {
+public:
+    explicit DequeChaseLev(int64_t capacidadeInicial = 256) {
+        arranjos.emplace_back(new Arranjo(capacidadeInicial));
+        arranjo.store(arranjos.back().get(), std::memory_order_relaxed);
+    }
+
+    void empilhar(Tarefa* tarefa) {
+        int64_t b = fundo.load(std::memory_order_relaxed);
+        int64_t t = topo.load(std::memory_order_acquire);
+        Arranjo* a = arranjo.load(std::memory_order_relaxed);
+        if (b - t > a->capacidade - 1)
+            a = crescer(a, b, t);
+        a->escrever(b, tarefa);
+        std::atomic_thread_fence(std::memory_order_release);
+        fundo.store(b + 1, std::memory_order_relaxed);
+    }
+
+    Tarefa* desempilhar() {
+        int64_t b = fundo.load(std::memory_order_relaxed) - 1;
+        Arranjo* a = arranjo.load(std::memory_order_relaxed);
+        fundo.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = topo.load(std::memory_order_relaxed);
+        if (t > b) { // Vazia
+            fundo.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        Tarefa* tarefa = a->ler(b);
+        if (t == b) { // Último elemento: disputa com os ladrões
+            if (!topo.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                tarefa = nullptr;
+            fundo.store(b + 1, std::memory_order_relaxed);
+        }
+        return tarefa;
+    }
+
+    Tarefa* roubar() {
+        int64_t t = topo.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = fundo.load(std::memory_order_acquire);
+        if (t >= b)
+            return nullptr;
+        Arranjo* a = arranjo.load(std::memory_order_acquire);
+        Tarefa* tarefa = a->ler(t);
+        if (!topo.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr; // Outro ladrão (ou a dona) levou primeiro
+        return tarefa;
+    }
+
+    bool vazia() const {
+        return topo.load(std::memory_order_relaxed) >= fundo.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Arranjo {
+        int64_t capacidade; // Potência de 2
+        std::unique_ptr<std::atomic<Tarefa*>[]> itens;
+        explicit Arranjo(int64_t capacidade) : capacidade(capacidade), itens(new std::atomic<Tarefa*>[capacidade]) {}
+        Tarefa* ler(int64_t i) const { return itens[i & (capacidade - 1)].load(std::memory_order_relaxed); }
+        void escrever(int64_t i, Tarefa* t) { itens[i & (capacidade - 1)].store(t, std::memory_order_relaxed); }
+    };
+
+    // Os arranjos antigos ficam guardados até o fim: um ladrão pode estar lendo deles
+    Arranjo* crescer(Arranjo* antigo, int64_t b, int64_t t) {
+        arranjos.emplace_back(new Arranjo(2 * antigo->capacidade));
+        Arranjo* novo = arranjos.back().get();
+        for (int64_t i = t; i < b; ++i)
+            novo->escrever(i, antigo->ler(i));
+        arranjo.store(novo, std::memory_order_release);
+        return novo;
+    }
+
+    alignas(64) std::atomic<int64_t> topo{0};
+    alignas(64) std::atomic<int64_t> fundo{0};
+    std::atomic<Arranjo*> arranjo{nullptr};
+    std::vector<std::unique_ptr<Arranjo>> arranjos;
+};
+
+struct EstatisticasTrabalhador {
+    uint64_t executadas = 0;
+    uint64_t roubos = 0;           // Tarefas tiradas de outra fila
+    uint64_t tentativasRoubo = 0;  // Incluindo as que encontraram a vítima vazia
+    double segundosOcupado = 0.0;
+    double utilizacao = 0.0;       // segundosOcupado / tempo desde o último zerarEstatisticas()
+};
+
+class Agendador {
+public:
+    // numeroTrabalhadores: threads criadas (0 = número de núcleos menos a thread que chama).
+    // fixarAfinidade prende o trabalhador i ao núcleo i + 1 (só no Linux; ignorado nos demais).
+    explicit Agendador(unsigned numeroTrabalhadores = 0, bool fixarAfinidade = false) {
+        if (numeroTrabalhadores == 0)
+            numeroTrabalhadores = std::max(1u, std::thread::hardware_concurrency()) - 1;
+        // Um espaço a mais (fila e estatísticas) para as threads de fora que ajudam enquanto esperam
+        contadores = std::unique_ptr<Contadores[]>(new Contadores[numeroTrabalhadores + 1]);
+        for (unsigned i = 0; i <= numeroTrabalhadores; ++i)
+            filas.emplace_back(new DequeChaseLev());
+        inicioMedicao = agora();
+        for (unsigned i = 0; i < numeroTrabalhadores; ++i) {
+            trabalhadores.emplace_back([this, i] { laco(i); });
+            if (fixarAfinidade)
+                fixar(trabalhadores.back(), i + 1);
+        }
+    }
+
+    ~Agendador() {
+        {
+            std::lock_guard<std::mutex> trava(mutexInjecao);
+            encerrar = true;
+        }
+        acordar.notify_all();
+        for (std::thread& t : trabalhadores)
+            t.join();
+    }
+
+    Agendador(const Agendador&) = delete;
+    Agendador& operator=(const Agendador&) = delete;
+
+    //--------------------------------------------------------------------------------
+    // Grafo de tarefas
+
+    template <typename Funcao>
+    std::shared_ptr<Tarefa> criar(Funcao funcao) {
+        auto tarefa = std::make_shared<Tarefa>();
+        tarefa->funcao = std::move(funcao);
+        return tarefa;
+    }
+
+    // "posterior" só começa depois que "anterior" terminar. Deve ser chamada antes de
+    // enviar(posterior); se "anterior" já terminou, não há o que esperar.
+    void depois(const std::shared_ptr<Tarefa>& anterior, const std::shared_ptr<Tarefa>& posterior) {
+        std::lock_guard<std::mutex> trava(anterior->mutexSucessores);
+        if (anterior->terminou.load(std::memory_order_relaxed))
+            return;
+        posterior->dependencias.fetch_add(1, std::memory_order_relaxed);
+        anterior->sucessores.push_back(posterior);
+    }
+
+    // Cria, encadeia e envia uma continuação de "anterior"
+    template <typename Funcao>
+    std::shared_ptr<Tarefa> continuar(const std::shared_ptr<Tarefa>& anterior, Funcao funcao) {
+        auto continuacao = criar(std::move(funcao));
+        depois(anterior, continuacao);
+        enviar(continuacao);
+        return continuacao;
+    }
+
+    // Libera a tarefa para rodar assim que as dependências terminarem
+    void enviar(const std::shared_ptr<Tarefa>& tarefa) {
+        tarefa->manterViva = tarefa;
+        liberar(tarefa.get());
+    }
+
+    void esperar(const std::shared_ptr<Tarefa>& tarefa) {
+        Participacao participacao(*this);
+        ajudarAte([&] { return tarefa->concluida(); });
+    }
+
+    //--------------------------------------------------------------------------------
+    // Fork/join
+
+    // Divide [inicio, fim) ao meio até os pedaços terem no máximo "granulo" elementos e
+    // chama funcao(i0, i1) em cada um. Quem chama executa a primeira metade de cada divisão
+    // e só empilha a segunda, que fica disponível para roubo.
+    template <typename Funcao>
+    void paraleloPara(size_t inicio, size_t fim, size_t granulo, const Funcao& funcao) {
+        if (fim <= inicio)
+            return;
+        granulo = std::max<size_t>(granulo, 1);
+        if (trabalhadores.empty() || fim - inicio <= granulo) {
+            funcao(inicio, fim);
+            return;
+        }
+        Participacao participacao(*this);
+        std::atomic<size_t> pendentes{0};
+        dividir(inicio, fim, granulo, funcao, pendentes);
+        ajudarAte([&] { return pendentes.load(std::memory_order_acquire) == 0; });
+    }
+
+    //--------------------------------------------------------------------------------
+    // Instrumentação
+
+    unsigned numeroTrabalhadores() const { return static_cast<unsigned>(trabalhadores.size()); }
+
+    // Um item por trabalhador e, no fim, o das threads de fora que ajudaram ao esperar
+    std::vector<EstatisticasTrabalhador> estatisticas() const {
+        double decorrido = std::max(1e-9, std::chrono::duration<double>(agora() - inicioMedicao).count());
+        std::vector<EstatisticasTrabalhador> resultado(trabalhadores.size() + 1);
+        for (size_t i = 0; i < resultado.size(); ++i) {
+            const Contadores& c = contadores[i];
+            EstatisticasTrabalhador& e = resultado[i];
+            e.executadas = c.executadas.load(std::memory_order_relaxed);
+            e.roubos = c.roubos.load(std::memory_order_relaxed);
+            e.tentativasRoubo = c.tentativasRoubo.load(std::memory_order_relaxed);
+            e.segundosOcupado = c.nanossegundosOcupado.load(std::memory_order_relaxed) * 1e-9;
+            e.utilizacao = std::min(1.0, e.segundosOcupado / decorrido);
+        }
+        return resultado;
+    }
+
+    void zerarEstatisticas() {
+        for (size_t i = 0; i <= trabalhadores.size(); ++i) {
+            contadores[i].executadas.store(0, std::memory_order_relaxed);
+            contadores[i].roubos.store(0, std::memory_order_relaxed);
+            contadores[i].tentativasRoubo.store(0, std::memory_order_relaxed);
+            contadores[i].nanossegundosOcupado.store(0, std::memory_order_relaxed);
+        }
+        inicioMedicao = agora();
+    }
+
+    void imprimirEstatisticas(FILE* saida = stdout) const {
+        std::vector<EstatisticasTrabalhador> e = estatisticas();
+        for (size_t i = 0; i < e.size(); ++i) {
+            if (i + 1 == e.size())
+                fprintf(saida, "  externas       ");
+            else
+                fprintf(saida, "  trabalhador %2zu ", i);
+            fprintf(saida, "%8llu tarefas  %6llu roubos em %8llu tentativas  %5.1f%% ocupado\n",
+                    (unsigned long long)e[i].executadas, (unsigned long long)e[i].roubos,
+                    (unsigned long long)e[i].tentativasRoubo, 100.0 * e[i].utilizacao);
+        }
+    }
+
+    // Chamada a cada tarefa concluída com (trabalhador, segundos de execução); o trabalhador
+    // vale numeroTrabalhadores() para threads de fora. Registre antes de enviar trabalho.
+    void observar(std::function<void(unsigned, double)> observador) { this->observador = std::move(observador); }
+
+private:
+    friend class Grupo;
+
+    struct alignas(64) Contadores {
+        std::atomic<uint64_t> executadas{0}, roubos{0}, tentativasRoubo{0}, nanossegundosOcupado{0};
+    };
+
+    using Relogio = std::chrono::steady_clock;
+    static Relogio::time_point agora() { return Relogio::now(); }
+
+    // Trabalhador da thread atual neste agendador, ou -1 para threads de fora
+    int indiceAtual() const {
+        return agendadorDaThread() == this ? static_cast<int>(indiceDaThread()) : -1;
+    }
+    static const Agendador*& agendadorDaThread() {
+        thread_local const Agendador* agendador = nullptr;
+        return agendador;
+    }
+    static unsigned& indiceDaThread() {
+        thread_local unsigned indice = 0;
+        return indice;
+    }
+
+    // Enquanto existir, dá à thread de fora a fila extra (se estiver livre), para que as
+    // divisões feitas por ela fiquem numa fila sem trava em vez da fila de injeção
+    class Participacao {
+    public:
+        explicit Participacao(Agendador& agendador) : agendador(agendador) {
+            if (agendador.indiceAtual() >= 0 || agendador.filaExternaOcupada.exchange(true, std::memory_order_acquire))
+                return;
+            reservou = true;
+            agendadorAnterior = agendadorDaThread();
+            indiceAnterior = indiceDaThread();
+            agendadorDaThread() = &agendador;
+            indiceDaThread() = static_cast<unsigned>(agendador.trabalhadores.size());
+        }
+        ~Participacao() {
+            if (!reservou)
+                return;
+            agendadorDaThread() = agendadorAnterior;
+            indiceDaThread() = indiceAnterior;
+            agendador.filaExternaOcupada.store(false, std::memory_order_release);
+        }
+        Participacao(const Participacao&) = delete;
+        Participacao& operator=(const Participacao&) = delete;
+
+    private:
+        Agendador& agendador;
+        bool reservou = false;
+        const Agendador* agendadorAnterior = nullptr;
+        unsigned indiceAnterior = 0;
+    };
+
+    static void fixar(std::thread& thread, unsigned nucleo) {
+#ifdef __linux__
+        cpu_set_t conjunto;
+        CPU_ZERO(&conjunto);
+        CPU_SET(nucleo % std::max(1u, std::thread::hardware_concurrency()), &conjunto);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(conjunto), &conjunto);
+#else
+        (void)thread;
+        (void)nucleo;
+#endif
+    }
+
+    template <typename Funcao>
+    Tarefa* interna(Funcao&& funcao) {
+        Tarefa* tarefa = new Tarefa();
+        tarefa->funcao = std::forward<Funcao>(funcao);
+        tarefa->interna = true;
+        tarefa->dependencias.store(0, std::memory_order_relaxed);
+        return tarefa;
+    }
+
+    template <typename Funcao>
+    void dividir(size_t inicio, size_t fim, size_t granulo, const Funcao& funcao, std::atomic<size_t>& pendentes) {
+        while (fim - inicio > granulo) {
+            size_t meio = inicio + (fim - inicio) / 2;
+            pendentes.fetch_add(1, std::memory_order_relaxed);
+            agendar(interna([this, meio, fim, granulo, &funcao, &pendentes] {
+                dividir(meio, fim, granulo, funcao, pendentes);
+                pendentes.fetch_sub(1, std::memory_order_release);
+            }));
+            fim = meio;
+        }
+        funcao(inicio, fim);
+    }
+
+    void liberar(Tarefa* tarefa) {
+        if (tarefa->dependencias.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            agendar(tarefa);
+    }
+
+    // Na fila do próprio trabalhador, se quem chama for um; senão na fila de injeção
+    void agendar(Tarefa* tarefa) {
+        int indice = indiceAtual();
+        if (indice >= 0) {
+            filas[indice]->empilhar(tarefa);
+        } else {
+            std::lock_guard<std::mutex> trava(mutexInjecao);
+            injecao.push_back(tarefa);
+            tamanhoInjecao.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (dormindo.load(std::memory_order_seq_cst) > 0)
+            acordar.notify_one();
+    }
+
+    // Própria fila, depois injeção, depois roubo de uma vítima começando em posição aleatória
+    Tarefa* buscar(int indice, uint32_t& semente) {
+        if (indice >= 0)
+            if (Tarefa* tarefa = filas[indice]->desempilhar())
+                return tarefa;
+        if (tamanhoInjecao.load(std::memory_order_relaxed) > 0) { // Evita a trava quando está vazia
+            std::lock_guard<std::mutex> trava(mutexInjecao);
+            if (!injecao.empty()) {
+                Tarefa* tarefa = injecao.front();
+                injecao.pop_front();
+                tamanhoInjecao.fetch_sub(1, std::memory_order_relaxed);
+                return tarefa;
+            }
+        }
+        size_t n = filas.size();
+        if (n == 0)
+            return nullptr;
+        Contadores& c = contadores[indice >= 0 ? size_t(indice) : trabalhadores.size()];
+        semente = semente * 1664525u + 1013904223u;
+        size_t primeira = (semente >> 8) % n;
+        for (size_t k = 0; k < n; ++k) {
+            size_t vitima = (primeira + k) % n;
+            if (int(vitima) == indice)
+                continue;
+            c.tentativasRoubo.fetch_add(1, std::memory_order_relaxed);
+            if (Tarefa* tarefa = filas[vitima]->roubar()) {
+                c.roubos.fetch_add(1, std::memory_order_relaxed);
+                return tarefa;
+            }
+        }
+        return nullptr;
+    }
+
+    void executar(Tarefa* tarefa, int indice) {
+        unsigned trabalhador = indice >= 0 ? unsigned(indice) : unsigned(trabalhadores.size());
+        Relogio::time_point inicio = agora();
+        tarefa->funcao();
+        double segundos = std::chrono::duration<double>(agora() - inicio).count();
+        Contadores& c = contadores[trabalhador];
+        c.executadas.fetch_add(1, std::memory_order_relaxed);
+        c.nanossegundosOcupado.fetch_add(uint64_t(segundos * 1e9), std::memory_order_relaxed);
+        if (observador)
+            observador(trabalhador, segundos);
+
+        if (tarefa->interna) {
+            delete tarefa;
+            return;
+        }
+        std::vector<std::shared_ptr<Tarefa>> sucessores;
+        {
+            std::lock_guard<std::mutex> trava(tarefa->mutexSucessores);
+            tarefa->terminou.store(true, std::memory_order_release);
+            sucessores.swap(tarefa->sucessores);
+        }
+        for (const std::shared_ptr<Tarefa>& s : sucessores)
+            liberar(s.get());
+        std::shared_ptr<Tarefa> referencia = std::move(tarefa->manterViva); // Pode apagar a tarefa aqui
+    }
+
+    // Executa tarefas pendentes até a condição valer
+    template <typename Condicao>
+    void ajudarAte(const Condicao& condicao) {
+        int indice = indiceAtual();
+        uint32_t semente = uint32_t(reinterpret_cast<uintptr_t>(&indice) >> 4);
+        while (!condicao()) {
+            if (Tarefa* tarefa = buscar(indice, semente))
+                executar(tarefa, indice);
+            else
+                std::this_thread::yield();
+        }
+    }
+
+    void laco(unsigned indice) {
+        agendadorDaThread() = this;
+        indiceDaThread() = indice;
+        uint32_t semente = 2654435761u * (indice + 1);
+        int ociosas = 0;
+        for (;;) {
+            if (Tarefa* tarefa = buscar(int(indice), semente)) {
+                executar(tarefa, int(indice));
+                ociosas = 0;
+                continue;
+            }
+            if (++ociosas < 64) {
+                std::this_thread::yield();
+                continue;
+            }
+            // Dorme até chegar trabalho; o limite de tempo cobre roubos possíveis que não avisam
+            std::unique_lock<std::mutex> trava(mutexInjecao);
+            if (encerrar)
+                return;
+            if (injecao.empty()) {
+                dormindo.fetch_add(1, std::memory_order_seq_cst);
+                acordar.wait_for(trava, std::chrono::milliseconds(1));
+                dormindo.fetch_sub(1, std::memory_order_seq_cst);
+            }
+            ociosas = 0;
+        }
+    }
+
+    std::vector<std::thread> trabalhadores;
+    std::vector<std::unique_ptr<DequeChaseLev>> filas;
+    std::unique_ptr<Contadores[]> contadores;
+    Relogio::time_point inicioMedicao;
+    std::function<void(unsigned, double)> observador;
+
+    std::mutex mutexInjecao;
+    std::condition_variable acordar;
+    std::deque<Tarefa*> injecao;
+    std::atomic<size_t> tamanhoInjecao{0};
+    std::atomic<bool> filaExternaOcupada{false};
+    std::atomic<int> dormindo{0};
+    bool encerrar = false;
+};
+
+// Executa tarefas soltas e espera por todas juntas
+class Grupo {
+public:
+    explicit Grupo(Agendador& agendador) : agendador(agendador) {}
+    ~Grupo() { esperar(); }
+    Grupo(const Grupo&) = delete;
+    Grupo& operator=(const Grupo&) = delete;
+
+    template <typename Funcao>
+    void executar(Funcao funcao) {
+        pendentes.fetch_add(1, std::memory_order_relaxed);
+        agendador.agendar(agendador.interna([this, funcao = std::move(funcao)]() mutable {
+            funcao();
+            pendentes.fetch_sub(1, std::memory_order_release);
+        }));
+    }
+
+    void esperar() {
+        Agendador::Participacao participacao(agendador);
+        agendador.ajudarAte([this] { return pendentes.load(std::memory_order_acquire) == 0; });
+    }
+
+private:
+    Agendador& agendador;
+    std::atomic<size_t> pendentes{0};
+};
+
+// Agendador compartilhado pelo programa, criado no primeiro uso
+inline Agendador& padrao() {
+    static Agendador agendador;
+    return agendador;
+}
+
+} // namespace tarefas
@@ -0,0 +1,373 @@
+// Transformação em lote de vértices pela matriz 4x4 na CPU
+//
+// Equivalente no host ao "gl_Position = mvp * vec4(posicao, 1.0)" dos shaders, para
+// caminhos que rodam na CPU (rasterização em software, exportação, descarte):
+//  - transformarSoA: x[], y[], z[] -> x[], y[], z[], w[] em coordenadas de recorte;
+//  - transformarAoS: xyz intercalados -> xyzw intercalados;
+//  - projetarSoA: transformação + divisão perspectiva + mapeamento para o viewport
+//    (x, y em pixels, z em [0, 1] como em glDepthRange(0, 1)); w de recorte é
+//    devolvido para que o chamador descarte vértices com w <= 0.
+//
+// As matrizes seguem a ordem de colunas do OpenGL/GLM (glm::value_ptr). Em x86 a
+// implementação é escolhida em tempo de execução entre AVX-512, AVX2+FMA e SSE;
+// nas demais plataformas usa simd::f4 (NEON ou escalar). As versões "Paralelo"
+// dividem o intervalo entre os trabalhadores de tarefas::padrao().
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#include "simd.hpp"
+#include "tarefas.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#  include <immintrin.h>
+#  define TRANSFORMACAO_LOTE_X86 1
+#endif
+
+namespace lote {
+
+struct Viewport {
+    float x, y, largura, altura;
+};
+
+//--------------------------------------------------------------------------------
+// Versões de referência, um vértice por vez
+
+inline void transformarSoAEscalar(const float* m, const float* x, const float* y, const float* z, size_t n,
+                                  float* ox, float* oy, float* oz, float* ow) {
+    for (size_t i = 0; i < n; ++i) {
+        float xi = x[i], yi = y[i], zi = z[i];
+        ox[i] = m[0] * xi + m[4] * yi + m[8] * zi + m[12];
+        oy[i] = m[1] * xi + m[5] * yi + m[9] * zi + m[13];
+        oz[i] = m[2] * xi + m[6] * yi + m[10] * zi + m[14];
+        ow[i] = m[3] * xi + m[7] * yi + m[11] * zi + m[15];
+    }
+}
+
+inline void projetarSoAEscalar(const float* m, const Viewport& v, const float* x, const float* y, const float* z, size_t n,
+                               float* sx, float* sy, float* sz, float* sw) {
+    for (size_t i = 0; i < n; ++i) {
+        float xi = x[i], yi = y[i], zi = z[i];
+        float cx = m[0] * xi + m[4] * yi + m[8] * zi + m[12];
+        float cy = m[1] * xi + m[5] * yi + m[9] * zi + m[13];
+        float cz = m[2] * xi + m[6] * yi + m[10] * zi + m[14];
+        float cw = m[3] * xi + m[7] * yi + m[11] * zi + m[15];
+        float inverso = 1.0f / cw;
+        sx[i] = v.x + (cx * inverso * 0.5f + 0.5f) * v.largura;
+        sy[i] = v.y + (cy * inverso * 0.5f + 0.5f) * v.altura;
+        sz[i] = cz * inverso * 0.5f + 0.5f;
+        sw[i] = cw;
+    }
+}
+
+//--------------------------------------------------------------------------------
+// 4 vértices por iteração com simd::f4 (SSE, NEON ou escalar)
+
+namespace detalhe {
+
+// Linha i da matriz difundida em 4 pistas: m[i], m[4+i], m[8+i], m[12+i]
+struct LinhasF4 {
+    simd::f4 l[4][4];
+    explicit LinhasF4(const float* m) {
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 4; ++j)
+                l[i][j] = simd::difundir(m[j * 4 + i]);
+    }
+    simd::f4 linha(int i, simd::f4 x, simd::f4 y, simd::f4 z) const {
+        return simd::multiplicarSomar(l[i][0], x, simd::multiplicarSomar(l[i][1], y, simd::multiplicarSomar(l[i][2], z, l[i][3])));
+    }
+};
+
+inline void transformarSoAF4(const float* m, const float* x, const float* y, const float* z, size_t n,
+                             float* ox, float* oy, float* oz, float* ow) {
+    LinhasF4 linhas(m);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        simd::f4 xi = simd::carregar(x + i), yi = simd::carregar(y + i), zi = simd::carregar(z + i);
+        simd::armazenar(ox + i, linhas.linha(0, xi, yi, zi));
+        simd::armazenar(oy + i, linhas.linha(1, xi, yi, zi));
+        simd::armazenar(oz + i, linhas.linha(2, xi, yi, zi));
+        simd::armazenar(ow + i, linhas.linha(3, xi, yi, zi));
+    }
+    transformarSoAEscalar(m, x + i, y + i, z + i, n - i, ox + i, oy + i, oz + i, ow + i);
+}
+
+inline void projetarSoAF4(const float* m, const Viewport& v, const float* x, const float* y, const float* z, size_t n,
+                          float* sx, float* sy, float* sz, float* sw) {
+    LinhasF4 linhas(m);
+    simd::f4 meio = simd::difundir(0.5f), um = simd::difundir(1.0f);
+    simd::f4 escalaX = simd::difundir(0.5f * v.largura), baseX = simd::difundir(v.x + 0.5f * v.largura);
+    simd::f4 escalaY = simd::difundir(0.5f * v.altura), baseY = simd::difundir(v.y + 0.5f * v.altura);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        simd::f4 xi = simd::carregar(x + i), yi = simd::carregar(y + i), zi = simd::carregar(z + i);
+        simd::f4 cw = linhas.linha(3, xi, yi, zi);
+        simd::f4 inverso = um / cw;
+        simd::armazenar(sx + i, simd::multiplicarSomar(linhas.linha(0, xi, yi, zi) * inverso, escalaX, baseX));
+        simd::armazenar(sy + i, simd::multiplicarSomar(linhas.linha(1, xi, yi, zi) * inverso, escalaY, baseY));
+        simd::armazenar(sz + i, simd::multiplicarSomar(linhas.linha(2, xi, yi, zi) * inverso, meio, meio));
+        simd::armazenar(sw + i, cw);
+    }
+    projetarSoAEscalar(m, v, x + i, y + i, z + i, n - i, sx + i, sy + i, sz + i, sw + i);
+}
+
+// AoS: cada vértice é c0 * x + c1 * y + c2 * z + c3, com as colunas da matriz em f4
+inline void transformarAoSF4(const float* m, const float* xyz, size_t n, float* xyzw) {
+    simd::f4 c0 = simd::carregar(m), c1 = simd::carregar(m + 4), c2 = simd::carregar(m + 8), c3 = simd::carregar(m + 12);
+    for (size_t i = 0; i < n; ++i) {
+        const float* p = xyz + 3 * i;
+        simd::f4 r = simd::multiplicarSomar(c0, simd::difundir(p[0]), c3);
+        r = simd::multiplicarSomar(c1, simd::difundir(p[1]), r);
+        r = simd::multiplicarSomar(c2, simd::difundir(p[2]), r);
+        simd::armazenar(xyzw + 4 * i, r);
+    }
+}
+
+#if defined(TRANSFORMACAO_LOTE_X86)
+
+//--------------------------------------------------------------------------------
+// AVX2 + FMA: 8 vértices por iteração (SoA) ou 2 vértices por registrador (AoS)
+
+__attribute__((target("avx2,fma")))
+inline void transformarSoAAVX2(const float* m, const float* x, const float* y, const float* z, size_t n,
+                               float* ox, float* oy, float* oz, float* ow) {
+    __m256 l[4][4];
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 4; ++j)
+            l[i][j] = _mm256_set1_ps(m[j * 4 + i]);
+    float* saidas[4] = {ox, oy, oz, ow};
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 xi = _mm256_loadu_ps(x + i), yi = _mm256_loadu_ps(y + i), zi = _mm256_loadu_ps(z + i);
+        for (int k = 0; k < 4; ++k)
+            _mm256_storeu_ps(saidas[k] + i, _mm256_fmadd_ps(l[k][0], xi, _mm256_fmadd_ps(l[k][1], yi, _mm256_fmadd_ps(l[k][2], zi, l[k][3]))));
+    }
+    transformarSoAEscalar(m, x + i, y + i, z + i, n - i, ox + i, oy + i, oz + i, ow + i);
+}
+
+__attribute__((target("avx2,fma")))
+inline void projetarSoAAVX2(const float* m, const Viewport& v, const float* x, const float* y, const float* z, size_t n,
+                            float* sx, float* sy, float* sz, float* sw) {
+    __m256 l[4][4];
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 4; ++j)
+            l[i][j] = _mm256_set1_ps(m[j * 4 + i]);
+    __m256 meio = _mm256_set1_ps(0.5f), um = _mm256_set1_ps(1.0f);
+    __m256 escalaX = _mm256_set1_ps(0.5f * v.largura), baseX = _mm256_set1_ps(v.x + 0.5f * v.largura);
+    __m256 escalaY = _mm256_set1_ps(0.5f * v.altura), baseY = _mm256_set1_ps(v.y + 0.5f * v.altura);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 xi = _mm256_loadu_ps(x + i), yi = _mm256_loadu_ps(y + i), zi = _mm256_loadu_ps(z + i);
+        __m256 c[4];
+        for (int k = 0; k < 4; ++k)
+            c[k] = _mm256_fmadd_ps(l[k][0], xi, _mm256_fmadd_ps(l[k][1], yi, _mm256_fmadd_ps(l[k][2], zi, l[k][3])));
+        __m256 inverso = _mm256_div_ps(um, c[3]);
+        _mm256_storeu_ps(sx + i, _mm256_fmadd_ps(_mm256_mul_ps(c[0], inverso), escalaX, baseX));
+        _mm256_storeu_ps(sy + i, _mm256_fmadd_ps(_mm256_mul_ps(c[1], inverso), escalaY, baseY));
+        _mm256_storeu_ps(sz + i, _mm256_fmadd_ps(_mm256_mul_ps(c[2], inverso), meio, meio));
+        _mm256_storeu_ps(sw + i, c[3]);
+    }
+    projetarSoAEscalar(m, v, x + i, y + i, z + i, n - i, sx + i, sy + i, sz + i, sw + i);
+}
+
+__attribute__((target("avx2,fma")))
+inline void transformarAoSAVX2(const float* m, const float* xyz, size_t n, float* xyzw) {
+    // Cada coluna é repetida nas duas metades: a metade baixa calcula o vértice i e a alta o i + 1
+    __m256 c0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m));
+    __m256 c1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 4));
+    __m256 c2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 8));
+    __m256 c3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 12));
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        const float* p = xyz + 3 * i;
+        __m256 x = _mm256_set_m128(_mm_set1_ps(p[3]), _mm_set1_ps(p[0]));
+        __m256 y = _mm256_set_m128(_mm_set1_ps(p[4]), _mm_set1_ps(p[1]));
+        __m256 z = _mm256_set_m128(_mm_set1_ps(p[5]), _mm_set1_ps(p[2]));
+        _mm256_storeu_ps(xyzw + 4 * i, _mm256_fmadd_ps(c0, x, _mm256_fmadd_ps(c1, y, _mm256_fmadd_ps(c2, z, c3))));
+    }
+    transformarAoSF4(m, xyz + 3 * i, n - i, xyzw + 4 * i);
+}
+
+//--------------------------------------------------------------------------------
+// AVX-512: 16 vértices por iteração (SoA) ou 4 vértices por registrador (AoS)
+
+__attribute__((target("avx512f")))
+inline void transformarSoAAVX512(const float* m, const float* x, const float* y, const float* z, size_t n,
+                                 float* ox, float* oy, float* oz, float* ow) {
+    __m512 l[4][4];
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 4; ++j)
+            l[i][j] = _mm512_set1_ps(m[j * 4 + i]);
+    float* saidas[4] = {ox, oy, oz, ow};
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 xi = _mm512_loadu_ps(x + i), yi = _mm512_loadu_ps(y + i), zi = _mm512_loadu_ps(z + i);
+        for (int k = 0; k < 4; ++k)
+            _mm512_storeu_ps(saidas[k] + i, _mm512_fmadd_ps(l[k][0], xi, _mm512_fmadd_ps(l[k][1], yi, _mm512_fmadd_ps(l[k][2], zi, l[k][3]))));
+    }
+    transformarSoAEscalar(m, x + i, y + i, z + i, n - i, ox + i, oy + i, oz + i, ow + i);
+}
+
+__attribute__((target("avx512f")))
+inline void projetarSoAAVX512(const float* m, const Viewport& v, const float* x, const float* y, const float* z, size_t n,
+                              float* sx, float* sy, float* sz, float* sw) {
+    __m512 l[4][4];
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 4; ++j)
+            l[i][j] = _mm512_set1_ps(m[j * 4 + i]);
+    __m512 meio = _mm512_set1_ps(0.5f), um = _mm512_set1_ps(1.0f);
+    __m512 escalaX = _mm512_set1_ps(0.5f * v.largura), baseX = _mm512_set1_ps(v.x + 0.5f * v.largura);
+    __m512 escalaY = _mm512_set1_ps(0.5f * v.altura), baseY = _mm512_set1_ps(v.y + 0.5f * v.altura);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 xi = _mm512_loadu_ps(x + i), yi = _mm512_loadu_ps(y + i), zi = _mm512_loadu_ps(z + i);
+        __m512 c[4];
+        for (int k = 0; k < 4; ++k)
+            c[k] = _mm512_fmadd_ps(l[k][0], xi, _mm512_fmadd_ps(l[k][1], yi, _mm512_fmadd_ps(l[k][2], zi, l[k][3])));
+        __m512 inverso = _mm512_div_ps(um, c[3]);
+        _mm512_storeu_ps(sx + i, _mm512_fmadd_ps(_mm512_mul_ps(c[0], inverso), escalaX, baseX));
+        _mm512_storeu_ps(sy + i, _mm512_fmadd_ps(_mm512_mul_ps(c[1], inverso), escalaY, baseY));
+        _mm512_storeu_ps(sz + i, _mm512_fmadd_ps(_mm512_mul_ps(c[2], inverso), meio, meio));
+        _mm512_storeu_ps(sw + i, c[3]);
+    }
+    projetarSoAEscalar(m, v, x + i, y + i, z + i, n - i, sx + i, sy + i, sz + i, sw + i);
+}
+
+__attribute__((target("avx512f")))
+inline void transformarAoSAVX512(const float* m, const float* xyz, size_t n, float* xyzw) {
+    // Cada coluna repetida nas quatro faixas de 128 bits; a faixa k calcula o vértice i + k.
+    // Os 12 floats de 4 vértices vêm em uma carga com máscara (sem ler além do fim) e são
+    // espalhados pelas faixas com uma permutação por coordenada
+    __m512 c0 = _mm512_broadcast_f32x4(_mm_loadu_ps(m));
+    __m512 c1 = _mm512_broadcast_f32x4(_mm_loadu_ps(m + 4));
+    __m512 c2 = _mm512_broadcast_f32x4(_mm_loadu_ps(m + 8));
+    __m512 c3 = _mm512_broadcast_f32x4(_mm_loadu_ps(m + 12));
+    const __m512i indiceX = _mm512_set_epi32(9, 9, 9, 9, 6, 6, 6, 6, 3, 3, 3, 3, 0, 0, 0, 0);
+    const __m512i um = _mm512_set1_epi32(1);
+    const __m512i indiceY = _mm512_add_epi32(indiceX, um), indiceZ = _mm512_add_epi32(indiceY, um);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m512 p = _mm512_maskz_loadu_ps(0x0FFF, xyz + 3 * i);
+        __m512 x = _mm512_permutexvar_ps(indiceX, p);
+        __m512 y = _mm512_permutexvar_ps(indiceY, p);
+        __m512 z = _mm512_permutexvar_ps(indiceZ, p);
+        _mm512_storeu_ps(xyzw + 4 * i, _mm512_fmadd_ps(c0, x, _mm512_fmadd_ps(c1, y, _mm512_fmadd_ps(c2, z, c3))));
+    }
+    transformarAoSF4(m, xyz + 3 * i, n - i, xyzw + 4 * i);
+}
+
+#endif
+
+enum class Instrucoes { F4, AVX2, AVX512 };
+
+// Conjunto de instruções detectado uma única vez
+inline Instrucoes instrucoesDisponiveis() {
+#if defined(TRANSFORMACAO_LOTE_X86)
+    static const Instrucoes detectadas = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return Instrucoes::AVX512;
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return Instrucoes::AVX2;
+        return Instrucoes::F4;
+    }();
+    return detectadas;
+#else
+    return Instrucoes::F4;
+#endif
+}
+
+} // namespace detalhe
+
+inline const char* nomeInstrucoes() {
+    switch (detalhe::instrucoesDisponiveis()) {
+        case detalhe::Instrucoes::AVX512: return "AVX-512";
+        case detalhe::Instrucoes::AVX2: return "AVX2+FMA";
+        default:
+#if defined(SIMD_SSE)
+            return "SSE";
+#elif defined(SIMD_NEON)
+            return "NEON";
+#else
+            return "escalar";
+#endif
+    }
+}
+
+//--------------------------------------------------------------------------------
+// Pontos de entrada com escolha automática do conjunto de instruções
+
+inline void transformarSoA(const float* m, const float* x, const float* y, const float* z, size_t n,
+                           float* ox, float* oy, float* oz, float* ow) {
+#if defined(TRANSFORMACAO_LOTE_X86)
+    switch (detalhe::instrucoesDisponiveis()) {
+        case detalhe::Instrucoes::AVX512: detalhe::transformarSoAAVX512(m, x, y, z, n, ox, oy, oz, ow); return;
+        case detalhe::Instrucoes::AVX2: detalhe::transformarSoAAVX2(m, x, y, z, n, ox, oy, oz, ow); return;
+        default: break;
+    }
+#endif
+    detalhe::transformarSoAF4(m, x, y, z, n, ox, oy, oz, ow);
+}
+
+inline void projetarSoA(const float* m, const Viewport& v, const float* x, const float* y, const float* z, size_t n,
+                        float* sx, float* sy, float* sz, float* sw) {
+#if defined(TRANSFORMACAO_LOTE_X86)
+    switch (detalhe::instrucoesDisponiveis()) {
+        case detalhe::Instrucoes::AVX512: detalhe::projetarSoAAVX512(m, v, x, y, z, n, sx, sy, sz, sw); return;
+        case detalhe::Instrucoes::AVX2: detalhe::projetarSoAAVX2(m, v, x, y, z, n, sx, sy, sz, sw); return;
+        default: break;
+    }
+#endif
+    detalhe::projetarSoAF4(m, v, x, y, z, n, sx, sy, sz, sw);
+}
+
+inline void transformarAoS(const float* m, const float* xyz, size_t n, float* xyzw) {
+#if defined(TRANSFORMACAO_LOTE_X86)
+    switch (detalhe::instrucoesDisponiveis()) {
+        case detalhe::Instrucoes::AVX512: detalhe::transformarAoSAVX512(m, xyz, n, xyzw); return;
+        case detalhe::Instrucoes::AVX2: detalhe::transformarAoSAVX2(m, xyz, n, xyzw); return;
+        default: break;
+    }
+#endif
+    detalhe::transformarAoSF4(m, xyz, n, xyzw);
+}
+
+//--------------------------------------------------------------------------------
+// Divide [0, n) entre os trabalhadores do agendador compartilhado (tarefas::padrao()),
+// em pedaços de pelo menos "granulo" vértices; pedaços menores não compensam o custo
+// de despachar a tarefa. Para rodar só na thread que chama, use as versões sem "Paralelo".
+template <typename Funcao>
+void executarEmParalelo(size_t n, Funcao funcao, size_t granulo = 1 << 16) {
+    if (n <= granulo) {
+        funcao(size_t(0), n);
+        return;
+    }
+    // A divisão é feita em blocos de 16 vértices: fronteiras múltiplas de 16 mantêm os
+    // laços vetoriais sem resto no meio do array
+    size_t blocos = (n + 15) / 16;
+    tarefas::padrao().paraleloPara(0, blocos, std::max<size_t>(1, granulo / 16), [&](size_t b0, size_t b1) {
+        funcao(16 * b0, std::min(n, 16 * b1));
+    });
+}
+
+inline void transformarSoAParalelo(const float* m, const float* x, const float* y, const float* z, size_t n,
+                                   float* ox, float* oy, float* oz, float* ow) {
+    executarEmParalelo(n, [=](size_t inicio, size_t fim) {
+        transformarSoA(m, x + inicio, y + inicio, z + inicio, fim - inicio, ox + inicio, oy + inicio, oz + inicio, ow + inicio);
+    });
+}
+
+inline void projetarSoAParalelo(const float* m, const Viewport& v, const float* x, const float* y, const float* z, size_t n,
+                                float* sx, float* sy, float* sz, float* sw) {
+    Viewport copia = v;
+    executarEmParalelo(n, [=](size_t inicio, size_t fim) {
+        projetarSoA(m, copia, x + inicio, y + inicio, z + inicio, fim - inicio, sx + inicio, sy + inicio, sz + inicio, sw + inicio);
+    });
+}
+
+inline void transformarAoSParalelo(const float* m, const float* xyz, size_t n, float* xyzw) {
+    executarEmParalelo(n, [=](size_t inicio, size_t fim) {
+        transformarAoS(m, xyz + 3 * inicio, fim - inicio, xyzw + 4 * inicio);
+    });
+}
+
+} // namespace lote
@@ -0,0 +1,577 @@
+// Desenho vetorial 2D: caminhos, traços, preenchimentos e transformações, renderizados em
+// ladrilhos paralelos sobre imagem::Imagem
+//
+// vetorial::Caminho guarda comandos como os do canvas/SVG (moverPara, linhaPara,
+// quadraticaPara, cubicaPara, fechar). vetorial::Cena reduz cada preencher()/tracar() a
+// arestas em pixels assim que é chamada:
+//  - as curvas viram segmentos em número dado pela fórmula de Wang, o bastante para o erro
+//    ficar abaixo de TOLERANCIA pixel depois da transformação: curvas pequenas custam poucos
+//    segmentos e as grandes não ficam facetadas;
+//  - os traços viram polígonos convexos (um retângulo por segmento, junções e pontas), todos
+//    no mesmo sentido, que a regra não zero une sem costuras.
+// renderizar() distribui as primitivas nos ladrilhos de LADO_LADRILHO pixels que a caixa de
+// cada uma toca e rasteriza os ladrilhos em paralelo (tarefas::padrao()), cada um com uma
+// raster::Cobertura pequena que fica na cache, compondo na ordem em que foram desenhadas.
+// vetorial::referencia::renderizar() desenha primitiva por primitiva na imagem inteira,
+// para conferir; cores_imagens/vetorial_benchmark.cpp mede as duas.
+//
+//   vetorial::Cena cena;
+//   vetorial::Caminho petala;
+//   petala.moverPara(0, 0).linhaPara(100, 0);
+//   cena.tracar(petala, {255, 255, 0}, vetorial::Traco{2.0f}, vetorial::Transformacao::translacao(128, 128));
+//   cena.preencher(vetorial::Caminho::circulo(128, 128, 50), {255, 165, 0});
+//   cena.renderizar(img);
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "imagem.hpp"
+#include "rasterizacao.hpp"
+#include "tarefas.hpp"
+
+namespace vetorial {
+
+using raster::Ponto;
+using Cor = std::array<uint8_t, 3>; // Em imagens cinza vale o primeiro canal
+
+const float TOLERANCIA = 0.2f; // Distância máxima, em pixels, entre a curva e os segmentos
+const int LADO_LADRILHO = 64;
+
+// Transformação afim como a do canvas: x' = a x + c y + e, y' = b x + d y + f
+struct Transformacao {
+    float a = 1, b = 0, c = 0, d = 1, e = 0, f = 0;
+
+    static Transformacao translacao(float x, float y) { return {1, 0, 0, 1, x, y}; }
+    static Transformacao escala(float sx, float sy) { return {sx, 0, 0, sy, 0, 0}; }
+    // Em radianos; com y para baixo, ângulos positivos giram no sentido horário da tela
+    static Transformacao rotacao(float angulo) {
+        float s = std::sin(angulo), co = std::cos(angulo);
+        return {co, s, -s, co, 0, 0};
+    }
+
+    Ponto aplicar(Ponto p) const { return {a * p.x + c * p.y + e, b * p.x + d * p.y + f}; }
+    // (t * u).aplicar(p) == t.aplicar(u.aplicar(p))
+    Transformacao operator*(const Transformacao& u) const {
+        return {a * u.a + c * u.b, b * u.a + d * u.b, a * u.c + c * u.d, b * u.c + d * u.d, a * u.e + c * u.f + e, b * u.e + d * u.f + f};
+    }
+    // Maior ampliação de um comprimento (maior valor singular), para levar tolerâncias em
+    // pixels ao espaço do caminho
+    float ampliacaoMaxima() const {
+        float p = (a * a + b * b + c * c + d * d) * 0.5f, q = a * d - b * c;
+        return std::sqrt(p + std::sqrt(std::max(0.0f, p * p - q * q)));
+    }
+};
+
+class Caminho {
+public:
+    enum Verbo : uint8_t { MOVER, LINHA, QUADRATICA, CUBICA, FECHAR };
+
+    Caminho& moverPara(float x, float y) {
+        listaVerbos.push_back(MOVER);
+        listaPontos.push_back({x, y});
+        inicio = {x, y};
+        aberto = true;
+        return *this;
+    }
+    Caminho& linhaPara(float x, float y) {
+        continuar();
+        listaVerbos.push_back(LINHA);
+        listaPontos.push_back({x, y});
+        return *this;
+    }
+    Caminho& quadraticaPara(float cx, float cy, float x, float y) {
+        continuar();
+        listaVerbos.push_back(QUADRATICA);
+        listaPontos.insert(listaPontos.end(), {Ponto{cx, cy}, Ponto{x, y}});
+        return *this;
+    }
+    Caminho& cubicaPara(float c1x, float c1y, float c2x, float c2y, float x, float y) {
+        continuar();
+        listaVerbos.push_back(CUBICA);
+        listaPontos.insert(listaPontos.end(), {Ponto{c1x, c1y}, Ponto{c2x, c2y}, Ponto{x, y}});
+        return *this;
+    }
+    // Liga ao começo do subcaminho; o próximo comando sem moverPara() recomeça de lá
+    Caminho& fechar() {
+        if (aberto) {
+            listaVerbos.push_back(FECHAR);
+            aberto = false;
+        }
+        return *this;
+    }
+
+    static Caminho retangulo(float x, float y, float largura, float altura) {
+        Caminho c;
+        c.moverPara(x, y).linhaPara(x + largura, y).linhaPara(x + largura, y + altura).linhaPara(x, y + altura).fechar();
+        return c;
+    }
+    // Quatro cúbicas (erro de raio de 0,03%)
+    static Caminho elipse(float cx, float cy, float rx, float ry) {
+        const float k = 0.5522847f;
+        Caminho c;
+        c.moverPara(cx + rx, cy)
+            .cubicaPara(cx + rx, cy + k * ry, cx + k * rx, cy + ry, cx, cy + ry)
+            .cubicaPara(cx - k * rx, cy + ry, cx - rx, cy + k * ry, cx - rx, cy)
+            .cubicaPara(cx - rx, cy - k * ry, cx - k * rx, cy - ry, cx, cy - ry)
+            .cubicaPara(cx + k * rx, cy - ry, cx + rx, cy - k * ry, cx + rx, cy)
+            .fechar();
+        return c;
+    }
+    static Caminho circulo(float cx, float cy, float raio) { return elipse(cx, cy, raio, raio); }
+
+    bool vazio() const { return listaVerbos.empty(); }
+    const std::vector<Verbo>& verbos() const { return listaVerbos; }
+    const std::vector<Ponto>& pontos() const { return listaPontos; }
+
+private:
+    // Sem subcaminho aberto, começa um no início do último (ou na origem)
+    void continuar() {
+        if (!aberto)
+            moverPara(inicio.x, inicio.y);
+    }
+
+    std::vector<Verbo> listaVerbos;
+    std::vector<Ponto> listaPontos; // MOVER e LINHA usam 1, QUADRATICA 2, CUBICA 3, FECHAR nenhum
+    Ponto inicio{0.0f, 0.0f};
+    bool aberto = false;
+};
+
+enum Juncao { JUNCAO_MITRA, JUNCAO_REDONDA, JUNCAO_CHANFRADA };
+enum Ponta { PONTA_RETA, PONTA_REDONDA, PONTA_QUADRADA };
+
+struct Traco {
+    float largura = 1.0f;
+    Juncao juncao = JUNCAO_MITRA;
+    Ponta ponta = PONTA_RETA;
+    float limiteMitra = 4.0f; // Comprimento máximo da mitra em larguras (o miterlimit do SVG)
+};
+
+namespace detalhe {
+
+// Subcaminhos achatados em segmentos
+struct Polilinhas {
+    std::vector<Ponto> pontos;
+    std::vector<uint32_t> fins;   // Um depois do último ponto de cada subcaminho
+    std::vector<uint8_t> fechadas;
+
+    void limpar() {
+        pontos.clear();
+        fins.clear();
+        fechadas.clear();
+    }
+};
+
+inline Ponto interpolarQuadratica(Ponto p0, Ponto p1, Ponto p2, float t) {
+    float mt = 1.0f - t;
+    return {mt * mt * p0.x + 2.0f * mt * t * p1.x + t * t * p2.x, mt * mt * p0.y + 2.0f * mt * t * p1.y + t * t * p2.y};
+}
+
+inline Ponto interpolarCubica(Ponto p0, Ponto p1, Ponto p2, Ponto p3, float t) {
+    float mt = 1.0f - t, a = mt * mt * mt, b = 3.0f * mt * mt * t, c = 3.0f * mt * t * t, d = t * t * t;
+    return {a * p0.x + b * p1.x + c * p2.x + d * p3.x, a * p0.y + b * p1.y + c * p2.y + d * p3.y};
+}
+
+// Fórmula de Wang: com n pedaços iguais em t, a corda se afasta da curva no máximo
+// max|B''| / (8 n²)
+inline int pedacosQuadratica(Ponto p0, Ponto p1, Ponto p2, float tolerancia) {
+    float segunda = std::hypot(p0.x - 2.0f * p1.x + p2.x, p0.y - 2.0f * p1.y + p2.y); // |B''| / 2
+    return std::max(1, std::min(1024, int(std::ceil(std::sqrt(segunda / (4.0f * tolerancia))))));
+}
+
+inline int pedacosCubica(Ponto p0, Ponto p1, Ponto p2, Ponto p3, float tolerancia) {
+    float segunda = std::max(std::hypot(p0.x - 2.0f * p1.x + p2.x, p0.y - 2.0f * p1.y + p2.y),
+                             std::hypot(p1.x - 2.0f * p2.x + p3.x, p1.y - 2.0f * p2.y + p3.y)); // max|B''| / 6
+    return std::max(1, std::min(1024, int(std::ceil(std::sqrt(3.0f * segunda / (4.0f * tolerancia))))));
+}
+
+// Achata o caminho, com os pontos já transformados por t
+inline void achatar(const Caminho& caminho, const Transformacao& t, float tolerancia, Polilinhas& saida) {
+    saida.limpar();
+    const std::vector<Ponto>& p = caminho.pontos();
+    size_t k = 0;
+    auto terminar = [&](bool fechada) {
+        if (!saida.pontos.empty() && (saida.fins.empty() || saida.fins.back() < saida.pontos.size())) {
+            saida.fins.push_back(uint32_t(saida.pontos.size()));
+            saida.fechadas.push_back(fechada);
+        }
+    };
+    for (Caminho::Verbo verbo : caminho.verbos()) {
+        switch (verbo) {
+        case Caminho::MOVER:
+            terminar(false);
+            saida.pontos.push_back(t.aplicar(p[k++]));
+            break;
+        case Caminho::LINHA:
+            saida.pontos.push_back(t.aplicar(p[k++]));
+            break;
+        case Caminho::QUADRATICA: {
+            Ponto p0 = saida.pontos.back(), p1 = t.aplicar(p[k]), p2 = t.aplicar(p[k + 1]);
+            k += 2;
+            const int n = pedacosQuadratica(p0, p1, p2, tolerancia);
+            for (int i = 1; i < n; ++i)
+                saida.pontos.push_back(interpolarQuadratica(p0, p1, p2, float(i) / n));
+            saida.pontos.push_back(p2);
+            break;
+        }
+        case Caminho::CUBICA: {
+            Ponto p0 = saida.pontos.back(), p1 = t.aplicar(p[k]), p2 = t.aplicar(p[k + 1]), p3 = t.aplicar(p[k + 2]);
+            k += 3;
+            const int n = pedacosCubica(p0, p1, p2, p3, tolerancia);
+            for (int i = 1; i < n; ++i)
+                saida.pontos.push_back(interpolarCubica(p0, p1, p2, p3, float(i) / n));
+            saida.pontos.push_back(p3);
+            break;
+        }
+        case Caminho::FECHAR:
+            terminar(true);
+            break;
+        }
+    }
+    terminar(false);
+}
+
+inline Ponto somar(Ponto a, Ponto b) { return {a.x + b.x, a.y + b.y}; }
+inline Ponto subtrair(Ponto a, Ponto b) { return {a.x - b.x, a.y - b.y}; }
+inline Ponto escalar(Ponto a, float s) { return {a.x * s, a.y * s}; }
+inline Ponto normalizar(Ponto a) {
+    float n = std::hypot(a.x, a.y);
+    return {a.x / n, a.y / n};
+}
+
+// Leque de "v" com o arco de raio |r| que começa em v + r e gira "angulo" radianos
+template <typename Peca>
+void leque(Ponto v, Ponto r, float angulo, float tolerancia, Peca&& peca) {
+    const float raio = std::hypot(r.x, r.y);
+    const int n = std::max(1, int(std::ceil(std::fabs(angulo) / (2.0f * float(M_PI)) * raster::ladosCirculo(raio, tolerancia))));
+    thread_local std::vector<Ponto> pontos;
+    pontos.resize(n + 2);
+    pontos[0] = v;
+    for (int i = 0; i <= n; ++i) {
+        float a = angulo * float(i) / float(n), s = std::sin(a), c = std::cos(a);
+        pontos[i + 1] = {v.x + c * r.x - s * r.y, v.y + s * r.x + c * r.y};
+    }
+    peca(pontos.data(), n + 2);
+}
+
+// Decompõe o traço de uma polilinha em polígonos convexos, entregues a peca(pontos, n)
+template <typename Peca>
+void contornar(const Ponto* origem, int n, bool fechada, const Traco& traco, float tolerancia, std::vector<Ponto>& q, Peca&& peca) {
+    const float h = traco.largura * 0.5f;
+    if (!(h > 0.0f) || n == 0)
+        return;
+    // Sem pontos repetidos (nem o último igual ao primeiro, se fechada)
+    q.clear();
+    for (int i = 0; i < n; ++i)
+        if (q.empty() || origem[i].x != q.back().x || origem[i].y != q.back().y)
+            q.push_back(origem[i]);
+    if (q.size() > 1 && q.back().x == q.front().x && q.back().y == q.front().y)
+        q.pop_back();
+    const int m = int(q.size());
+
+    if (m == 1) { // Ponto isolado: só as pontas aparecem
+        Ponto v = q[0];
+        if (traco.ponta == PONTA_REDONDA) {
+            leque(v, {h, 0.0f}, 2.0f * float(M_PI), tolerancia, peca);
+        } else if (traco.ponta == PONTA_QUADRADA) {
+            Ponto quadrado[4] = {{v.x - h, v.y - h}, {v.x + h, v.y - h}, {v.x + h, v.y + h}, {v.x - h, v.y + h}};
+            peca(quadrado, 4);
+        }
+        return;
+    }
+    fechada = fechada && m > 2;
+
+    // Um retângulo por segmento
+    const int segmentos = fechada ? m : m - 1;
+    for (int i = 0; i < segmentos; ++i) {
+        Ponto a = q[i], b = q[(i + 1) % m], u = normalizar(subtrair(b, a)), nr = {-u.y * h, u.x * h};
+        Ponto retangulo[4] = {somar(a, nr), somar(b, nr), subtrair(b, nr), subtrair(a, nr)};
+        peca(retangulo, 4);
+    }
+
+    // Junções, do lado de fora da curva
+    for (int i = fechada ? 0 : 1; i < (fechada ? m : m - 1); ++i) {
+        Ponto v = q[i], anterior = q[(i + m - 1) % m], proximo = q[(i + 1) % m];
+        Ponto uEntrada = normalizar(subtrair(v, anterior)), uSaida = normalizar(subtrair(proximo, v));
+        const float produtoVetorial = uEntrada.x * uSaida.y - uEntrada.y * uSaida.x;
+        const float produtoEscalar = uEntrada.x * uSaida.x + uEntrada.y * uSaida.y;
+        if (produtoVetorial == 0.0f && produtoEscalar > 0.0f)
+            continue; // Colineares
+        const float lado = produtoVetorial > 0.0f ? -h : h;
+        Ponto nEntrada = {-uEntrada.y * lado, uEntrada.x * lado}, nSaida = {-uSaida.y * lado, uSaida.x * lado};
+        Ponto oEntrada = somar(v, nEntrada), oSaida = somar(v, nSaida);
+        // cos da metade do ângulo entre os segmentos
+        const float cosMetade = std::sqrt(std::max(0.0f, (1.0f + produtoEscalar) * 0.5f));
+        Juncao juncao = traco.juncao;
+        if (h * (1.0f - cosMetade) < tolerancia * 0.5f)
+            juncao = JUNCAO_CHANFRADA; // Curva suave (a de um arco achatado): o chanfro já basta
+        if (juncao == JUNCAO_MITRA && cosMetade * traco.limiteMitra >= 1.0f) {
+            Ponto mitra = somar(v, escalar(somar(nEntrada, nSaida), 1.0f / (1.0f + produtoEscalar)));
+            Ponto quadrilatero[4] = {v, oEntrada, mitra, oSaida};
+            peca(quadrilatero, 4);
+        } else if (juncao == JUNCAO_REDONDA) {
+            float angulo = std::atan2(nSaida.y, nSaida.x) - std::atan2(nEntrada.y, nEntrada.x);
+            if (angulo > float(M_PI))
+                angulo -= 2.0f * float(M_PI);
+            else if (angulo < -float(M_PI))
+                angulo += 2.0f * float(M_PI);
+            leque(v, nEntrada, angulo, tolerancia, peca);
+        } else {
+            Ponto triangulo[3] = {v, oEntrada, oSaida};
+            peca(triangulo, 3);
+        }
+    }
+
+    // Pontas
+    if (!fechada && traco.ponta != PONTA_RETA)
+        for (int lado = 0; lado < 2; ++lado) {
+            Ponto v = lado == 0 ? q[0] : q[m - 1];
+            Ponto fora = normalizar(lado == 0 ? subtrair(q[0], q[1]) : subtrair(q[m - 1], q[m - 2])); // Para fora do traço
+            Ponto nr = {-fora.y * h, fora.x * h};
+            if (traco.ponta == PONTA_REDONDA) {
+                leque(v, nr, -float(M_PI), tolerancia, peca);
+            } else {
+                Ponto f = escalar(fora, h);
+                Ponto retangulo[4] = {somar(v, nr), somar(somar(v, nr), f), somar(subtrair(v, nr), f), subtrair(v, nr)};
+                peca(retangulo, 4);
+            }
+        }
+}
+
+// Cor tem 3 bytes e o pincel lê um por canal da imagem
+inline void exigirCanais(const imagem::Imagem& img) {
+    if (img.canais != 1 && img.canais != 3)
+        throw std::invalid_argument("O desenho vetorial trabalha com imagens de 1 ou 3 canais");
+}
+
+} // namespace detalhe
+
+class Cena {
+public:
+    struct Aresta {
+        Ponto a, b;
+    };
+    // Contorno fechado: sozinho, soma enrolamento zero em qualquer linha que atravesse
+    struct Contorno {
+        uint32_t primeiraAresta, fimArestas;
+        float xMinimo, yMinimo, xMaximo, yMaximo;
+    };
+    struct Primitiva {
+        uint32_t primeiraAresta, fimArestas;
+        uint32_t primeiroContorno, fimContornos;
+        Cor cor;
+        raster::Regra regra;
+        float xMinimo, yMinimo, xMaximo, yMaximo; // Caixa em pixels
+    };
+
+    void preencher(const Caminho& caminho, Cor cor, raster::Regra regra = raster::NAO_ZERO, const Transformacao& t = {}) {
+        detalhe::achatar(caminho, t, TOLERANCIA, polilinhas);
+        iniciar(cor, regra);
+        uint32_t inicio = 0;
+        for (uint32_t fim : polilinhas.fins) {
+            abrirContorno();
+            for (uint32_t i = inicio; i < fim; ++i)
+                aresta(polilinhas.pontos[i], polilinhas.pontos[i + 1 < fim ? i + 1 : inicio]);
+            fecharContorno();
+            inicio = fim;
+        }
+        terminar();
+    }
+
+    void tracar(const Caminho& caminho, Cor cor, const Traco& traco = {}, const Transformacao& t = {}) {
+        // Achata e contorna no espaço do caminho, com a tolerância levada para lá, e só
+        // então transforma: uma escala não uniforme também deforma a largura do traço
+        const float ampliacao = t.ampliacaoMaxima();
+        if (!(ampliacao > 0.0f))
+            return;
+        const float tolerancia = TOLERANCIA / ampliacao;
+        detalhe::achatar(caminho, {}, tolerancia, polilinhas);
+        iniciar(cor, raster::NAO_ZERO);
+        auto peca = [&](const Ponto* p, int n) {
+            // Todas as peças no mesmo sentido, para somarem enrolamentos do mesmo sinal
+            transformados.resize(n);
+            Ponto* d = transformados.data();
+            float area = 0.0f;
+            for (int i = 0; i < n; ++i)
+                d[i] = t.aplicar(p[i]);
+            for (int i = 0; i < n; ++i)
+                area += d[i].x * d[(i + 1) % n].y - d[(i + 1) % n].x * d[i].y;
+            abrirContorno();
+            for (int i = 0; i < n; ++i) {
+                const int j = (i + 1) % n;
+                if (area >= 0.0f)
+                    aresta(d[i], d[j]);
+                else
+                    aresta(d[j], d[i]);
+            }
+            fecharContorno();
+        };
+        uint32_t inicio = 0;
+        for (size_t s = 0; s < polilinhas.fins.size(); ++s) {
+            const uint32_t fim = polilinhas.fins[s];
+            detalhe::contornar(&polilinhas.pontos[inicio], int(fim - inicio), polilinhas.fechadas[s] != 0, traco, tolerancia,
+                               semRepetidos, peca);
+            inicio = fim;
+        }
+        terminar();
+    }
+
+    void limpar() {
+        listaPrimitivas.clear();
+        listaContornos.clear();
+        listaArestas.clear();
+    }
+
+    const std::vector<Primitiva>& primitivas() const { return listaPrimitivas; }
+    const std::vector<Contorno>& contornos() const { return listaContornos; }
+    const std::vector<Aresta>& arestas() const { return listaArestas; }
+
+    // Desenha as primitivas, na ordem em que foram acrescentadas, sobre o que já está na imagem
+    void renderizar(imagem::Imagem& img) const {
+        detalhe::exigirCanais(img);
+        const int colunas = (img.largura + LADO_LADRILHO - 1) / LADO_LADRILHO;
+        const int linhas = (img.altura + LADO_LADRILHO - 1) / LADO_LADRILHO;
+        if (colunas == 0 || linhas == 0)
+            return;
+
+        // Distribuição nos ladrilhos em duas passadas (contagem e preenchimento), com as
+        // listas de todos os ladrilhos em um vetor só e cada uma na ordem de desenho
+        std::vector<uint32_t> inicios(size_t(colunas) * linhas + 1, 0);
+        auto ladrilhos = [&](const Primitiva& p, int& tx0, int& ty0, int& tx1, int& ty1) {
+            if (!(p.xMaximo > 0.0f && p.yMaximo > 0.0f && p.xMinimo < float(img.largura) && p.yMinimo < float(img.altura)))
+                return false;
+            tx0 = int(std::max(p.xMinimo, 0.0f)) / LADO_LADRILHO;
+            ty0 = int(std::max(p.yMinimo, 0.0f)) / LADO_LADRILHO;
+            tx1 = int(std::min(p.xMaximo, float(img.largura - 1))) / LADO_LADRILHO;
+            ty1 = int(std::min(p.yMaximo, float(img.altura - 1))) / LADO_LADRILHO;
+            return true;
+        };
+        int tx0, ty0, tx1, ty1;
+        for (const Primitiva& p : listaPrimitivas)
+            if (ladrilhos(p, tx0, ty0, tx1, ty1))
+                for (int ty = ty0; ty <= ty1; ++ty)
+                    for (int tx = tx0; tx <= tx1; ++tx)
+                        inicios[size_t(ty) * colunas + tx + 1]++;
+        for (size_t i = 1; i < inicios.size(); ++i)
+            inicios[i] += inicios[i - 1];
+        std::vector<uint32_t> listas(inicios.back());
+        std::vector<uint32_t> proximo(inicios.begin(), inicios.end() - 1);
+        for (uint32_t indice = 0; indice < listaPrimitivas.size(); ++indice)
+            if (ladrilhos(listaPrimitivas[indice], tx0, ty0, tx1, ty1))
+                for (int ty = ty0; ty <= ty1; ++ty)
+                    for (int tx = tx0; tx <= tx1; ++tx)
+                        listas[proximo[size_t(ty) * colunas + tx]++] = indice;
+
+        // Cada ladrilho escreve só nos seus pixels
+        tarefas::padrao().paraleloPara(0, size_t(colunas) * linhas, 1, [&](size_t i0, size_t i1) {
+            thread_local raster::Cobertura cobertura(LADO_LADRILHO, LADO_LADRILHO);
+            for (size_t i = i0; i < i1; ++i) {
+                const int x0 = int(i % colunas) * LADO_LADRILHO, y0 = int(i / colunas) * LADO_LADRILHO;
+                const float fx0 = float(x0), fy0 = float(y0), fx1 = fx0 + LADO_LADRILHO, fy1 = fy0 + LADO_LADRILHO;
+                for (uint32_t k = inicios[i]; k < inicios[i + 1]; ++k) {
+                    // As primitivas de um ladrilho estão espalhadas pela cena inteira: sem buscar
+                    // adiante, cada círculo pequeno custa algumas faltas de cache
+                    if (k + 8 < inicios[i + 1])
+                        __builtin_prefetch(&listaPrimitivas[listas[k + 8]]);
+                    if (k + 4 < inicios[i + 1]) {
+                        const Primitiva& adiante = listaPrimitivas[listas[k + 4]];
+                        __builtin_prefetch(&listaContornos[adiante.primeiroContorno]);
+                        __builtin_prefetch(&listaArestas[adiante.primeiraAresta]);
+                        __builtin_prefetch(&listaArestas[adiante.primeiraAresta] + 4);
+                    }
+                    const Primitiva& p = listaPrimitivas[listas[k]];
+                    for (uint32_t c = p.primeiroContorno; c < p.fimContornos; ++c) {
+                        const Contorno& contorno = listaContornos[c];
+                        // Um contorno que não toca o ladrilho, mesmo à esquerda dele, soma zero
+                        // aqui: as peças de um traço longo só custam nos ladrilhos onde estão
+                        if (contorno.xMaximo <= fx0 || contorno.yMaximo <= fy0 || contorno.xMinimo >= fx1 || contorno.yMinimo >= fy1)
+                            continue;
+                        for (uint32_t j = contorno.primeiraAresta; j < contorno.fimArestas; ++j) {
+                            const Aresta& e = listaArestas[j];
+                            // Fora das linhas do ladrilho ou toda à direita dele: não muda nada aqui
+                            if (std::max(e.a.y, e.b.y) <= fy0 || std::min(e.a.y, e.b.y) >= fy1 || std::min(e.a.x, e.b.x) >= fx1)
+                                continue;
+                            cobertura.aresta({e.a.x - fx0, e.a.y - fy0}, {e.b.x - fx0, e.b.y - fy0});
+                        }
+                    }
+                    raster::compor(img, x0, y0, cobertura, p.cor.data(), p.regra);
+                }
+            }
+        });
+    }
+
+private:
+    void iniciar(Cor cor, raster::Regra regra) {
+        const float infinito = std::numeric_limits<float>::infinity();
+        listaPrimitivas.push_back({uint32_t(listaArestas.size()), 0, uint32_t(listaContornos.size()), 0, cor, regra, infinito,
+                                   infinito, -infinito, -infinito});
+    }
+
+    void abrirContorno() {
+        const float infinito = std::numeric_limits<float>::infinity();
+        listaContornos.push_back({uint32_t(listaArestas.size()), 0, infinito, infinito, -infinito, -infinito});
+    }
+
+    void aresta(Ponto a, Ponto b) {
+        if (a.y == b.y || !std::isfinite(a.x + a.y + b.x + b.y))
+            return;
+        listaArestas.push_back({a, b});
+        Contorno& c = listaContornos.back();
+        c.xMinimo = std::min(c.xMinimo, std::min(a.x, b.x));
+        c.yMinimo = std::min(c.yMinimo, std::min(a.y, b.y));
+        c.xMaximo = std::max(c.xMaximo, std::max(a.x, b.x));
+        c.yMaximo = std::max(c.yMaximo, std::max(a.y, b.y));
+    }
+
+    void fecharContorno() {
+        Contorno& c = listaContornos.back();
+        c.fimArestas = uint32_t(listaArestas.size());
+        if (c.fimArestas == c.primeiraAresta) {
+            listaContornos.pop_back();
+            return;
+        }
+        Primitiva& p = listaPrimitivas.back();
+        p.xMinimo = std::min(p.xMinimo, c.xMinimo);
+        p.yMinimo = std::min(p.yMinimo, c.yMinimo);
+        p.xMaximo = std::max(p.xMaximo, c.xMaximo);
+        p.yMaximo = std::max(p.yMaximo, c.yMaximo);
+    }
+
+    void terminar() {
+        Primitiva& p = listaPrimitivas.back();
+        p.fimArestas = uint32_t(listaArestas.size());
+        p.fimContornos = uint32_t(listaContornos.size());
+        if (p.fimArestas == p.primeiraAresta)
+            listaPrimitivas.pop_back(); // Nada a desenhar
+    }
+
+    std::vector<Primitiva> listaPrimitivas;
+    std::vector<Contorno> listaContornos;
+    std::vector<Aresta> listaArestas;
+    // Rascunhos reaproveitados entre as chamadas
+    detalhe::Polilinhas polilinhas;
+    std::vector<Ponto> semRepetidos;
+    std::vector<Ponto> transformados;
+};
+
+namespace referencia {
+
+// Sem ladrilhos: cada primitiva em uma cobertura do tamanho da imagem, em ordem
+inline void renderizar(const Cena& cena, imagem::Imagem& img) {
+    detalhe::exigirCanais(img);
+    raster::Cobertura cobertura(img.largura, img.altura);
+    for (const Cena::Primitiva& p : cena.primitivas()) {
+        for (uint32_t j = p.primeiraAresta; j < p.fimArestas; ++j)
+            cobertura.aresta(cena.arestas()[j].a, cena.arestas()[j].b);
+        raster::compor(img, cobertura, p.cor.data(), p.regra);
+    }
+}
+
+} // namespace referencia
+
+} // namespace vetorial
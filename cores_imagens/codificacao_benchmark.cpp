@@ -0,0 +1,133 @@
+// Mede tamanho e velocidade dos formatos de saída: PPM, QOI e PNG (comum/png.hpp)
+//
+// Uso: codificacao_benchmark [imagem.ppm]   (sem argumento, gera uma imagem 2048x2048 sintética)
+// Confere a decodificação de todos os arquivos gerados e que a escolha de filtros em uma
+// passada dá o mesmo resultado que a heurística direta do libpng.
+// Compilação: g++ -std=c++17 -O2 -march=native -pthread codificacao_benchmark.cpp -o codificacao_benchmark -lz
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <random>
+#include <vector>
+
+#include "../comum/png.hpp"
+#include "../comum/qoi.hpp"
+
+const int REPETICOES = 5;
+
+double milissegundos(std::chrono::steady_clock::time_point inicio) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+// Menor tempo de REPETICOES execuções
+template <typename Funcao>
+double medir(Funcao&& f) {
+    double melhor = 1e30;
+    for (int r = 0; r < REPETICOES; ++r) {
+        auto inicio = std::chrono::steady_clock::now();
+        f();
+        melhor = std::min(melhor, milissegundos(inicio));
+    }
+    return melhor;
+}
+
+// Parecida com um quadro renderizado: degradês, discos sombreados com borda suavizada
+// e um pouco de ruído (o ruído puro não se comprime, e um quadro liso se comprime demais)
+imagem::Imagem imagemSintetica(int largura, int altura) {
+    imagem::Imagem img(largura, altura, 3);
+    std::mt19937 gerador(42);
+    std::uniform_int_distribution<int> ruido(-2, 2);
+    for (int y = 0; y < altura; ++y)
+        for (int x = 0; x < largura; ++x) {
+            uint8_t* p = img.pixel(x, y);
+            double d = std::hypot(x % 256 - 128, y % 256 - 128);
+            double cobertura = std::min(1.0, std::max(0.0, 80.5 - d)); // Borda de 1 pixel
+            double sombra = 1.0 - d / 160.0;
+            int fundo[3] = {x * 255 / largura, y * 255 / altura, 60};
+            int disco[3] = {int(230 * sombra), int(120 * sombra), int(40 * sombra)};
+            for (int c = 0; c < 3; ++c) {
+                int v = int(fundo[c] + cobertura * (disco[c] - fundo[c]) + 0.5) + (y < altura / 2 ? 0 : ruido(gerador));
+                p[c] = static_cast<uint8_t>(std::min(255, std::max(0, v)));
+            }
+        }
+    return img;
+}
+
+bool iguais(const imagem::Imagem& a, const imagem::Imagem& b) {
+    return a.largura == b.largura && a.altura == b.altura && a.canais == b.canais && a.pixels == b.pixels;
+}
+
+// Mede a codificação e a decodificação, confere a ida e volta e imprime uma linha
+template <typename Codificar, typename Decodificar>
+bool medirFormato(const char* nome, const imagem::Imagem& img, Codificar&& codificar, Decodificar&& decodificar) {
+    std::vector<uint8_t> dados;
+    double tCodificar = medir([&] { dados = codificar(); });
+    imagem::Imagem lida;
+    double tDecodificar = medir([&] { lida = decodificar(dados); });
+    bool ok = iguais(img, lida);
+    double mb = img.pixels.size() / 1e6;
+    printf("%-26s %10zu bytes (%5.2fx menor)   codifica %8.2f ms (%7.1f MB/s)   decodifica %7.2f ms   %s\n", nome, dados.size(),
+           double(img.pixels.size()) / dados.size(), tCodificar, mb / tCodificar * 1000.0, tDecodificar, ok ? "ok" : "ERRO");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    imagem::Imagem img;
+    try {
+        img = argc > 1 ? imagem::ler(argv[1]) : imagemSintetica(2048, 2048);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return -1;
+    }
+    printf("Imagem %dx%d com %d canais (%.1f MB sem compressão), %u trabalhadores\n", img.largura, img.altura, img.canais,
+           img.pixels.size() / 1e6, tarefas::padrao().numeroTrabalhadores());
+
+    auto decodificarPng = [](const std::vector<uint8_t>& d) { return png::decodificar(d.data(), d.size()); };
+    auto codificarPng = [&](int nivel, png::Filtro filtro, size_t bytesPorBloco, int estrategia = Z_RLE) {
+        return [&img, nivel, filtro, bytesPorBloco, estrategia] {
+            png::Opcoes opcoes;
+            opcoes.nivel = nivel;
+            opcoes.filtro = filtro;
+            opcoes.bytesPorBloco = bytesPorBloco;
+            opcoes.estrategia = estrategia;
+            return png::codificar(img, opcoes);
+        };
+    };
+    const size_t blocoUnico = ~size_t(0); // Um só bloco: deflate serial, como o libpng
+
+    bool ok = true;
+    ok &= medirFormato("QOI", img, [&] { return qoi::codificar(img); },
+                       [](const std::vector<uint8_t>& d) { return qoi::decodificar(d.data(), d.size()); });
+    ok &= medirFormato("PNG (padrão: 6, Z_RLE)", img, codificarPng(6, png::ADAPTATIVO, 512 << 10), decodificarPng);
+    ok &= medirFormato("PNG bloco único", img, codificarPng(6, png::ADAPTATIVO, blocoUnico), decodificarPng);
+    ok &= medirFormato("PNG sem filtro", img, codificarPng(6, png::NENHUM, 512 << 10), decodificarPng);
+    ok &= medirFormato("PNG só Paeth", img, codificarPng(6, png::PAETH, 512 << 10), decodificarPng);
+    ok &= medirFormato("PNG nível 1, deflate", img, codificarPng(1, png::ADAPTATIVO, 512 << 10, Z_DEFAULT_STRATEGY), decodificarPng);
+    ok &= medirFormato("PNG nível 6, deflate", img, codificarPng(6, png::ADAPTATIVO, 512 << 10, Z_DEFAULT_STRATEGY), decodificarPng);
+    ok &= medirFormato("PNG nível 9, deflate", img, codificarPng(9, png::ADAPTATIVO, 512 << 10, Z_DEFAULT_STRATEGY), decodificarPng);
+
+    // Heurística de filtros: uma passada contra os 5 buffers do libpng, na imagem toda
+    const size_t n = img.bytesPorLinha();
+    const std::vector<uint8_t> zeros(n, 0);
+    std::vector<png::Filtro> umaPassada(img.altura), direta(img.altura);
+    auto escolher = [&](std::vector<png::Filtro>& saida, auto&& escolherFiltro) {
+        for (int y = 0; y < img.altura; ++y)
+            saida[y] = escolherFiltro(img.linha(y), y > 0 ? img.linha(y - 1) : zeros.data(), n, img.canais);
+    };
+    double tUma = medir([&] { escolher(umaPassada, png::detalhe::escolherFiltro); });
+    double tDireta = medir([&] { escolher(direta, png::referencia::escolherFiltro); });
+    int contagem[5] = {};
+    for (png::Filtro f : umaPassada)
+        contagem[f]++;
+    bool mesmaEscolha = umaPassada == direta;
+    ok &= mesmaEscolha;
+    printf("Escolha de filtros (1 thread): uma passada %.2f ms, 5 buffers %.2f ms (%.1fx), %s\n", tUma, tDireta, tDireta / tUma,
+           mesmaEscolha ? "mesma escolha" : "ESCOLHAS DIFERENTES");
+    printf("Linhas por filtro: nenhum %d, sub %d, cima %d, média %d, Paeth %d\n", contagem[0], contagem[1], contagem[2], contagem[3],
+           contagem[4]);
+
+    printf(ok ? "Todos os arquivos decodificam para a imagem original\n" : "ERROS de codificação\n");
+    return ok ? 0 : 1;
+}
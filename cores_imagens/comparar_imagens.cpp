@@ -0,0 +1,73 @@
+// Compara uma imagem PPM/PGM/PNG/QOI com a imagem de referência e diz se a diferença é aceitável
+//
+// Uso: comparar_imagens <referencia> <teste> [opções]
+//   -t N      tolerância por canal (padrão 0: qualquer diferença conta)
+//   -f X      fração máxima de pixels fora da tolerância (padrão 0)
+//   -p DB     PSNR mínimo em dB (padrão: sem limite)
+//   -s X      SSIM mínimo (padrão: sem limite)
+//   -m ARQ    grava o mapa de calor das diferenças em ARQ (formato pela extensão)
+// Sai com 0 se a imagem passou, 1 se não passou e 2 em caso de erro (arquivo ausente,
+// tamanhos diferentes). Imagens com números de canais diferentes são comparadas em cinza.
+//
+// Compilação: g++ -std=c++17 -O2 -march=native -pthread comparar_imagens.cpp -o comparar_imagens -lz
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+
+#include "../comum/comparacao_imagens.hpp"
+#include "../comum/formatos_imagem.hpp"
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Uso: %s <referencia> <teste> [-t tolerancia] [-f fracao] [-p psnr] [-s ssim] [-m mapa.ppm]\n", argv[0]);
+        return 2;
+    }
+    int tolerancia = 0;
+    double fracaoMaxima = 0.0, psnrMinimo = 0.0, ssimMinimo = -1.0;
+    std::string caminhoMapa;
+    for (int i = 3; i < argc; ++i) {
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Opção %s sem valor\n", argv[i]);
+            return 2;
+        }
+        if (std::strcmp(argv[i], "-t") == 0) tolerancia = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "-f") == 0) fracaoMaxima = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "-p") == 0) psnrMinimo = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "-s") == 0) ssimMinimo = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "-m") == 0) caminhoMapa = argv[++i];
+        else {
+            fprintf(stderr, "Opção desconhecida: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    try {
+        imagem::Imagem referencia = formatos::ler(argv[1]);
+        imagem::Imagem teste = formatos::ler(argv[2]);
+        if (referencia.canais != teste.canais) {
+            referencia = imagem::paraCinza(referencia);
+            teste = imagem::paraCinza(teste);
+        }
+        if (referencia.largura != teste.largura || referencia.altura != teste.altura) {
+            fprintf(stderr, "Tamanhos diferentes: %dx%d e %dx%d\n", referencia.largura, referencia.altura, teste.largura, teste.altura);
+            return 2;
+        }
+
+        comparacao::Resultado r = comparacao::comparar(referencia, teste, tolerancia);
+        bool passou = r.fracaoForaTolerancia() <= fracaoMaxima && r.psnr >= psnrMinimo && r.ssim >= ssimMinimo;
+        printf("%s: maior diferença %d, %zu pixels (%.4f%%) acima de %d, PSNR %.2f dB, SSIM %.5f: %s\n", argv[2],
+               r.maiorDiferenca, r.pixelsForaTolerancia, 100.0 * r.fracaoForaTolerancia(), tolerancia, r.psnr, r.ssim,
+               passou ? "ok" : "DIFERENTE");
+
+        if (!caminhoMapa.empty()) {
+            formatos::escrever(caminhoMapa, comparacao::mapaDiferencas(referencia, teste, tolerancia));
+            printf("Mapa de diferenças em %s\n", caminhoMapa.c_str());
+        }
+        return passou ? 0 : 1;
+    } catch (const std::exception& e) {
+        fprintf(stderr, "Erro: %s\n", e.what());
+        return 2;
+    }
+}
@@ -0,0 +1,151 @@
+// Mede a conversão de cor, o pontilhado e a quantização de comum/cor.hpp e comum/paleta.hpp
+//
+// Uso: cor_benchmark [imagem.ppm]   (sem argumento, gera um render sintético 4096x4096 em luz linear)
+// Confere a conversão rápida contra a fórmula do sRGB e mostra quanto cada pontilhado
+// preserva a luz média de cada bloco 8x8 (o que o olho vê de longe).
+// Compilação: g++ -std=c++17 -O2 -march=native -pthread cor_benchmark.cpp -o cor_benchmark
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+
+#include "../comum/comparacao_imagens.hpp"
+#include "../comum/cor.hpp"
+#include "../comum/paleta.hpp"
+
+const int REPETICOES = 3;
+
+double milissegundos(std::chrono::steady_clock::time_point inicio) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+// Menor tempo de REPETICOES execuções
+template <typename Funcao>
+double medir(Funcao&& f) {
+    double melhor = 1e30;
+    for (int r = 0; r < REPETICOES; ++r) {
+        auto inicio = std::chrono::steady_clock::now();
+        f();
+        melhor = std::min(melhor, milissegundos(inicio));
+    }
+    return melhor;
+}
+
+// Render em luz linear: céu em degradê escuro (onde 8 bits fazem faixas) e discos
+// iluminados de várias cores com borda suavizada, compostos em luz linear
+cor::ImagemLinear renderSintetico(int largura, int altura) {
+    cor::ImagemLinear img(largura, altura, 3);
+    for (int y = 0; y < altura; ++y)
+        for (int x = 0; x < largura; ++x) {
+            float* p = img.pixel(x, y);
+            float t = float(y) / altura;
+            p[0] = 0.002f + 0.03f * t;
+            p[1] = 0.004f + 0.05f * t;
+            p[2] = 0.02f + 0.12f * t * t + 0.01f * float(x) / largura;
+            float d = std::hypot(float(x % 512) - 256.0f, float(y % 512) - 256.0f);
+            float cobertura = std::min(1.0f, std::max(0.0f, 180.5f - d));
+            float luz = std::max(0.0f, 1.0f - d / 200.0f);
+            float matiz = float((x / 512 + 3 * (y / 512)) % 8) / 8.0f; // Cada disco com uma cor
+            float disco[3] = {0.9f * luz * luz * (1.0f - matiz), 0.45f * luz + 0.4f * matiz * luz, 0.1f * luz + 0.8f * matiz * matiz};
+            if (cobertura > 0.0f)
+                cor::compor(img, x, y, disco, cobertura);
+        }
+    return img;
+}
+
+// Média do erro de luz em blocos 8x8 entre o original e os bytes decodificados
+double erroLocal(const cor::ImagemLinear& original, const imagem::Imagem& bytes) {
+    double total = 0;
+    int blocos = 0;
+    for (int by = 0; by + 8 <= original.altura; by += 8)
+        for (int bx = 0; bx + 8 <= original.largura; bx += 8) {
+            for (int c = 0; c < original.canais; ++c) {
+                double a = 0, b = 0;
+                for (int y = by; y < by + 8; ++y)
+                    for (int x = bx; x < bx + 8; ++x) {
+                        a += original.pixel(x, y)[c];
+                        b += cor::deSRGB(bytes.pixel(x, y)[c]);
+                    }
+                total += std::fabs(a - b) / 64.0;
+            }
+            blocos += original.canais;
+        }
+    return total / blocos;
+}
+
+int main(int argc, char** argv) {
+    cor::ImagemLinear linear;
+    try {
+        linear = argc > 1 ? cor::paraLinear(imagem::ler(argv[1])) : renderSintetico(4096, 4096);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return -1;
+    }
+    printf("Imagem %dx%d com %d canais, %u trabalhadores\n", linear.largura, linear.altura, linear.canais,
+           tarefas::padrao().numeroTrabalhadores());
+    const double megapixels = linear.pixels.size() / linear.canais / 1e6;
+    bool ok = true;
+
+    // sRGB -> linear
+    imagem::Imagem bytes = cor::referencia::paraSRGB(linear);
+    cor::ImagemLinear deTabela, deFormula;
+    double tTabela = medir([&] { deTabela = cor::paraLinear(bytes); });
+    double tFormula = medir([&] { deFormula = cor::referencia::paraLinear(bytes); });
+    float maiorLinear = 0;
+    for (size_t i = 0; i < deTabela.pixels.size(); ++i)
+        maiorLinear = std::max(maiorLinear, std::fabs(deTabela.pixels[i] - deFormula.pixels[i]));
+    ok &= maiorLinear == 0.0f;
+    printf("sRGB -> linear      tabela %7.2f ms   fórmula %8.2f ms (%5.1fx)   diferença %g\n", tTabela, tFormula, tFormula / tTabela,
+           maiorLinear);
+
+    // linear -> sRGB
+    imagem::Imagem rapido, exato;
+    double tRapido = medir([&] { rapido = cor::paraSRGB(linear); });
+    double tExato = medir([&] { exato = cor::referencia::paraSRGB(linear); });
+    size_t diferentes = 0;
+    int maiorByte = 0;
+    for (size_t i = 0; i < rapido.pixels.size(); ++i)
+        if (rapido.pixels[i] != exato.pixels[i]) {
+            diferentes++;
+            maiorByte = std::max(maiorByte, std::abs(int(rapido.pixels[i]) - int(exato.pixels[i])));
+        }
+    ok &= maiorByte <= 1;
+    printf("linear -> sRGB      polinômio %6.2f ms   pow %12.2f ms (%5.1fx)   %zu bytes diferentes (%.4f%%), no máximo %d\n", tRapido,
+           tExato, tExato / tRapido, diferentes, 100.0 * diferentes / rapido.pixels.size(), maiorByte);
+
+    // Conferência em todos os floats de 0 a 1 espaçados de 2^-20
+    int maiorVarredura = 0;
+    for (int i = 0; i <= (1 << 20); ++i) {
+        float x = float(i) / (1 << 20);
+        maiorVarredura = std::max(maiorVarredura, std::abs(int(cor::paraSRGB(x)) - int(cor::referencia::paraSRGB(x))));
+    }
+    ok &= maiorVarredura <= 1;
+    printf("Varredura de 2^20 valores: diferença máxima de %d nível\n", maiorVarredura);
+
+    // Pontilhado
+    imagem::Imagem ordenado, difusao;
+    double tOrdenado = medir([&] { ordenado = cor::paraSRGB(linear, cor::ORDENADO); });
+    double tDifusao = medir([&] { difusao = cor::paraSRGB(linear, cor::DIFUSAO_ERRO); });
+    printf("Pontilhado ordenado %7.2f ms (%6.1f Mpixels/s)   difusão de erro %8.2f ms (%5.1f Mpixels/s)\n", tOrdenado,
+           megapixels / tOrdenado * 1000.0, tDifusao, megapixels / tDifusao * 1000.0);
+    printf("Erro médio de luz em blocos 8x8: arredondado %.3g   ordenado %.3g   difusão %.3g\n", erroLocal(linear, rapido),
+           erroLocal(linear, ordenado), erroLocal(linear, difusao));
+
+    // Paleta
+    paleta::Paleta mediano, refinada;
+    double tMediano = medir([&] { mediano = paleta::corteMediano(rapido, 256); });
+    double tKMedias = medir([&] { refinada = paleta::kMedias(rapido, mediano, 8); });
+    paleta::ImagemIndexada semDifusao, comDifusao;
+    double tMapear = medir([&] { semDifusao = paleta::quantizar(rapido, refinada); });
+    double tMapearDifusao = medir([&] { comDifusao = paleta::quantizar(rapido, refinada, true); });
+    comparacao::Resultado soMediano = comparacao::comparar(rapido, paleta::expandir(paleta::quantizar(rapido, mediano)), 0);
+    comparacao::Resultado rSem = comparacao::comparar(rapido, paleta::expandir(semDifusao), 0);
+    comparacao::Resultado rCom = comparacao::comparar(rapido, paleta::expandir(comDifusao), 0);
+    printf("Paleta de %zu cores: corte mediano %.2f ms, k-médias (8 passos) %.2f ms\n", refinada.size(), tMediano, tKMedias);
+    printf("Mapeamento: direto %.2f ms (PSNR %.2f dB; só corte mediano %.2f dB)   com difusão %.2f ms (PSNR %.2f dB, SSIM %.4f)\n",
+           tMapear, rSem.psnr, soMediano.psnr, tMapearDifusao, rCom.psnr, rCom.ssim);
+
+    printf(ok ? "Conversões conferem com a fórmula do sRGB\n" : "DIFERENÇAS em relação à fórmula do sRGB\n");
+    return ok ? 0 : 1;
+}
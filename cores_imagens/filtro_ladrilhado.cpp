@@ -0,0 +1,152 @@
+// Filtra imagens maiores que a memória, ladrilho a ladrilho (comum/imagem_ladrilhada.hpp)
+//
+// Uso:
+//   filtro_ladrilhado gerar <largura> <altura> <saida.ppm|saida.pgm>
+//   filtro_ladrilhado <filtro> <entrada> <saida> [opções]
+// Filtros: gaussiano (cor ou cinza), sobel e caixa (só cinza, PGM).
+//   -s SIGMA   desvio padrão do gaussiano (padrão 2)
+//   -r RAIO    raio da caixa (padrão 4)
+//   -l LADO    lado do ladrilho em pixels (padrão 512)
+//   -m MB      orçamento da cache de cada imagem em MB (padrão 256)
+//   -c         confere com o filtro aplicado à imagem inteira (só para imagens que cabem na memória)
+// A memória usada fica perto de 2 x orçamento, seja qual for o tamanho da imagem;
+// "gerar" cria uma imagem sintética do tamanho pedido, também por ladrilhos.
+//
+// Compilação: g++ -std=c++17 -O2 -march=native -pthread filtro_ladrilhado.cpp -o filtro_ladrilhado
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <string>
+
+#include "../comum/filtros_imagem.hpp"
+#include "../comum/imagem_ladrilhada.hpp"
+
+double segundos(std::chrono::steady_clock::time_point inicio) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+// Mesmo padrão de filtros_benchmark (faixas e círculos), sem ruído para depender só de (x, y)
+void gerar(int largura, int altura, const std::string& caminho, int lado, size_t orcamento) {
+    bool cinza = caminho.size() >= 4 && caminho.compare(caminho.size() - 4, 4, ".pgm") == 0;
+    ladrilhos::ImagemLadrilhada saida = ladrilhos::ImagemLadrilhada::criar(caminho, largura, altura, cinza ? 1 : 3, lado, 0, orcamento);
+    tarefas::padrao().paraleloPara(0, size_t(saida.numeroLadrilhos()), 1, [&](size_t i0, size_t i1) {
+        for (size_t i = i0; i < i1; ++i) {
+            std::shared_ptr<ladrilhos::Ladrilho> l = saida.obter(static_cast<int>(i % saida.colunasLadrilhos()),
+                                                                 static_cast<int>(i / saida.colunasLadrilhos()), ladrilhos::SOBRESCREVER);
+            for (int j = 0; j < l->altura; ++j)
+                for (int k = 0; k < l->largura; ++k) {
+                    int x = l->x0 + k, y = l->y0 + j;
+                    bool circulo = std::hypot(x % 256 - 128, y % 256 - 128) < 80;
+                    uint8_t cor[3] = {static_cast<uint8_t>(int64_t(x) * 255 / largura), static_cast<uint8_t>(int64_t(y) * 255 / altura),
+                                      static_cast<uint8_t>(circulo ? 230 : 40)};
+                    uint8_t* p = l->pixel(k, j);
+                    if (cinza)
+                        p[0] = static_cast<uint8_t>((cor[0] + cor[1] + cor[2]) / 3);
+                    else
+                        std::copy_n(cor, 3, p);
+                }
+            l->marcarAlterado();
+        }
+    });
+    saida.sincronizar();
+    saida.imprimirEstatisticas("saída");
+}
+
+int main(int argc, char** argv) {
+    if (argc == 5 && std::strcmp(argv[1], "gerar") == 0) {
+        try {
+            auto inicio = std::chrono::steady_clock::now();
+            gerar(std::atoi(argv[2]), std::atoi(argv[3]), argv[4], 512, size_t(256) << 20);
+            printf("%s gerada em %.2f s\n", argv[4], segundos(inicio));
+            return 0;
+        } catch (const std::exception& e) {
+            fprintf(stderr, "%s\n", e.what());
+            return -1;
+        }
+    }
+    if (argc < 4) {
+        fprintf(stderr, "Uso: %s gerar <largura> <altura> <saida>\n"
+                        "     %s <gaussiano|sobel|caixa> <entrada> <saida> [-s sigma] [-r raio] [-l lado] [-m MB] [-c]\n",
+                argv[0], argv[0]);
+        return -1;
+    }
+    std::string filtro = argv[1];
+    float sigma = 2.0f;
+    int raio = 4, lado = 512;
+    size_t orcamento = size_t(256) << 20;
+    bool conferir = false;
+    for (int i = 4; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-c") == 0) {
+            conferir = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Opção %s sem valor\n", argv[i]);
+            return -1;
+        }
+        if (std::strcmp(argv[i], "-s") == 0) sigma = static_cast<float>(std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "-r") == 0) raio = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "-l") == 0) lado = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "-m") == 0) orcamento = size_t(std::atoi(argv[++i])) << 20;
+        else {
+            fprintf(stderr, "Opção desconhecida: %s\n", argv[i]);
+            return -1;
+        }
+    }
+
+    // Cada filtro lê no máximo "halo" pixels além do interior do ladrilho
+    int halo;
+    std::function<imagem::Imagem(const imagem::Imagem&)> aplicar;
+    if (filtro == "gaussiano") {
+        halo = static_cast<int>(filtros::detalhe::nucleoGaussiano(sigma).size() / 2);
+        aplicar = [sigma](const imagem::Imagem& img) { return filtros::desfoqueGaussiano(img, sigma); };
+    } else if (filtro == "sobel") {
+        halo = 1;
+        aplicar = [](const imagem::Imagem& img) { return filtros::sobel(img); };
+    } else if (filtro == "caixa") {
+        halo = raio;
+        aplicar = [raio](const imagem::Imagem& img) { return filtros::filtroCaixa(img, raio); };
+    } else {
+        fprintf(stderr, "Filtro desconhecido: %s\n", filtro.c_str());
+        return -1;
+    }
+
+    try {
+        auto inicio = std::chrono::steady_clock::now();
+        {
+            ladrilhos::ImagemLadrilhada entrada(argv[2], lado, halo, orcamento);
+            ladrilhos::ImagemLadrilhada saida = ladrilhos::ImagemLadrilhada::criar(argv[3], entrada.largura(), entrada.altura(),
+                                                                                   entrada.canais(), lado, 0, orcamento);
+            printf("%s: %dx%d, %d ladrilhos de %d (+%d de borda), %u trabalhadores\n", argv[2], entrada.largura(), entrada.altura(),
+                   entrada.numeroLadrilhos(), lado, halo, tarefas::padrao().numeroTrabalhadores());
+            ladrilhos::paraCadaLadrilho(entrada, saida, [&](const ladrilhos::Ladrilho& de, ladrilhos::Ladrilho& para) {
+                // Recortado na beirada da imagem, cada filtro trata as bordas como faria na imagem inteira
+                para.copiarInterior(aplicar(de.recorteDentroDaImagem()), de.haloEsquerda, de.haloTopo);
+            });
+            saida.sincronizar();
+            entrada.imprimirEstatisticas("entrada");
+            saida.imprimirEstatisticas("saída");
+        }
+        double tempo = segundos(inicio);
+        printf("%s gravada em %.2f s\n", argv[3], tempo);
+
+        if (conferir) {
+            imagem::Imagem esperado = aplicar(imagem::ler(argv[2]));
+            imagem::Imagem obtido = imagem::ler(argv[3]);
+            int maior = 0;
+            for (size_t i = 0; i < esperado.pixels.size(); ++i)
+                maior = std::max(maior, std::abs(int(esperado.pixels[i]) - int(obtido.pixels[i])));
+            printf("Diferença para o filtro na imagem inteira: %d\n", maior);
+            return maior == 0 ? 0 : 1;
+        }
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+// Mede os filtros de comum/filtros_imagem.hpp contra as versões escalares de referência
+//
+// Uso: filtros_benchmark [imagem.ppm]   (sem argumento, gera uma imagem 2048x2048 sintética)
+// Compilação: g++ -std=c++17 -O2 -march=native -pthread filtros_benchmark.cpp -o filtros_benchmark
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <random>
+
+#include "../comum/filtros_imagem.hpp"
+
+const int REPETICOES = 5;
+
+double milissegundos(std::chrono::steady_clock::time_point inicio) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+// Menor tempo de REPETICOES execuções
+template <typename Funcao>
+double medir(Funcao&& f) {
+    double melhor = 1e30;
+    for (int r = 0; r < REPETICOES; ++r) {
+        auto inicio = std::chrono::steady_clock::now();
+        f();
+        melhor = std::min(melhor, milissegundos(inicio));
+    }
+    return melhor;
+}
+
+int maiorDiferenca(const imagem::Imagem& a, const imagem::Imagem& b) {
+    int maior = 0;
+    for (size_t i = 0; i < a.pixels.size(); ++i)
+        maior = std::max(maior, std::abs(int(a.pixels[i]) - int(b.pixels[i])));
+    return maior;
+}
+
+// Faixas de cor, círculos e ruído: bordas e regiões lisas para todos os filtros
+imagem::Imagem imagemSintetica(int largura, int altura) {
+    imagem::Imagem img(largura, altura, 3);
+    std::mt19937 gerador(42);
+    std::uniform_int_distribution<int> ruido(-20, 20);
+    for (int y = 0; y < altura; ++y)
+        for (int x = 0; x < largura; ++x) {
+            uint8_t* p = img.pixel(x, y);
+            bool circulo = std::hypot(x % 256 - 128, y % 256 - 128) < 80;
+            int base[3] = {x * 255 / largura, y * 255 / altura, circulo ? 230 : 40};
+            for (int c = 0; c < 3; ++c)
+                p[c] = static_cast<uint8_t>(std::min(255, std::max(0, base[c] + ruido(gerador))));
+        }
+    return img;
+}
+
+// Mede a referência e a versão otimizada, confere a diferença e imprime uma linha
+template <typename Referencia, typename Otimizada>
+bool comparar(const char* nome, double megabytes, int tolerancia, Referencia&& referencia, Otimizada&& otimizada) {
+    imagem::Imagem esperado, obtido;
+    double tReferencia = medir([&] { esperado = referencia(); });
+    double tOtimizada = medir([&] { obtido = otimizada(); });
+    int diferenca = maiorDiferenca(esperado, obtido);
+    printf("%-22s referência %8.2f ms   otimizada %7.2f ms (%6.1fx, %6.2f GB/s)   diferença %d\n", nome, tReferencia,
+           tOtimizada, tReferencia / tOtimizada, megabytes / tOtimizada, diferenca);
+    return diferenca <= tolerancia;
+}
+
+int main(int argc, char** argv) {
+    imagem::Imagem colorida;
+    try {
+        colorida = argc > 1 ? imagem::ler(argv[1]) : imagemSintetica(2048, 2048);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return -1;
+    }
+    if (colorida.canais != 3) {
+        fprintf(stderr, "A imagem precisa ser colorida (PPM)\n");
+        return -1;
+    }
+    imagem::Imagem cinza = filtros::paraCinza(colorida);
+    const double mbCor = colorida.pixels.size() / 1e6, mbCinza = cinza.pixels.size() / 1e6; // MB lidos (ms -> GB/s)
+    printf("Imagem %dx%d, %u trabalhadores\n", colorida.largura, colorida.altura, tarefas::padrao().numeroTrabalhadores());
+
+    bool ok = true;
+    ok &= comparar("Cinza", mbCor, 0, [&] { return filtros::referencia::paraCinza(colorida); },
+                   [&] { return filtros::paraCinza(colorida); });
+    ok &= comparar("Gaussiano (cor, 1.5)", mbCor, 1, [&] { return filtros::referencia::desfoqueGaussiano(colorida, 1.5f); },
+                   [&] { return filtros::desfoqueGaussiano(colorida, 1.5f); });
+    ok &= comparar("Gaussiano (cinza, 3)", mbCinza, 1, [&] { return filtros::referencia::desfoqueGaussiano(cinza, 3.0f); },
+                   [&] { return filtros::desfoqueGaussiano(cinza, 3.0f); });
+    ok &= comparar("Sobel", mbCinza, 1, [&] { return filtros::referencia::sobel(cinza); }, [&] { return filtros::sobel(cinza); });
+    ok &= comparar("Caixa (raio 4)", mbCinza, 0, [&] { return filtros::referencia::filtroCaixa(cinza, 4); },
+                   [&] { return filtros::filtroCaixa(cinza, 4); });
+    // Área 49: o inverso não é exato e (soma + 24) múltiplo de 49 testa o arredondamento
+    ok &= comparar("Caixa (raio 3)", mbCinza, 0, [&] { return filtros::referencia::filtroCaixa(cinza, 3); },
+                   [&] { return filtros::filtroCaixa(cinza, 3); });
+    ok &= comparar("Equalização", mbCinza, 0, [&] { return filtros::referencia::equalizar(cinza); },
+                   [&] { return filtros::equalizar(cinza); });
+    ok &= comparar("Limiar (50)", mbCinza, 0, [&] { return filtros::referencia::limiarizar(cinza, 50); },
+                   [&] { return filtros::limiarizar(cinza, 50); });
+
+    // O raio não muda o custo da caixa pela imagem integral
+    double tCaixa = medir([&] { filtros::filtroCaixa(cinza, 32); });
+    printf("Caixa (raio 32)        otimizada %7.2f ms\n", tCaixa);
+
+    filtros::Histograma h = filtros::histograma(cinza);
+    ok &= h == filtros::referencia::histograma(cinza);
+    printf("Limiar de Otsu: %d\n", filtros::limiarOtsu(h));
+
+    printf(ok ? "Todos os filtros conferem com a referência\n" : "DIFERENÇAS em relação à referência\n");
+    return ok ? 0 : 1;
+}
@@ -1,11 +1,14 @@
+// Uso: pgm_simples [arquivo]   (imagem.pgm por padrão; .png e .qoi também servem)
+// Compilação: g++ -std=c++17 -O2 -pthread pgm_simples.cpp -o pgm_simples -lz
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <stdexcept>
-#include <sstream>
+#include <string>
 
-// Função para escrever uma imagem em tons de cinza no formato PGM
-void escrever_pgm(const std::vector<std::vector<int>>& imagem, const std::string& nome_arquivo) {
+#include "../comum/formatos_imagem.hpp"
+
+// Função para escrever uma imagem em tons de cinza no formato escolhido pela extensão do arquivo
+void escrever_cinza(const std::vector<std::vector<int>>& imagem, const std::string& nome_arquivo) {
     // Verificar se a imagem é uma matriz 2D
     if (imagem.empty() || imagem[0].empty()) {
         throw std::invalid_argument("A imagem deve ser uma matriz 2D.");
@@ -24,28 +27,22 @@ void escrever_pgm(const std::vector<std::vector<int>>& imagem, const std::string
     int altura = imagem.size();
     int largura = imagem[0].size();
 
-    // Criar o cabeçalho do arquivo PGM
-    std::stringstream cabecalho;
-    cabecalho << "P5 " << largura << " " << altura << " 255\n";
-
-    // Converter a matriz em bytes
-    std::vector<unsigned char> dados;
-    for (const auto& linha : imagem) {
-        for (int pixel : linha) {
-            dados.push_back(static_cast<unsigned char>(pixel));
+    // Converter a matriz em uma imagem de 1 canal
+    imagem::Imagem saida(largura, altura, 1);
+    for (int y = 0; y < altura; y++) {
+        if (static_cast<int>(imagem[y].size()) != largura) {
+            throw std::invalid_argument("Todas as linhas da imagem devem ter a mesma largura.");
+        }
+        for (int x = 0; x < largura; x++) {
+            *saida.pixel(x, y) = static_cast<uint8_t>(imagem[y][x]);
         }
     }
 
-    // Abrir o arquivo PGM em modo binário e escrever o cabeçalho e os dados
-    std::ofstream arquivo(nome_arquivo, std::ios::binary);
-    if (!arquivo) {
-        throw std::runtime_error("Não foi possível abrir o arquivo para escrita.");
-    }
-    arquivo.write(cabecalho.str().c_str(), cabecalho.str().size());
-    arquivo.write(reinterpret_cast<const char*>(dados.data()), dados.size());
+    // Gravar: PGM (P5, binário) para extensões que não sejam .png ou .qoi
+    formatos::escrever(nome_arquivo, saida);
 }
 
-int main() {
+int main(int argc, char** argv) {
     // Exemplo de uso
     std::vector<std::vector<int>> imagem = {
         {0, 50, 100},
@@ -54,8 +51,9 @@ int main() {
     };
 
     try {
-        escrever_pgm(imagem, "imagem.pgm");
-        std::cout << "Imagem PGM criada com sucesso." << std::endl;
+        const std::string arquivo = argc > 1 ? argv[1] : "imagem.pgm";
+        escrever_cinza(imagem, arquivo);
+        std::cout << "Imagem criada com sucesso: " << arquivo << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "Erro: " << e.what() << std::endl;
     }
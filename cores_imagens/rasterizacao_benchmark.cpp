@@ -0,0 +1,174 @@
+// Mede as linhas e os polígonos suavizados de comum/rasterizacao.hpp contra os serrilhados
+//
+// Uso: rasterizacao_benchmark [linhas] [discos]   (padrão: 20000 linhas e 5000 discos em 2048x2048)
+// Confere a cobertura contra a área exata de cada pixel e a composição em simd::i16x8
+// contra a escalar.
+// Compilação: g++ -std=c++17 -O2 -march=native rasterizacao_benchmark.cpp -o rasterizacao_benchmark
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../comum/rasterizacao.hpp"
+
+const int LADO = 2048;
+const int REPETICOES = 3;
+
+double milissegundos(std::chrono::steady_clock::time_point inicio) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+// Menor tempo de REPETICOES execuções, cada uma sobre uma tela branca nova
+template <typename Funcao>
+double medir(imagem::Imagem& tela, Funcao&& f) {
+    double melhor = 1e30;
+    for (int r = 0; r < REPETICOES; ++r) {
+        tela = imagem::Imagem(LADO, LADO, 3, 255);
+        auto inicio = std::chrono::steady_clock::now();
+        f();
+        melhor = std::min(melhor, milissegundos(inicio));
+    }
+    return melhor;
+}
+
+struct Segmento {
+    raster::Ponto a, b;
+    uint8_t cor[3];
+};
+
+struct Disco {
+    raster::Ponto centro;
+    float raio;
+    uint8_t cor[3];
+};
+
+std::vector<raster::Ponto> contornoDisco(const Disco& d) {
+    const int n = raster::ladosCirculo(d.raio);
+    std::vector<raster::Ponto> pontos(n);
+    for (int i = 0; i < n; ++i)
+        pontos[i] = {d.centro.x + d.raio * std::cos(2.0f * float(M_PI) * i / n), d.centro.y + d.raio * std::sin(2.0f * float(M_PI) * i / n)};
+    return pontos;
+}
+
+// Maior diferença entre a cobertura acumulada e a área exata em cada pixel
+float conferirCobertura(std::mt19937& gerador) {
+    std::uniform_real_distribution<float> coordenada(-16.0f, 80.0f);
+    raster::Cobertura cobertura(64, 64);
+    std::vector<float> alfa(64 * 64);
+    float pior = 0;
+    for (int t = 0; t < 500; ++t) {
+        std::vector<raster::Ponto> triangulo = {{coordenada(gerador), coordenada(gerador)},
+                                                {coordenada(gerador), coordenada(gerador)},
+                                                {coordenada(gerador), coordenada(gerador)}};
+        std::fill(alfa.begin(), alfa.end(), 0.0f);
+        cobertura.poligono(triangulo);
+        cobertura.resolver(raster::NAO_ZERO, [&](int y, int x0, int x1, const float* a) {
+            for (int x = x0; x < x1; ++x)
+                alfa[y * 64 + x] = a[x];
+        });
+        for (int y = 0; y < 64; ++y)
+            for (int x = 0; x < 64; ++x)
+                pior = std::max(pior, std::fabs(alfa[y * 64 + x] - raster::referencia::areaNoPixel(triangulo, x, y)));
+    }
+    return pior;
+}
+
+int main(int argc, char** argv) {
+    const int numeroLinhas = argc > 1 ? std::atoi(argv[1]) : 20000;
+    const int numeroDiscos = argc > 2 ? std::atoi(argv[2]) : 5000;
+    if (numeroLinhas < 0 || numeroDiscos < 0) {
+        fprintf(stderr, "Uso: %s [linhas] [discos]\n", argv[0]);
+        return -1;
+    }
+    std::mt19937 gerador(7);
+    std::uniform_real_distribution<float> posicao(-32.0f, LADO + 32.0f), deslocamento(-150.0f, 150.0f), raio(2.0f, 40.0f);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<Segmento> segmentos(numeroLinhas);
+    for (Segmento& s : segmentos) {
+        s.a = {posicao(gerador), posicao(gerador)};
+        s.b = {s.a.x + deslocamento(gerador), s.a.y + deslocamento(gerador)};
+        for (uint8_t& c : s.cor)
+            c = static_cast<uint8_t>(byte(gerador));
+    }
+    std::vector<Disco> discos(numeroDiscos);
+    double areaDiscos = 0;
+    for (Disco& d : discos) {
+        d.centro = {posicao(gerador), posicao(gerador)};
+        d.raio = raio(gerador);
+        areaDiscos += M_PI * d.raio * d.raio;
+        for (uint8_t& c : d.cor)
+            c = static_cast<uint8_t>(byte(gerador));
+    }
+    printf("Tela %dx%d: %d linhas de até 212 pixels, %d discos (%.1f Mpixels de área)\n", LADO, LADO, numeroLinhas, numeroDiscos,
+           areaDiscos / 1e6);
+
+    imagem::Imagem tela;
+    raster::Cobertura cobertura(LADO, LADO);
+
+    // Linhas
+    double tBresenham = medir(tela, [&] {
+        for (const Segmento& s : segmentos)
+            raster::referencia::linhaBresenham(tela, int(s.a.x), int(s.a.y), int(s.b.x), int(s.b.y), s.cor);
+    });
+    double tWu = medir(tela, [&] {
+        for (const Segmento& s : segmentos)
+            raster::linhaWu(tela, s.a, s.b, s.cor);
+    });
+    double tCobertura = medir(tela, [&] {
+        for (const Segmento& s : segmentos) {
+            raster::linha(cobertura, s.a, s.b, 1.0f);
+            raster::compor(tela, cobertura, s.cor);
+        }
+    });
+    printf("Linhas:  Bresenham %7.2f ms   Wu %7.2f ms (%.2fx)   cobertura com 1 pixel %7.2f ms (%.2fx)\n", tBresenham, tWu,
+           tWu / tBresenham, tCobertura, tCobertura / tBresenham);
+
+    // Discos
+    std::vector<std::vector<raster::Ponto>> contornos;
+    for (const Disco& d : discos)
+        contornos.push_back(contornoDisco(d));
+    double tSerrilhado = medir(tela, [&] {
+        for (size_t i = 0; i < discos.size(); ++i)
+            raster::referencia::preencherSerrilhado(tela, contornos[i], discos[i].cor);
+    });
+    double tSuave = medir(tela, [&] {
+        for (size_t i = 0; i < discos.size(); ++i) {
+            cobertura.poligono(contornos[i]);
+            raster::compor(tela, cobertura, discos[i].cor);
+        }
+    });
+    imagem::Imagem escalar;
+    double tEscalar = medir(escalar, [&] {
+        for (size_t i = 0; i < discos.size(); ++i) {
+            cobertura.poligono(contornos[i]);
+            raster::referencia::compor(escalar, cobertura, discos[i].cor);
+        }
+    });
+    printf("Discos:  serrilhado %7.2f ms   suavizado %7.2f ms (%.2fx, %.0f Mpixels/s)   composição escalar %7.2f ms\n", tSerrilhado,
+           tSuave, tSuave / tSerrilhado, areaDiscos / 1e3 / tSuave, tEscalar);
+
+    // Conferências. Camadas sobrepostas acumulam o arredondamento de cada composição, então
+    // a vetorial e a escalar são comparadas com todos os discos em uma só cobertura
+    imagem::Imagem vetorial(LADO, LADO, 3, 255);
+    escalar = vetorial;
+    const uint8_t cor[3] = {200, 60, 30};
+    for (auto* saida : {&vetorial, &escalar}) {
+        for (const auto& contorno : contornos)
+            cobertura.poligono(contorno);
+        if (saida == &vetorial)
+            raster::compor(vetorial, cobertura, cor, raster::PAR_IMPAR);
+        else
+            raster::referencia::compor(escalar, cobertura, cor, raster::PAR_IMPAR);
+    }
+    int maiorDiferenca = 0;
+    for (size_t i = 0; i < vetorial.pixels.size(); ++i)
+        maiorDiferenca = std::max(maiorDiferenca, std::abs(int(vetorial.pixels[i]) - int(escalar.pixels[i])));
+    float pior = conferirCobertura(gerador);
+    bool ok = maiorDiferenca <= 1 && pior < 1e-3f;
+    printf("Composição vetorial contra escalar: até %d nível; cobertura contra área exata: erro máximo %.2g\n", maiorDiferenca, pior);
+    printf(ok ? "Rasterização confere\n" : "DIFERENÇAS na rasterização\n");
+    return ok ? 0 : 1;
+}
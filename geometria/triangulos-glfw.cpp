@@ -1,6 +1,7 @@
 #include <GL/glew.h>                           // Inclui a biblioteca GLEW para lidar com extensões OpenGL de forma portável
 #include <GLFW/glfw3.h>                        // Inclui a biblioteca GLFW para criação de janelas e contexto OpenGL
 #include <iostream>                            // Inclui a biblioteca para entrada e saída de dados em console
+#include "../comum/estado_gl.hpp"              // Rastreamento do estado do OpenGL e fila de desenho ordenada
 
 const char* vertex_shader = R"(                // Define uma string contendo o código do shader de vértices
     #version 330 core                         // Declara a versão do OpenGL utilizada
@@ -23,28 +24,27 @@ GLuint shaderProgram;                         // Variável para armazenar o prog
 GLint attribute_coord3d;                      // Localização do atributo de coordenadas 3D nos shaders
 GLFWwindow* window;                           // Variável para a janela GLFW
 GLuint vao, vbo;                              // Variáveis para os objetos de array de vértices e buffer de vértices
+EstadoGL estado;                              // Lembra o que já está vinculado e evita chamadas redundantes
+FilaDesenho fila(estado);                     // Ordena os desenhos por (programa, material, malha, profundidade)
+uint16_t programa_fila, material_vermelho, material_verde, malha_abaixo, malha_acima; // Identificadores na fila
+double ultimoRelatorio;                       // Instante em que os contadores foram mostrados pela última vez
 
 void onDisplay() {                            // Função chamada para renderizar a cena na janela OpenGL
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);   // Limpa os buffers de cor e profundidade
-    glUseProgram(shaderProgram);              // Usa o programa de shader especificado
-
-    glBindVertexArray(vao);                   // Vincula o array de vértices
-    glEnableVertexAttribArray(attribute_coord3d);  // Habilita o atributo de coordenadas 3D
-
-    GLfloat red[] = {1.0f, 0.0f, 0.0f, 1.0f}; // Define a cor vermelha
-    GLfloat green[] = {0.0f, 1.0f, 0.0f, 1.0f};   // Define a cor verde
-
-    glUniform4fv(glGetUniformLocation(shaderProgram, "color"), 1, red); // Define a cor do primeiro triângulo como vermelho
-    glDrawArrays(GL_TRIANGLES, 0, 3);        // Desenha o primeiro triângulo
-
-    glUniform4fv(glGetUniformLocation(shaderProgram, "color"), 1, green); // Define a cor do segundo triângulo como verde
-    glDrawArrays(GL_TRIANGLES, 3, 3);        // Desenha o segundo triângulo
+    EstadoGL::Contadores anterior = estado.iniciarQuadro(); // Zera os contadores e devolve os do quadro anterior
+    if (glfwGetTime() - ultimoRelatorio >= 1.0) {             // No máximo uma vez por segundo
+        EstadoGL::imprimirContadores(anterior);               // Chamadas emitidas e evitadas no último quadro completo
+        ultimoRelatorio = glfwGetTime();
+    }
 
-    glDisableVertexAttribArray(attribute_coord3d);  // Desabilita o atributo de coordenadas 3D
+    fila.submeter(programa_fila, material_verde, malha_acima);    // Segundo triângulo (verde)
+    fila.submeter(programa_fila, material_vermelho, malha_abaixo); // Primeiro triângulo (vermelho)
+    fila.executar();                          // Ordena e desenha; programa, VAO e atributo só são vinculados se mudarem
     glfwSwapBuffers(window);                   // Troca os buffers da janela OpenGL
 }
 
 void free_resources() {                       // Função para liberar os recursos alocados na GPU
+    estado.esquecerPrograma(shaderProgram);   // Remove o programa do cache de uniforms
     glDeleteProgram(shaderProgram);           // Deleta o programa de shader
     glDeleteVertexArrays(1, &vao);            // Deleta o array de vértices
     glDeleteBuffers(1, &vbo);                 // Deleta o buffer de vértices
@@ -89,8 +89,13 @@ void init_resources() {                       // Função para inicializar os re
         return;                                // Retorna caso não seja possível vincular o atributo
     }
 
-    glVertexAttribPointer(attribute_coord3d, 3, GL_FLOAT, GL_FALSE, 0, 0); // Define os atributos dos vértices
-    glEnableVertexAttribArray(attribute_coord3d); // Habilita o atributo de coordenadas 3D
+    // Registra o programa, as cores e os dois triângulos (intervalos do mesmo VBO) na fila de desenho
+    programa_fila = fila.registrarPrograma(shaderProgram);
+    material_vermelho = fila.registrarMaterial({"color", {1.0f, 0.0f, 0.0f, 1.0f}}); // Cor do primeiro triângulo
+    material_verde = fila.registrarMaterial({"color", {0.0f, 1.0f, 0.0f, 1.0f}});    // Cor do segundo triângulo
+    malha_abaixo = fila.registrarMalha({vao, vbo, GLuint(attribute_coord3d), 3, nullptr, GL_TRIANGLES, 0, 3});
+    malha_acima = fila.registrarMalha({vao, vbo, GLuint(attribute_coord3d), 3, nullptr, GL_TRIANGLES, 3, 3});
+    // O ponteiro e a habilitação do atributo são feitos pela fila no primeiro quadro (e não repetidos depois)
 }
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) { // Função de callback para eventos de teclado
@@ -126,6 +131,7 @@ int main() {                                   // Função principal
     glEnable(GL_DEPTH_TEST);                   // Habilita o teste de profundidade para renderização 3D
     init_resources();                          // Inicializa os recursos na GPU
     glfwSetKeyCallback(window, key_callback);  // Configura a função de callback para eventos de teclado
+    ultimoRelatorio = glfwGetTime();           // O primeiro relatório sai depois de um segundo de quadros
 
     while (!glfwWindowShouldClose(window)) {   // Loop principal de renderização
         onDisplay();                           // Renderiza a cena na janela
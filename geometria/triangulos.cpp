@@ -1,9 +1,26 @@
 #include <GLUT/glut.h>
 #include <iostream>
+#include "../comum/estado_gl.hpp"
 
 GLuint shaderProgram;
 GLint attribute_coord3d;
 
+// Estado já vinculado no OpenGL e fila de desenho ordenada por (programa, material, malha, profundidade)
+EstadoGL estado;
+FilaDesenho fila(estado);
+uint16_t programa_fila, material_vermelho, material_verde, malha_abaixo, malha_acima;
+int ultimoRelatorio = 0; // Em milissegundos de glutGet(GLUT_ELAPSED_TIME)
+
+// Define os vértices em 3D de cada triângulo (arrays do cliente: precisam continuar válidos entre quadros)
+const GLfloat vertices[] = {
+  -1.0f, -1.0f, 0.0f, // Triângulo 1 (abaixo)
+  1.0f, -1.0f, 0.0f,
+  0.0f, 1.0f,  0.0f,
+  -1.0f, 1.0f,  0.0f, // Triângulo 2 (acima)
+  1.0f, 1.0f,  0.0f,
+  0.0f, -1.0f, 0.0f,
+};
+
 const GLchar* vertex_shader =
   "#version 120\n"
   "attribute vec3 coord3d;\n"
@@ -20,37 +37,22 @@ const GLchar* fragment_shader =
 
 void onDisplay() {
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  glUseProgram(shaderProgram);
-  glEnableVertexAttribArray(attribute_coord3d);
-  
-  // Define os vértices em 3D e as cores para cada triângulo
-  GLfloat vertices[] = {
-    -1.0f, -1.0f, 0.0f, // Triângulo 1 (abaixo)
-    1.0f, -1.0f, 0.0f,
-    0.0f, 1.0f,  0.0f,
-    -1.0f, 1.0f,  0.0f, // Triângulo 2 (acima)
-    1.0f, 1.0f,  0.0f,
-    0.0f, -1.0f, 0.0f,
-  };
-  
-  GLfloat red[] = { 1.0, 0.0, 0.0, 1.0 };   // Cor para o primeiro triângulo
-  GLfloat green[] = { 0.0, 1.0, 0.0, 1.0 }; // Cor para o segundo triângulo
-
-  // Desenha o primeiro triângulo (abaixo) com a cor vermelha
-  glUniform4fv(glGetUniformLocation(shaderProgram, "color"), 1, red);
-  glVertexAttribPointer(attribute_coord3d, 3, GL_FLOAT, GL_FALSE, 0, vertices);
-  glDrawArrays(GL_TRIANGLES, 0, 3);
-
-  // Desenha o segundo triângulo (acima) com a cor verde
-  glUniform4fv(glGetUniformLocation(shaderProgram, "color"), 1, green);
-  glVertexAttribPointer(attribute_coord3d, 3, GL_FLOAT, GL_FALSE, 0, vertices + 3);
-  glDrawArrays(GL_TRIANGLES, 0, 3);
+  // Zera os contadores; os do quadro anterior aparecem no máximo uma vez por segundo
+  EstadoGL::Contadores anterior = estado.iniciarQuadro();
+  if (anterior.desenhos > 0 && glutGet(GLUT_ELAPSED_TIME) - ultimoRelatorio >= 1000) {
+    EstadoGL::imprimirContadores(anterior);
+    ultimoRelatorio = glutGet(GLUT_ELAPSED_TIME);
+  }
 
-  glDisableVertexAttribArray(attribute_coord3d);
+  // Submete os triângulos em qualquer ordem; a fila agrupa por programa e material antes de desenhar
+  fila.submeter(programa_fila, material_verde, malha_acima);    // Segundo triângulo (acima) com a cor verde
+  fila.submeter(programa_fila, material_vermelho, malha_abaixo); // Primeiro triângulo (abaixo) com a cor vermelha
+  fila.executar(); // Só emite glUseProgram, glEnableVertexAttribArray e glGetUniformLocation quando algo muda
   glutSwapBuffers();
 }
 
 void free_resources() {
+  estado.esquecerPrograma(shaderProgram);
   glDeleteProgram(shaderProgram);
 }
 
@@ -87,6 +89,13 @@ void init_resources() {
     fprintf(stderr, "Não foi possível vincular o atributo %s\n", attribute_name);
     return;
   }
+
+  // Registra o programa, as cores e os dois triângulos na fila de desenho
+  programa_fila = fila.registrarPrograma(shaderProgram);
+  material_vermelho = fila.registrarMaterial({"color", { 1.0, 0.0, 0.0, 1.0 }}); // Cor para o primeiro triângulo
+  material_verde = fila.registrarMaterial({"color", { 0.0, 1.0, 0.0, 1.0 }});    // Cor para o segundo triângulo
+  malha_abaixo = fila.registrarMalha({0, 0, GLuint(attribute_coord3d), 3, vertices, GL_TRIANGLES, 0, 3});
+  malha_acima = fila.registrarMalha({0, 0, GLuint(attribute_coord3d), 3, vertices, GL_TRIANGLES, 3, 3});
 }
 
 int main(int argc, char* argv[]) {
@@ -0,0 +1,88 @@
+#!/bin/sh
+# Confere se os exemplos ainda desenham as mesmas imagens das referências guardadas aqui
+#
+# Compila cada exemplo, captura um quadro fora da tela (--capturar, veja
+# comum/captura_quadro.hpp) e compara com goldens/<nome>.ppm usando
+# cores_imagens/comparar_imagens. Os mapas de diferença ficam em $SAIDA.
+#
+# Uso, na raiz do repositório:
+#   goldens/verificar.sh               compara com as referências
+#   goldens/verificar.sh --atualizar   grava as capturas atuais como novas referências
+# Sem GPU, com o OpenGL em software do Mesa (llvmpipe):
+#   xvfb-run -s "-screen 0 1280x1024x24" goldens/verificar.sh
+#
+# girassol.ppm é gerada na CPU; as referências dos exemplos OpenGL foram gravadas com
+# --atualizar no llvmpipe do Mesa. Ao trocar uma delas, grave de novo no llvmpipe.
+#
+# Sai com 0 se todas as imagens conferem, 1 se alguma falhou, 2 se nem o comparador
+# compilou e 3 se nada falhou mas faltou alguma referência (a verificação não está completa).
+set -u
+
+RAIZ=$(cd "$(dirname "$0")/.." && pwd)
+GOLDENS="$RAIZ/goldens"
+SAIDA=${SAIDA:-/tmp/goldens}
+CXX=${CXX:-g++}
+FLAGS="-std=c++17 -O2 -pthread"
+BIBLIOTECAS_GL="-lGLEW -lglfw -lGL -lGLU -lz"
+ATUALIZAR=0
+[ "${1:-}" = "--atualizar" ] && ATUALIZAR=1
+# Renderizações diferentes (driver, ordem de rasterização) mudam alguns pixels de borda
+TOLERANCIA_GL="-t 8 -f 0.002 -s 0.98"
+FALHAS=0
+PULADAS=0
+
+mkdir -p "$SAIDA"
+$CXX $FLAGS -march=native "$RAIZ/cores_imagens/comparar_imagens.cpp" -o "$SAIDA/comparar_imagens" -lz || exit 2
+
+# comparar <nome> <opções de comparar_imagens>
+comparar() {
+    nome=$1; shift
+    if [ $ATUALIZAR -eq 1 ]; then
+        cp "$SAIDA/$nome.ppm" "$GOLDENS/$nome.ppm" && echo "$nome: referência atualizada"
+    elif [ ! -f "$GOLDENS/$nome.ppm" ]; then
+        echo "$nome: sem referência (rode com --atualizar no llvmpipe)"
+        PULADAS=$((PULADAS + 1))
+    elif ! "$SAIDA/comparar_imagens" "$GOLDENS/$nome.ppm" "$SAIDA/$nome.ppm" "$@" -m "$SAIDA/$nome-diferencas.ppm"; then
+        FALHAS=$((FALHAS + 1))
+    fi
+}
+
+# capturar <nome> <diretório> <fonte> <quadro> [argumentos do exemplo]
+capturar() {
+    nome=$1; diretorio=$2; fonte=$3; quadro=$4; shift 4
+    if ! $CXX $FLAGS "$RAIZ/$diretorio/$fonte" -o "$SAIDA/$nome" $BIBLIOTECAS_GL; then
+        echo "$nome: falha na compilação"
+        FALHAS=$((FALHAS + 1))
+        return
+    fi
+    # Executa no diretório do exemplo, que lê shaders e modelos de lá
+    if ! (cd "$RAIZ/$diretorio" && "$SAIDA/$nome" "$@" --capturar "$quadro" "$SAIDA/$nome.ppm" > "$SAIDA/$nome.log" 2>&1); then
+        echo "$nome: falha na captura (veja $SAIDA/$nome.log)"
+        FALHAS=$((FALHAS + 1))
+        return
+    fi
+    comparar "$nome" $TOLERANCIA_GL
+}
+
+# Exemplo só de CPU: a saída deve ser idêntica
+if $CXX $FLAGS "$RAIZ/cores_imagens/pgm.cpp" -o "$SAIDA/pgm" -lz && (cd "$SAIDA" && ./pgm girassol.ppm > /dev/null); then
+    comparar girassol
+else
+    echo "girassol: falha ao gerar a imagem"
+    FALHAS=$((FALHAS + 1))
+fi
+
+capturar casa transformacoes casa-glfw.cpp 120
+capturar cubo projecoes/cubo cubo-visualizacao-multipla-atividade.cpp 2
+capturar phong modelo-iluminacao-phong phong.cpp 2
+capturar multiprojecoes projecoes/multiprojecoes multiprojecoes.cpp 2 teapot.obj
+
+if [ $FALHAS -ne 0 ]; then
+    echo "$FALHAS verificações falharam"
+    exit 1
+fi
+if [ $PULADAS -ne 0 ]; then
+    echo "$PULADAS comparações sem referência"
+    exit 3
+fi
+[ $ATUALIZAR -eq 1 ] || echo "Todas as imagens conferem"
@@ -7,12 +7,21 @@
 #include <cmath>  // Para funções matemáticas como sin, cos, M_PI
 #include <iostream>  // Para saída de console (std::cout)
 #include <cstring>  // Para função strcmp
+#include "../comum/lod.hpp"  // Para a simplificação da esfera em níveis de detalhe
+#include "../comum/captura_quadro.hpp"  // Para o modo de captura (--capturar N arquivo.ppm)
+
+// Níveis de detalhe da esfera, do original 250x250 (nível 0) ao mais simples
+lod::Cadeia cadeia_esfera;
+int altura_framebuffer = 800;  // Altura em pixels usada para projetar o erro de cada nível na tela
+size_t nivel_desenhado[4] = {SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX};  // Último nível escolhido por esfera
+captura::Captura captura_quadro;  // Salva um quadro fora da tela para comparar com goldens/
 
 // Função para inicializar o GLFW e criar uma janela
 GLFWwindow* inicializar_glfw() {
     if (!glfwInit()) {  // Tenta inicializar o GLFW
         return nullptr;  // Se falhar, retorna nullptr
     }
+    captura_quadro.prepararJanela();  // Na captura, a janela fica invisível
     // Cria uma janela de 800x800 pixels com o título "Modelo de iluminação Phong"
     GLFWwindow* window = glfwCreateWindow(800, 800, "Modelo de iluminação Phong", nullptr, nullptr);
     if (!window) {  // Se falhar ao criar a janela
@@ -53,38 +62,55 @@ void configurar_iluminacao() {
     glLightfv(GL_LIGHT2, GL_POSITION, posicao_luz);  // Define a posição da luz especular
 }
 
-// Função para desenhar uma esfera
-void desenhar_esfera(float raio, int slices, int stacks) {
-    // Este loop cria as fatias verticais da esfera
-    for (int i = 0; i < slices; ++i) {
-        // Calcula as coordenadas para duas fatias adjacentes
-        float lat0 = M_PI * (-0.5 + float(i) / slices);
-        float z0 = raio * sin(lat0);
-        float zr0 = raio * cos(lat0);
-
-        float lat1 = M_PI * (-0.5 + float(i + 1) / slices);
-        float z1 = raio * sin(lat1);
-        float zr1 = raio * cos(lat1);
-
-        // Começa a desenhar uma faixa de quadriláteros
-        glBegin(GL_QUAD_STRIP);
-        // Este loop cria os segmentos horizontais da esfera
+// Função para gerar a malha de uma esfera, com as mesmas fatias e segmentos do antigo desenho com GL_QUAD_STRIP
+malha::Malha gerar_esfera(float raio, int slices, int stacks) {
+    malha::Malha esfera;
+    // Uma linha de vértices por latitude; a costura em 0 e 2*pi é soldada pela simplificação
+    for (int i = 0; i <= slices; ++i) {
+        float lat = M_PI * (-0.5 + float(i) / slices);
+        float z = raio * sin(lat);
+        float zr = raio * cos(lat);
         for (int j = 0; j <= stacks; ++j) {
             float lng = 2 * M_PI * float(j) / stacks;
-            float x = cos(lng);
-            float y = sin(lng);
-            // Define a normal e o vértice para dois pontos adjacentes
-            glNormal3f(x * zr0, y * zr0, z0);
-            glVertex3f(x * zr0, y * zr0, z0);
-            glNormal3f(x * zr1, y * zr1, z1);
-            glVertex3f(x * zr1, y * zr1, z1);
+            esfera.posicoes.insert(esfera.posicoes.end(), {cosf(lng) * zr, sinf(lng) * zr, z});
+            esfera.normais.insert(esfera.normais.end(), {cosf(lng) * zr / raio, sinf(lng) * zr / raio, z / raio});  // Normal exata (unitária)
+        }
+    }
+    // Cada quadrilátero da faixa vira dois triângulos
+    for (int i = 0; i < slices; ++i) {
+        for (int j = 0; j < stacks; ++j) {
+            uint32_t a = i * (stacks + 1) + j, b = a + 1, c = a + stacks + 1, d = c + 1;
+            esfera.indices.insert(esfera.indices.end(), {a, b, d, a, d, c});
         }
-        glEnd();  // Termina de desenhar a faixa de quadriláteros
+    }
+    return esfera;
+}
+
+// Função para desenhar uma malha com arrays de vértices (uma chamada em vez de milhares de glVertex)
+void desenhar_malha(const malha::Malha& m) {
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, m.posicoes.data());
+    glNormalPointer(GL_FLOAT, 0, m.normais.data());
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(m.indices.size()), GL_UNSIGNED_INT, m.indices.data());
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+// Função para montar os níveis de detalhe da esfera
+void preparar_esfera(float raio) {
+    cadeia_esfera = lod::gerarCadeia(gerar_esfera(raio, 250, 250));
+    for (size_t i = 0; i < cadeia_esfera.niveis.size(); ++i) {
+        malha::Malha& nivel = cadeia_esfera.niveis[i];
+        // O desenho original usava a posição como normal, sem GL_NORMALIZE: mantém o comprimento igual ao raio
+        for (float& n : nivel.normais)
+            n *= raio;
+        std::cout << "Nível " << i << ": " << nivel.numeroTriangulos() << " triângulos, erro " << cadeia_esfera.erros[i] << std::endl;
     }
 }
 
 // Função para desenhar uma esfera em uma posição específica
-void desenhar_esfera_na_posicao(float x, float y, const char* modo_de_iluminacao) {
+void desenhar_esfera_na_posicao(int indice, float x, float y, const char* modo_de_iluminacao) {
     glPushMatrix();  // Salva o estado atual da matriz
     glTranslatef(x, y, -5);  // Move a esfera para a posição desejada
 
@@ -113,7 +139,15 @@ void desenhar_esfera_na_posicao(float x, float y, const char* modo_de_iluminacao
         glEnable(GL_LIGHT2);
     }
     
-    desenhar_esfera(0.5f, 250, 250);  // Desenha a esfera
+    // Escolhe o nível mais simples cujo erro projetado na tela não passa de um pixel
+    float distancia = sqrtf(x * x + y * y + 25.0f);  // Distância da câmera (na origem) ao centro da esfera
+    double pixels_por_unidade = lod::pixelsPorUnidadePerspectiva(distancia, glm::radians(45.0f), altura_framebuffer);
+    size_t nivel = lod::selecionar(cadeia_esfera, pixels_por_unidade);
+    if (nivel != nivel_desenhado[indice]) {
+        std::cout << "Esfera " << modo_de_iluminacao << ": nível " << nivel << " (" << cadeia_esfera.niveis[nivel].numeroTriangulos() << " triângulos)" << std::endl;
+        nivel_desenhado[indice] = nivel;
+    }
+    desenhar_malha(cadeia_esfera.niveis[nivel]);  // Desenha a esfera
     glPopMatrix();  // Restaura o estado anterior da matriz
 }
 
@@ -131,14 +165,15 @@ void renderizar() {
     glLoadIdentity();  // Reseta a matriz de modelagem
 
     // Desenha as esferas nos quatro quadrantes com diferentes modos de iluminação
-    desenhar_esfera_na_posicao(-1.5f, 1.5f, "ambiente");
-    desenhar_esfera_na_posicao(1.5f, 1.5f, "difusa");
-    desenhar_esfera_na_posicao(-1.5f, -1.5f, "especular");
-    desenhar_esfera_na_posicao(1.5f, -1.5f, "phong");
+    desenhar_esfera_na_posicao(0, -1.5f, 1.5f, "ambiente");
+    desenhar_esfera_na_posicao(1, 1.5f, 1.5f, "difusa");
+    desenhar_esfera_na_posicao(2, -1.5f, -1.5f, "especular");
+    desenhar_esfera_na_posicao(3, 1.5f, -1.5f, "phong");
 }
 
 // Função principal do programa
-int main() {
+int main(int argc, char** argv) {
+    captura_quadro.configurar(argc, argv);  // --capturar N arquivo.ppm: salva o quadro N e termina
     GLFWwindow* window = inicializar_glfw();  // Inicializa o GLFW e cria a janela
     if (!window) {  // Se falhar ao criar a janela
         return -1;  // Encerra o programa
@@ -151,14 +186,20 @@ int main() {
 
     glEnable(GL_DEPTH_TEST);  // Habilita o teste de profundidade
     configurar_iluminacao();  // Configura a iluminação
+    preparar_esfera(0.5f);  // Gera os níveis de detalhe da esfera
 
     // Loop principal do programa
     while (!glfwWindowShouldClose(window)) {
+        int largura;
+        glfwGetFramebufferSize(window, &largura, &altura_framebuffer);  // A escolha do nível depende do tamanho na tela
         renderizar();  // Renderiza a cena
+        if (captura_quadro.concluirQuadro(window)) {  // Na captura, salva o quadro pedido e termina
+            break;
+        }
         glfwSwapBuffers(window);  // Troca os buffers de exibição
         glfwPollEvents();  // Processa eventos da janela
     }
 
     glfwTerminate();  // Finaliza o GLFW quando o loop termina
-    return 0;
+    return captura_quadro.codigoSaida();
 }
\ No newline at end of file
@@ -4,6 +4,10 @@
 #include <iostream>
 #include <fstream>
 #include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <cmath>
 
 // Inclui GLEW
 #include <GL/glew.h>
@@ -12,6 +16,39 @@
 #include <GLFW/glfw3.h>
 GLFWwindow* janela;
 
+// Cache de programas GLSL compartilhado pelos exemplos
+#include "../../comum/gerenciador_shaders.hpp"
+GerenciadorShaders gerenciadorShaders;
+
+// Tipos compactos de vértice (cores RGBA8)
+#include "../../comum/formato_vertice.hpp"
+
+// Recompila os shaders em segundo plano quando os arquivos são editados
+#include "../../comum/recarga_shaders.hpp"
+RecarregadorShaders recarregadorShaders;
+
+// Só desenha quando algo muda (janela, mouse, teclado ou shaders recarregados), em vez de a cada volta do laço
+#include "../../comum/renderizacao_sob_demanda.hpp"
+RenderizacaoSobDemanda sobDemanda;
+
+// Os comandos de cada viewport são gravados em paralelo (tarefas::padrao()) e emitidos pela thread principal, dona do contexto
+#include "../../comum/comandos_render.hpp"
+comandos::GravadorParalelo gravador;
+
+// Dados temporários de cada quadro vêm de uma arena linear reiniciada a cada quadro (nenhum malloc no laço).
+// Compilado com -DARENA_QUADRO_CONTAR_NEW, também conta as chamadas a operator new e relata o uso da arena.
+#include "../../comum/arena_quadro.hpp"
+arena::ArenaQuadro arenaQuadro(gravador.numeroThreads()); // Uma sub-arena por thread do gravador
+
+// Retângulos dos viewports, recalculados só quando o framebuffer muda de tamanho
+#include "../../comum/disposicao_viewports.hpp"
+disposicao::Disposicao disposicaoViewports;
+const size_t NUMERO_VIEWPORTS = 4; // Grade 2x2; com mais vistas as câmeras abaixo se repetem
+
+// Com --capturar N arquivo.ppm, desenha o quadro N fora da tela, salva e termina (para comparar com goldens/)
+#include "../../comum/captura_quadro.hpp"
+captura::Captura capturaQuadro;
+
 // Cabeçalho GLM
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -43,9 +80,26 @@ glm::mat4 MVP;
 GLint larguraJanela = 1024;
 GLint alturaJanela = 768;
 
+// Nossos vértices. Três floats consecutivos formam um vértice 3D; Três vértices consecutivos formam um triângulo.
+// Um cubo tem 6 faces com 2 triângulos cada, o que resulta em 6*2=12 triângulos, e 12*3 vértices
+static const GLfloat dadosBufferVertices[] = {
+    -1.0f,-1.0f,-1.0f,  -1.0f,-1.0f, 1.0f,  -1.0f, 1.0f, 1.0f, // Face 1
+    -1.0f,-1.0f,-1.0f,  -1.0f, 1.0f,-1.0f,  -1.0f, 1.0f, 1.0f,
+    1.0f,-1.0f, 1.0f,   -1.0f,-1.0f, 1.0f,  1.0f,-1.0f,-1.0f, // Face 2
+    1.0f,-1.0f,-1.0f,   -1.0f,-1.0f,-1.0f,  -1.0f,-1.0f, 1.0f,
+    -1.0f, 1.0f, 1.0f,  1.0f, 1.0f,-1.0f,   1.0f, 1.0f, 1.0f, // Face 3
+    -1.0f, 1.0f, 1.0f,  -1.0f, 1.0f,-1.0f,  1.0f, 1.0f,-1.0f,
+    -1.0f,-1.0f,-1.0f,  1.0f,-1.0f,-1.0f,   1.0f, 1.0f,-1.0f, // Face 4
+    -1.0f,-1.0f,-1.0f,  -1.0f, 1.0f,-1.0f,  1.0f, 1.0f,-1.0f,
+    -1.0f,-1.0f, 1.0f,  1.0f,-1.0f, 1.0f,   1.0f, 1.0f, 1.0f, // Face 5
+    -1.0f,-1.0f, 1.0f,  -1.0f, 1.0f, 1.0f,  1.0f, 1.0f, 1.0f,
+    1.0f,-1.0f,-1.0f,   1.0f, 1.0f,-1.0f,   1.0f, 1.0f, 1.0f, // Face 6
+    1.0f,-1.0f,-1.0f,   1.0f,-1.0f, 1.0f,   1.0f, 1.0f, 1.0f
+};
+
 void limparDadosDaGPU();
 void desenhar(void);
-void desenharEixos();
+void gravarEixos(comandos::BufferComandos& buffer);
 std::string getCaminhoShader(std::string arquivo);
 void inicializarDadosEixos();
 GLuint carregarShaders(const char* caminhoArquivoVertice, const char* caminhoArquivoFragmento);
@@ -53,76 +107,307 @@ void configurarMVP(void);
 void transferirDadosParaMemoriaGPU(void);
 
 //--------------------------------------------------------------------------------
-GLuint carregarShaders(const char* caminhoArquivoVertice, const char* caminhoArquivoFragmento) {
-    // Cria os shaders
-    GLuint idShaderVertice = glCreateShader(GL_VERTEX_SHADER);
-    GLuint idShaderFragmento = glCreateShader(GL_FRAGMENT_SHADER);
-
-    // Lê o código do Shader de Vértice do arquivo
-    std::string codigoShaderVertice;
-    std::ifstream streamShaderVertice(caminhoArquivoVertice, std::ios::in);
-    if (streamShaderVertice.is_open()) {
-        std::string linha = "";
-        while (getline(streamShaderVertice, linha))
-            codigoShaderVertice += "\n" + linha;
-        streamShaderVertice.close();
+// Seleção (picking) por raio
+//
+// Cada viewport guarda o retângulo e a inversa de Projecao * Visualizacao usados no
+// último quadro. Ao mover o mouse, o cursor é convertido para coordenadas do
+// framebuffer, o viewport que o contém é localizado, o ponto é desprojetado em um
+// raio no espaço do mundo e o raio é testado contra uma BVH (Bounding Volume
+// Hierarchy) dos triângulos da cena. Nada é alocado durante a consulta.
+
+// Triângulo da cena, com o objeto e o índice original a que pertence
+struct TrianguloCena {
+    glm::vec3 v0, v1, v2;
+    int objeto;
+    int indice;
+};
+
+// Nó da BVH em 32 bytes: se quantidade > 0 é folha e "inicio" indexa os triângulos,
+// caso contrário "inicio" é o índice do filho esquerdo (o direito é inicio + 1)
+struct NoBVH {
+    glm::vec3 minimo;
+    int inicio;
+    glm::vec3 maximo;
+    int quantidade;
+};
+
+struct BVH {
+    std::vector<NoBVH> nos;
+    std::vector<TrianguloCena> triangulos; // Reordenados para que cada folha seja contígua
+};
+
+struct Raio {
+    glm::vec3 origem;
+    glm::vec3 direcao;
+    glm::vec3 inversoDirecao;
+};
+
+struct ResultadoSelecao {
+    bool acertou = false;
+    int viewport = -1;
+    int objeto = -1;
+    int triangulo = -1;
+    float distancia = 0.0f;
+};
+
+// Estado de câmera de cada viewport, atualizado em desenhar()
+struct ViewportSelecao {
+    int x, y, largura, altura;
+    glm::mat4 inversaProjecaoVisualizacao;
+    bool valido;
+};
+
+const int MAXIMO_TRIANGULOS_FOLHA = 4;
+const int OBJETO_CUBO = 0;
+
+BVH bvhCena;
+std::vector<ViewportSelecao> viewportsSelecao;
+ResultadoSelecao ultimaSelecao;
+double tempoTotalSelecaoUs = 0.0;
+long long numeroSelecoes = 0;
+
+//--------------------------------------------------------------------------------
+void ajustarCaixa(NoBVH& no, const std::vector<TrianguloCena>& triangulos) {
+    no.minimo = glm::vec3(std::numeric_limits<float>::max());
+    no.maximo = glm::vec3(-std::numeric_limits<float>::max());
+    for (int i = no.inicio; i < no.inicio + no.quantidade; ++i) {
+        const TrianguloCena& t = triangulos[i];
+        no.minimo = glm::min(no.minimo, glm::min(t.v0, glm::min(t.v1, t.v2)));
+        no.maximo = glm::max(no.maximo, glm::max(t.v0, glm::max(t.v1, t.v2)));
+    }
+}
+
+//--------------------------------------------------------------------------------
+void subdividirNo(BVH& bvh, int indiceNo) {
+    NoBVH& no = bvh.nos[indiceNo];
+    if (no.quantidade <= MAXIMO_TRIANGULOS_FOLHA)
+        return;
+
+    // Divide pelo eixo mais longo da caixa, no ponto médio dos centróides
+    glm::vec3 extensao = no.maximo - no.minimo;
+    int eixo = 0;
+    if (extensao.y > extensao.x) eixo = 1;
+    if (extensao.z > extensao[eixo]) eixo = 2;
+
+    auto centroide = [eixo](const TrianguloCena& t) { return (t.v0[eixo] + t.v1[eixo] + t.v2[eixo]) / 3.0f; };
+    auto primeiro = bvh.triangulos.begin() + no.inicio;
+    auto ultimo = primeiro + no.quantidade;
+    float minimoC = std::numeric_limits<float>::max(), maximoC = -std::numeric_limits<float>::max();
+    for (auto it = primeiro; it != ultimo; ++it) {
+        minimoC = std::min(minimoC, centroide(*it));
+        maximoC = std::max(maximoC, centroide(*it));
+    }
+    float corte = 0.5f * (minimoC + maximoC);
+    auto meio = std::partition(primeiro, ultimo, [&](const TrianguloCena& t) { return centroide(t) < corte; });
+
+    // Centróides coincidentes: recorre à divisão pela mediana
+    int quantidadeEsquerda = static_cast<int>(meio - primeiro);
+    if (quantidadeEsquerda == 0 || quantidadeEsquerda == no.quantidade) {
+        quantidadeEsquerda = no.quantidade / 2;
+        std::nth_element(primeiro, primeiro + quantidadeEsquerda, ultimo,
+                         [&](const TrianguloCena& a, const TrianguloCena& b) { return centroide(a) < centroide(b); });
+    }
+
+    int inicio = no.inicio, quantidade = no.quantidade;
+    int indiceEsquerdo = static_cast<int>(bvh.nos.size());
+    bvh.nos.push_back({glm::vec3(0.0f), inicio, glm::vec3(0.0f), quantidadeEsquerda});
+    bvh.nos.push_back({glm::vec3(0.0f), inicio + quantidadeEsquerda, glm::vec3(0.0f), quantidade - quantidadeEsquerda});
+    ajustarCaixa(bvh.nos[indiceEsquerdo], bvh.triangulos);
+    ajustarCaixa(bvh.nos[indiceEsquerdo + 1], bvh.triangulos);
+
+    // push_back pode ter realocado o vetor: acessa o nó novamente pelo índice
+    bvh.nos[indiceNo].inicio = indiceEsquerdo;
+    bvh.nos[indiceNo].quantidade = 0;
+
+    subdividirNo(bvh, indiceEsquerdo);
+    subdividirNo(bvh, indiceEsquerdo + 1);
+}
+
+//--------------------------------------------------------------------------------
+void construirBVH(BVH& bvh) {
+    bvh.nos.clear();
+    if (bvh.triangulos.empty())
+        return;
+    bvh.nos.reserve(2 * bvh.triangulos.size());
+    bvh.nos.push_back({glm::vec3(0.0f), 0, glm::vec3(0.0f), static_cast<int>(bvh.triangulos.size())});
+    ajustarCaixa(bvh.nos[0], bvh.triangulos);
+    subdividirNo(bvh, 0);
+}
+
+//--------------------------------------------------------------------------------
+void adicionarMalhaNaBVH(BVH& bvh, const GLfloat* vertices, int numeroVertices, int objeto) {
+    for (int i = 0; i + 2 < numeroVertices; i += 3) {
+        const GLfloat* v = vertices + 3 * i;
+        bvh.triangulos.push_back({
+            glm::vec3(v[0], v[1], v[2]),
+            glm::vec3(v[3], v[4], v[5]),
+            glm::vec3(v[6], v[7], v[8]),
+            objeto,
+            i / 3
+        });
+    }
+}
+
+//--------------------------------------------------------------------------------
+// Teste de slabs: retorna a distância de entrada na caixa, ou infinito se não houver interseção
+inline float intersectarCaixa(const Raio& raio, const NoBVH& no, float distanciaMaxima) {
+    glm::vec3 t0 = (no.minimo - raio.origem) * raio.inversoDirecao;
+    glm::vec3 t1 = (no.maximo - raio.origem) * raio.inversoDirecao;
+    glm::vec3 tMenor = glm::min(t0, t1);
+    glm::vec3 tMaior = glm::max(t0, t1);
+    float entrada = std::max(std::max(tMenor.x, tMenor.y), std::max(tMenor.z, 0.0f));
+    float saida = std::min(std::min(tMaior.x, tMaior.y), std::min(tMaior.z, distanciaMaxima));
+    return entrada <= saida ? entrada : std::numeric_limits<float>::infinity();
+}
+
+//--------------------------------------------------------------------------------
+// Interseção raio-triângulo de Möller–Trumbore
+inline bool intersectarTriangulo(const Raio& raio, const TrianguloCena& t, float& distancia) {
+    const float epsilon = 1e-7f;
+    glm::vec3 aresta1 = t.v1 - t.v0;
+    glm::vec3 aresta2 = t.v2 - t.v0;
+    glm::vec3 p = glm::cross(raio.direcao, aresta2);
+    float determinante = glm::dot(aresta1, p);
+    if (std::fabs(determinante) < epsilon)
+        return false;
+    float inversoDeterminante = 1.0f / determinante;
+    glm::vec3 s = raio.origem - t.v0;
+    float u = glm::dot(s, p) * inversoDeterminante;
+    if (u < 0.0f || u > 1.0f)
+        return false;
+    glm::vec3 q = glm::cross(s, aresta1);
+    float v = glm::dot(raio.direcao, q) * inversoDeterminante;
+    if (v < 0.0f || u + v > 1.0f)
+        return false;
+    float d = glm::dot(aresta2, q) * inversoDeterminante;
+    if (d <= epsilon || d >= distancia)
+        return false;
+    distancia = d;
+    return true;
+}
+
+//--------------------------------------------------------------------------------
+bool intersectarBVH(const BVH& bvh, const Raio& raio, ResultadoSelecao& resultado) {
+    if (bvh.nos.empty())
+        return false;
+
+    float maisProximo = std::numeric_limits<float>::max();
+    int pilha[64];
+    int topo = 0;
+    pilha[topo++] = 0;
+
+    while (topo > 0) {
+        const NoBVH& no = bvh.nos[pilha[--topo]];
+        if (intersectarCaixa(raio, no, maisProximo) == std::numeric_limits<float>::infinity())
+            continue;
+
+        if (no.quantidade > 0) {
+            for (int i = no.inicio; i < no.inicio + no.quantidade; ++i) {
+                if (intersectarTriangulo(raio, bvh.triangulos[i], maisProximo)) {
+                    resultado.acertou = true;
+                    resultado.objeto = bvh.triangulos[i].objeto;
+                    resultado.triangulo = bvh.triangulos[i].indice;
+                    resultado.distancia = maisProximo;
+                }
+            }
+            continue;
+        }
+
+        // Empilha primeiro o filho mais distante para visitar antes o mais próximo
+        int esquerdo = no.inicio, direito = no.inicio + 1;
+        float dEsquerdo = intersectarCaixa(raio, bvh.nos[esquerdo], maisProximo);
+        float dDireito = intersectarCaixa(raio, bvh.nos[direito], maisProximo);
+        if (dEsquerdo > dDireito) {
+            std::swap(esquerdo, direito);
+            std::swap(dEsquerdo, dDireito);
+        }
+        if (dDireito != std::numeric_limits<float>::infinity()) pilha[topo++] = direito;
+        if (dEsquerdo != std::numeric_limits<float>::infinity()) pilha[topo++] = esquerdo;
     }
+    return resultado.acertou;
+}
 
-    // Lê o código do Shader de Fragmento do arquivo
-    std::string codigoShaderFragmento;
-    std::ifstream streamShaderFragmento(caminhoArquivoFragmento, std::ios::in);
-    if (streamShaderFragmento.is_open()) {
-        std::string linha = "";
-        while (getline(streamShaderFragmento, linha))
-            codigoShaderFragmento += "\n" + linha;
-        streamShaderFragmento.close();
+//--------------------------------------------------------------------------------
+// Converte a posição do cursor (coordenadas da janela, origem no canto superior
+// esquerdo) em um raio no espaço do mundo e o testa contra a cena
+ResultadoSelecao selecionarNoCursor(GLFWwindow* janela, double cursorX, double cursorY) {
+    ResultadoSelecao resultado;
+
+    // Em telas de alta densidade o framebuffer é maior que a janela
+    int larguraTela, alturaTela, larguraFramebuffer, alturaFramebuffer;
+    glfwGetWindowSize(janela, &larguraTela, &alturaTela);
+    glfwGetFramebufferSize(janela, &larguraFramebuffer, &alturaFramebuffer);
+    if (larguraTela <= 0 || alturaTela <= 0)
+        return resultado;
+    double px = cursorX * larguraFramebuffer / larguraTela;
+    double py = alturaFramebuffer - cursorY * alturaFramebuffer / alturaTela;
+
+    for (size_t i = 0; i < viewportsSelecao.size(); ++i) {
+        const ViewportSelecao& v = viewportsSelecao[i];
+        if (!v.valido || px < v.x || px >= v.x + v.largura || py < v.y || py >= v.y + v.altura)
+            continue;
+
+        // Coordenadas normalizadas do dispositivo dentro do viewport encontrado
+        float ndcX = static_cast<float>(2.0 * (px - v.x) / v.largura - 1.0);
+        float ndcY = static_cast<float>(2.0 * (py - v.y) / v.altura - 1.0);
+        glm::vec4 perto = v.inversaProjecaoVisualizacao * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+        glm::vec4 longe = v.inversaProjecaoVisualizacao * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+        if (perto.w == 0.0f || longe.w == 0.0f)
+            return resultado;
+
+        Raio raio;
+        raio.origem = glm::vec3(perto) / perto.w;
+        raio.direcao = glm::normalize(glm::vec3(longe) / longe.w - raio.origem);
+        // Componente nula: 1/0 = inf, e 0 * inf = NaN no teste de slabs quando a origem cai no
+        // plano de uma face. Um inverso finito enorme, com o sinal do zero, dá o mesmo corte sem NaN
+        for (int k = 0; k < 3; ++k)
+            raio.inversoDirecao[k] = raio.direcao[k] != 0.0f ? 1.0f / raio.direcao[k] : std::copysign(1e30f, raio.direcao[k]);
+
+        resultado.viewport = static_cast<int>(i);
+        intersectarBVH(bvhCena, raio, resultado);
+        return resultado;
     }
+    return resultado;
+}
+
+//--------------------------------------------------------------------------------
+void callbackTamanhoFramebuffer(GLFWwindow*, int largura, int altura) {
+    larguraJanela = largura;
+    alturaJanela = altura;
+    disposicaoViewports.redimensionar(largura, altura);
+}
+
+void callbackPosicaoCursor(GLFWwindow* janela, double x, double y) {
+    auto inicio = std::chrono::steady_clock::now();
+    ResultadoSelecao selecao = selecionarNoCursor(janela, x, y);
+    auto fim = std::chrono::steady_clock::now();
+    tempoTotalSelecaoUs += std::chrono::duration<double, std::micro>(fim - inicio).count();
+    numeroSelecoes++;
+
+    // Só informa quando o objeto/triângulo sob o cursor muda
+    if (selecao.acertou == ultimaSelecao.acertou && selecao.objeto == ultimaSelecao.objeto &&
+        selecao.triangulo == ultimaSelecao.triangulo && selecao.viewport == ultimaSelecao.viewport)
+        return;
+    ultimaSelecao = selecao;
+
+    if (selecao.acertou)
+        printf("Viewport %d: objeto %d, triângulo %d (face %d), distância %.3f | média %.2f us por seleção\n",
+               selecao.viewport, selecao.objeto, selecao.triangulo, selecao.triangulo / 2 + 1,
+               selecao.distancia, tempoTotalSelecaoUs / numeroSelecoes);
+    else
+        printf("Viewport %d: nenhum objeto\n", selecao.viewport);
+}
 
-    GLint resultado = GL_FALSE;
-    int tamanhoLog;
-
-    // Compila o Shader de Vértice
-    printf("Compilando shader: %s\n", caminhoArquivoVertice);
-    char const* ponteiroCodigoVertice = codigoShaderVertice.c_str();
-    glShaderSource(idShaderVertice, 1, &ponteiroCodigoVertice, NULL);
-    glCompileShader(idShaderVertice);
-
-    // Verifica o Shader de Vértice
-    glGetShaderiv(idShaderVertice, GL_COMPILE_STATUS, &resultado);
-    glGetShaderiv(idShaderVertice, GL_INFO_LOG_LENGTH, &tamanhoLog);
-    std::vector<char> mensagemErroShaderVertice(tamanhoLog);
-    glGetShaderInfoLog(idShaderVertice, tamanhoLog, NULL, &mensagemErroShaderVertice[0]);
-    fprintf(stdout, "%s\n", &mensagemErroShaderVertice[0]);
-
-    // Compila o Shader de Fragmento
-    printf("Compilando shader: %s\n", caminhoArquivoFragmento);
-    char const* ponteiroCodigoFragmento = codigoShaderFragmento.c_str();
-    glShaderSource(idShaderFragmento, 1, &ponteiroCodigoFragmento, NULL);
-    glCompileShader(idShaderFragmento);
-
-    // Verifica o Shader de Fragmento
-    glGetShaderiv(idShaderFragmento, GL_COMPILE_STATUS, &resultado);
-    glGetShaderiv(idShaderFragmento, GL_INFO_LOG_LENGTH, &tamanhoLog);
-    std::vector<char> mensagemErroShaderFragmento(tamanhoLog);
-    glGetShaderInfoLog(idShaderFragmento, tamanhoLog, NULL, &mensagemErroShaderFragmento[0]);
-    fprintf(stdout, "%s\n", &mensagemErroShaderFragmento[0]);
-
-    // Linka o programa
-    fprintf(stdout, "Linkando programa\n");
-    GLuint idPrograma = glCreateProgram();
-    glAttachShader(idPrograma, idShaderVertice);
-    glAttachShader(idPrograma, idShaderFragmento);
-    glLinkProgram(idPrograma);
-
-    // Verifica o programa
-    glGetProgramiv(idPrograma, GL_LINK_STATUS, &resultado);
-    glGetProgramiv(idPrograma, GL_INFO_LOG_LENGTH, &tamanhoLog);
-    std::vector<char> mensagemErroPrograma(std::max(tamanhoLog, int(1)));
-    glGetProgramInfoLog(idPrograma, tamanhoLog, NULL, &mensagemErroPrograma[0]);
-    fprintf(stdout, "%s\n", &mensagemErroPrograma[0]);
-
-    glDeleteShader(idShaderVertice);
-    glDeleteShader(idShaderFragmento);
+//--------------------------------------------------------------------------------
+GLuint carregarShaders(const char* caminhoArquivoVertice, const char* caminhoArquivoFragmento) {
+    // Lê o código dos shaders dos arquivos
+    std::string codigoShaderVertice = GerenciadorShaders::lerArquivo(caminhoArquivoVertice);
+    std::string codigoShaderFragmento = GerenciadorShaders::lerArquivo(caminhoArquivoFragmento);
+
+    // Compila e linka o programa, ou o recarrega do cache de binários se já tiver sido compilado antes
+    printf("Carregando shaders: %s, %s\n", caminhoArquivoVertice, caminhoArquivoFragmento);
+    GLuint idPrograma = gerenciadorShaders.programa(gerenciadorShaders.solicitar(codigoShaderVertice, codigoShaderFragmento));
+    gerenciadorShaders.imprimirEstatisticas();
 
     return idPrograma;
 }
@@ -149,23 +434,6 @@ void transferirDadosParaMemoriaGPU(void) {
     // Cria e compila nosso programa GLSL a partir dos shaders
     idPrograma = carregarShaders(getCaminhoShader("TransformVertexShader.vertexshader").c_str(), getCaminhoShader("ColorFragmentShader.fragmentshader").c_str());
     
-    // Nossos vértices. Três floats consecutivos formam um vértice 3D; Três vértices consecutivos formam um triângulo.
-    // Um cubo tem 6 faces com 2 triângulos cada, o que resulta em 6*2=12 triângulos, e 12*3 vértices
-    static const GLfloat dadosBufferVertices[] = {
-        -1.0f,-1.0f,-1.0f,  -1.0f,-1.0f, 1.0f,  -1.0f, 1.0f, 1.0f, // Face 1
-        -1.0f,-1.0f,-1.0f,  -1.0f, 1.0f,-1.0f,  -1.0f, 1.0f, 1.0f,
-        1.0f,-1.0f, 1.0f,   -1.0f,-1.0f, 1.0f,  1.0f,-1.0f,-1.0f, // Face 2
-        1.0f,-1.0f,-1.0f,   -1.0f,-1.0f,-1.0f,  -1.0f,-1.0f, 1.0f,
-        -1.0f, 1.0f, 1.0f,  1.0f, 1.0f,-1.0f,   1.0f, 1.0f, 1.0f, // Face 3
-        -1.0f, 1.0f, 1.0f,  -1.0f, 1.0f,-1.0f,  1.0f, 1.0f,-1.0f,
-        -1.0f,-1.0f,-1.0f,  1.0f,-1.0f,-1.0f,   1.0f, 1.0f,-1.0f, // Face 4
-        -1.0f,-1.0f,-1.0f,  -1.0f, 1.0f,-1.0f,  1.0f, 1.0f,-1.0f,
-        -1.0f,-1.0f, 1.0f,  1.0f,-1.0f, 1.0f,   1.0f, 1.0f, 1.0f, // Face 5
-        -1.0f,-1.0f, 1.0f,  -1.0f, 1.0f, 1.0f,  1.0f, 1.0f, 1.0f,
-        1.0f,-1.0f,-1.0f,   1.0f, 1.0f,-1.0f,   1.0f, 1.0f, 1.0f, // Face 6
-        1.0f,-1.0f,-1.0f,   1.0f,-1.0f, 1.0f,   1.0f, 1.0f, 1.0f
-    };
-
     // Cores para cada face, repetidas para cada vértice
     static const GLfloat dadosBufferCores[] = {
         1.0f, 0.0f, 0.0f,  1.0f, 0.0f, 0.0f,  1.0f, 0.0f, 0.0f, // Face 1 Vermelho
@@ -187,10 +455,15 @@ void transferirDadosParaMemoriaGPU(void) {
     glBindBuffer(GL_ARRAY_BUFFER, idBufferVertices);
     glBufferData(GL_ARRAY_BUFFER, sizeof(dadosBufferVertices), dadosBufferVertices, GL_STATIC_DRAW);
     
+    // Compacta as cores para 8 bits por canal (4 bytes por vértice em vez de 12); as faces têm cores puras
+    std::vector<vertice::CorRGBA8> coresCompactas;
+    for (size_t i = 0; i < sizeof(dadosBufferCores) / sizeof(GLfloat); i += 3)
+        coresCompactas.push_back(vertice::empacotarCor(dadosBufferCores[i], dadosBufferCores[i + 1], dadosBufferCores[i + 2]));
+
     // Move os dados das cores para a memória de vídeo; especificamente para o CBO chamado idBufferCores
     glGenBuffers(1, &idBufferCores);
     glBindBuffer(GL_ARRAY_BUFFER, idBufferCores);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(dadosBufferCores), dadosBufferCores, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, coresCompactas.size() * sizeof(vertice::CorRGBA8), coresCompactas.data(), GL_STATIC_DRAW);
 }
 
 
@@ -226,68 +499,69 @@ void desenhar() {
     // Limpa a tela
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    // Obtém o tamanho do framebuffer para lidar com DPIs diferentes
-    glfwGetFramebufferSize(janela, &larguraJanela, &alturaJanela);
-
-    // Define os viewports e as configurações de câmera
-    std::vector<std::tuple<int, int, int, int>> viewports = {
-        std::make_tuple(0, 0, larguraJanela / 2, alturaJanela / 2), // Inferior Esquerdo - Frente
-        std::make_tuple(larguraJanela / 2, 0, larguraJanela / 2, alturaJanela / 2), // Inferior Direito - Trás
-        std::make_tuple(0, alturaJanela / 2, larguraJanela / 2, alturaJanela / 2), // Superior Esquerdo - Esquerda
-        std::make_tuple(larguraJanela / 2, alturaJanela / 2, larguraJanela / 2, alturaJanela / 2) // Superior Direito - Direita
-    };
+    // Os retângulos vêm da disposição (em ordem de leitura, a partir do canto superior esquerdo);
+    // as configurações de câmera ficam em vetores alocados na arena do quadro
+    const std::vector<disposicao::Retangulo>& viewports = disposicaoViewports.retangulos();
 
-    std::vector<glm::vec3> posicoes_da_camera = {
-        glm::vec3(0, 0, 0), // Inferior Esquerdo - Frente
-        glm::vec3(0, 0, 0), // Inferior Direito - Trás
+    arena::Vetor<glm::vec3> posicoes_da_camera({
         glm::vec3(0, 0, 0), // Superior Esquerdo - Esquerda
-        glm::vec3(0, 0, 0) // Superior Direito - Direita
-    };
+        glm::vec3(0, 0, 0), // Superior Direito - Direita
+        glm::vec3(0, 0, 0), // Inferior Esquerdo - Frente
+        glm::vec3(0, 0, 0) // Inferior Direito - Trás
+    }, arena::Alocador<glm::vec3>(arenaQuadro.principal()));
 
-    std::vector<glm::vec3> posicoes_alvo = {
+    arena::Vetor<glm::vec3> posicoes_alvo({
         glm::vec3(0, 0, 0), // Olhando para a origem
         glm::vec3(0, 0, 0), // Olhando para a origem
         glm::vec3(0, 0, 0), // Olhando para a origem
         glm::vec3(0, 0, 0) // Olhando para a origem
-    };
+    }, arena::Alocador<glm::vec3>(arenaQuadro.principal()));
+
+    viewportsSelecao.resize(viewports.size());
 
-    // Desenha em cada viewport
-    for (size_t i = 0; i < viewports.size(); ++i) {
-        int x, y, width, height;
-        std::tie(x, y, width, height) = viewports[i];
-        glViewport(x, y, width, height);
-        float aspect_ratio = static_cast<float>(width) / static_cast<float>(height);
+    // Grava os comandos de cada viewport em uma thread de trabalho; só a thread principal chama o OpenGL
+    gravador.gravar(viewports.size(), [&](size_t i, comandos::BufferComandos& buffer) {
+        int x = viewports[i].x, y = viewports[i].y, width = viewports[i].largura, height = viewports[i].altura;
+        buffer.viewport(x, y, width, height);
+        float aspect_ratio = viewports[i].proporcao();
         glm::mat4 Projecao = glm::perspective(glm::radians(45.0f), aspect_ratio, 0.1f, 100.0f);
         glm::mat4 Visualizacao = glm::lookAt(
-            posicoes_da_camera[i],
-            posicoes_alvo[i],
+            posicoes_da_camera[i % posicoes_da_camera.size()],
+            posicoes_alvo[i % posicoes_alvo.size()],
             glm::vec3(0, 1, 0)
         );
-        MVP = Projecao * Visualizacao * glm::mat4(1.0f);
+        glm::mat4 mvpViewport = Projecao * Visualizacao * glm::mat4(1.0f); // Local: cada thread tem a sua
+
+        // Guarda a câmera deste viewport para a seleção com o mouse (cada tarefa escreve só a sua posição)
+        glm::mat4 inversa = glm::inverse(Projecao * Visualizacao);
+        bool finita = true;
+        for (int c = 0; c < 4; ++c)
+            for (int l = 0; l < 4; ++l)
+                finita = finita && std::isfinite(inversa[c][l]);
+        viewportsSelecao[i] = {x, y, width, height, inversa, finita};
 
         // Usa nosso shader
-        glUseProgram(idPrograma);
-        glUniformMatrix4fv(idMatrizMVP, 1, GL_FALSE, &MVP[0][0]);
+        buffer.usarPrograma(idPrograma);
+        buffer.uniformeMatriz4(idMatrizMVP, &mvpViewport[0][0]);
 
         // Primeiro buffer de atributo: vértices
-        glEnableVertexAttribArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, idBufferVertices);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+        buffer.atributo(0, idBufferVertices, 3, GL_FLOAT);
 
         // Segundo buffer de atributo: cores
-        glEnableVertexAttribArray(1);
-        glBindBuffer(GL_ARRAY_BUFFER, idBufferCores);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+        buffer.atributo(1, idBufferCores, 4, GL_UNSIGNED_BYTE, GL_TRUE); // RGBA8 normalizado; o shader usa só rgb
 
         // Desenha o cubo
-        glDrawArrays(GL_TRIANGLES, 0, 12 * 3); // 12*3 é o número total de vértices a serem desenhados
+        buffer.desenharArrays(GL_TRIANGLES, 0, 12 * 3); // 12*3 é o número total de vértices a serem desenhados
 
-        glDisableVertexAttribArray(0);
-        glDisableVertexAttribArray(1);
+        buffer.desabilitarAtributo(0);
+        buffer.desabilitarAtributo(1);
 
         // Desenha os eixos
-        desenharEixos();
-    }
+        gravarEixos(buffer);
+    });
+
+    // Emite os comandos gravados, na ordem dos viewports
+    gravador.executar();
 
     // Restaura o viewport original para abranger toda a janela
     glViewport(0, 0, larguraJanela, alturaJanela);
@@ -319,24 +593,21 @@ void inicializarDadosEixos() {
 }
 //--------------------------------------------------------------------------------
 
-void desenharEixos() {
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, idBufferVerticesEixos);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-
-    glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ARRAY_BUFFER, idBufferCoresEixos);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+void gravarEixos(comandos::BufferComandos& buffer) {
+    buffer.atributo(0, idBufferVerticesEixos, 3, GL_FLOAT);
+    buffer.atributo(1, idBufferCoresEixos, 3, GL_FLOAT);
 
-    glDrawArrays(GL_LINES, 0, 6);
+    buffer.desenharArrays(GL_LINES, 0, 6);
 
-    glDisableVertexAttribArray(0);
-    glDisableVertexAttribArray(1);
+    buffer.desabilitarAtributo(0);
+    buffer.desabilitarAtributo(1);
 }
 //--------------------------------------------------------------------------------
 
 
-int main(void) {
+int main(int argc, char** argv) {
+    capturaQuadro.configurar(argc, argv);
+
     // Inicializa GLFW
     glfwInit();
 
@@ -346,6 +617,9 @@ int main(void) {
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // Para alegria do MacOS; não deveria ser necessário
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
+    // Na captura: janela invisível e sem multiamostragem
+    capturaQuadro.prepararJanela();
+
     // Abre uma janela
     janela = glfwCreateWindow(larguraJanela, alturaJanela, "Um cubo com 12 triângulos", NULL, NULL);
 
@@ -376,24 +650,70 @@ int main(void) {
     // Configura a matriz de projeção-visualização-modelo
     configurarMVP();
 
-    // Renderiza cena para cada frame
-    do {
+    // Observa os arquivos de shader; as versões editadas são compiladas em outra thread, que acorda o laço
+    recarregadorShaders.aoRecompilar([] { sobDemanda.marcarSujo(); });
+    recarregadorShaders.iniciar(janela, getCaminhoShader("TransformVertexShader.vertexshader"), getCaminhoShader("ColorFragmentShader.fragmentshader"));
+
+    // Monta a BVH da cena e habilita a seleção com o mouse
+    adicionarMalhaNaBVH(bvhCena, dadosBufferVertices, 12 * 3, OBJETO_CUBO);
+    construirBVH(bvhCena);
+    glfwSetCursorPosCallback(janela, callbackPosicaoCursor);
+
+    // Calcula os viewports para o tamanho atual do framebuffer (que difere da janela em telas de alta densidade)
+    // e depois só quando ele mudar
+    disposicaoViewports.configurar(disposicao::GRADE, NUMERO_VIEWPORTS);
+    glfwGetFramebufferSize(janela, &larguraJanela, &alturaJanela);
+    disposicaoViewports.redimensionar(larguraJanela, alturaJanela);
+    glfwSetFramebufferSizeCallback(janela, callbackTamanhoFramebuffer);
+
+    // Depois dos callbacks do programa, que continuam sendo chamados por ele
+    sobDemanda.conectar(janela);
+
+    // Renderiza um quadro sempre que algo pedir; proximoQuadro() dorme enquanto nada muda e processa os eventos
+#ifdef ARENA_QUADRO_CONTAR_NEW
+    double ultimoRelatorio = glfwGetTime();
+#endif
+    while (sobDemanda.proximoQuadro() && glfwGetKey(janela, GLFW_KEY_ESCAPE) != GLFW_PRESS) {
+        // Novo quadro: a arena do quadro anterior fica intacta e a outra é reiniciada
+        arenaQuadro.iniciarQuadro();
+#ifdef ARENA_QUADRO_CONTAR_NEW
+        size_t chamadasNewAntes = arena::chamadasNew;
+#endif
+
+        // Troca para os shaders recompilados, se houver, sempre entre dois quadros
+        if (recarregadorShaders.trocar(idPrograma))
+            idMatrizMVP = glGetUniformLocation(idPrograma, "MVP");
         // Desenha o cubo
         desenhar();
+
+#ifdef ARENA_QUADRO_CONTAR_NEW
+        // No máximo uma vez por segundo (só há quadros quando algo muda), mostra o uso da arena e se o quadro chamou operator new (deve ser 0 após os primeiros)
+        if (glfwGetTime() - ultimoRelatorio >= 1.0) {
+            arena::Contadores c = arenaQuadro.contadoresQuadro();
+            printf("Quadro %llu: %zu alocações na arena (%zu bytes), %zu blocos do heap, %zu chamadas a new\n",
+                   static_cast<unsigned long long>(arenaQuadro.quadro()), c.alocacoes, c.bytes, c.blocosHeap,
+                   arena::chamadasNew - chamadasNewAntes);
+            ultimoRelatorio = glfwGetTime();
+        }
+#endif
+        // Na captura, salva o quadro pedido e termina; até lá, desenha sem esperar por eventos
+        if (capturaQuadro.concluirQuadro(janela))
+            break;
+        if (capturaQuadro.ativa())
+            sobDemanda.solicitarQuadro();
         // Troca os buffers
         glfwSwapBuffers(janela);
-        // Procura por eventos
-        glfwPollEvents();
-
-    } // Verifica se a tecla ESC foi pressionada ou a janela foi fechada
-    while (glfwGetKey(janela, GLFW_KEY_ESCAPE) != GLFW_PRESS &&
-           glfwWindowShouldClose(janela) == 0);
+    } // Termina quando a tecla ESC for pressionada ou a janela for fechada
+    sobDemanda.imprimirEstatisticas();
+    sobDemanda.desconectar();
 
+    // Encerra a thread de recarga antes de apagar os objetos que ela compartilha
+    recarregadorShaders.parar();
     // Limpa VAO, VBOs e shaders da GPU
     limparDadosDaGPU();
 
     // Fecha a janela OpenGL e termina GLFW
     glfwTerminate();
 
-    return 0;
+    return capturaQuadro.codigoSaida();
 }
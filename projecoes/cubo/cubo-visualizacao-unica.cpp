@@ -12,6 +12,17 @@
 #include <GLFW/glfw3.h>
 GLFWwindow* janela;
 
+// Cache de programas GLSL compartilhado pelos exemplos
+#include "../../comum/gerenciador_shaders.hpp"
+GerenciadorShaders gerenciadorShaders;
+
+// Tipos compactos de vértice (cores RGBA8)
+#include "../../comum/formato_vertice.hpp"
+
+// Recompila os shaders em segundo plano quando os arquivos são editados
+#include "../../comum/recarga_shaders.hpp"
+RecarregadorShaders recarregadorShaders;
+
 // Cabeçalho GLM
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -54,75 +65,14 @@ void transferirDadosParaMemoriaGPU(void);
 
 //--------------------------------------------------------------------------------
 GLuint carregarShaders(const char* caminhoArquivoVertice, const char* caminhoArquivoFragmento) {
-    // Cria os shaders
-    GLuint idShaderVertice = glCreateShader(GL_VERTEX_SHADER);
-    GLuint idShaderFragmento = glCreateShader(GL_FRAGMENT_SHADER);
-
-    // Lê o código do Shader de Vértice do arquivo
-    std::string codigoShaderVertice;
-    std::ifstream streamShaderVertice(caminhoArquivoVertice, std::ios::in);
-    if (streamShaderVertice.is_open()) {
-        std::string linha = "";
-        while (getline(streamShaderVertice, linha))
-            codigoShaderVertice += "\n" + linha;
-        streamShaderVertice.close();
-    }
-
-    // Lê o código do Shader de Fragmento do arquivo
-    std::string codigoShaderFragmento;
-    std::ifstream streamShaderFragmento(caminhoArquivoFragmento, std::ios::in);
-    if (streamShaderFragmento.is_open()) {
-        std::string linha = "";
-        while (getline(streamShaderFragmento, linha))
-            codigoShaderFragmento += "\n" + linha;
-        streamShaderFragmento.close();
-    }
-
-    GLint resultado = GL_FALSE;
-    int tamanhoLog;
-
-    // Compila o Shader de Vértice
-    printf("Compilando shader: %s\n", caminhoArquivoVertice);
-    char const* ponteiroCodigoVertice = codigoShaderVertice.c_str();
-    glShaderSource(idShaderVertice, 1, &ponteiroCodigoVertice, NULL);
-    glCompileShader(idShaderVertice);
-
-    // Verifica o Shader de Vértice
-    glGetShaderiv(idShaderVertice, GL_COMPILE_STATUS, &resultado);
-    glGetShaderiv(idShaderVertice, GL_INFO_LOG_LENGTH, &tamanhoLog);
-    std::vector<char> mensagemErroShaderVertice(tamanhoLog);
-    glGetShaderInfoLog(idShaderVertice, tamanhoLog, NULL, &mensagemErroShaderVertice[0]);
-    fprintf(stdout, "%s\n", &mensagemErroShaderVertice[0]);
-
-    // Compila o Shader de Fragmento
-    printf("Compilando shader: %s\n", caminhoArquivoFragmento);
-    char const* ponteiroCodigoFragmento = codigoShaderFragmento.c_str();
-    glShaderSource(idShaderFragmento, 1, &ponteiroCodigoFragmento, NULL);
-    glCompileShader(idShaderFragmento);
-
-    // Verifica o Shader de Fragmento
-    glGetShaderiv(idShaderFragmento, GL_COMPILE_STATUS, &resultado);
-    glGetShaderiv(idShaderFragmento, GL_INFO_LOG_LENGTH, &tamanhoLog);
-    std::vector<char> mensagemErroShaderFragmento(tamanhoLog);
-    glGetShaderInfoLog(idShaderFragmento, tamanhoLog, NULL, &mensagemErroShaderFragmento[0]);
-    fprintf(stdout, "%s\n", &mensagemErroShaderFragmento[0]);
-
-    // Linka o programa
-    fprintf(stdout, "Linkando programa\n");
-    GLuint idPrograma = glCreateProgram();
-    glAttachShader(idPrograma, idShaderVertice);
-    glAttachShader(idPrograma, idShaderFragmento);
-    glLinkProgram(idPrograma);
-
-    // Verifica o programa
-    glGetProgramiv(idPrograma, GL_LINK_STATUS, &resultado);
-    glGetProgramiv(idPrograma, GL_INFO_LOG_LENGTH, &tamanhoLog);
-    std::vector<char> mensagemErroPrograma(std::max(tamanhoLog, int(1)));
-    glGetProgramInfoLog(idPrograma, tamanhoLog, NULL, &mensagemErroPrograma[0]);
-    fprintf(stdout, "%s\n", &mensagemErroPrograma[0]);
-
-    glDeleteShader(idShaderVertice);
-    glDeleteShader(idShaderFragmento);
+    // Lê o código dos shaders dos arquivos
+    std::string codigoShaderVertice = GerenciadorShaders::lerArquivo(caminhoArquivoVertice);
+    std::string codigoShaderFragmento = GerenciadorShaders::lerArquivo(caminhoArquivoFragmento);
+
+    // Compila e linka o programa, ou o recarrega do cache de binários se já tiver sido compilado antes
+    printf("Carregando shaders: %s, %s\n", caminhoArquivoVertice, caminhoArquivoFragmento);
+    GLuint idPrograma = gerenciadorShaders.programa(gerenciadorShaders.solicitar(codigoShaderVertice, codigoShaderFragmento));
+    gerenciadorShaders.imprimirEstatisticas();
 
     return idPrograma;
 }
@@ -187,10 +137,15 @@ void transferirDadosParaMemoriaGPU(void) {
     glBindBuffer(GL_ARRAY_BUFFER, idBufferVertices);
     glBufferData(GL_ARRAY_BUFFER, sizeof(dadosBufferVertices), dadosBufferVertices, GL_STATIC_DRAW);
     
+    // Compacta as cores para 8 bits por canal (4 bytes por vértice em vez de 12); as faces têm cores puras
+    std::vector<vertice::CorRGBA8> coresCompactas;
+    for (size_t i = 0; i < sizeof(dadosBufferCores) / sizeof(GLfloat); i += 3)
+        coresCompactas.push_back(vertice::empacotarCor(dadosBufferCores[i], dadosBufferCores[i + 1], dadosBufferCores[i + 2]));
+
     // Move os dados das cores para a memória de vídeo; especificamente para o CBO chamado idBufferCores
     glGenBuffers(1, &idBufferCores);
     glBindBuffer(GL_ARRAY_BUFFER, idBufferCores);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(dadosBufferCores), dadosBufferCores, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, coresCompactas.size() * sizeof(vertice::CorRGBA8), coresCompactas.data(), GL_STATIC_DRAW);
 }
 
 
@@ -250,9 +205,9 @@ void desenhar(void) {
     glBindBuffer(GL_ARRAY_BUFFER, idBufferCores);
     glVertexAttribPointer(
         1,                                // atributo. Não há razão particular para 1, mas deve corresponder ao layout no shader.
-        3,                                // tamanho
-        GL_FLOAT,                         // tipo
-        GL_FALSE,                         // normalizado?
+        4,                                // tamanho (RGBA8; o shader usa só rgb)
+        GL_UNSIGNED_BYTE,                 // tipo
+        GL_TRUE,                          // normalizado? sim: [0, 255] -> [0, 1]
         0,                                // passo
         (void*)0                          // deslocamento do buffer de array
     );
@@ -349,8 +304,14 @@ int main(void) {
     // Configura a matriz de projeção-visualização-modelo
     configurarMVP();
 
+    // Observa os arquivos de shader; as versões editadas são compiladas em outra thread
+    recarregadorShaders.iniciar(janela, getCaminhoShader("TransformVertexShader.vertexshader"), getCaminhoShader("ColorFragmentShader.fragmentshader"));
+
     // Renderiza cena para cada frame
     do {
+        // Troca para os shaders recompilados, se houver, sempre entre dois quadros
+        if (recarregadorShaders.trocar(idPrograma))
+            idMatrizMVP = glGetUniformLocation(idPrograma, "MVP");
         // Desenha o cubo
         desenhar();
         // Troca os buffers
@@ -362,6 +323,8 @@ int main(void) {
     while (glfwGetKey(janela, GLFW_KEY_ESCAPE) != GLFW_PRESS &&
            glfwWindowShouldClose(janela) == 0);
 
+    // Encerra a thread de recarga antes de apagar os objetos que ela compartilha
+    recarregadorShaders.parar();
     // Limpa VAO, VBOs e shaders da GPU
     limparDadosDaGPU();
 
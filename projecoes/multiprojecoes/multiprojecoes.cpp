@@ -1,87 +1,269 @@
-// include glfw
-#include <GLFW/glfw3.h>
-
+// include glew e glfw
+#include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #ifdef __APPLE__
 #  include <OpenGL/gl.h>
 #  include <OpenGL/glu.h>
-#  include <GLUT/glut.h>
 #else
 #  include <GL/gl.h>
 #  include <GL/glu.h>
-#  include <GL/freeglut.h>
 #endif
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <vector>
+
+#include "../../comum/disposicao_viewports.hpp"
+#include "../../comum/gerenciador_shaders.hpp"
+#include "../../comum/lod.hpp"
+#include "../../comum/quantizacao.hpp"
+#include "../../comum/renderizacao_sob_demanda.hpp"
+#include "../../comum/captura_quadro.hpp"
+
 #define WIDTH 800
 #define HEIGHT 600
 
+// Níveis de detalhe do bule (teapot.obj); cada vista desenha só o que consegue resolver
+lod::Cadeia teapotLod;
+std::vector<size_t> lastLevel;
+
+// Com GLSL 3.30, cada nível vai para a GPU quantizado (16 bytes por vértice, índices de
+// 16 bits) e o vertex shader decodifica posição e normal; sem ele, o pipeline fixo desenha
+// as malhas em floats. Os dois iluminam como o GL_LIGHT0 padrão.
+struct QuantizedLevel {
+    quantizacao::MalhaQuantizada mesh;
+    GLuint vertexBuffer = 0, indexBuffer = 0;
+};
+std::vector<QuantizedLevel> quantizedLevels;
+GerenciadorShaders shaders;
+GLuint quantizedProgram = 0;
+GLint decodeLocation = -1;
+
+const char* quantizedVertexShader = R"(#version 330 compatibility
+uniform mat4 decodificacao; // [0, 1]^3 -> espaço do modelo (MalhaQuantizada::matrizDecodificacao)
+out vec3 corVertice;
+void main() {
+    gl_Position = gl_ModelViewProjectionMatrix * (decodificacao * vec4(posicao.xyz, 1.0));
+    vec3 n = normalize(gl_NormalMatrix * decodificarNormal(normal));
+    // GL_LIGHT0 padrão: direcional em +z do olho, difusa 1 x material 0.8 e ambiente global 0.2 x 0.2
+    corVertice = cor.rgb * (0.04 + 0.8 * max(n.z, 0.0));
+}
+)";
+
+const char* quantizedFragmentShader = R"(#version 330 compatibility
+in vec3 corVertice;
+void main() {
+    gl_FragColor = vec4(corVertice, 1.0);
+}
+)";
+
+// Retângulos das vistas, recalculados só no callback de tamanho do framebuffer
+disposicao::Disposicao layout;
+
+// As vistas são estáticas: desenha só quando a janela muda de tamanho, é exposta ou recebe entrada
+RenderizacaoSobDemanda onDemand;
+
+// --capturar N arquivo.ppm: desenha o quadro N fora da tela, salva e termina (comparado com goldens/)
+captura::Captura capture;
+
+// Carrega o bule, centraliza e escala para o tamanho do antigo glutSolidTeapot(0.5) e gera os níveis
+bool loadTeapot(const char* path) {
+    malha::Malha teapot;
+    try {
+        teapot = malha::carregarObj(path);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return false;
+    }
+    float lo[3], hi[3];
+    for (int c = 0; c < 3; ++c) {
+        lo[c] = hi[c] = teapot.posicoes[c];
+        for (size_t v = 0; v < teapot.numeroVertices(); ++v) {
+            lo[c] = std::min(lo[c], teapot.posicoes[3 * v + c]);
+            hi[c] = std::max(hi[c], teapot.posicoes[3 * v + c]);
+        }
+    }
+    float scale = 1.6f / std::max({hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2]});
+    for (size_t v = 0; v < teapot.numeroVertices(); ++v)
+        for (int c = 0; c < 3; ++c)
+            teapot.posicoes[3 * v + c] = (teapot.posicoes[3 * v + c] - 0.5f * (lo[c] + hi[c])) * scale;
+
+    teapotLod = lod::gerarCadeia(teapot);
+    for (size_t i = 0; i < teapotLod.niveis.size(); ++i)
+        printf("LOD %zu: %zu triângulos, erro %g\n", i, teapotLod.niveis[i].numeroTriangulos(), teapotLod.erros[i]);
+    return true;
+}
+
+// Compila o programa que lê os vértices quantizados e envia os níveis para a GPU;
+// sem GLSL 3.30 fica o pipeline fixo
+void prepareQuantizedTeapot() {
+    if (!GLEW_VERSION_3_3)
+        return;
+    std::string vertexCode = vertice::inserirDeclaracoes<quantizacao::VerticeQuantizado>(quantizedVertexShader);
+    vertexCode.insert(vertexCode.find("uniform"), quantizacao::DECODIFICAR_NORMAL_GLSL);
+    quantizedProgram = shaders.programa(shaders.solicitar(vertexCode, quantizedFragmentShader));
+    if (!quantizedProgram)
+        return;
+    decodeLocation = glGetUniformLocation(quantizedProgram, "decodificacao");
+
+    size_t floatBytes = 0, quantizedBytes = 0;
+    for (const malha::Malha& level : teapotLod.niveis) {
+        QuantizedLevel q;
+        q.mesh = quantizacao::quantizar(level);
+        glGenBuffers(1, &q.vertexBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, q.vertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, q.mesh.vertices.size() * sizeof(quantizacao::VerticeQuantizado), q.mesh.vertices.data(), GL_STATIC_DRAW);
+        glGenBuffers(1, &q.indexBuffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, q.indexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, q.mesh.indices.size() * sizeof(uint16_t), q.mesh.indices.data(), GL_STATIC_DRAW);
+        floatBytes += (level.posicoes.size() + level.normais.size()) * sizeof(float) + level.indices.size() * sizeof(uint32_t);
+        quantizedBytes += q.mesh.bytes();
+        quantizedLevels.push_back(std::move(q));
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    printf("Bule quantizado na GPU: %zu KB (%zu KB em floats)\n", quantizedBytes / 1024, floatBytes / 1024);
+}
+
+void releaseQuantizedTeapot() {
+    for (QuantizedLevel& q : quantizedLevels) {
+        glDeleteBuffers(1, &q.vertexBuffer);
+        glDeleteBuffers(1, &q.indexBuffer);
+    }
+    quantizedLevels.clear();
+    if (quantizedProgram)
+        glDeleteProgram(quantizedProgram);
+    quantizedProgram = 0;
+}
+
+void drawQuantized(size_t level) {
+    const QuantizedLevel& q = quantizedLevels[level];
+    float decode[16];
+    q.mesh.matrizDecodificacao(decode);
+    glUseProgram(quantizedProgram);
+    glUniformMatrix4fv(decodeLocation, 1, GL_FALSE, decode);
+    glBindBuffer(GL_ARRAY_BUFFER, q.vertexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, q.indexBuffer);
+    vertice::configurarAtributos<quantizacao::VerticeQuantizado>();
+    for (const quantizacao::Bloco& block : q.mesh.blocos)
+        glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(block.numeroIndices), GL_UNSIGNED_SHORT,
+                                 reinterpret_cast<const void*>(block.primeiroIndice * sizeof(uint16_t)), static_cast<GLint>(block.verticeBase));
+    vertice::desabilitarAtributos<quantizacao::VerticeQuantizado>();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glUseProgram(0);
+}
+
+void drawFixed(size_t level) {
+    const malha::Malha& mesh = teapotLod.niveis[level];
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, mesh.posicoes.data());
+    glNormalPointer(GL_FLOAT, 0, mesh.normais.data());
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(mesh.indices.size()), GL_UNSIGNED_INT, mesh.indices.data());
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
 void initGLFW() {
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    // Contexto padrão (compatibilidade): as matrizes continuam no pipeline fixo, que não existe no perfil core
 }
 
 GLFWwindow*  createWindow() {
+    capture.prepararJanela();
     GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "Teapot Example", NULL, NULL);
     glfwMakeContextCurrent(window);
+    glewInit();
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_LIGHTING); // Só vale para o pipeline fixo; o shader quantizado ilumina igual
+    glEnable(GL_LIGHT0);
+
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+    layout.redimensionar(width, height);
+    glfwSetFramebufferSizeCallback(window, [](GLFWwindow*, int w, int h) { layout.redimensionar(w, h); });
+    onDemand.conectar(window); // Depois do callback acima, que continua sendo chamado
 
     return window;
 }
 
-void renderTeapot(GLfloat angle, GLfloat x, GLfloat y, GLfloat z, GLfloat fov) {
+// fov > 0: projeção perspectiva com esse campo de visão; fov = 0: ortográfica de 4 unidades de altura
+void renderTeapot(int view, GLfloat angle, GLfloat x, GLfloat y, GLfloat z, GLfloat fov) {
+    const disposicao::Retangulo& r = layout[view];
+    glViewport(r.x, r.y, r.largura, r.altura);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    // A proporção vem do retângulo da vista, para a imagem não ficar esticada
+    if (fov > 0)
+        gluPerspective(fov, r.proporcao(), 1, 100);
+    else
+        gluOrtho2D(-2 * r.proporcao(), 2 * r.proporcao(), -2, 2);
+
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
     gluLookAt(x, y, z, 0, 0, 0, 0, 1, 0);
     glRotatef(angle, 0, 1, 0);
-    glutSolidTeapot(0.5);
-}
-
-void render(GLFWwindow* window) {
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    // Primeiro quadrante: Projeção perspectiva
-    glViewport(0, HEIGHT/2, WIDTH/2, HEIGHT/2);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    gluPerspective(45, (GLfloat)WIDTH/(GLfloat)HEIGHT, 1, 100);
-    // glClearColor(1.0f, 0.0f, 0.0f, 1.0f);
-    renderTeapot(0, 0, 0, 5, 45);
 
-    // Segundo quadrante: Vista de topo
-    glViewport(WIDTH/2, HEIGHT/2, WIDTH/2, HEIGHT/2);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    gluOrtho2D(-2, 2, -2, 2);
-    // glClearColor(0.0f, 1.0f, 0.0f, 1.0f);
-    renderTeapot(90, 0, 5, 0, 0);
+    // Erro projetado de cada nível nesta vista: escolhe o mais simples com até 1 pixel
+    double pixelsPerUnit = fov > 0 ? lod::pixelsPorUnidadePerspectiva(std::sqrt(x * x + y * y + z * z), fov * M_PI / 180.0, r.altura)
+                                   : lod::pixelsPorUnidadeOrtografica(4.0, r.altura);
+    size_t level = lod::selecionar(teapotLod, pixelsPerUnit);
+    if (level != lastLevel[view]) {
+        printf("Vista %d: LOD %zu (%zu triângulos)\n", view + 1, level, teapotLod.niveis[level].numeroTriangulos());
+        lastLevel[view] = level;
+    }
 
-    // Terceiro quadrante: Vista de frente
-    glViewport(0, 0, WIDTH/2, HEIGHT/2);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    gluOrtho2D(-2, 2, -2, 2);
-    renderTeapot(0, 0, 0, 0, 0);
+    if (quantizedProgram)
+        drawQuantized(level);
+    else
+        drawFixed(level);
+}
 
-    // Quarto quadrante: Vista do lado esquerdo
-    glViewport(WIDTH/2, 0, WIDTH/2, HEIGHT/2);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    gluOrtho2D(-2, 2, -2, 2);
-    renderTeapot(-90, 0, 0, 5, 0);
+void render() {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glfwSwapBuffers(window);
+    // As quatro câmeras de sempre, repetidas se houver mais vistas (em ordem de leitura na grade)
+    for (size_t view = 0; view < layout.numeroVistas(); ++view) {
+        switch (view % 4) {
+        case 0: renderTeapot(view, 0, 0, 0, 5, 45); break;   // Projeção perspectiva
+        case 1: renderTeapot(view, 90, 0, 5, 0, 0); break;   // Vista de topo
+        case 2: renderTeapot(view, 0, 0, 0, 0, 0); break;    // Vista de frente
+        case 3: renderTeapot(view, -90, 0, 0, 5, 0); break;  // Vista do lado esquerdo
+        }
+    }
 }
 
-int main() {
+int main(int argc, char** argv) {
+    capture.configurar(argc, argv);
+    // Segundo argumento: número de vistas (4 por padrão, uma por câmera)
+    int views = argc > 2 ? std::max(1, std::atoi(argv[2])) : 4;
+    layout.configurar(disposicao::GRADE, views);
+    lastLevel.assign(views, SIZE_MAX);
+
     initGLFW();
     GLFWwindow*  window =createWindow();
+    if (!loadTeapot(argc > 1 ? argv[1] : "teapot.obj")) {
+        glfwTerminate();
+        return -1;
+    }
+    prepareQuantizedTeapot();
 
-    while (!glfwWindowShouldClose(glfwGetCurrentContext())) {
-        render(window);
-        glfwPollEvents();
+    while (onDemand.proximoQuadro()) {
+        render();
+        if (capture.concluirQuadro(window))
+            break;
+        if (capture.ativa())
+            onDemand.solicitarQuadro(); // Continua desenhando até o quadro pedido
+        glfwSwapBuffers(window);
     }
 
+    onDemand.imprimirEstatisticas();
+    onDemand.desconectar();
+    releaseQuantizedTeapot();
     glfwTerminate();
-    return 0;
+    return capture.codigoSaida();
 }
\ No newline at end of file
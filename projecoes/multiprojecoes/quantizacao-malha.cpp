@@ -0,0 +1,54 @@
+// Quantiza teapot.obj (subdividido até milhões de triângulos) e mede memória e erro
+//
+// Uso: quantizacao-malha [arquivo.obj] [níveis de subdivisão]
+// Compilação: g++ -std=c++17 -O2 quantizacao-malha.cpp -o quantizacao-malha
+// (só usa os cabeçalhos do GLEW, para os tipos do formato de vértice; não abre janela)
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <vector>
+
+#include "../../comum/quantizacao.hpp"
+
+int main(int argc, char** argv) {
+    const char* caminho = argc > 1 ? argv[1] : "teapot.obj";
+    int niveis = argc > 2 ? std::atoi(argv[2]) : 5; // 992 triângulos * 4^5 ~ 1 milhão
+
+    malha::Malha m;
+    try {
+        m = malha::carregarObj(caminho);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return -1;
+    }
+
+    printf("%10s %10s %12s %12s %6s %12s %12s %9s %9s %5s %8s\n", "triângulos", "vértices", "original",
+           "quantizada", "razão", "erro máx.", "erro RMS", "normal máx", "normal méd", "cor", "tempo");
+    for (int nivel = 0; nivel <= niveis; ++nivel) {
+        if (nivel > 0)
+            m = malha::subdividir(m);
+
+        // Cor por vértice derivada da normal, só para exercitar a quantização de 8 bits
+        std::vector<float> cores(m.normais.size());
+        for (size_t i = 0; i < cores.size(); ++i)
+            cores[i] = 0.5f + 0.5f * m.normais[i];
+
+        auto inicio = std::chrono::steady_clock::now();
+        quantizacao::MalhaQuantizada q = quantizacao::quantizar(m, &cores);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+        quantizacao::Erro erro = quantizacao::medirErro(m, q, &cores);
+
+        printf("%10zu %10zu %9.2f MB %9.2f MB %5.2fx %12.3g %12.3g %8.4f° %8.4f° %5d %5.1f ms\n", m.numeroTriangulos(),
+               m.numeroVertices(), erro.bytesOriginal / 1e6, erro.bytesQuantizado / 1e6,
+               double(erro.bytesOriginal) / erro.bytesQuantizado, erro.maiorPosicao, erro.rmsPosicao,
+               erro.maiorAnguloNormal, erro.medioAnguloNormal, erro.maiorCor, ms);
+
+        // Limites esperados: meio passo de quantização por eixo, normais bem abaixo de 0,01° e cor em 1/255
+        if (erro.relativoDiagonal > 1.0 / 65535.0 || erro.maiorAnguloNormal > 0.01 || erro.maiorCor > 1) {
+            fprintf(stderr, "Erro de quantização acima do esperado\n");
+            return 1;
+        }
+    }
+    return 0;
+}
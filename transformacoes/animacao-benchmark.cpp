@@ -0,0 +1,99 @@
+// Mede a avaliação em lote das trilhas de quadros-chave (comum/animacao.hpp) com 300 mil trilhas
+//
+// Compilação: g++ -std=c++17 -O2 -march=native -pthread animacao-benchmark.cpp -o animacao-benchmark
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../comum/animacao.hpp"
+
+const int NUMERO_POSES = 100000; // Uma trilha de translação, uma de rotação e uma de escala por pose
+const int CHAVES = 8;
+const int PASSOS = 240; // Dois segundos de simulação a 120 Hz
+
+// Referência escalar para as trilhas de translação: busca binária a cada avaliação
+void translacaoReferencia(const std::vector<float>& tempos, const std::vector<float>& valores, double t, float r[3]) {
+    size_t n = tempos.size();
+    if (t <= tempos[0] || t >= tempos[n - 1]) {
+        size_t k = t <= tempos[0] ? 0 : n - 1;
+        std::copy(&valores[3 * k], &valores[3 * k] + 3, r);
+        return;
+    }
+    size_t k = static_cast<size_t>(std::upper_bound(tempos.begin(), tempos.end(), float(t)) - tempos.begin()) - 1;
+    float u = static_cast<float>((t - tempos[k]) / (tempos[k + 1] - tempos[k]));
+    for (int c = 0; c < 3; ++c)
+        r[c] = valores[3 * k + c] + (valores[3 * (k + 1) + c] - valores[3 * k + c]) * u;
+}
+
+double milissegundos(std::chrono::steady_clock::time_point inicio) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+int main() {
+    std::mt19937 gerador(42);
+    std::uniform_real_distribution<float> aleatorio(-1.0f, 1.0f);
+    animacao::Trilhas trilhas;
+    std::vector<std::vector<float>> temposTranslacao, valoresTranslacao;
+
+    for (uint32_t p = 0; p < NUMERO_POSES; ++p) {
+        // Chaves em instantes diferentes para cada pose, cobrindo de 0 a cerca de 2 s
+        std::vector<float> tempos(CHAVES), translacoes, rotacoes, escalas;
+        float t = 0.0f;
+        for (int k = 0; k < CHAVES; ++k) {
+            tempos[k] = t;
+            t += 0.05f + 0.25f * (aleatorio(gerador) + 1.0f) * 0.5f;
+            translacoes.insert(translacoes.end(), {aleatorio(gerador), aleatorio(gerador), aleatorio(gerador)});
+            float q[4];
+            animacao::quaternioEixoAngulo(3.0f * aleatorio(gerador), 0.0f, 0.0f, 1.0f, q);
+            rotacoes.insert(rotacoes.end(), q, q + 4);
+            float e = 1.0f + 0.5f * aleatorio(gerador);
+            escalas.insert(escalas.end(), {e, e, 1.0f});
+        }
+        trilhas.adicionar(p, animacao::TRANSLACAO, tempos, translacoes, p % 2 == 0);
+        trilhas.adicionar(p, animacao::ROTACAO, tempos, rotacoes);
+        trilhas.adicionar(p, animacao::ESCALA, tempos, escalas);
+        temposTranslacao.push_back(tempos);
+        valoresTranslacao.push_back(translacoes);
+    }
+    printf("%zu trilhas, %d poses\n", trilhas.numeroTrilhas(), NUMERO_POSES);
+
+    // Passo fixo: avalia todas as trilhas a cada tick e interpola o estado de desenho
+    animacao::Poses anterior, atual, desenho;
+    trilhas.avaliar(0.0, atual);
+    anterior = atual;
+    double totalAvaliacao = 0.0, totalInterpolacao = 0.0;
+    const double passo = 1.0 / 120.0;
+    for (int k = 1; k <= PASSOS; ++k) {
+        std::swap(anterior, atual);
+        auto inicio = std::chrono::steady_clock::now();
+        trilhas.avaliar(k * passo, atual);
+        totalAvaliacao += milissegundos(inicio);
+        inicio = std::chrono::steady_clock::now();
+        animacao::interpolar(anterior, atual, 0.5f, desenho);
+        totalInterpolacao += milissegundos(inicio);
+    }
+    printf("Avaliação: %.3f ms por tick (%.1f ns por trilha)\n", totalAvaliacao / PASSOS,
+           1e6 * totalAvaliacao / PASSOS / trilhas.numeroTrilhas());
+    printf("Interpolação: %.3f ms por quadro\n", totalInterpolacao / PASSOS);
+    tarefas::padrao().imprimirEstatisticas();
+
+    // Confere as translações contra a referência, inclusive voltando no tempo (o cache de segmento é refeito)
+    float erro = 0.0f;
+    for (double t : {0.7, 1.9, 0.1, 1.3}) {
+        trilhas.avaliar(t, atual);
+        for (int p = 1; p < NUMERO_POSES; p += 2) { // Só as trilhas sem repetição
+            float r[3];
+            translacaoReferencia(temposTranslacao[p], valoresTranslacao[p], t, r);
+            erro = std::max({erro, std::fabs(r[0] - atual.tx[p]), std::fabs(r[1] - atual.ty[p]), std::fabs(r[2] - atual.tz[p])});
+        }
+        for (int p = 0; p < NUMERO_POSES; ++p) { // Rotações sempre unitárias
+            float norma = atual.qx[p] * atual.qx[p] + atual.qy[p] * atual.qy[p] + atual.qz[p] * atual.qz[p] + atual.qw[p] * atual.qw[p];
+            erro = std::max(erro, std::fabs(norma - 1.0f));
+        }
+    }
+    printf("Maior erro em relação à referência escalar: %g\n", erro);
+    return erro < 1e-4f ? 0 : 1;
+}
@@ -5,21 +5,35 @@
 #include <glm/glm.hpp> // Inclui o cabeçalho da biblioteca GLM (OpenGL Mathematics) para operações matemáticas.
 #include <glm/gtc/type_ptr.hpp> // Inclui o cabeçalho da biblioteca GLM para funções de conversão de tipos.
 #include <glm/gtc/matrix_transform.hpp> // Inclui o cabeçalho da biblioteca GLM para operações de transformação de matrizes.
+#include "../comum/grafo_cena.hpp" // Inclui o grafo de cena em arrays (SoA) com propagação das transformações em lote
+#include "../comum/buffer_anel.hpp" // Inclui o buffer em anel mapeado de forma persistente para os dados de cada quadro
+#include "../comum/gerenciador_shaders.hpp" // Inclui o cache de programas GLSL (binários salvos em disco)
+#include "../comum/formato_vertice.hpp" // Inclui os formatos de vértice tipados (atributos e declarações GLSL gerados da struct)
+#include "../comum/animacao.hpp" // Inclui a simulação de passo fixo e as trilhas de quadros-chave
+#include "../comum/captura_quadro.hpp" // Inclui o modo de captura (--capturar N arquivo.ppm) para comparar com as imagens de referência
+#include <cstring> // Inclui std::memcpy
+#include <string> // Inclui std::string
 
 // Código fonte dos shaders vertex e fragment (são programas executados na GPU)
 const char* vertex_shader_code = R"(
     #version 330 core // Especifica a versão do GLSL (OpenGL Shading Language) como 3.30 core
-    layout(location = 0) in vec3 vertexPosition; // Declara um atributo de entrada para as posições dos vértices (vec3 = vetor de 3 elementos) com layout location 0
-    layout(location = 1) in vec3 vertexColor; // Declara um atributo de entrada para as cores dos vértices com layout location 1
-
-    uniform mat4 mvp; // Declara uma variável uniforme (constante durante a execução do shader) para a matriz de projeção
-    uniform mat4 trans; // Declara uma variável uniforme para a matriz de transformação
+    // As entradas vertexPosition e vertexColor são declaradas a partir de Vertex (veja formato_vertice.hpp)
+
+#ifdef UNIFORMES_SOLTOS // Sem o buffer em anel: uniformes comuns, definidos com glUniformMatrix4fv
+    uniform mat4 mvp; // Matriz de projeção
+    uniform mat4 trans; // Matriz de transformação do objeto
+#else
+    layout(std140) uniform Transformacoes { // Bloco de uniformes lido de um buffer (UBO), um trecho por objeto
+        mat4 mvp; // Matriz de projeção
+        mat4 trans; // Matriz de transformação do objeto
+    };
+#endif
 
     out vec3 fragmentColor; // Declara uma variável de saída para a cor do fragmento
 
     void main() { // Função principal do vertex shader
         gl_Position = mvp * trans * vec4(vertexPosition, 1.0); // Calcula a posição final do vértice
-        fragmentColor = vertexColor; // Passa a cor do vértice para o fragment shader
+        fragmentColor = vertexColor.rgb; // Passa a cor do vértice para o fragment shader
     }
 )";
 
@@ -33,59 +47,121 @@ const char* fragment_shader_code = R"(
     }
 )";
 
-// Variáveis globais para o deslocamento da casa
-GLfloat delta = 0.0f; // Inicializa o deslocamento como zero
-GLuint VertexArrayID, programID, vertexbuffer, colorbuffer; // Declara identificadores para o Vertex Array Object (VAO), programa de shader, buffer de vértices e buffer de cores
+// Vértice intercalado: posição em floats e cor compactada em 4 bytes (16 bytes por vértice, em vez de 24)
+struct Vertex {
+    GLfloat vertexPosition[3]; // Posição do vértice
+    vertice::CorRGBA8 vertexColor; // Cor do vértice, normalizada para [0, 1] no shader
+};
 
-// Protótipos de funções
-GLuint compileShader(const char* source, GLenum shader_type) { // Função para compilar um shader
-    GLuint shader = glCreateShader(shader_type); // Cria um shader do tipo especificado
-    glShaderSource(shader, 1, &source, NULL); // Associa o código fonte ao shader
-    glCompileShader(shader); // Compila o shader
-
-    GLint success; // Variável para armazenar o status de compilação
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success); // Obtém o status de compilação do shader
-    if (!success) { // Se a compilação falhou
-        GLchar infoLog[512]; // Buffer para armazenar o log de erros
-        glGetShaderInfoLog(shader, 512, NULL, infoLog); // Obtém o log de erros do shader
-        std::cerr << "Shader compilation failed: " << infoLog << std::endl; // Imprime o log de erros
-        return 0; // Retorna 0 para indicar falha
+template <> struct vertice::Formato<Vertex> { // Descrição usada para gerar glVertexAttribPointer e as entradas do shader
+    static constexpr vertice::Atributo atributos[] = {
+        ATRIBUTO_VERTICE(Vertex, vertexPosition, 0),
+        ATRIBUTO_VERTICE(Vertex, vertexColor, 1),
+    };
+};
+
+GLuint VertexArrayID, programID, vertexbuffer; // Declara identificadores para o Vertex Array Object (VAO), programa de shader e buffer de vértices
+
+// Uniformes por objeto: cada quadro escreve mvp e trans de todas as casas no buffer em anel
+const GLuint PONTO_TRANSFORMACOES = 0; // Ponto de ligação (binding) do bloco "Transformacoes"
+const size_t TAMANHO_TRANSFORMACOES = 2 * 16 * sizeof(GLfloat); // mvp + trans no layout std140
+BufferAnel anelUniformes; // Buffer triplo com cercas de sincronização
+bool uniformesNoAnel = false; // Falso se o buffer em anel não pôde ser criado
+GLint localMvp = -1, localTrans = -1; // Uniformes do programa sem o bloco (UNIFORMES_SOLTOS)
+GerenciadorShaders shaders; // Compila os programas ou os recarrega do cache em disco
+GLint alinhamentoUniformes = 256; // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+std::vector<GLintptr> deslocamentosCasas; // Deslocamento no buffer dos uniformes de cada casa no quadro atual
+
+// Grafo de cena: a vila é a raiz deslocada pela animação e a casa é filha da vila
+grafo::GrafoCena grafoCasas; // Hierarquia de transformações das casas
+int noVila; // Nó raiz, que recebe o deslocamento
+std::vector<int> nosCasas; // Nós que desenham uma casa
+
+void montarGrafoCena() { // Função para montar a hierarquia de casas
+    noVila = grafoCasas.adicionar(-1); // Cria a raiz da hierarquia
+    nosCasas.push_back(grafoCasas.adicionar(noVila)); // A casa acompanha a vila
+}
+
+// Animação: a vila anda de (0, 0) a (10, 10) em 10/3 s (o mesmo movimento de antes a 60
+// quadros por segundo, agora independente da taxa de quadros)
+const double PASSO_SIMULACAO = 1.0 / 120.0; // A simulação avança sempre 1/120 s por passo
+animacao::Trilhas trilhasCasas; // Quadros-chave de translação da vila
+std::vector<int> nosAnimados; // Nó do grafo de cada pose
+animacao::Poses posesAnterior, posesAtual, posesDesenho; // Dois últimos passos e o estado interpolado
+animacao::PassoFixo relogioSimulacao(PASSO_SIMULACAO); // Quantos passos simular a cada quadro
+animacao::SimulacaoEmThread simulacaoEmThread; // Usada com o argumento -t
+bool simularEmThread = false;
+captura::Captura capturaQuadro; // Com --capturar, a animação segue o relógio virtual da captura
+
+void montarAnimacao() { // Função para criar as trilhas de quadros-chave
+    const float duracao = 10.0f / 3.0f;
+    nosAnimados.push_back(noVila);
+    trilhasCasas.adicionar(0, animacao::TRANSLACAO, {0.0f, duracao}, {0.0f, 0.0f, 0.0f, 10.0f, 10.0f, 0.0f});
+
+    // Estado inicial das poses: as trilhas só escrevem os canais animados, o resto fica na identidade
+    posesAtual.redimensionar(nosAnimados.size());
+    trilhasCasas.avaliar(0.0, posesAtual);
+    posesAnterior = posesDesenho = posesAtual;
+
+    if (simularEmThread) // Os passos correm em outra thread, no ritmo do relógio; o desenho só interpola
+        simulacaoEmThread.iniciar(posesAtual, PASSO_SIMULACAO, [](animacao::Poses& estado, double tempo, double passo) {
+            trilhasCasas.avaliar(tempo + passo, estado);
+        });
+}
+
+void simularAnimacao() { // Função para avançar a simulação até o instante atual
+    if (simularEmThread) {
+        simulacaoEmThread.amostrar(posesDesenho);
+        return;
+    }
+    double agora = capturaQuadro.ativa() ? capturaQuadro.tempo() : glfwGetTime(); // Relógio virtual na captura: o quadro N é sempre o mesmo
+    for (int n = relogioSimulacao.avancar(agora); n > 0; n--) { // Zero ou mais passos fixos neste quadro
+        std::swap(posesAnterior, posesAtual);
+        trilhasCasas.avaliar(relogioSimulacao.tempoSimulado() - (n - 1) * PASSO_SIMULACAO, posesAtual);
     }
-    return shader; // Retorna o identificador do shader compilado
+    animacao::interpolar(posesAnterior, posesAtual, relogioSimulacao.alfa(), posesDesenho); // Estado entre os dois últimos passos
 }
 
+// Protótipos de funções
 void transferDataToGPUMemory() { // Função para transferir dados para a memória da GPU
-    // Compila e vincula os shaders
-    programID = glCreateProgram(); // Cria um novo programa de shader
-    GLuint vertex_shader = compileShader(vertex_shader_code, GL_VERTEX_SHADER); // Compila o vertex shader
-    GLuint fragment_shader = compileShader(fragment_shader_code, GL_FRAGMENT_SHADER); // Compila o fragment shader
-    glAttachShader(programID, vertex_shader); // Anexa o vertex shader ao programa
-    glAttachShader(programID, fragment_shader); // Anexa o fragment shader ao programa
-    glLinkProgram(programID); // Vincula os shaders ao programa
-
-    // Verifica erros na vinculação dos shaders
-    GLint success; // Variável para armazenar o status de vinculação
-    glGetProgramiv(programID, GL_LINK_STATUS, &success); // Obtém o status de vinculação do programa
-    if (!success) { // Se a vinculação falhou
-        GLchar infoLog[512]; // Buffer para armazenar o log de erros
-        glGetProgramInfoLog(programID, 512, NULL, infoLog); // Obtém o log de erros do programa
-        std::cerr << "Shader linking failed: " << infoLog << std::endl; // Imprime o log de erros
+    // Cria o buffer em anel (64 KB por quadro); sem ele, o shader usa uniformes comuns
+    uniformesNoAnel = anelUniformes.criar(GL_UNIFORM_BUFFER, 64 * 1024); // Três regiões: uma em escrita e até duas em uso pela GPU
+    std::vector<std::string> definicoes; // #define injetados nos shaders
+    if (!uniformesNoAnel)
+        definicoes.push_back("UNIFORMES_SOLTOS");
+
+    // Compila e vincula os shaders, ou recarrega o programa do cache de binários de uma execução anterior
+    programID = shaders.programa(shaders.solicitar(vertice::inserirDeclaracoes<Vertex>(vertex_shader_code), fragment_shader_code, definicoes)); // Espera o fim do link
+    if (!programID) { // Se a compilação ou a vinculação falhou (o log já foi impresso)
         return; // Retorna sem fazer nada
     }
+    shaders.imprimirEstatisticas(); // Informa se o programa veio do cache ou foi compilado
+
+    if (uniformesNoAnel) { // Liga o bloco de uniformes ao ponto de ligação
+        glUniformBlockBinding(programID, glGetUniformBlockIndex(programID, "Transformacoes"), PONTO_TRANSFORMACOES);
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alinhamentoUniformes); // Alinhamento exigido por glBindBufferRange
+        std::cout << "Buffer de uniformes " << (anelUniformes.persistente() ? "persistente (GL_ARB_buffer_storage)" : "com glBufferSubData") << std::endl;
+    } else {
+        localMvp = glGetUniformLocation(programID, "mvp"); // Localização das matrizes no programa
+        localTrans = glGetUniformLocation(programID, "trans");
+        std::cout << "Buffer em anel indisponível: uniformes com glUniformMatrix4fv" << std::endl;
+    }
 
     // Vértices e cores para os componentes da casa
-    std::vector<GLfloat> g_vertex_buffer_data = { // Vetor contendo os dados dos vértices
-        // Telhado (triângulo)
-        -10.0f, 20.0f, 0.0f, // Vértice 1 do telhado
-        10.0f, 20.0f, 0.0f, // Vértice 2 do telhado
-        0.0f, 30.0f, 0.0f, // Vértice 3 do telhado
-        // Paredes (retângulo)
-        -10.0f, 10.0f, 0.0f, // Vértice 1 da parede esquerda
-        -10.0f, 20.0f, 0.0f, // Vértice 2 da parede esquerda
-        10.0f, 20.0f, 0.0f, // Vértice 3 da parede direita
-        -10.0f, 10.0f, 0.0f, // Vértice 1 da parede esquerda (novamente)
-        10.0f, 20.0f, 0.0f, // Vértice 2 da parede direita (novamente)
-        10.0f, 10.0f, 0.0f // Vértice 3 da parede direita
+    const vertice::CorRGBA8 vermelho = vertice::empacotarCor(1.0f, 0.0f, 0.0f); // Cor do telhado
+    const vertice::CorRGBA8 azul = vertice::empacotarCor(0.0f, 0.0f, 1.0f); // Cor das paredes
+    std::vector<Vertex> g_vertex_buffer_data = { // Vetor contendo os vértices (posição e cor intercaladas)
+        // Telhado (triângulo vermelho)
+        {{-10.0f, 20.0f, 0.0f}, vermelho}, // Vértice 1 do telhado
+        {{10.0f, 20.0f, 0.0f}, vermelho}, // Vértice 2 do telhado
+        {{0.0f, 30.0f, 0.0f}, vermelho}, // Vértice 3 do telhado
+        // Paredes (retângulo azul)
+        {{-10.0f, 10.0f, 0.0f}, azul}, // Vértice 1 da parede esquerda
+        {{-10.0f, 20.0f, 0.0f}, azul}, // Vértice 2 da parede esquerda
+        {{10.0f, 20.0f, 0.0f}, azul}, // Vértice 3 da parede direita
+        {{-10.0f, 10.0f, 0.0f}, azul}, // Vértice 1 da parede esquerda (novamente)
+        {{10.0f, 20.0f, 0.0f}, azul}, // Vértice 2 da parede direita (novamente)
+        {{10.0f, 10.0f, 0.0f}, azul} // Vértice 3 da parede direita
     };
 
     glGenVertexArrays(1, &VertexArrayID); // Gera um novo Vertex Array Object (VAO)
@@ -93,32 +169,14 @@ void transferDataToGPUMemory() { // Função para transferir dados para a memór
 
     glGenBuffers(1, &vertexbuffer); // Gera um novo buffer de vértices
     glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer); // Vincula o buffer de vértices para uso
-    glBufferData(GL_ARRAY_BUFFER, g_vertex_buffer_data.size() * sizeof(GLfloat), g_vertex_buffer_data.data(), GL_STATIC_DRAW); // Envia os dados dos vértices para o buffer
-
-    std::vector<GLfloat> g_color_buffer_data = { // Vetor contendo os dados das cores
-        // Telhado (cor vermelha)
-        1.0f, 0.0f, 0.0f, // Cor vermelha para o vértice 1 do telhado
-        1.0f, 0.0f, 0.0f, // Cor vermelha para o vértice 2 do telhado
-        1.0f, 0.0f, 0.0f, // Cor vermelha para o vértice 3 do telhado
-        // Paredes (cor azul)
-        0.0f, 0.0f, 1.0f, // Cor azul para o vértice 1 da parede esquerda
-        0.0f, 0.0f, 1.0f, // Cor azul para o vértice 2 da parede esquerda
-        0.0f, 0.0f, 1.0f, // Cor azul para o vértice 3 da parede direita
-        0.0f, 0.0f, 1.0f, // Cor azul para o vértice 1 da parede esquerda (novamente)
-        0.0f, 0.0f, 1.0f, // Cor azul para o vértice 2 da parede direita (novamente)
-        0.0f, 0.0f, 1.0f // Cor azul para o vértice 3 da parede direita
-    };
-
-    glGenBuffers(1, &colorbuffer); // Gera um novo buffer de cores
-    glBindBuffer(GL_ARRAY_BUFFER, colorbuffer); // Vincula o buffer de cores para uso
-    glBufferData(GL_ARRAY_BUFFER, g_color_buffer_data.size() * sizeof(GLfloat), g_color_buffer_data.data(), GL_STATIC_DRAW); // Envia os dados das cores para o buffer
+    glBufferData(GL_ARRAY_BUFFER, g_vertex_buffer_data.size() * sizeof(Vertex), g_vertex_buffer_data.data(), GL_STATIC_DRAW); // Envia os dados dos vértices para o buffer
 }
 
 void cleanupDataFromGPU() { // Função para limpar os dados da GPU
     glDeleteBuffers(1, &vertexbuffer); // Exclui o buffer de vértices
-    glDeleteBuffers(1, &colorbuffer); // Exclui o buffer de cores
     glDeleteVertexArrays(1, &VertexArrayID); // Exclui o Vertex Array Object (VAO)
     glDeleteProgram(programID); // Exclui o programa de shader
+    anelUniformes.destruir(); // Libera o buffer em anel e as cercas pendentes
 }
 
 void draw(GLFWwindow* window) { // Função para desenhar a cena
@@ -131,35 +189,71 @@ void draw(GLFWwindow* window) { // Função para desenhar a cena
     // Cria o domínio da cena
     glm::mat4 mvp = glm::ortho(-40.0f, 40.0f, -40.0f, 40.0f); // Cria a matriz de projeção ortogonal
 
-    // Obtém as localizações das variáveis uniformes
-    GLint matrix = glGetUniformLocation(programID, "mvp"); // Obtém a localização da variável uniforme "mvp"
-    glUniformMatrix4fv(matrix, 1, GL_FALSE, glm::value_ptr(mvp)); // Envia a matriz de projeção para o shader
-
-    glm::mat4 trans = glm::mat4(1.0f); // Cria uma matriz de transformação identidade
-    trans = glm::translate(trans, glm::vec3(delta, delta, 0.0f)); // Aplica uma translação à matriz de transformação
-    GLint m = glGetUniformLocation(programID, "trans"); // Obtém a localização da variável uniforme "trans"
-    glUniformMatrix4fv(m, 1, GL_FALSE, glm::value_ptr(trans)); // Envia a matriz de transformação para o shader
+    // Atualiza o grafo de cena: só os nós alterados e seus descendentes são recalculados
+    animacao::aplicar(posesDesenho, grafoCasas, nosAnimados); // Aplica a pose interpolada à vila
+    grafoCasas.atualizar(); // Propaga as transformações para as matrizes de mundo
 
-    // 1º buffer de atributos: vértices
-    glEnableVertexAttribArray(0); // Habilita o atributo de vértices
+    // Atributos intercalados (posição e cor) gerados a partir da descrição de Vertex
     glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer); // Vincula o buffer de vértices
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr); // Configura o ponteiro de atributo para os vértices
+    vertice::configurarAtributos<Vertex>(); // Habilita e configura os ponteiros de atributo com o stride de Vertex
+
+    if (!uniformesNoAnel) { // Sem o buffer em anel: uma chamada glUniformMatrix4fv por casa
+        glUniformMatrix4fv(localMvp, 1, GL_FALSE, glm::value_ptr(mvp)); // Matriz de projeção, comum a todas
+        for (int no : nosCasas) {
+            glUniformMatrix4fv(localTrans, 1, GL_FALSE, grafoCasas.mundo(no)); // Matriz de transformação desta casa
+            glDrawArrays(GL_TRIANGLES, 0, 3); // Desenha o telhado (triângulo)
+            glDrawArrays(GL_TRIANGLES, 3, 6); // Desenha as paredes (retângulo)
+        }
+        vertice::desabilitarAtributos<Vertex>(); // Desabilita os atributos de posição e cor
+        return;
+    }
 
-    // 2º buffer de atributos: cores
-    glEnableVertexAttribArray(1); // Habilita o atributo de cores
-    glBindBuffer(GL_ARRAY_BUFFER, colorbuffer); // Vincula o buffer de cores
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr); // Configura o ponteiro de atributo para as cores
+    // Desenha os componentes das casas [inicio, fim) com a matriz de mundo de cada uma
+    auto desenharCasas = [](size_t inicio, size_t fim) {
+        anelUniformes.enviar(); // Sem buffer persistente, envia a faixa escrita com um único glBufferSubData
+        for (size_t i = inicio; i < fim; i++) {
+            glBindBufferRange(GL_UNIFORM_BUFFER, PONTO_TRANSFORMACOES, anelUniformes.buffer(), deslocamentosCasas[i], TAMANHO_TRANSFORMACOES); // Aponta o bloco para os uniformes desta casa
+            glDrawArrays(GL_TRIANGLES, 0, 3); // Desenha o telhado (triângulo)
+            glDrawArrays(GL_TRIANGLES, 3, 6); // Desenha as paredes (retângulo)
+        }
+    };
 
-    // Desenha os componentes da casa
-    glDrawArrays(GL_TRIANGLES, 0, 3); // Desenha o telhado (triângulo)
-    glDrawArrays(GL_TRIANGLES, 3, 6); // Desenha as paredes (retângulo)
+    // Escreve os uniformes de todas as casas diretamente na memória mapeada do quadro atual
+    anelUniformes.iniciarQuadro(); // Espera a GPU liberar a região, se ainda estiver em uso
+    deslocamentosCasas.resize(nosCasas.size()); // Só aloca na primeira chamada
+    size_t primeiraPendente = 0, escritas = 0; // Casas [primeiraPendente, escritas) escritas e ainda não desenhadas
+    for (size_t i = 0; i < nosCasas.size(); i++) {
+        BufferAnel::Alocacao a = anelUniformes.alocar(TAMANHO_TRANSFORMACOES, alinhamentoUniformes);
+        if (!a.ponteiro && i > primeiraPendente) { // Região cheia: desenha o que já foi escrito e passa para a próxima região
+            desenharCasas(primeiraPendente, i);
+            anelUniformes.finalizarQuadro();
+            anelUniformes.iniciarQuadro();
+            primeiraPendente = i;
+            a = anelUniformes.alocar(TAMANHO_TRANSFORMACOES, alinhamentoUniformes);
+        }
+        if (!a.ponteiro) { // Nem uma região vazia comporta os uniformes de uma casa
+            std::cerr << "Região do buffer de uniformes menor que os uniformes de uma casa" << std::endl;
+            break;
+        }
+        std::memcpy(a.ponteiro, glm::value_ptr(mvp), 16 * sizeof(GLfloat)); // Matriz de projeção
+        std::memcpy(static_cast<GLfloat*>(a.ponteiro) + 16, grafoCasas.mundo(nosCasas[i]), 16 * sizeof(GLfloat)); // Matriz de transformação
+        deslocamentosCasas[i] = a.deslocamento;
+        escritas = i + 1;
+    }
+    desenharCasas(primeiraPendente, escritas);
 
     // Desabilita os arrays de atributos para vértices
-    glDisableVertexAttribArray(0); // Desabilita o atributo de vértices
-    glDisableVertexAttribArray(1); // Desabilita o atributo de cores
+    vertice::desabilitarAtributos<Vertex>(); // Desabilita os atributos de posição e cor
+
+    anelUniformes.finalizarQuadro(); // Insere a cerca que protege a região até a GPU terminar este quadro
 }
 
-int main() { // Função principal
+int main(int argc, char** argv) { // Função principal
+    // Argumentos --capturar N arquivo.ppm: salva o quadro N e termina (tira esses argumentos de argv)
+    capturaQuadro.configurar(argc, argv);
+    // Argumento -t: executa a simulação em uma thread separada (ignorado na captura, que precisa ser determinística)
+    simularEmThread = argc > 1 && std::string(argv[1]) == "-t" && !capturaQuadro.ativa();
+
     // Inicializa o GLFW
     if (!glfwInit()) { // Se a inicialização do GLFW falhar
         std::cerr << "Falha ao inicializar o GLFW" << std::endl; // Imprime uma mensagem de erro
@@ -173,6 +267,8 @@ int main() { // Função principal
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // Habilita a compatibilidade futura do OpenGL
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE); // Define o perfil do OpenGL para core
 
+    capturaQuadro.prepararJanela(); // Na captura: janela invisível e sem multiamostragem
+
     // Abre uma janela
     GLFWwindow* window = glfwCreateWindow(800, 800, "Movimentação de casa em 2D", nullptr, nullptr); // Cria uma janela de 800x800 pixels com o título "Moving House in 2D"
     if (!window) { // Se a criação da janela falhar
@@ -200,15 +296,21 @@ int main() { // Função principal
     // Transfere os dados (vértices, cores e shaders) para a GPU
     transferDataToGPUMemory();
 
+    // Monta a hierarquia de casas
+    montarGrafoCena();
+    montarAnimacao();
+
     // Renderiza a cena para cada quadro
-    delta = 0.0f; // Inicializa o deslocamento como zero
     while (!glfwWindowShouldClose(window)) { // Loop enquanto a janela não for fechada
+        simularAnimacao(); // Avança a simulação em passos fixos e interpola o estado a desenhar
         draw(window); // Chama a função draw() para desenhar a cena
+        if (capturaQuadro.concluirQuadro(window)) // Na captura, salva o quadro pedido e termina
+            break;
         glfwSwapBuffers(window); // Troca os buffers de renderização (double buffering)
         glfwPollEvents(); // Processa eventos de entrada (teclado, mouse, etc.)
-        if (delta < 10.0f) // Se o deslocamento for menor que 10
-            delta += 0.05f; // Incrementa o deslocamento
     }
+    simulacaoEmThread.parar(); // Termina a thread de simulação, se houver
+    std::cout << "Passos de simulação: " << (simularEmThread ? simulacaoEmThread.passos() : relogioSimulacao.passos()) << std::endl;
 
     // Limpa o VAO, VBOs e shaders da GPU
     cleanupDataFromGPU();
@@ -216,5 +318,5 @@ int main() { // Função principal
     // Fecha a janela OpenGL e termina o GLFW
     glfwTerminate();
 
-    return 0; // Retorna 0 indicando sucesso
+    return capturaQuadro.codigoSaida(); // Retorna 0 indicando sucesso (1 se a captura não pôde ser salva)
 }
\ No newline at end of file
@@ -0,0 +1,120 @@
+// Mede a atualização do grafo de cena SoA (comum/grafo_cena.hpp) com 1 milhão de nós
+//
+// Compilação: g++ -std=c++17 -O2 -march=native grafo-cena-benchmark.cpp -o grafo-cena-benchmark
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../comum/grafo_cena.hpp"
+
+const int NUMERO_NOS = 1000000;
+const int NUMERO_RAIZES = 1000;
+const int QUADROS = 20;
+
+// Referência escalar: T * Rz(angulo), sobe até a raiz multiplicando as matrizes locais
+void mundoReferencia(const grafo::GrafoCena& grafo, const std::vector<float>& translacoes,
+                     const std::vector<float>& angulos, int no, float r[16]) {
+    float m[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+    for (int i = no; i >= 0; i = grafo.pai(i)) {
+        float c = std::cos(angulos[i]), s = std::sin(angulos[i]);
+        const float* t = &translacoes[3 * i];
+        float local[16] = {c, s, 0, 0, -s, c, 0, 0, 0, 0, 1, 0, t[0], t[1], t[2], 1};
+        float produto[16];
+        for (int coluna = 0; coluna < 4; ++coluna)
+            for (int linha = 0; linha < 4; ++linha) {
+                float soma = 0.0f;
+                for (int k = 0; k < 4; ++k)
+                    soma += local[k * 4 + linha] * m[coluna * 4 + k];
+                produto[coluna * 4 + linha] = soma;
+            }
+        std::copy(produto, produto + 16, m);
+    }
+    std::copy(m, m + 16, r);
+}
+
+// Compara todas as matrizes de mundo com a referência e devolve o maior erro absoluto
+float verificar(const grafo::GrafoCena& grafo, const std::vector<float>& translacoes, const std::vector<float>& angulos) {
+    float maiorErro = 0.0f;
+    for (int i = 0; i < grafo.tamanho(); ++i) {
+        float referencia[16];
+        mundoReferencia(grafo, translacoes, angulos, i, referencia);
+        for (int k = 0; k < 16; ++k)
+            maiorErro = std::max(maiorErro, std::fabs(referencia[k] - grafo.mundo(i)[k]));
+    }
+    return maiorErro;
+}
+
+double milissegundos(std::chrono::steady_clock::time_point inicio) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+int main() {
+    std::mt19937 gerador(42);
+    std::uniform_real_distribution<float> aleatorio(-1.0f, 1.0f);
+    grafo::GrafoCena grafo;
+
+    // Floresta: cada raiz tem uma árvore com pais escolhidos entre os nós anteriores dela
+    int nosPorArvore = NUMERO_NOS / NUMERO_RAIZES;
+    for (int a = 0; a < NUMERO_RAIZES; ++a) {
+        int raiz = grafo.adicionar(-1);
+        for (int k = 1; k < nosPorArvore; ++k) {
+            int pai = raiz + static_cast<int>(gerador() % k);
+            int no = grafo.adicionar(pai);
+            grafo.definirTranslacao(no, aleatorio(gerador), aleatorio(gerador), aleatorio(gerador));
+            grafo.definirRotacao(no, aleatorio(gerador), 0.0f, 0.0f, 1.0f);
+        }
+    }
+    auto inicio = std::chrono::steady_clock::now();
+    grafo.atualizar();
+    printf("Construção + primeira atualização de %d nós: %.2f ms\n", grafo.tamanho(), milissegundos(inicio));
+
+    // Todos os nós animados: cada raiz se move, então toda a floresta é recalculada
+    double total = 0.0;
+    int recalculados = 0;
+    for (int q = 0; q < QUADROS; ++q) {
+        for (int a = 0; a < NUMERO_RAIZES; ++a)
+            grafo.definirTranslacao(a * nosPorArvore, 0.01f * q, 0.0f, 0.0f);
+        inicio = std::chrono::steady_clock::now();
+        recalculados = grafo.atualizar();
+        total += milissegundos(inicio);
+    }
+    printf("Todos animados: %d nós recalculados em %.2f ms por quadro\n", recalculados, total / QUADROS);
+
+    // Poucas alterações: só as subárvores de 1%% dos nós são recalculadas
+    total = 0.0;
+    for (int q = 0; q < QUADROS; ++q) {
+        for (int k = 0; k < NUMERO_NOS / 100; ++k) {
+            int no = static_cast<int>(gerador() % NUMERO_NOS);
+            grafo.definirRotacao(no, 0.1f * q, 0.0f, 0.0f, 1.0f);
+        }
+        inicio = std::chrono::steady_clock::now();
+        recalculados = grafo.atualizar();
+        total += milissegundos(inicio);
+    }
+    printf("1%% dos nós alterados: %d nós recalculados em %.2f ms por quadro\n", recalculados, total / QUADROS);
+
+    // Confere um grafo menor contra a referência escalar, inclusive após atualizações parciais
+    grafo::GrafoCena pequeno;
+    std::vector<float> translacoes, angulos;
+    for (int i = 0; i < 10000; ++i) {
+        int no = pequeno.adicionar(i == 0 ? -1 : static_cast<int>(gerador() % i));
+        translacoes.insert(translacoes.end(), {aleatorio(gerador), aleatorio(gerador), aleatorio(gerador)});
+        angulos.push_back(aleatorio(gerador));
+        pequeno.definirTranslacao(no, translacoes[3 * no], translacoes[3 * no + 1], translacoes[3 * no + 2]);
+        pequeno.definirRotacao(no, angulos[no], 0.0f, 0.0f, 1.0f);
+    }
+    pequeno.atualizar();
+    float erro = verificar(pequeno, translacoes, angulos);
+    for (int k = 0; k < 50; ++k) {
+        int no = static_cast<int>(gerador() % pequeno.tamanho());
+        angulos[no] = aleatorio(gerador);
+        pequeno.definirRotacao(no, angulos[no], 0.0f, 0.0f, 1.0f);
+    }
+    pequeno.atualizar();
+    erro = std::max(erro, verificar(pequeno, translacoes, angulos));
+    printf("Maior erro em relação à referência escalar: %g\n", erro);
+    return erro < 1e-3f ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+// Compara os núcleos de comum/transformacao_lote.hpp com o laço ingênuo glm::mat4 * glm::vec4
+//
+// Compilação: g++ -std=c++17 -O2 transformacao-lote-benchmark.cpp -o transformacao-lote-benchmark -pthread
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "../comum/transformacao_lote.hpp"
+
+const size_t NUMERO_VERTICES = 1 << 22;
+const int REPETICOES = 10;
+
+// Executa a função várias vezes e devolve o melhor tempo em milissegundos
+template <typename Funcao>
+double medir(Funcao funcao) {
+    double melhor = 1e30;
+    for (int r = 0; r < REPETICOES; ++r) {
+        auto inicio = std::chrono::steady_clock::now();
+        funcao();
+        melhor = std::min(melhor, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count());
+    }
+    return melhor;
+}
+
+void relatar(const char* nome, double ms, double referencia) {
+    printf("%-32s %8.2f ms  %6.0f Mvértices/s  %5.1fx\n", nome, ms, NUMERO_VERTICES / ms / 1e3, referencia / ms);
+}
+
+int main() {
+    std::mt19937 gerador(7);
+    std::uniform_real_distribution<float> aleatorio(-10.0f, 10.0f);
+    std::vector<float> x(NUMERO_VERTICES), y(NUMERO_VERTICES), z(NUMERO_VERTICES), xyz(3 * NUMERO_VERTICES);
+    std::vector<glm::vec4> vertices(NUMERO_VERTICES), resultadoGlm(NUMERO_VERTICES);
+    for (size_t i = 0; i < NUMERO_VERTICES; ++i) {
+        x[i] = aleatorio(gerador); y[i] = aleatorio(gerador); z[i] = aleatorio(gerador);
+        xyz[3 * i] = x[i]; xyz[3 * i + 1] = y[i]; xyz[3 * i + 2] = z[i];
+        vertices[i] = glm::vec4(x[i], y[i], z[i], 1.0f);
+    }
+
+    // Mesma composição usada em casa-glfw.cpp: projeção * translação
+    glm::mat4 mvp = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 100.0f) *
+                    glm::lookAt(glm::vec3(4, 3, -30), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0)) *
+                    glm::translate(glm::mat4(1.0f), glm::vec3(0.5f, 0.5f, 0.0f));
+    const float* m = glm::value_ptr(mvp);
+    lote::Viewport viewport = {0.0f, 0.0f, 1024.0f, 768.0f};
+
+    std::vector<float> ox(NUMERO_VERTICES), oy(NUMERO_VERTICES), oz(NUMERO_VERTICES), ow(NUMERO_VERTICES);
+    std::vector<float> xyzw(4 * NUMERO_VERTICES);
+
+    printf("%zu vértices, instruções: %s, %u threads\n\n", NUMERO_VERTICES, lote::nomeInstrucoes(),
+           tarefas::padrao().numeroTrabalhadores() + 1);
+
+    double ingenuo = medir([&] {
+        for (size_t i = 0; i < NUMERO_VERTICES; ++i)
+            resultadoGlm[i] = mvp * vertices[i];
+    });
+    relatar("glm::mat4 * glm::vec4", ingenuo, ingenuo);
+    relatar("SoA escalar", medir([&] { lote::transformarSoAEscalar(m, x.data(), y.data(), z.data(), NUMERO_VERTICES, ox.data(), oy.data(), oz.data(), ow.data()); }), ingenuo);
+    relatar("SoA vetorizado", medir([&] { lote::transformarSoA(m, x.data(), y.data(), z.data(), NUMERO_VERTICES, ox.data(), oy.data(), oz.data(), ow.data()); }), ingenuo);
+    relatar("SoA vetorizado + threads", medir([&] { lote::transformarSoAParalelo(m, x.data(), y.data(), z.data(), NUMERO_VERTICES, ox.data(), oy.data(), oz.data(), ow.data()); }), ingenuo);
+
+    // Confere a saída SoA contra a GLM
+    float maiorErro = 0.0f;
+    for (size_t i = 0; i < NUMERO_VERTICES; ++i) {
+        const glm::vec4& r = resultadoGlm[i];
+        maiorErro = std::max({maiorErro, std::fabs(r.x - ox[i]), std::fabs(r.y - oy[i]), std::fabs(r.z - oz[i]), std::fabs(r.w - ow[i])});
+    }
+
+    relatar("AoS vetorizado", medir([&] { lote::transformarAoS(m, xyz.data(), NUMERO_VERTICES, xyzw.data()); }), ingenuo);
+    relatar("AoS vetorizado + threads", medir([&] { lote::transformarAoSParalelo(m, xyz.data(), NUMERO_VERTICES, xyzw.data()); }), ingenuo);
+    for (size_t i = 0; i < NUMERO_VERTICES; ++i) {
+        const glm::vec4& r = resultadoGlm[i];
+        maiorErro = std::max({maiorErro, std::fabs(r.x - xyzw[4 * i]), std::fabs(r.w - xyzw[4 * i + 3])});
+    }
+
+    // Projeção completa (divisão perspectiva + viewport) contra o equivalente com GLM
+    double projecaoIngenua = medir([&] {
+        for (size_t i = 0; i < NUMERO_VERTICES; ++i) {
+            glm::vec4 c = mvp * vertices[i];
+            glm::vec3 ndc = glm::vec3(c) / c.w;
+            resultadoGlm[i] = glm::vec4((ndc.x * 0.5f + 0.5f) * viewport.largura, (ndc.y * 0.5f + 0.5f) * viewport.altura, ndc.z * 0.5f + 0.5f, c.w);
+        }
+    });
+    printf("\n");
+    relatar("projeção com glm", projecaoIngenua, projecaoIngenua);
+    relatar("projeção vetorizada", medir([&] { lote::projetarSoA(m, viewport, x.data(), y.data(), z.data(), NUMERO_VERTICES, ox.data(), oy.data(), oz.data(), ow.data()); }), projecaoIngenua);
+    relatar("projeção vetorizada + threads", medir([&] { lote::projetarSoAParalelo(m, viewport, x.data(), y.data(), z.data(), NUMERO_VERTICES, ox.data(), oy.data(), oz.data(), ow.data()); }), projecaoIngenua);
+    float maiorErroTela = 0.0f;
+    for (size_t i = 0; i < NUMERO_VERTICES; ++i) {
+        const glm::vec4& r = resultadoGlm[i];
+        if (r.w > 0.1f) // Vértices muito próximos do plano w = 0 amplificam o arredondamento
+            maiorErroTela = std::max({maiorErroTela, std::fabs(r.x - ox[i]), std::fabs(r.y - oy[i])});
+    }
+
+    printf("\nMaior erro: %g (recorte), %g pixels (tela)\n", maiorErro, maiorErroTela);
+    printf("\nAgendador de tarefas:\n");
+    tarefas::padrao().imprimirEstatisticas();
+    return maiorErro < 1e-3f && maiorErroTela < 0.5f ? 0 : 1;
+}
@@ -5,6 +5,9 @@
 #include <glm/glm.hpp> // Biblioteca GLM (OpenGL Mathematics) para operações matemáticas
 #include <glm/gtc/matrix_transform.hpp> // Extensão da biblioteca GLM para transformações geométricas
 #include <glm/gtc/type_ptr.hpp> // Extensão da biblioteca GLM para conversão de tipos
+#include "../../comum/gerenciador_shaders.hpp" // Cache de programas GLSL (binários salvos em disco)
+
+GerenciadorShaders gerenciadorShaders; // Compila os programas ou os recarrega do cache em disco
 
 // Protótipos de funções (declarações)
 GLuint CarregarShaders(); // Função para carregar e compilar os shaders
@@ -137,52 +140,10 @@ int main() {
 
 
 GLuint CarregarShaders() {
-    // Cria os shaders
-    GLuint IDShaderVertices = glCreateShader(GL_VERTEX_SHADER); // Cria um objeto de shader de vértices
-    GLuint IDShaderFragmentos = glCreateShader(GL_FRAGMENT_SHADER); // Cria um objeto de shader de fragmentos
-
-    // Compila o Shader de Vértices
-    glShaderSource(IDShaderVertices, 1, &CodigoShaderVertices, nullptr);
-    glCompileShader(IDShaderVertices); // Compila o código fonte do shader de vértices
-
-    // Verifica se o Shader de Vértices compilou corretamente
-    GLint sucesso;
-    GLchar infoLog[512];
-    glGetShaderiv(IDShaderVertices, GL_COMPILE_STATUS, &sucesso);
-    if (!sucesso) {
-        glGetShaderInfoLog(IDShaderVertices, 512, nullptr, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-        // Se o shader de vértices não compilou, exibe o log de erros da compilação
-    }
-
-    // Compila o Shader de Fragmentos
-    glShaderSource(IDShaderFragmentos, 1, &CodigoShaderFragmentos, nullptr);
-    glCompileShader(IDShaderFragmentos); // Compila o código fonte do shader de fragmentos
-
-    // Verifica se o Shader de Fragmentos compilou corretamente
-    glGetShaderiv(IDShaderFragmentos, GL_COMPILE_STATUS, &sucesso);
-    if (!sucesso) {
-        glGetShaderInfoLog(IDShaderFragmentos, 512, nullptr, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-        // Se o shader de fragmentos não compilou, exibe o log de erros da compilação
-    }
-
-    // Faz o link do programa GLSL combinando os shaders compilados
-    IDPrograma = glCreateProgram(); // Cria um objeto de programa GLSL
-    glAttachShader(IDPrograma, IDShaderVertices); // Anexa o shader de vértices ao programa
-    glAttachShader(IDPrograma, IDShaderFragmentos); // Anexa o shader de fragmentos ao programa
-    glLinkProgram(IDPrograma); // Faz o link do programa combinando os shaders anexados
-
-    // Verifica se o programa GLSL foi linkado corretamente
-    glGetProgramiv(IDPrograma, GL_LINK_STATUS, &sucesso);
-    if (!sucesso) {
-        glGetProgramInfoLog(IDPrograma, 512, nullptr, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-        // Se o programa não foi linkado corretamente, exibe o log de erros do link
-    }
-
-    glDeleteShader(IDShaderVertices); // Exclui o objeto de shader de vértices, pois ele já foi incorporado ao programa
-    glDeleteShader(IDShaderFragmentos); // Exclui o objeto de shader de fragmentos, pois ele já foi incorporado ao programa
+    // Compila e linka o programa GLSL, ou o recarrega do cache de binários gerado em uma execução anterior
+    size_t solicitacao = gerenciadorShaders.solicitar(CodigoShaderVertices, CodigoShaderFragmentos);
+    IDPrograma = gerenciadorShaders.programa(solicitacao); // Espera o fim do link; 0 se houve erro (o log é impresso)
+    gerenciadorShaders.imprimirEstatisticas(); // Informa se o programa veio do cache ou foi compilado
 
     return IDPrograma; // Retorna o identificador do programa GLSL linkado
 }
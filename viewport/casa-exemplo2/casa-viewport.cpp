@@ -1,29 +1,58 @@
 // Inclui as bibliotecas necessárias
 #include <iostream> // Biblioteca padrão de entrada/saída em C++
+#include <cstdlib> // Biblioteca padrão C (atoi)
+#include <vector> // Biblioteca padrão de vetores dinâmicos
 #include <GL/glew.h> // Biblioteca GLEW (OpenGL Extension Wrangler Library) para carregar funções OpenGL
 #include <GLFW/glfw3.h> // Biblioteca GLFW (Graphics Library Framework) para gerenciamento de janelas e entrada
 #include <glm/glm.hpp> // Biblioteca GLM (OpenGL Mathematics) para operações matemáticas
 #include <glm/gtc/matrix_transform.hpp> // Extensão da biblioteca GLM para transformações geométricas
 #include <glm/gtc/type_ptr.hpp> // Extensão da biblioteca GLM para conversão de tipos
+#include "../../comum/cena.hpp" // Leitura da cena (malhas, câmeras e viewports) a partir de arquivo
+#include "../../comum/gerenciador_shaders.hpp" // Cache de programas GLSL (binários salvos em disco)
+#include "../../comum/lote_desenho.hpp" // Megabuffers e desenho indireto com número constante de chamadas
+#include "../../comum/comandos_render.hpp" // Gravação de comandos em várias threads, execução na thread do OpenGL
+#include "../../comum/disposicao_viewports.hpp" // Retângulos das vistas, recalculados só quando o framebuffer muda de tamanho
+#include "../../comum/renderizacao_sob_demanda.hpp" // Laço que dorme até um evento pedir um novo quadro
+
+GerenciadorShaders gerenciadorShaders; // Compila os programas ou os recarrega do cache em disco
 
 // Protótipos de funções (declarações)
 GLuint CarregarShaders(); // Função para carregar e compilar os shaders
-void TransferirDadosParaGPU(); // Função para transferir dados para a GPU
+void TransferirDadosParaGPU(int copias); // Função para transferir dados para a GPU
 void LimparDadosDaGPU(); // Função para limpar dados da GPU
-void Desenhar(); // Função para desenhar na janela
+void GravarViewport(const disposicao::Retangulo& retangulo, const cena::Camera& camera, comandos::BufferComandos& buffer,
+                    LoteDesenho<struct VerticeCasa>::Visiveis& visiveis); // Grava (sem chamar o OpenGL) os comandos de um viewport
+void CallbackTamanhoFramebuffer(GLFWwindow* janela, int largura, int altura); // Recalcula a disposição das vistas
+void DesenharLote(LoteDesenho<struct VerticeCasa>::Visiveis* visiveis); // Desenha o resultado do descarte na thread do OpenGL
+
+
+// Vértice intercalado (posição e cor) usado nos megabuffers do lote de desenho
+struct VerticeCasa {
+    GLfloat posicaoVertice[3]; // Coordenadas x, y, z
+    vertice::CorRGBA8 corVertice; // Cor r, g, b (e a) com 8 bits por canal
+};
+template <> struct vertice::Formato<VerticeCasa> { // Gera os glVertexAttribPointer e as entradas do shader de vértices
+    static constexpr vertice::Atributo atributos[] = {
+        ATRIBUTO_VERTICE(VerticeCasa, posicaoVertice, 0),
+        ATRIBUTO_VERTICE(VerticeCasa, corVertice, 1),
+    };
+};
 
+// Lote de desenho: todas as malhas da cena em um único VBO/IBO e as matrizes de modelo em um buffer de instâncias
+LoteDesenho<VerticeCasa> lote(4); // A matriz de modelo ocupa os locais de atributo 4 a 7
+// Com GL 4.3 cada viewport é desenhado com uma única glMultiDrawElementsIndirect, qualquer que seja o número de objetos
 
-// Objeto de Array de Vértices (VAO)
-GLuint IDArrayVertices; // Inicializa uma variável global como None para armazenar o identificador do objeto Vertex Array (VAO)
-// O Vertex Array Object (VAO) é um objeto que armazena os buffers de dados de vértices
+// Grava os comandos de cada viewport (matrizes da câmera e descarte dos objetos) em paralelo
+comandos::GravadorParalelo gravador; // Nos trabalhadores de tarefas::padrao() e na thread principal, dona do contexto OpenGL
+std::vector<LoteDesenho<VerticeCasa>::Visiveis> visiveisPorViewport; // Resultado do descarte de cada viewport no quadro
+GLint localProjecaoVisualizacao = -1; // Local do uniform, obtido uma vez na thread do OpenGL
 
-// Objeto de Buffer de Vértices (VBO)
-GLuint bufferVertices; // Inicializa uma variável global como None para armazenar o identificador do objeto Vertex Buffer (VBO)
-// O Vertex Buffer Object (VBO) é um objeto que armazena os dados dos vértices (posições, coordenadas de textura, normais, etc.)
+// Disposição das vistas na janela: os viewports da cena (em frações) ou, com o terceiro argumento, uma grade de N vistas
+disposicao::Disposicao disposicaoVistas;
+std::vector<uint32_t> cameraPorVista; // Câmera da cena usada por cada vista
 
-// Objeto de Buffer de Cores (CBO)
-GLuint bufferCores; // Inicializa uma variável global como None para armazenar o identificador do objeto Color Buffer (CBO)
-// O Color Buffer Object (CBO) é um objeto que armazena as cores dos vértices
+// Cena carregada do arquivo (.cena em texto ou .cenab binário mapeado na memória)
+cena::Cena cenaAtual; // Mantém o arquivo mapeado enquanto os ponteiros para vértices, cores e viewports forem usados
 
 // Programa GLSL
 GLuint IDPrograma; // Inicializa uma variável global como None para armazenar o identificador do programa GLSL compilado a partir dos shaders
@@ -34,16 +63,15 @@ const char* CodigoShaderVertices = R"(
 #version 330 core
 // A linha acima especifica a versão do GLSL (OpenGL Shading Language) que será usada (330 core)
 
-// Entradas de dados de vértices e cores
-layout(location = 0) in vec3 posicaoVertice;
-// A linha acima declara uma variável de entrada chamada 'posicaoVertice' do tipo vec3 (vetor de 3 componentes) que receberá as coordenadas dos vértices. O layout(location = 0) especifica que esta variável será associada ao índice 0 dos atributos de vértice.
+// As entradas 'posicaoVertice' (vec3) e 'corVertice' (vec4) são declaradas a partir de VerticeCasa (veja formato_vertice.hpp)
 
-layout(location = 1) in vec3 corVertice;
-// A linha acima declara uma variável de entrada chamada 'corVertice' do tipo vec3 (vetor de 3 componentes) que receberá as cores dos vértices. O layout(location = 1) especifica que esta variável será associada ao índice 1 dos atributos de vértice.
+// Matriz de modelo do objeto, lida do buffer de instâncias (uma por objeto)
+layout(location = 4) in mat4 modelo;
+// A linha acima declara uma entrada do tipo mat4, que ocupa os locais 4 a 7 (uma coluna por local). Ela muda a cada instância, não a cada vértice.
 
-// Matriz de transformação da janela para a viewport
-uniform mat4 mvp;
-// A linha acima declara uma variável uniforme chamada 'mvp' do tipo mat4 (matriz 4x4) que receberá a matriz de transformação da janela para a viewport.
+// Matriz de projeção e visualização da câmera do viewport
+uniform mat4 projecaoVisualizacao;
+// A linha acima declara uma variável uniforme chamada 'projecaoVisualizacao' do tipo mat4 (matriz 4x4), comum a todos os objetos desenhados no viewport.
 
 // Dados de saída para o shader de fragmentos
 out vec3 corFragmento;
@@ -53,11 +81,11 @@ void main() {
 // A linha acima define a função principal do shader de vértices.
 
     // Projeta cada vértice em coordenadas homogêneas
-    gl_Position = mvp * vec4(posicaoVertice, 1.0);
-    // A linha acima projeta as coordenadas de vértice 'posicaoVertice' em coordenadas homogêneas (4D) usando a matriz de transformação 'mvp'. O resultado é armazenado na variável built-in 'gl_Position', que define a posição final do vértice.
+    gl_Position = projecaoVisualizacao * modelo * vec4(posicaoVertice, 1.0);
+    // A linha acima leva as coordenadas de vértice 'posicaoVertice' para o mundo com a matriz 'modelo' e as projeta em coordenadas homogêneas (4D). O resultado é armazenado na variável built-in 'gl_Position', que define a posição final do vértice.
 
     // O shader de vértices apenas passa a cor para o shader de fragmentos
-    corFragmento = corVertice;
+    corFragmento = corVertice.rgb;
     // A linha acima simplesmente atribui a cor do vértice 'corVertice' à variável de saída 'corFragmento', que será interpolada e enviada para o shader de fragmentos.
 }
 )";
@@ -84,7 +112,18 @@ void main() {
 )";
 
 // Função principal
-int main() {
+int main(int argc, char* argv[]) {
+    // Carrega a cena (por padrão casa.cena no diretório corrente; aceita também o binário .cenab)
+    const char* caminhoCena = argc > 1 ? argv[1] : "casa.cena";
+    int copias = argc > 2 ? std::atoi(argv[2]) : 1; // Cópias de cada objeto em grade, para medir o custo com muitos objetos
+    int vistas = argc > 3 ? std::atoi(argv[3]) : 0; // Número de vistas em grade (por exemplo 64, para um painel de vídeo); 0 usa os viewports da cena
+    try {
+        cenaAtual = cena::Cena::carregar(caminhoCena); // Lê o arquivo em uma única passada
+    } catch (const std::exception& e) {
+        std::cerr << "Erro ao carregar a cena: " << e.what() << std::endl; // Imprime mensagem de erro no fluxo de erro padrão
+        return -1; // Retorna um valor de erro (-1) para indicar que o programa falhou
+    }
+
     // Inicializa a biblioteca GLFW
     if (!glfwInit()) {
         std::cerr << "Falha ao inicializar GLFW" << std::endl; // Imprime mensagem de erro no fluxo de erro padrão
@@ -120,39 +159,70 @@ int main() {
     }
 
     // Transfere os dados (vértices, cores e shaders) para a memória da GPU
-    TransferirDadosParaGPU(); // Chama a função para transferir dados para a GPU
+    TransferirDadosParaGPU(copias); // Chama a função para transferir dados para a GPU
     CarregarShaders(); // Chama a função para carregar e compilar os shaders
 
-    // Divide a janela em 4 regiões e desenha em cada uma delas
+    // Configura a disposição das vistas
+    if (vistas > 0) {
+        // Grade de vistas que repetem, em ordem, as câmeras dos viewports da cena. Se a primeira câmera for
+        // ortográfica, as vistas mantêm a proporção do volume de visão (com faixas nas sobras, sem distorcer)
+        for (int i = 0; i < vistas; i++)
+            cameraPorVista.push_back(cenaAtual.numeroViewports() > 0 ? cenaAtual.viewports()[i % cenaAtual.numeroViewports()].camera : 0);
+        const cena::Camera& camera = cenaAtual.cameras()[cameraPorVista[0]];
+        float proporcao = 0.0f;
+        if (camera.tipo == cena::CAMERA_ORTOGRAFICA && camera.parametros[3] != camera.parametros[2])
+            proporcao = (camera.parametros[1] - camera.parametros[0]) / (camera.parametros[3] - camera.parametros[2]);
+        disposicaoVistas.configurar(disposicao::GRADE, vistas, proporcao, 2);
+    } else {
+        // Viewports descritos na cena, em frações da janela, como antes
+        std::vector<disposicao::Fracao> fracoes;
+        for (uint32_t i = 0; i < cenaAtual.numeroViewports(); i++) {
+            const cena::Viewport& v = cenaAtual.viewports()[i];
+            fracoes.push_back({v.x, v.y, v.largura, v.altura});
+            cameraPorVista.push_back(v.camera);
+        }
+        disposicaoVistas.configurarFracoes(fracoes);
+    }
+
+    // Os retângulos são calculados agora e depois só quando o framebuffer muda de tamanho
     int larguraJanela, alturaJanela;
-    glfwGetFramebufferSize(janela, &larguraJanela, &alturaJanela); // Obtém a largura e altura da janela
-    int larguraRegiao = larguraJanela / 2; // Calcula a largura de cada região (metade da largura da janela)
-    int alturaRegiao = alturaJanela / 2; // Calcula a altura de cada região (metade da altura da janela)
+    glfwGetFramebufferSize(janela, &larguraJanela, &alturaJanela); // Obtém a largura e altura do framebuffer
+    disposicaoVistas.redimensionar(larguraJanela, alturaJanela);
+    glfwSetFramebufferSizeCallback(janela, CallbackTamanhoFramebuffer);
+
+    // A cena é estática: só desenha quando a janela muda de tamanho, é exposta ou recebe entrada do usuário
+    RenderizacaoSobDemanda sobDemanda;
+    sobDemanda.conectar(janela); // Encadeia o callback de tamanho acima
 
     GLuint framebufferID; // Identificador do framebuffer
     glGenFramebuffers(1, &framebufferID); // Gera um framebuffer (objeto que armazena a imagem renderizada)
 
-    // Loop até que o usuário feche a janela
-    while (!glfwWindowShouldClose(janela)) { // Enquanto a janela não for fechada
+    // Loop até que o usuário feche a janela; proximoQuadro() dorme até haver algo a desenhar e processa os eventos
+    while (sobDemanda.proximoQuadro()) { // Enquanto a janela não for fechada
         glBindFramebuffer(GL_FRAMEBUFFER, 0); // Vincula o framebuffer padrão (a janela)
         glClear(GL_COLOR_BUFFER_BIT); // Limpa o buffer de cor da tela (preenche com a cor de fundo)
 
-        for (int i = 0; i < 2; i++) { // Itera sobre as linhas das regiões
-            for (int j = 0; j < 2; j++) { // Itera sobre as colunas das regiões
-                // Define a viewport para a região atual
-                glViewport(j * larguraRegiao, i * alturaRegiao, larguraRegiao, alturaRegiao);
-                // Define a região retangular da janela que será renderizada
-                // Desenha nesta região
-                Desenhar(); // Chama a função para desenhar na região atual
-            }
+        // Cada vista é uma tarefa: as threads de trabalho montam as matrizes, descartam os objetos fora do
+        // volume de visão e gravam os comandos; nenhuma delas chama o OpenGL. Todas as vistas saem em uma única passada.
+        const std::vector<disposicao::Retangulo>& retangulos = disposicaoVistas.retangulos();
+        visiveisPorViewport.resize(retangulos.size());
+        gravador.gravar(retangulos.size(), [&](size_t i, comandos::BufferComandos& buffer) {
+            GravarViewport(retangulos[i], cenaAtual.cameras()[cameraPorVista[i]], buffer, visiveisPorViewport[i]);
+        });
+        gravador.executar(); // A thread principal emite os comandos de todas as vistas, em ordem
+
+        static bool estatisticasImpressas = false;
+        if (!estatisticasImpressas) { // Informa uma vez quantas chamadas de desenho o último viewport precisou
+            std::cout << "Último viewport: " << lote.visiveisUltimoDesenho() << " objetos visíveis em "
+                      << lote.chamadasUltimoDesenho() << " chamada(s) de desenho" << std::endl;
+            estatisticasImpressas = true;
         }
 
         // Troca os buffers de frente e fundo da janela
         glfwSwapBuffers(janela); // Troca os buffers de frente e fundo da janela (double buffering)
-
-        // Processa eventos de entrada (teclado, mouse, etc.)
-        glfwPollEvents(); // Processa eventos de entrada (teclado, mouse, etc.)
     }
+    sobDemanda.imprimirEstatisticas(); // Quantos quadros foram de fato desenhados
+    sobDemanda.desconectar(); // Restaura os callbacks antes de encerrar o GLFW
 
     // Limpa os objetos OpenGL da GPU
     LimparDadosDaGPU(); // Chama a função para limpar os dados da GPU
@@ -166,131 +236,86 @@ int main() {
 
 
 GLuint CarregarShaders() {
-    // Cria os shaders
-    GLuint IDShaderVertices = glCreateShader(GL_VERTEX_SHADER); // Cria um objeto de shader de vértices
-    GLuint IDShaderFragmentos = glCreateShader(GL_FRAGMENT_SHADER); // Cria um objeto de shader de fragmentos
-
-    // Compila o Shader de Vértices
-    glShaderSource(IDShaderVertices, 1, &CodigoShaderVertices, nullptr);
-    glCompileShader(IDShaderVertices); // Compila o código fonte do shader de vértices
-
-    // Verifica se o Shader de Vértices compilou corretamente
-    GLint sucesso;
-    GLchar infoLog[512];
-    glGetShaderiv(IDShaderVertices, GL_COMPILE_STATUS, &sucesso);
-    if (!sucesso) {
-        glGetShaderInfoLog(IDShaderVertices, 512, nullptr, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-        // Se o shader de vértices não compilou, exibe o log de erros da compilação
-    }
+    // Compila e linka o programa GLSL, ou o recarrega do cache de binários gerado em uma execução anterior
+    size_t solicitacao = gerenciadorShaders.solicitar(vertice::inserirDeclaracoes<VerticeCasa>(CodigoShaderVertices), CodigoShaderFragmentos);
+    IDPrograma = gerenciadorShaders.programa(solicitacao); // Espera o fim do link; 0 se houve erro (o log é impresso)
+    localProjecaoVisualizacao = glGetUniformLocation(IDPrograma, "projecaoVisualizacao"); // Consultado uma única vez
+    gerenciadorShaders.imprimirEstatisticas(); // Informa se o programa veio do cache ou foi compilado
 
-    // Compila o Shader de Fragmentos
-    glShaderSource(IDShaderFragmentos, 1, &CodigoShaderFragmentos, nullptr);
-    glCompileShader(IDShaderFragmentos); // Compila o código fonte do shader de fragmentos
+    return IDPrograma; // Retorna o identificador do programa GLSL linkado
+}
 
-    // Verifica se o Shader de Fragmentos compilou corretamente
-    glGetShaderiv(IDShaderFragmentos, GL_COMPILE_STATUS, &sucesso);
-    if (!sucesso) {
-        glGetShaderInfoLog(IDShaderFragmentos, 512, nullptr, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-        // Se o shader de fragmentos não compilou, exibe o log de erros da compilação
+void TransferirDadosParaGPU(int copias) {
+    // Cada malha da cena vira um intervalo do megabuffer de vértices, com índices próprios
+    const float* posicoes = cenaAtual.posicoes();
+    const float* cores = cenaAtual.cores();
+    for (uint32_t m = 0; m < cenaAtual.numeroMalhas(); m++) {
+        const cena::Malha& malha = cenaAtual.malhas()[m];
+        std::vector<VerticeCasa> vertices(malha.numeroVertices);
+        std::vector<uint32_t> indices(malha.numeroVertices);
+        for (uint32_t v = 0; v < malha.numeroVertices; v++) {
+            const float* p = &posicoes[3 * size_t(malha.primeiroVertice + v)];
+            const float* c = &cores[3 * size_t(malha.primeiroVertice + v)];
+            vertices[v] = {{p[0], p[1], p[2]}, vertice::empacotarCor(c[0], c[1], c[2])};
+            indices[v] = v; // As malhas da cena são listas de triângulos sem vértices compartilhados
+        }
+        lote.adicionarMalha(vertices, indices);
     }
 
-    // Faz o link do programa GLSL combinando os shaders compilados
-    IDPrograma = glCreateProgram(); // Cria um objeto de programa GLSL
-    glAttachShader(IDPrograma, IDShaderVertices); // Anexa o shader de vértices ao programa
-    glAttachShader(IDPrograma, IDShaderFragmentos); // Anexa o shader de fragmentos ao programa
-    glLinkProgram(IDPrograma); // Faz o link do programa combinando os shaders anexados
-
-    // Verifica se o programa GLSL foi linkado corretamente
-    glGetProgramiv(IDPrograma, GL_LINK_STATUS, &sucesso);
-    if (!sucesso) {
-        glGetProgramInfoLog(IDPrograma, 512, nullptr, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-        // Se o programa não foi linkado corretamente, exibe o log de erros do link
+    // Objetos da cena, replicados em uma grade de copias x copias (30 unidades na horizontal, 40 na vertical)
+    for (uint32_t i = 0; i < cenaAtual.numeroObjetos(); i++) {
+        const cena::Objeto& objeto = cenaAtual.objetos()[i];
+        for (int linha = 0; linha < copias; linha++) {
+            for (int coluna = 0; coluna < copias; coluna++) {
+                glm::mat4 deslocamento = glm::translate(glm::mat4(1.0f), glm::vec3(30.0f * coluna, 40.0f * linha, 0.0f));
+                glm::mat4 modelo = deslocamento * glm::make_mat4(objeto.modelo);
+                lote.adicionarObjeto(objeto.malha, glm::value_ptr(modelo));
+            }
+        }
     }
 
-    glDeleteShader(IDShaderVertices); // Exclui o objeto de shader de vértices, pois ele já foi incorporado ao programa
-    glDeleteShader(IDShaderFragmentos); // Exclui o objeto de shader de fragmentos, pois ele já foi incorporado ao programa
-
-    return IDPrograma; // Retorna o identificador do programa GLSL linkado
-}
-
-void TransferirDadosParaGPU() {
-    // Dados de vértices para 3 triângulos
-    GLfloat dadosBufferVertices[] = {
-        0.0f, 0.0f,  0.0f,  20.0f, 0.0f,
-        0.0f, 20.0f, 20.0f, 0.0f,  // primeiro triângulo
-        0.0f, 0.0f,  0.0f,  20.0f, 20.0f,
-        0.0f, 0.0f,  20.0f, 0.0f,  // segundo triângulo
-        0.0f, 20.0f, 0.0f,  20.0f, 20.0f,
-        0.0f, 10.0f, 30.0f, 0.0f   // terceiro triângulo
-    };
-    // Define um array com as coordenadas dos vértices para três triângulos
-
-    // Uma cor para cada vértice
-    GLfloat dadosBufferCores[] = {
-        1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
-        0.0f, 1.0f, 0.0f, 0.0f,  // cor para os 3 vértices do primeiro triângulo
-        1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
-        0.0f, 1.0f, 0.0f, 0.0f,  // cor para os 3 vértices do segundo triângulo
-        0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
-        0.0f, 0.0f, 1.0f, 0.0f   // cor para os 3 vértices do terceiro triângulo
-    };
-    // Define um array com as cores para cada vértice dos triângulos
-
-    // VAO (Vertex Array Object)
-    glGenVertexArrays(1, &IDArrayVertices); // Gera um objeto Vertex Array (VAO)
-    glBindVertexArray(IDArrayVertices); // Vincula o VAO criado como o VAO ativo
-
-    // Move os dados de vértices para a memória de vídeo, especificamente para o VBO
-    glGenBuffers(1, &bufferVertices); // Gera um objeto Vertex Buffer (VBO)
-    glBindBuffer(GL_ARRAY_BUFFER, bufferVertices); // Vincula o VBO criado como o VBO ativo
-    glBufferData(GL_ARRAY_BUFFER, sizeof(dadosBufferVertices), dadosBufferVertices, GL_STATIC_DRAW);
-    // Transfere os dados dos vértices do array para a memória de vídeo (VBO)
-
-    // Move os dados de cores para a memória de vídeo, especificamente para o CBO
-    glGenBuffers(1, &bufferCores); // Gera um objeto Color Buffer (CBO)
-    glBindBuffer(GL_ARRAY_BUFFER, bufferCores); // Vincula o CBO criado como o VBO ativo
-    glBufferData(GL_ARRAY_BUFFER, sizeof(dadosBufferCores), dadosBufferCores, GL_STATIC_DRAW);
-    // Transfere os dados das cores do array para a memória de vídeo (CBO)
-
-    // Atributos de vértices
-    glBindBuffer(GL_ARRAY_BUFFER, bufferVertices); // Vincula o VBO com os dados de vértices
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
-    // Define o ponteiro para o atributo de vértice no índice 0, com 3 componentes (x, y, z), tipo float
-    glEnableVertexAttribArray(0); // Habilita o atributo de vértice no índice 0
-
-    // Atributos de cores
-    glBindBuffer(GL_ARRAY_BUFFER, bufferCores); // Vincula o CBO com os dados de cores
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
-    // Define o ponteiro para o atributo de cor no índice 1, com 3 componentes (r, g, b), tipo float
-    glEnableVertexAttribArray(1); // Habilita o atributo de cor no índice 1
+    // Cria o VAO, os megabuffers e o buffer de instâncias (e o de comandos, quando há desenho indireto)
+    lote.enviar();
+    lote.imprimirEstatisticas(); // Informa o caminho escolhido (instanciado, indireto ou com descarte na GPU)
 }
 
 void LimparDadosDaGPU() {
-    glDeleteBuffers(1, &bufferVertices); // Exclui o objeto VBO da GPU
-    glDeleteBuffers(1, &bufferCores); // Exclui o objeto CBO da GPU
-    glDeleteVertexArrays(1, &IDArrayVertices); // Exclui o objeto VAO da GPU
+    lote.limpar(); // Exclui o VAO e os buffers do lote da GPU
     glDeleteProgram(IDPrograma); // Exclui o programa GLSL da GPU
 }
 
-void Desenhar() {
-    // Limpa o buffer de cores da tela
-    // glClear(GL_COLOR_BUFFER_BIT); // Limpa o buffer de cor da tela
+void CallbackTamanhoFramebuffer(GLFWwindow*, int largura, int altura) {
+    disposicaoVistas.redimensionar(largura, altura); // Único ponto em que os retângulos das vistas são recalculados
+}
+
+void GravarViewport(const disposicao::Retangulo& retangulo, const cena::Camera& camera, comandos::BufferComandos& buffer,
+                    LoteDesenho<VerticeCasa>::Visiveis& visiveis) {
+    // Define a viewport para a região da vista, já em pixels
+    buffer.viewport(retangulo.x, retangulo.y, retangulo.largura, retangulo.altura); // Grava a região retangular da janela que será renderizada
 
     // Utiliza o programa GLSL criado
-    glUseProgram(IDPrograma); // Ativa o programa GLSL criado
+    buffer.usarPrograma(IDPrograma); // Grava a ativação do programa GLSL criado
+
+    // Monta as matrizes de projeção e de visualização a partir da câmera do viewport
+    glm::mat4 projecao;
+    if (camera.tipo == cena::CAMERA_ORTOGRAFICA) {
+        const float* p = camera.parametros;
+        projecao = glm::ortho(p[0], p[1], p[2], p[3], p[4], p[5]); // Cria uma matriz de projeção ortogonal
+    } else {
+        float proporcao = retangulo.proporcao();
+        projecao = glm::perspective(glm::radians(camera.parametros[0]), proporcao, camera.parametros[1], camera.parametros[2]);
+    }
+    glm::mat4 visualizacao = glm::lookAt(glm::make_vec3(camera.olho), glm::make_vec3(camera.alvo), glm::make_vec3(camera.cima));
+    glm::mat4 projecaoVisualizacao = projecao * visualizacao;
 
-    // Transformação da janela para a viewport
-    glm::mat4 mvp = glm::ortho(-40.0f, 40.0f, -40.0f, 40.0f); // Cria uma matriz de projeção ortogonal
+    // Grava o envio da matriz da câmera; as matrizes de modelo já estão no buffer de instâncias
+    buffer.uniformeMatriz4(localProjecaoVisualizacao, glm::value_ptr(projecaoVisualizacao));
 
-    // Obtém o local da variável uniforme da matriz de transformação
-    GLint matrizUniforme = glGetUniformLocation(IDPrograma, "mvp"); // Obtém o local da variável uniforme "mvp" no programa GLSL
-    glUniformMatrix4fv(matrizUniforme, 1, GL_FALSE, glm::value_ptr(mvp));
-    // Envia a matriz mvp para a variável uniforme "mvp" no programa GLSL
+    // Descarta os objetos fora do volume de visão aqui mesmo, na thread de trabalho, e grava o desenho do resultado
+    lote.descartar(glm::value_ptr(projecaoVisualizacao), visiveis);
+    buffer.chamar(DesenharLote, &visiveis);
+}
 
-    // Desenha os 3 triângulos
-    glBindVertexArray(IDArrayVertices); // Vincula o VAO com os dados de vértices e cores
-    glDrawArrays(GL_TRIANGLES, 0, 9); // Desenha 3 triângulos a partir dos 9 vértices fornecidos
-}
\ No newline at end of file
+void DesenharLote(LoteDesenho<VerticeCasa>::Visiveis* visiveis) {
+    lote.desenharVisiveis(*visiveis); // Envia as matrizes visíveis e os comandos indiretos (thread do OpenGL)
+}
@@ -1,6 +1,34 @@
 #include <GLFW/glfw3.h>  // Inclui a biblioteca GLFW
 #include <OpenGL/gl.h>    // Inclui a biblioteca OpenGL
 
+#include "../../comum/renderizacao_sob_demanda.hpp"  // Laço que só desenha quando algo muda
+
+// Dimensões da cena (supondo que a cena está carregada ou calculada)
+int larguraCena = 1280;
+int alturaCena = 720;
+
+// Viewport ajustada, recalculada apenas quando o framebuffer muda de tamanho
+int larguraViewportAjustada, alturaViewportAjustada;
+
+// Ajusta as dimensões da viewport com base na proporção de aspecto da cena
+void ajustarViewport(int larguraFramebuffer, int alturaFramebuffer) {
+    // Calcula a proporção de aspecto da cena
+    float proporcaoAspectoCena = (float)larguraCena / (float)alturaCena;
+
+    if (proporcaoAspectoCena > 1.0f) {  // Se a proporção de aspecto da cena for maior que 1.0
+        larguraViewportAjustada = larguraFramebuffer;
+        alturaViewportAjustada = larguraFramebuffer / proporcaoAspectoCena;
+    } else {
+        larguraViewportAjustada = alturaFramebuffer * proporcaoAspectoCena;
+        alturaViewportAjustada = alturaFramebuffer;
+    }
+}
+
+// Chamado pelo GLFW quando o tamanho do framebuffer muda (inclusive ao mover a janela entre telas de densidades diferentes)
+void callbackTamanhoFramebuffer(GLFWwindow*, int largura, int altura) {
+    ajustarViewport(largura, altura);
+}
+
 int main() {  // Função principal do programa
     // Inicializa o GLFW
     glfwInit();
@@ -14,31 +42,18 @@ int main() {  // Função principal do programa
     GLFWwindow* janela = glfwCreateWindow(larguraJanela, alturaJanela, "Configuração da Viewport", NULL, NULL);  // Cria a janela
     glfwMakeContextCurrent(janela);  // Define a janela atual como contexto OpenGL
 
-    // Define as dimensões da viewport para coincidir com as dimensões da janela inicialmente
-    glViewport(0, 0, larguraJanela, alturaJanela);
-
-    // Dimensões da cena (supondo que a cena está carregada ou calculada)
-    int larguraCena = 1280;
-    int alturaCena = 720;
-
-    // Calcula a proporção de aspecto da cena
-    float proporcaoAspectoCena = (float)larguraCena / (float)alturaCena;
+    // Calcula a viewport para o tamanho inicial do framebuffer (que pode diferir da janela em telas de alta densidade)
+    int larguraFramebuffer, alturaFramebuffer;
+    glfwGetFramebufferSize(janela, &larguraFramebuffer, &alturaFramebuffer);
+    ajustarViewport(larguraFramebuffer, alturaFramebuffer);
+    glfwSetFramebufferSizeCallback(janela, callbackTamanhoFramebuffer);
 
-    // Loop principal
-    while (!glfwWindowShouldClose(janela)) {  // Enquanto a janela não deve ser fechada
-        // Verifica eventos
-        glfwPollEvents();
-
-        // Ajusta as dimensões da viewport com base na proporção de aspecto da cena
-        int larguraViewportAjustada, alturaViewportAjustada;
-        if (proporcaoAspectoCena > 1.0f) {  // Se a proporção de aspecto da cena for maior que 1.0
-            larguraViewportAjustada = larguraJanela;
-            alturaViewportAjustada = larguraJanela / proporcaoAspectoCena;
-        } else {
-            larguraViewportAjustada = alturaJanela * proporcaoAspectoCena;
-            alturaViewportAjustada = alturaJanela;
-        }
+    // Desenha só quando necessário: redimensionamento, exposição da janela ou entrada do usuário
+    RenderizacaoSobDemanda sobDemanda;
+    sobDemanda.conectar(janela);
 
+    // Loop principal: proximoQuadro() dorme até haver algo a desenhar e devolve false quando a janela deve fechar
+    while (sobDemanda.proximoQuadro()) {
         // Define as dimensões atualizadas da viewport
         glViewport(0, 0, larguraViewportAjustada, alturaViewportAjustada);  // (x, y, larguraViewportAjustada, alturaViewportAjustada)
 
@@ -53,6 +68,7 @@ int main() {  // Função principal do programa
     }
 
     // Finaliza o GLFW
+    sobDemanda.desconectar();
     glfwTerminate();
 
     return 0;